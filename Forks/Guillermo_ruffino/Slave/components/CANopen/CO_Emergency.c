@@ -226,6 +226,73 @@ void CO_EM_initCallbackRx(
 }
 
 
+/*
+ * Add message to emergency buffer and update error status bit. Called by
+ * CO_errorReport() and CO_errorReset(), which may run in different threads
+ * than CO_EM_process(), so check, update and copy are one critical section.
+ *
+ * @param set True to set errorBit, false to clear it.
+ *
+ * @return true, if error status bit has changed.
+ */
+static bool_t CO_EM_bufAdd(CO_EM_t *em, uint8_t *errorStatusBits, uint8_t bitmask,
+                           bool_t set, const uint8_t msg[8])
+{
+    bool_t changed;
+
+    CO_LOCK_EMCY();
+    /* if error was already reported or cleared, do nothing */
+    changed = ((*errorStatusBits & bitmask) != 0) != set;
+    if(changed){
+        if(!set){
+            *errorStatusBits &= ~bitmask;
+        }
+        else if(msg[3] != CO_EM_NO_ERROR){
+            /* any error except NO_ERROR */
+            *errorStatusBits |= bitmask;
+        }
+
+        /* verify buffer full, set overflow */
+        if(em->bufFull){
+            em->bufFull = 2;
+            changed = false;
+        }
+        else{
+            /* copy data to the buffer, increment writePtr and verify buffer full */
+            CO_memcpy(em->bufWritePtr, msg, 8);
+            em->bufWritePtr += 8;
+
+            if(em->bufWritePtr == em->bufEnd) em->bufWritePtr = em->buf;
+            if(em->bufWritePtr == em->bufReadPtr) em->bufFull = 1;
+        }
+    }
+    CO_UNLOCK_EMCY();
+
+    return changed;
+}
+
+
+/*
+ * Take oldest message from emergency buffer, which must not be empty, and
+ * add errorRegister to it. Sets overflow, if messages were lost, because
+ * buffer was full.
+ */
+static void CO_EM_bufTake(CO_EM_t *em, uint8_t msg[8], uint8_t errorRegister, bool_t *overflow)
+{
+    CO_LOCK_EMCY();
+    em->bufReadPtr[2] = errorRegister;
+    CO_memcpy(msg, em->bufReadPtr, 8);
+    em->bufReadPtr += 8;
+    if(em->bufReadPtr == em->bufEnd){
+        em->bufReadPtr = em->buf;
+    }
+    /* one entry is free now, clear full flag */
+    *overflow = (em->bufFull == 2U);
+    em->bufFull = 0U;
+    CO_UNLOCK_EMCY();
+}
+
+
 /******************************************************************************/
 void CO_EM_process(
         CO_EMpr_t              *emPr,
@@ -282,28 +349,23 @@ void CO_EM_process(
 
         if (emPr->inhibitEmTimer >= emInhTime) {
             /* inhibit time elapsed, send message */
+            uint8_t msg[8];
+            bool_t overflow;
 
-            /* add error register */
-            em->bufReadPtr[2] = *emPr->errorRegister;
+            CO_EM_bufTake(em, msg, *emPr->errorRegister, &overflow);
 
             /* copy data to CAN emergency message */
-            CO_memcpy(emPr->CANtxBuff->data, em->bufReadPtr, 8U);
-            CO_memcpy((uint8_t*)&preDEF, em->bufReadPtr, 4U);
-            em->bufReadPtr += 8;
+            CO_memcpy(emPr->CANtxBuff->data, msg, 8U);
+            CO_memcpy((uint8_t*)&preDEF, msg, 4U);
 
-            /* Update read buffer pointer and reset inhibit timer */
-            if(em->bufReadPtr == em->bufEnd){
-                em->bufReadPtr = em->buf;
-            }
+            /* reset inhibit timer */
             emPr->inhibitEmTimer = 0U;
 
-            /* verify message buffer overflow, then clear full flag */
-            if(em->bufFull == 2U){
-                em->bufFull = 0U;    /* will be updated below */
+            /* report message buffer overflow */
+            if(overflow){
                 CO_errorReport(em, CO_EM_EMERGENCY_BUFFER_FULL, CO_EMC_GENERIC, 0U);
             }
             else{
-                em->bufFull = 0;
                 CO_errorReset(em, CO_EM_EMERGENCY_BUFFER_FULL, 0);
             }
 
@@ -337,58 +399,28 @@ void CO_EM_process(
 void CO_errorReport(CO_EM_t *em, const uint8_t errorBit, const uint16_t errorCode, const uint32_t infoCode){
     uint8_t index = errorBit >> 3;
     uint8_t bitmask = 1 << (errorBit & 0x7);
-    uint8_t *errorStatusBits = 0;
-    bool_t sendEmergency = true;
+    uint8_t bufCopy[8];
 
     if(em == NULL){
-        sendEmergency = false;
+        return;
     }
     else if(index >= em->errorStatusBitsSize){
         /* if errorBit value not supported, send emergency 'CO_EM_WRONG_ERROR_REPORT' */
         em->wrongErrorReport = errorBit;
-        sendEmergency = false;
-    }
-    else{
-        errorStatusBits = &em->errorStatusBits[index];
-        /* if error was already reported, do nothing */
-        if((*errorStatusBits & bitmask) != 0){
-            sendEmergency = false;
-        }
+        return;
     }
 
-    if(sendEmergency){
-        /* set error bit */
-        if(errorBit){
-            /* any error except NO_ERROR */
-            *errorStatusBits |= bitmask;
-        }
-
-        /* verify buffer full, set overflow */
-        if(em->bufFull){
-            em->bufFull = 2;
-        }
-        else{
-            uint8_t bufCopy[8];
-
-            /* prepare data for emergency message */
-            CO_memcpySwap2(&bufCopy[0], &errorCode);
-            bufCopy[2] = 0; /* error register will be set later */
-            bufCopy[3] = errorBit;
-            CO_memcpySwap4(&bufCopy[4], &infoCode);
-
-            /* copy data to the buffer, increment writePtr and verify buffer full */
-            CO_LOCK_EMCY();
-            CO_memcpy(em->bufWritePtr, &bufCopy[0], 8);
-            em->bufWritePtr += 8;
-
-            if(em->bufWritePtr == em->bufEnd) em->bufWritePtr = em->buf;
-            if(em->bufWritePtr == em->bufReadPtr) em->bufFull = 1;
-            CO_UNLOCK_EMCY();
-
-            /* Optional signal to RTOS, which can resume task, which handles CO_EM_process */
-            if(em->pFunctSignal != NULL) {
-                em->pFunctSignal();
-            }
+    /* prepare data for emergency message */
+    CO_memcpySwap2(&bufCopy[0], &errorCode);
+    bufCopy[2] = 0; /* error register will be set later */
+    bufCopy[3] = errorBit;
+    CO_memcpySwap4(&bufCopy[4], &infoCode);
+
+    /* set error bit and add message, if error was not reported yet */
+    if(CO_EM_bufAdd(em, &em->errorStatusBits[index], bitmask, true, bufCopy)){
+        /* Optional signal to RTOS, which can resume task, which handles CO_EM_process */
+        if(em->pFunctSignal != NULL) {
+            em->pFunctSignal();
         }
     }
 }
@@ -398,56 +430,29 @@ void CO_errorReport(CO_EM_t *em, const uint8_t errorBit, const uint16_t errorCod
 void CO_errorReset(CO_EM_t *em, const uint8_t errorBit, const uint32_t infoCode){
     uint8_t index = errorBit >> 3;
     uint8_t bitmask = 1 << (errorBit & 0x7);
-    uint8_t *errorStatusBits = 0;
-    bool_t sendEmergency = true;
+    uint8_t bufCopy[8];
 
     if(em == NULL){
-        sendEmergency = false;
+        return;
     }
     else if(index >= em->errorStatusBitsSize){
         /* if errorBit value not supported, send emergency 'CO_EM_WRONG_ERROR_REPORT' */
         em->wrongErrorReport = errorBit;
-        sendEmergency = false;
+        return;
     }
-    else{
-        errorStatusBits = &em->errorStatusBits[index];
-        /* if error was allready cleared, do nothing */
-        if((*errorStatusBits & bitmask) == 0){
-            sendEmergency = false;
-        }
-    }
-
-    if(sendEmergency){
-        /* erase error bit */
-        *errorStatusBits &= ~bitmask;
-
-        /* verify buffer full */
-        if(em->bufFull){
-            em->bufFull = 2;
-        }
-        else{
-            uint8_t bufCopy[8];
-
-            /* prepare data for emergency message */
-            bufCopy[0] = 0;
-            bufCopy[1] = 0;
-            bufCopy[2] = 0; /* error register will be set later */
-            bufCopy[3] = errorBit;
-            CO_memcpySwap4(&bufCopy[4], &infoCode);
-
-            /* copy data to the buffer, increment writePtr and verify buffer full */
-            CO_LOCK_EMCY();
-            CO_memcpy(em->bufWritePtr, &bufCopy[0], 8);
-            em->bufWritePtr += 8;
 
-            if(em->bufWritePtr == em->bufEnd) em->bufWritePtr = em->buf;
-            if(em->bufWritePtr == em->bufReadPtr) em->bufFull = 1;
-            CO_UNLOCK_EMCY();
-
-            /* Optional signal to RTOS, which can resume task, which handles CO_EM_process */
-            if(em->pFunctSignal != NULL) {
-                em->pFunctSignal();
-            }
+    /* prepare data for emergency message */
+    bufCopy[0] = 0;
+    bufCopy[1] = 0;
+    bufCopy[2] = 0; /* error register will be set later */
+    bufCopy[3] = errorBit;
+    CO_memcpySwap4(&bufCopy[4], &infoCode);
+
+    /* erase error bit and add message, if error was not cleared yet */
+    if(CO_EM_bufAdd(em, &em->errorStatusBits[index], bitmask, false, bufCopy)){
+        /* Optional signal to RTOS, which can resume task, which handles CO_EM_process */
+        if(em->pFunctSignal != NULL) {
+            em->pFunctSignal();
         }
     }
 }
@@ -5,13 +5,32 @@
 
 #define CAN_TX_IO (21)  /** CAN TX pin */
 #define CAN_RX_IO (22) /** CAN RX pin */
-#define CAN_TX_QUEUE_LENGTH (5) /** CAN TX buffer size */
-#define CAN_RX_QUEUE_LENGTH (5) /** CAN RX buffer size */
+#define CAN_TX_QUEUE_LENGTH (5) /** CAN TX buffer size, shorter queue keeps pending messages closer to CAN-ID priority order */
+#define CAN_RX_QUEUE_LENGTH (32) /** CAN RX buffer size */
+#define CAN_USE_RX_FILTERS (1) /** Program CAN acceptance filter from registered rx buffers, 0 accepts all messages */
 
-#define CO_CAN_PSEUDO_INTERRUPT_INTERVAL (1000) /** CAN "Interrupt" Interval in μs*/
+#define CO_CAN_RX_TASK_PRIORITY (23)    /** CAN receive task priority, above esp_timer task */
+#define CO_CAN_RX_TASK_STACK_SIZE (3072) /** CAN receive task stack size in bytes */
+#define CO_CAN_RX_TASK_TIMEOUT (100)     /** CAN receive task wait in ms before module state is checked again */
+#define CO_CAN_TX_TASK_PRIORITY (23)    /** CAN transmit task priority, same as receive task */
+#define CO_CAN_TX_TASK_STACK_SIZE (2048) /** CAN transmit task stack size in bytes */
+#define CO_CAN_TRACE (0)                    /** 1 records every CAN frame into binary trace, printed by low priority task. 0 compiles frame logging out */
+#define CO_CAN_TRACE_SIZE (256)              /** Number of frames in trace ring buffer, must be power of 2 */
+#define CO_CAN_TRACE_TASK_PRIORITY (1)       /** Trace print task priority, below all CANopen tasks */
+#define CO_CAN_TRACE_TASK_STACK_SIZE (3072)  /** Trace print task stack size in bytes */
+#define CO_CAN_TRACE_INTERVAL (100)          /** Trace print task period in ms */
+#define CO_CAN_SEND_STATS (0)                /** 1 measures CO_CANsend() duration into histogram, logged by mainline */
+#define CO_CAN_SEND_STATS_INTERVAL (10000)   /** CO_CANsend() duration histogram log period in ms */
 #define CO_MAIN_TASK_INTERVAL (1000)   /* Interval of tmrTask thread in microseconds */
+#define CO_RT_CORE (1)                       /** Core running CAN rx/tx tasks and SYNC/PDO task, WiFi/LwIP stay on core 0 */
+#define CO_RT_TASK_PRIORITY (22)             /** SYNC/PDO task priority, below CAN rx/tx tasks */
+#define CO_RT_TASK_STACK_SIZE (3072)         /** SYNC/PDO task stack size in bytes */
+#define CO_MAIN_CORE (0)                     /** Core running mainline CO_process() (SDO, EMCY, HB, gateway) and application */
+#define CO_MAIN_TASK_PRIORITY (5)            /** Mainline task priority */
+#define CO_MAIN_TASK_STACK_SIZE (4096)       /** Mainline task stack size in bytes */
+#define CO_JITTER_MEASURE (0)                /** 1 records SYNC reception to TPDO latency, percentiles logged by mainline */
+#define CO_JITTER_SAMPLES (512)              /** Number of latency samples per logged percentile set */
 
-#define CAN_TICKS_TO_WAIT (10000) /*CAN TX/RX Timeout value*/
 
 //----------------------------------
 
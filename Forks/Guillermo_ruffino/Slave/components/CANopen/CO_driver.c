@@ -59,6 +59,11 @@
 #include "hal/twai_hal.h"
 CO_CANmodule_t *CANmodulePointer = NULL;
 
+//Critical section locks, see CO_LOCK_* in CO_driver_target.h
+portMUX_TYPE CO_CANsendMux = portMUX_INITIALIZER_UNLOCKED;
+portMUX_TYPE CO_EMCYmux = portMUX_INITIALIZER_UNLOCKED;
+SemaphoreHandle_t CO_ODmutex = NULL;
+
 //CAN Timing configuration
 static can_timing_config_t timingConfig = CAN_TIMING_CONFIG_125KBITS();     //Set Baudrate to 1Mbit
                                                                           //CAN Filter configuration
@@ -74,34 +79,497 @@ static can_general_config_t generalConfig = {.mode = TWAI_MODE_NORMAL,
                                              .alerts_enabled = CAN_ALERT_NONE,    /*Disable CAN Alarms TODO: Enable for CO_CANverifyErrors*/
                                              .clkout_divider = 0};                /*No Clockout*/
 
-//Timer Interrupt Configuration
-const esp_timer_create_args_t CO_CANinterruptArgs = {
-    .callback = &CO_CANinterrupt, /*Timer Interrupt Callback */
-    .name = "CO_CANinterrupt"};   /* Optional Task Name for debugging */
+//CAN receive task handle, NULL if task is not running
+static TaskHandle_t CO_CANrxTaskHandle = NULL;
+//CAN transmit task handle, NULL if task is not running
+static TaskHandle_t CO_CANtxTaskHandle = NULL;
+//True, if esp can driver is installed
+static bool_t CO_CANdriverInstalled = false;
+
+/* Group of rx buffers, accepted by one esp can acceptance filter */
+typedef struct
+{
+    uint16_t code;     /* common identifier bits */
+    uint16_t dontCare; /* identifier bits, which differ or are masked out */
+    uint16_t count;    /* number of rx buffers in group */
+} CO_CANfilterGroup_t;
+
+/* Merge rx buffer into hardware filter group, so group accepts also its identifiers */
+static void CO_CANfilterMerge(CO_CANfilterGroup_t *group, const CO_CANrx_t *buffer)
+{
+    uint16_t bufDontCare = (uint16_t)~buffer->mask & 0x07FFU;
+
+    if (group->count == 0U)
+    {
+        group->dontCare = bufDontCare;
+    }
+    else
+    {
+        group->dontCare |= bufDontCare | ((group->code ^ buffer->ident) & 0x07FFU);
+    }
+    group->code = buffer->ident & 0x07FFU & (uint16_t)~group->dontCare;
+    group->count++;
+}
+
+/* Number of 11-bit identifiers accepted by filter group */
+static uint32_t CO_CANfilterSize(const CO_CANfilterGroup_t *group)
+{
+    return (group->count == 0U) ? 0U : (1UL << __builtin_popcount(group->dontCare));
+}
+
+/* Number of 11-bit identifiers accepted by either of two filter groups. A
+ * buffer, which doesn't care about the split bit, may widen the first group
+ * over the second one, so overlap is not counted twice. */
+static uint32_t CO_CANfilterUnionSize(const CO_CANfilterGroup_t *group0, const CO_CANfilterGroup_t *group1)
+{
+    uint32_t size = CO_CANfilterSize(group0) + CO_CANfilterSize(group1);
+
+    if ((group0->count != 0U) && (group1->count != 0U) &&
+        (((group0->code ^ group1->code) & (uint16_t)~group0->dontCare & (uint16_t)~group1->dontCare) == 0U))
+    {
+        size -= 1UL << __builtin_popcount(group0->dontCare & group1->dontCare);
+    }
+    return size;
+}
+
+/* Compute the tightest esp can acceptance filter, which accepts all configured
+ * rx buffers. Single filter is compared with dual filters, where buffers are
+ * split on each of 11 identifier bits, and the one accepting the fewest
+ * identifiers is used. RTR bit and data bytes are not filtered. Returns number
+ * of accepted 11-bit identifiers. */
+static uint32_t CO_CANfilterSetup(CO_CANmodule_t *CANmodule, can_filter_config_t *filter)
+{
+    CO_CANfilterGroup_t single = {0};
+    CO_CANfilterGroup_t best[2] = {{0}};
+    uint32_t bestSize;
+    uint16_t i;
+    uint8_t bit;
+
+    for (i = 0U; i < CANmodule->rxSize; i++)
+    {
+        if (CANmodule->rxArray[i].pFunct != NULL)
+        {
+            CO_CANfilterMerge(&single, &CANmodule->rxArray[i]);
+        }
+    }
+    if (!CANmodule->useCANrxFilters || (single.count == 0U))
+    {
+        filter->acceptance_code = 0U;
+        filter->acceptance_mask = 0xFFFFFFFFU;
+        filter->single_filter = true;
+        return CO_CAN_RX_LOOKUP_SIZE;
+    }
+    bestSize = CO_CANfilterSize(&single);
+
+    for (bit = 0U; bit < 11U; bit++)
+    {
+        CO_CANfilterGroup_t split[2] = {{0}};
+        uint32_t size;
+
+        for (i = 0U; i < CANmodule->rxSize; i++)
+        {
+            const CO_CANrx_t *buffer = &CANmodule->rxArray[i];
+            if (buffer->pFunct != NULL)
+            {
+                /* buffers, which don't care about the bit, go to the first filter */
+                uint8_t side = ((buffer->mask & buffer->ident) >> bit) & 1U;
+                CO_CANfilterMerge(&split[side], buffer);
+            }
+        }
+        size = CO_CANfilterUnionSize(&split[0], &split[1]);
+        if ((split[0].count != 0U) && (split[1].count != 0U) && (size < bestSize))
+        {
+            best[0] = split[0];
+            best[1] = split[1];
+            bestSize = size;
+        }
+    }
+
+    if (best[0].count == 0U)
+    {
+        /* single filter: ID in bits 31..21, RTR and data bytes don't care */
+        filter->acceptance_code = (uint32_t)single.code << 21;
+        filter->acceptance_mask = ((uint32_t)single.dontCare << 21) | 0x001FFFFFU;
+        filter->single_filter = true;
+    }
+    else
+    {
+        /* dual filter: IDs in bits 31..21 and 15..5, everything else don't care */
+        filter->acceptance_code = ((uint32_t)best[0].code << 21) | ((uint32_t)best[1].code << 5);
+        filter->acceptance_mask = ((uint32_t)best[0].dontCare << 21) | ((uint32_t)best[1].dontCare << 5) | 0x001F001FU;
+        filter->single_filter = false;
+    }
+    return bestSize;
+}
+
+/* True, if esp can acceptance filter accepts all identifiers of ident/mask pair */
+static bool_t CO_CANfilterAccepts(const can_filter_config_t *filter, uint16_t ident, uint16_t mask)
+{
+    uint16_t dontCare = (uint16_t)~mask & 0x07FFU;
+    uint16_t code = (filter->acceptance_code >> 21) & 0x07FFU;
+    uint16_t filterDontCare = (filter->acceptance_mask >> 21) & 0x07FFU;
+
+    if (((dontCare & ~filterDontCare) == 0U) && (((ident ^ code) & ~filterDontCare & 0x07FFU) == 0U))
+    {
+        return true;
+    }
+    if (!filter->single_filter)
+    {
+        code = (filter->acceptance_code >> 5) & 0x07FFU;
+        filterDontCare = (filter->acceptance_mask >> 5) & 0x07FFU;
+        if (((dontCare & ~filterDontCare) == 0U) && (((ident ^ code) & ~filterDontCare & 0x07FFU) == 0U))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+#if CO_CAN_TRACE
+/* One CAN frame in binary trace */
+typedef struct
+{
+    volatile uint32_t seq; /* sequence number + 1, written after the frame, 0 while written */
+    uint32_t timestamp;    /* esp_timer time in microseconds */
+    uint16_t ident;        /* 11-bit identifier, bit 11 set for RTR frame */
+    uint8_t tx;            /* 1 for transmitted, 0 for received frame */
+    uint8_t DLC;
+    uint8_t data[8];
+} CO_CANtraceEntry_t;
+
+/* Trace ring buffer, written without locks by CAN receive task and CO_CANsend() callers */
+static CO_CANtraceEntry_t CO_CANtraceRing[CO_CAN_TRACE_SIZE];
+static uint32_t CO_CANtraceHead = 0U;
+static TaskHandle_t CO_CANtraceTaskHandle = NULL;
+
+/* Record frame into trace. Slot is reserved atomically, so writer never blocks.
+ * If trace task falls behind, the oldest frames are overwritten. */
+static void CO_CANtrace(const can_message_t *msg, uint8_t tx)
+{
+    uint32_t seq = __atomic_fetch_add(&CO_CANtraceHead, 1U, __ATOMIC_RELAXED);
+    CO_CANtraceEntry_t *entry = &CO_CANtraceRing[seq & (CO_CAN_TRACE_SIZE - 1U)];
+
+    __atomic_store_n(&entry->seq, 0U, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    entry->timestamp = (uint32_t)esp_timer_get_time();
+    entry->ident = (uint16_t)(msg->identifier & 0x07FFU);
+    if (msg->flags & CAN_MSG_FLAG_RTR)
+    {
+        entry->ident |= 0x0800U;
+    }
+    entry->tx = tx;
+    entry->DLC = msg->data_length_code;
+    memcpy(entry->data, msg->data, sizeof(entry->data));
+    __atomic_store_n(&entry->seq, seq + 1U, __ATOMIC_RELEASE);
+}
+
+/* Trace task. Prints recorded frames with low priority, so formatting and UART
+ * output don't delay CAN processing. */
+static void CO_CANtraceTask(void *arg)
+{
+    uint32_t tail = 0U;
+
+    (void)arg;
+    for (;;)
+    {
+        uint32_t head;
+
+        vTaskDelay(pdMS_TO_TICKS(CO_CAN_TRACE_INTERVAL));
+        head = __atomic_load_n(&CO_CANtraceHead, __ATOMIC_ACQUIRE);
+        if ((head - tail) > CO_CAN_TRACE_SIZE)
+        {
+            ESP_LOGW("CO_CANtrace", "trace overrun, %u frames lost", head - tail - CO_CAN_TRACE_SIZE);
+            tail = head - CO_CAN_TRACE_SIZE;
+        }
+        while (tail != head)
+        {
+            CO_CANtraceEntry_t *slot = &CO_CANtraceRing[tail & (CO_CAN_TRACE_SIZE - 1U)];
+            CO_CANtraceEntry_t entry;
+
+            if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != (tail + 1U))
+            {
+                break; /* frame is still written, print it next time */
+            }
+            entry = *slot;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == (tail + 1U))
+            {
+                ESP_LOGI("CO_CANtrace", "%10u %s 0x%03X%s [%d] %02X %02X %02X %02X %02X %02X %02X %02X",
+                         entry.timestamp, entry.tx ? "tx" : "rx", entry.ident & 0x07FFU, (entry.ident & 0x0800U) ? " rtr" : "",
+                         entry.DLC, entry.data[0], entry.data[1], entry.data[2], entry.data[3],
+                         entry.data[4], entry.data[5], entry.data[6], entry.data[7]);
+            }
+            tail++;
+        }
+    }
+}
+
+#define CO_CAN_TRACE_FRAME(msg, tx) CO_CANtrace((msg), (tx))
+#else
+#define CO_CAN_TRACE_FRAME(msg, tx)
+#endif /* CO_CAN_TRACE */
+
+/* CAN receive task. Blocks on the esp can RX queue and processes every
+ * received message, until CAN module leaves normal mode. */
+static void CO_CANrxTask(void *args)
+{
+    CO_CANmodule_t *CANmodule = (CO_CANmodule_t *)args;
+
+    while (CANmodule->CANnormal)
+    {
+        CO_CANinterrupt(CANmodule);
+    }
+    CO_CANrxTaskHandle = NULL;
+    vTaskDelete(NULL);
+}
+
+#if CO_CAN_SEND_STATS
+#define CO_CAN_SEND_STATS_BINS 16U
+/* CO_CANsend() duration histogram, bin n counts durations from 2^(n-1) to 2^n - 1 us */
+static uint32_t CO_CANsendHist[CO_CAN_SEND_STATS_BINS];
+/* Longest CO_CANsend() duration in us */
+static uint32_t CO_CANsendMax = 0U;
+
+/* Add CO_CANsend() duration to histogram, callable from any context */
+static void CO_CANsendStatsAdd(uint32_t duration)
+{
+    uint32_t bin = (duration == 0U) ? 0U : (32U - (uint32_t)__builtin_clz(duration));
+    uint32_t max = __atomic_load_n(&CO_CANsendMax, __ATOMIC_RELAXED);
+
+    if (bin >= CO_CAN_SEND_STATS_BINS)
+    {
+        bin = CO_CAN_SEND_STATS_BINS - 1U;
+    }
+    __atomic_fetch_add(&CO_CANsendHist[bin], 1U, __ATOMIC_RELAXED);
+    while ((duration > max) &&
+           !__atomic_compare_exchange_n(&CO_CANsendMax, &max, duration, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+/* Log CO_CANsend() duration histogram every CO_CAN_SEND_STATS_INTERVAL */
+static void CO_CANsendStatsLog(void)
+{
+    static int64_t lastLog = 0;
+    int64_t now = esp_timer_get_time();
+    char line[16 * CO_CAN_SEND_STATS_BINS];
+    int len = 0;
+    uint32_t i;
+
+    if ((now - lastLog) < ((int64_t)CO_CAN_SEND_STATS_INTERVAL * 1000))
+    {
+        return;
+    }
+    lastLog = now;
+    for (i = 0U; i < CO_CAN_SEND_STATS_BINS; i++)
+    {
+        len += snprintf(&line[len], sizeof(line) - len, " <%u:%u", 1U << i, CO_CANsendHist[i]);
+    }
+    ESP_LOGI("CO_CANsend", "CO_CANsend max %u us, histogram [us:count]%s", CO_CANsendMax, line);
+}
+#endif /* CO_CAN_SEND_STATS */
+
+/* Copy tx buffer into esp can message and add it to TX queue without waiting */
+static esp_err_t CO_CANtransmit(CO_CANtx_t *buffer)
+{
+    can_message_t temp_can_message = {0};            /* generate esp can message for transmission */
+    esp_err_t ret;
+
+    temp_can_message.identifier = buffer->ident;     /* Set message-id in esp can message */
+    temp_can_message.data_length_code = buffer->DLC; /* Set data length in esp can message */
+    temp_can_message.flags = CAN_MSG_FLAG_NONE;      /* reset all flags in esp can message */
+    if (buffer->rtr)
+    {
+        temp_can_message.flags |= CAN_MSG_FLAG_RTR; /* set rtr-flag if needed */
+    }
+    for (uint8_t i = 0; i < buffer->DLC; i++)
+    {
+        temp_can_message.data[i] = buffer->data[i]; /* copy data from buffer in esp can message */
+    }
+
+    ret = can_transmit(&temp_can_message, 0);
+    if (ret == ESP_OK)
+    {
+        CO_CAN_TRACE_FRAME(&temp_can_message, 1U);
+    }
+    return ret;
+}
+
+/* Insert tx buffer into pending list, sorted by CAN-ID as in bus arbitration.
+ * Buffers with the same CAN-ID keep their order. Must be called locked. */
+static void CO_CANtxPendingInsert(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer)
+{
+    CO_CANtx_t **link = &CANmodule->txPending;
+
+    while ((*link != NULL) && ((*link)->ident <= buffer->ident))
+    {
+        link = &(*link)->next;
+    }
+    buffer->next = *link;
+    *link = buffer;
+}
+
+/* Remove tx buffer from pending list. Returns false, if it is not there,
+ * because it is just being copied to TX queue. Must be called locked. */
+static bool_t CO_CANtxPendingRemove(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer)
+{
+    CO_CANtx_t **link = &CANmodule->txPending;
+
+    while (*link != NULL)
+    {
+        if (*link == buffer)
+        {
+            *link = buffer->next;
+            buffer->next = NULL;
+            return true;
+        }
+        link = &(*link)->next;
+    }
+    return false;
+}
 
-//Timer Handle
-esp_timer_handle_t CO_CANinterruptPeriodicTimer;
+/* Move pending messages, lowest CAN-ID first, to esp can TX queue until it is full */
+static void CO_CANtxProcess(CO_CANmodule_t *CANmodule)
+{
+    for (;;)
+    {
+        CO_CANtx_t *buffer;
+
+        CO_LOCK_CAN_SEND();
+        buffer = CANmodule->txPending;
+        if (buffer != NULL)
+        {
+            CANmodule->txPending = buffer->next;
+        }
+        CO_UNLOCK_CAN_SEND();
+
+        if (buffer == NULL)
+        {
+            break;
+        }
+        if (CO_CANtransmit(buffer) != ESP_OK)
+        {
+            /* TX queue is full, retry on next TX alert */
+            CO_LOCK_CAN_SEND();
+            CO_CANtxPendingInsert(CANmodule, buffer);
+            CO_UNLOCK_CAN_SEND();
+            break;
+        }
+        CO_LOCK_CAN_SEND();
+        buffer->bufferFull = false;
+        CANmodule->CANtxCount--;
+        CANmodule->txInFlight++;
+        CANmodule->bufferInhibitFlag = buffer->syncFlag;
+        CO_UNLOCK_CAN_SEND();
+    }
+}
+
+/* CAN transmit task. Waits for esp can TX alerts, which replace CAN TX
+ * interrupt, and refills TX queue with pending messages. */
+static void CO_CANtxTask(void *args)
+{
+    CO_CANmodule_t *CANmodule = (CO_CANmodule_t *)args;
+    uint32_t alerts;
+
+    while (CANmodule->CANnormal)
+    {
+        if (can_read_alerts(&alerts, pdMS_TO_TICKS(CO_CAN_RX_TASK_TIMEOUT)) == ESP_OK)
+        {
+            if (alerts & CAN_ALERT_TX_SUCCESS)
+            {
+                /* First CAN message (bootup) was sent successfully */
+                CANmodule->firstCANtxMessage = false;
+            }
+            CO_LOCK_CAN_SEND();
+            if (alerts & CAN_ALERT_TX_IDLE)
+            {
+                /* clear flag from previous message, TX queue is empty. A message
+                 * queued by CO_CANsend() since the alert is not counted now, see
+                 * txInFlight in CO_driver_target.h */
+                CANmodule->bufferInhibitFlag = false;
+                CANmodule->txInFlight = 0U;
+            }
+            else if ((alerts & (CAN_ALERT_TX_SUCCESS | CAN_ALERT_TX_FAILED)) && (CANmodule->txInFlight > 0U))
+            {
+                /* alerts don't count messages, so at least one has left TX queue */
+                CANmodule->txInFlight--;
+            }
+            CO_UNLOCK_CAN_SEND();
+        }
+        /* Are there any new messages waiting to be send */
+        if (CANmodule->CANtxCount > 0U)
+        {
+            CO_CANtxProcess(CANmodule);
+        }
+    }
+    CO_CANtxTaskHandle = NULL;
+    vTaskDelete(NULL);
+}
+
+/* Stop CAN receive and transmit tasks and uninstall esp can driver */
+static void CO_CANdriverStop(CO_CANmodule_t *CANmodule)
+{
+    if (CANmodule != NULL)
+    {
+        CANmodule->CANnormal = false;
+    }
+    /* CAN tasks exit after their current wait times out */
+    while ((CO_CANrxTaskHandle != NULL) || (CO_CANtxTaskHandle != NULL))
+    {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    if (CO_CANdriverInstalled)
+    {
+        can_stop();
+        if (can_driver_uninstall() == ESP_OK)
+        {
+            CO_CANdriverInstalled = false;
+        }
+        else
+        {
+            ESP_LOGE("CO_driver", "can_driver_uninstall failed, acceptance filter is not reprogrammed");
+        }
+    }
+}
 
 /******************************************************************************/
 void CO_CANsetConfigurationMode(void *CANdriverState)
 {
     /* Put CAN module in configuration mode */
     (void)CANdriverState;
+    CO_CANdriverStop(CANmodulePointer);
 }
 
 /******************************************************************************/
 void CO_CANsetNormalMode(CO_CANmodule_t *CANmodule)
 {
     /*Install CAN driver*/
-    can_driver_install(&generalConfig, &timingConfig, &filterConfig);
-    can_start();
+    if (!CO_CANdriverInstalled)
+    {
+        /* Acceptance filter is programmed from rx buffers, configured by CANopen init functions */
+        uint32_t accepted = CO_CANfilterSetup(CANmodule, &filterConfig);
+        ESP_LOGI("CO_driver", "Acceptance filter code: 0x%08X mask: 0x%08X single: %d, accepts %d of 2048 identifiers",
+                 filterConfig.acceptance_code, filterConfig.acceptance_mask, filterConfig.single_filter, accepted);
+        ESP_ERROR_CHECK(can_driver_install(&generalConfig, &timingConfig, &filterConfig));
+        CO_CANdriverInstalled = true;
+    }
+    ESP_ERROR_CHECK(can_start());
 	ESP_LOGE("mainTask", "CAN bus started");
-    /*WORKAROUND: INTERRUPT ALLOCATION FÜR CAN NICHT MÖGLICH DA BEREITS IM IDF TREIBER VERWENDET*/
-    /* Configure Timer interrupt function for execution every CO_CAN_PSEUDO_INTERRUPT_INTERVAL */
-    ESP_ERROR_CHECK(esp_timer_create(&CO_CANinterruptArgs, &CO_CANinterruptPeriodicTimer));
-    ESP_ERROR_CHECK(esp_timer_start_periodic(CO_CANinterruptPeriodicTimer, CO_CAN_PSEUDO_INTERRUPT_INTERVAL));
     /*Set Canmodule to normal mode*/
     CANmodule->CANnormal = true;
+    /* Received messages are processed by CAN receive task instead of interrupt */
+    if (CO_CANrxTaskHandle == NULL)
+    {
+        xTaskCreatePinnedToCore(&CO_CANrxTask, "CO_CANrx", CO_CAN_RX_TASK_STACK_SIZE, (void *)CANmodule,
+                                CO_CAN_RX_TASK_PRIORITY, &CO_CANrxTaskHandle, CO_RT_CORE);
+    }
+    /* Pending messages are sent by CAN transmit task */
+    if (CO_CANtxTaskHandle == NULL)
+    {
+        xTaskCreatePinnedToCore(&CO_CANtxTask, "CO_CANtx", CO_CAN_TX_TASK_STACK_SIZE, (void *)CANmodule,
+                                CO_CAN_TX_TASK_PRIORITY, &CO_CANtxTaskHandle, CO_RT_CORE);
+    }
 }
 
 /******************************************************************************/
@@ -123,6 +591,16 @@ CO_ReturnError_t CO_CANmodule_init(
         return CO_ERROR_ILLEGAL_ARGUMENT;
     }
 
+    if (CO_ODmutex == NULL)
+    {
+        CO_ODmutex = xSemaphoreCreateMutex();
+        if (CO_ODmutex == NULL)
+        {
+            ESP_LOGE("CO_CANmodule_init", "Failed to create OD mutex");
+            return CO_ERROR_OUT_OF_MEMORY;
+        }
+    }
+
     /* Configure object variables */
     CANmodule->CANdriverState = CANdriverState;
     CANmodule->baudrate = CANbitRate;
@@ -132,11 +610,13 @@ CO_ReturnError_t CO_CANmodule_init(
     CANmodule->txSize = txSize;
     CANmodule->txArray = txArray;
     CANmodule->txPin = CAN_TX_IO;
-    CANmodule->useCANrxFilters = false;
+    CANmodule->useCANrxFilters = CAN_USE_RX_FILTERS;
     CANmodule->firstCANtxMessage = true;
     CANmodule->CANnormal = false;
     CANmodule->bufferInhibitFlag = false;
     CANmodule->CANtxCount = 0U;
+    CANmodule->txPending = NULL;
+    CANmodule->txInFlight = 0U;
     CANmodule->errOld = 0U;
     CANmodule->em = NULL;
 
@@ -148,10 +628,22 @@ CO_ReturnError_t CO_CANmodule_init(
         CANmodule->rxArray[i].object = NULL;
         CANmodule->rxArray[i].pFunct = NULL;
     }
+    /*Init CAN-ID lookup*/
+    memset(CANmodule->rxLookup, 0, sizeof(CANmodule->rxLookup));
+    CANmodule->rxMaskedCount = 0U;
+#if CO_CAN_TRACE
+    if (CO_CANtraceTaskHandle == NULL)
+    {
+        xTaskCreatePinnedToCore(&CO_CANtraceTask, "CO_CANtrace", CO_CAN_TRACE_TASK_STACK_SIZE, NULL,
+                                CO_CAN_TRACE_TASK_PRIORITY, &CO_CANtraceTaskHandle, CO_MAIN_CORE);
+    }
+#endif
+
     /*Init TX-Array*/
     for (uint16_t i = 0U; i < txSize; i++)
     {
         CANmodule->txArray[i].bufferFull = false;
+        CANmodule->txArray[i].next = NULL;
     }
 
     /* Configure CAN module registers */
@@ -242,30 +734,7 @@ CO_ReturnError_t CO_CANmodule_init(
         timingConfig.triple_sampling = false;
     }
 
-    /* Configure CAN module hardware filters */
-    if (CANmodule->useCANrxFilters)
-    {
-        /* CAN module filters are used, they will be configured with */
-        /* CO_CANrxBufferInit() functions, called by separate CANopen */
-        /* init functions. */
-        /* Configure all masks so, that received message must match filter */
-
-        //Don't filter messages
-        ESP_LOGI("CO_driver", "RxFilters are active, but no filter configured.");
-        filterConfig.acceptance_code = 0;
-        filterConfig.acceptance_mask = 0xFFFFFFFF;
-        filterConfig.single_filter = true;
-    }
-    else
-    {
-        /* CAN module filters are not used, all messages with standard 11-bit */
-        /* identifier will be received */
-        /* Configure mask 0 so, that all messages with standard identifier are accepted */
-        //Don't filter messages
-        filterConfig.acceptance_code = 0;
-        filterConfig.acceptance_mask = 0xFFFFFFFF;
-        filterConfig.single_filter = true;
-    }
+    /* CAN module hardware filters are configured from rx buffers in CO_CANsetNormalMode() */
     return CO_ERROR_NO;
 }
 
@@ -273,7 +742,7 @@ CO_ReturnError_t CO_CANmodule_init(
 void CO_CANmodule_disable(CO_CANmodule_t *CANmodule)
 {
     /* turn off the module */
-    ESP_ERROR_CHECK(can_stop());
+    CO_CANdriverStop(CANmodule);
 }
 
 /******************************************************************************/
@@ -283,6 +752,97 @@ uint16_t CO_CANrxMsg_readIdent(const CO_CANrxMsg_t *rxMsg)
     return (uint16_t)rxMsg->ident;
 }
 
+/* True, if rx buffer mask covers all 11 bits of standard identifier */
+#define CO_CANrxIsExact(buffer) (((buffer)->mask & 0x07FFU) == 0x07FFU)
+
+/* Remove rx buffer from CAN-ID lookup before it is reconfigured. If another
+ * buffer with full mask is registered for the same identifier, the one with
+ * the lowest index takes its place. */
+static void CO_CANrxLookupRemove(CO_CANmodule_t *CANmodule, uint16_t index)
+{
+    CO_CANrx_t *buffer = &CANmodule->rxArray[index];
+    uint16_t id = buffer->ident & 0x07FFU;
+
+    if (buffer->pFunct == NULL)
+    {
+        return; /* buffer was not configured yet */
+    }
+    if (!CO_CANrxIsExact(buffer))
+    {
+        CANmodule->rxMaskedCount--;
+        return;
+    }
+    if (CANmodule->rxLookup[id] != (uint16_t)(index + 1U))
+    {
+        return;
+    }
+    CANmodule->rxLookup[id] = 0U;
+    for (uint16_t i = 0U; i < CANmodule->rxSize; i++)
+    {
+        CO_CANrx_t *other = &CANmodule->rxArray[i];
+        if ((i != index) && (other->pFunct != NULL) && CO_CANrxIsExact(other) && ((other->ident & 0x07FFU) == id))
+        {
+            CANmodule->rxLookup[id] = i + 1U;
+            break;
+        }
+    }
+}
+
+/* Add configured rx buffer to CAN-ID lookup. Lower index has priority, same as
+ * with linear search. */
+static void CO_CANrxLookupInsert(CO_CANmodule_t *CANmodule, uint16_t index)
+{
+    CO_CANrx_t *buffer = &CANmodule->rxArray[index];
+    uint16_t id = buffer->ident & 0x07FFU;
+
+    if (!CO_CANrxIsExact(buffer))
+    {
+        CANmodule->rxMaskedCount++;
+        return;
+    }
+    if ((CANmodule->rxLookup[id] == 0U) || (CANmodule->rxLookup[id] > (index + 1U)))
+    {
+        CANmodule->rxLookup[id] = index + 1U;
+    }
+}
+
+/* Find rx buffer for received identifier. Buffers with full mask are found
+ * directly in CAN-ID lookup and have precedence, only buffers with partial
+ * mask (emergency consumer) are searched linearly. */
+static CO_CANrx_t *CO_CANrxFind(CO_CANmodule_t *CANmodule, uint32_t rcvMsgIdent)
+{
+    uint16_t slot = CANmodule->rxLookup[rcvMsgIdent & 0x07FFU];
+    bool_t maskedOnly = true;
+    CO_CANrx_t *buffer;
+
+    if (slot != 0U)
+    {
+        buffer = &CANmodule->rxArray[slot - 1U];
+        /* verify also RTR */
+        if (((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U)
+        {
+            return buffer;
+        }
+        /* Same CAN-ID with different RTR, search all buffers */
+        maskedOnly = false;
+    }
+    else if (CANmodule->rxMaskedCount == 0U)
+    {
+        return NULL;
+    }
+
+    buffer = &CANmodule->rxArray[0];
+    for (uint16_t index = CANmodule->rxSize; index > 0U; index--)
+    {
+        if ((buffer->pFunct != NULL) && !(maskedOnly && CO_CANrxIsExact(buffer)) && (((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U))
+        {
+            return buffer;
+        }
+        buffer++;
+    }
+    return NULL;
+}
+
 /******************************************************************************/
 CO_ReturnError_t CO_CANrxBufferInit(
     CO_CANmodule_t *CANmodule,
@@ -300,6 +860,8 @@ CO_ReturnError_t CO_CANrxBufferInit(
         /* buffer, which will be configured */
         CO_CANrx_t *buffer = &CANmodule->rxArray[index];
 
+        CO_CANrxLookupRemove(CANmodule, index);
+
         /* Configure object variables */
         buffer->object = object;
         buffer->pFunct = pFunct;
@@ -312,10 +874,15 @@ CO_ReturnError_t CO_CANrxBufferInit(
         }
         buffer->mask = (mask & 0x07FFU) | 0x0800U;
 
-        /* Set CAN hardware module filter and mask. */
-        if (CANmodule->useCANrxFilters)
+        CO_CANrxLookupInsert(CANmodule, index);
+
+        /* Set CAN hardware module filter and mask. Filter can only be changed with
+         * the driver uninstalled, which is not safe while CAN tasks and CO_CANsend()
+         * callers run. Buffer configured in normal mode (SDO write of COB-ID) and
+         * not accepted by filter receives nothing until communication reset. */
+        if (CANmodule->CANnormal && !CO_CANfilterAccepts(&filterConfig, buffer->ident, buffer->mask))
         {
-            ESP_LOGE("CO_CANrxBufferInit", "No driver implementation for Filters");
+            ESP_LOGW("CO_driver", "rx[%d] ident: %d is outside acceptance filter until communication reset", index, ident);
         }
     }
     else
@@ -343,13 +910,22 @@ CO_CANtx_t *CO_CANtxBufferInit(
         /* get specific buffer */
         buffer = &CANmodule->txArray[index];
 
+        CO_LOCK_CAN_SEND();
+        /* Buffer may be reinitialized at runtime, drop message still pending
+         * with old CAN-ID. If it is just being copied to TX queue, its sender
+         * clears bufferFull, or queues it again with new CAN-ID. */
+        if (buffer->bufferFull && CO_CANtxPendingRemove(CANmodule, buffer))
+        {
+            buffer->bufferFull = false;
+            CANmodule->CANtxCount--;
+        }
         /* CAN identifier, DLC and rtr, bit aligned with CAN module transmit buffer. */
         /* Convert data from library message into esp message values */
         buffer->ident = ((uint32_t)ident & 0x07FFU); /* Set Message ID (Standard frame), delete other informations */
         buffer->rtr = rtr;                           /* Set RTR Flag */
         buffer->DLC = noOfBytes;                     /* Set number of bytes */
-        buffer->bufferFull = false;                  /* Set buffer full flag */
         buffer->syncFlag = syncFlag;                 /* Set sync flag */
+        CO_UNLOCK_CAN_SEND();
     }
     else
     {
@@ -359,141 +935,122 @@ CO_CANtx_t *CO_CANtxBufferInit(
 }
 
 /******************************************************************************/
-CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer, int cmd_flag)
+/* Send or queue tx buffer without waiting, see CO_CANsend() */
+static CO_ReturnError_t CO_CANsendBuffer(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer)
 {
-    CO_ReturnError_t err = CO_ERROR_NO;
-    can_status_info_t esp_can_hw_status;                      /* Define variable for hardware status of esp can interface */
-    ESP_ERROR_CHECK(can_get_status_info(&esp_can_hw_status)); /* Get hardware status of esp can interface */
+    bool_t txNow;
 
+    CO_LOCK_CAN_SEND();
     /* Verify overflow */
     if (buffer->bufferFull)
     {
+        CO_UNLOCK_CAN_SEND();
         if (!CANmodule->firstCANtxMessage)
         {
             /* don't set error, if bootup message is still on buffers */
             CO_errorReport((CO_EM_t *)CANmodule->em, CO_EM_CAN_TX_OVERFLOW, CO_EMC_CAN_OVERRUN, buffer->ident);
         }
-        err = CO_ERROR_TX_OVERFLOW;
-        ESP_LOGE("CO_CANsend", "CAN-tx-buffer overflow");
+        /* previous message is still pending, it will be sent with new data */
+        return CO_ERROR_TX_OVERFLOW;
+    }
+    buffer->bufferFull = true;
+    CANmodule->CANtxCount++;
+    /* if CAN TX queue has space and no other message is pending, copy message to it */
+    txNow = (CANmodule->txInFlight < CAN_TX_QUEUE_LENGTH) && (CANmodule->CANtxCount == 1U);
+    if (!txNow)
+    {
+        /* message will be sent by CAN transmit task */
+        CO_CANtxPendingInsert(CANmodule, buffer);
     }
+    CO_UNLOCK_CAN_SEND();
 
-    CO_LOCK_CAN_SEND();
-    /* if CAN TX buffer is free, copy message to it */
-    if ((esp_can_hw_status.msgs_to_tx < CAN_TX_QUEUE_LENGTH) && (CANmodule->CANtxCount == 0))
+    if (txNow)
     {
-        CANmodule->bufferInhibitFlag = buffer->syncFlag;
-        can_message_t temp_can_message = {0}; /* generate esp can message for transmission */
-        /*MESSAGE MIT DATEN FÜLLEN*/
-        temp_can_message.identifier = buffer->ident;     /* Set message-id in esp can message */
-        temp_can_message.data_length_code = buffer->DLC; /* Set data length in esp can message */
-        temp_can_message.flags = CAN_MSG_FLAG_NONE;      /* reset all flags in esp can message */
-        //temp_can_message.flags = CAN_MSG_FLAG_SELF;
-        if (buffer->rtr)
-        {
-            temp_can_message.flags |= CAN_MSG_FLAG_RTR; /* set rtr-flag if needed */
-        }
-        for (uint8_t i = 0; i < buffer->DLC; i++)
-        {
-            temp_can_message.data[i] = buffer->data[i]; /* copy data from buffer in esp can message */
-        }
-        twai_hal_frame_t tx_frame;
-        /* Transmit esp can message.  */
-       
-        if (can_transmit(&temp_can_message,/* &tx_frame, */ pdMS_TO_TICKS(CAN_TICKS_TO_WAIT)) == ESP_OK)
+        esp_err_t ret = CO_CANtransmit(buffer);
+
+        CO_LOCK_CAN_SEND();
+        if (ret == ESP_OK)
         {
-            //
-            //  ESP_LOGI("CANsend", "ID: %d %d,DLC %d ,  Data %d,%d,%d,%d,%d,%d,%d,%d   Data hex: %x,%x,%x,%x,%x,%x,%x,%x", tx_frame.standard.id[0],
-            //                                                                                                       tx_frame.standard.id[1],
-            //                                                                                                         tx_frame.dlc,
-            //                                                                                                         tx_frame.standard.data[0], 
-            //                                                                                                         tx_frame.standard.data[1], 
-            //                                                                                                         tx_frame.standard.data[2], 
-            //                                                                                                         tx_frame.standard.data[3], 
-            //                                                                                                         tx_frame.standard.data[4], 
-            //                                                                                                         tx_frame.standard.data[5],
-            //                                                                                                         tx_frame.standard.data[6],
-            //                                                                                                         tx_frame.standard.data[7], 
-            //                                                                                                         tx_frame.standard.data[0], 
-            //                                                                                                         tx_frame.standard.data[1], 
-            //                                                                                                         tx_frame.standard.data[2], 
-            //                                                                                                         tx_frame.standard.data[3], 
-            //                                                                                                         tx_frame.standard.data[4], 
-            //                                                                                                         tx_frame.standard.data[5],
-            //                                                                                                         tx_frame.standard.data[6],
-            //                                                                                                         tx_frame.standard.data[7]);
-            
-            ESP_LOGI("CANsend", "ID: %d ID hex: %x, cmd_flag %d,DLC %d ,  Data %d,%d,%d,%d,%d,%d,%d,%d   Data hex: %x,%x,%x,%x,%x,%x,%x,%x", temp_can_message.identifier,
-                                                                                                                    temp_can_message.identifier , 
-                                                                                                                    cmd_flag, 
-                                                                                                                    temp_can_message.data_length_code,
-                                                                                                                    temp_can_message.data[0], 
-                                                                                                                    temp_can_message.data[1], 
-                                                                                                                    temp_can_message.data[2], 
-                                                                                                                    temp_can_message.data[3], 
-                                                                                                                    temp_can_message.data[4], 
-                                                                                                                    temp_can_message.data[5],
-                                                                                                                    temp_can_message.data[6],
-                                                                                                                    temp_can_message.data[7], 
-                                                                                                                    temp_can_message.data[0], 
-                                                                                                                    temp_can_message.data[1], 
-                                                                                                                    temp_can_message.data[2], 
-                                                                                                                    temp_can_message.data[3], 
-                                                                                                                    temp_can_message.data[4], 
-                                                                                                                    temp_can_message.data[5],
-                                                                                                                    temp_can_message.data[6],
-                                                                                                                    temp_can_message.data[7]);
-            // ESP_LOGI("CANsend", "cmd_flag %d", cmd_flag);
+            buffer->bufferFull = false;
+            CANmodule->CANtxCount--;
+            CANmodule->txInFlight++;
+            CANmodule->bufferInhibitFlag = buffer->syncFlag;
         }
         else
         {
-            err = CO_ERROR_TIMEOUT;
-            ESP_LOGE("CO_CANsend", "Failed to queue message for transmission");
+            /* TX queue is full, txInFlight was too low. Message will be sent by
+             * CAN transmit task on next TX alert */
+            CO_CANtxPendingInsert(CANmodule, buffer);
         }
+        CO_UNLOCK_CAN_SEND();
     }
-    /* if no buffer is free, message will be sent by interrupt */
-    else
-    {
-        ESP_LOGE("CO_CANsend", "CAN-tx-buffer overflow");
-        buffer->bufferFull = true;
-        CANmodule->CANtxCount++;
-    }
-    CO_UNLOCK_CAN_SEND();
 
+    return CO_ERROR_NO;
+}
+
+/******************************************************************************/
+CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer, int cmd_flag)
+{
+    (void)cmd_flag;
+#if CO_CAN_SEND_STATS
+    int64_t start = esp_timer_get_time();
+    CO_ReturnError_t err = CO_CANsendBuffer(CANmodule, buffer);
+
+    CO_CANsendStatsAdd((uint32_t)(esp_timer_get_time() - start));
     return err;
+#else
+    return CO_CANsendBuffer(CANmodule, buffer);
+#endif
 }
 
 /******************************************************************************/
 void CO_CANclearPendingSyncPDOs(CO_CANmodule_t *CANmodule)
 {
-    //TODO: Implement this function
-    ESP_LOGE("CO_CANclearPendingSyncPDOs", "This function is NOT implemented!");
     uint32_t tpdoDeleted = 0U;
+    bool_t clearTxQueue = false;
 
-    // CO_LOCK_CAN_SEND();
-    // /* Abort message from CAN module, if there is synchronous TPDO.
-    //  * Take special care with this functionality. */
-    // if(/*messageIsOnCanBuffer && */CANmodule->bufferInhibitFlag){
-    //     /* clear TXREQ */
-    //     CANmodule->bufferInhibitFlag = false;
-    //     tpdoDeleted = 1U;
-    // }
-    // /* delete also pending synchronous TPDOs in TX buffers */
-    // if(CANmodule->CANtxCount != 0U){
-    //     uint16_t i;
-    //     CO_CANtx_t *buffer = &CANmodule->txArray[0];
-    //     for(i = CANmodule->txSize; i > 0U; i--){
-    //         if(buffer->bufferFull){
-    //             if(buffer->syncFlag){
-    //                 buffer->bufferFull = false;
-    //                 CANmodule->CANtxCount--;
-    //                 tpdoDeleted = 2U;
-    //             }
-    //         }
-    //         buffer++;
-    //     }
-    // }
-    // CO_UNLOCK_CAN_SEND();
+    CO_LOCK_CAN_SEND();
+    /* Abort message from CAN module, if there is synchronous TPDO.
+     * Take special care with this functionality. */
+    if (/*messageIsOnCanBuffer && */ CANmodule->bufferInhibitFlag)
+    {
+        CANmodule->bufferInhibitFlag = false;
+        clearTxQueue = true;
+        tpdoDeleted = 1U;
+    }
+    /* delete also pending synchronous TPDOs in TX buffers */
+    CO_CANtx_t **link = &CANmodule->txPending;
+    while (*link != NULL)
+    {
+        CO_CANtx_t *buffer = *link;
+        if (buffer->syncFlag)
+        {
+            *link = buffer->next;
+            buffer->bufferFull = false;
+            CANmodule->CANtxCount--;
+            tpdoDeleted = 2U;
+        }
+        else
+        {
+            link = &buffer->next;
+        }
+    }
+    CO_UNLOCK_CAN_SEND();
 
+    if (clearTxQueue)
+    {
+        /* clear TXREQ, esp can driver takes its own lock */
+        can_clear_transmit_queue();
+        /* TX queue is empty and no TX alert will report it */
+        CO_LOCK_CAN_SEND();
+        CANmodule->txInFlight = 0U;
+        CO_UNLOCK_CAN_SEND();
+        /* send other pending messages now, not on next TX alert */
+        if (CANmodule->CANtxCount > 0U)
+        {
+            CO_CANtxProcess(CANmodule);
+        }
+    }
     if (tpdoDeleted != 0U)
     {
         CO_errorReport((CO_EM_t *)CANmodule->em, CO_EM_TPDO_OUTSIDE_WINDOW, CO_EMC_COMMUNICATION, tpdoDeleted);
@@ -508,6 +1065,10 @@ void CO_CANverifyErrors(CO_CANmodule_t *CANmodule)
     CO_EM_t *em = (CO_EM_t *)CANmodule->em;
     uint32_t err;
 
+#if CO_CAN_SEND_STATS
+    CO_CANsendStatsLog();
+#endif
+
     /* get error counters from module. Id possible, function may use different way to
      * determine errors. */
     rxErrors = 0;
@@ -585,91 +1146,52 @@ void CO_CANverifyErrors(CO_CANmodule_t *CANmodule)
 }
 
 /******************************************************************************/
-void CO_CANinterrupt(void *args)
+/* Process one message received from esp can driver */
+static void CO_CANrxMessage(CO_CANmodule_t *CANmodule, const can_message_t *temp_can_message)
 {
-    CO_CANmodule_t *CANmodule = CANmodulePointer;
-    can_status_info_t esp_can_hw_status;                      /* Define variable for hardware status of esp can interface */
-    ESP_ERROR_CHECK(can_get_status_info(&esp_can_hw_status)); /* Get hardware status of esp can interface */
-    /* receive interrupt */
-    if (esp_can_hw_status.msgs_to_rx != 0)
+    CO_CANrxMsg_t rcvMsg;      /* pointer to received message in CAN module */
+    uint32_t rcvMsgIdent;      /* identifier of the received message */
+    CO_CANrx_t *buffer = NULL; /* receive message buffer from CO_CANmodule_t object. */
+
+    rcvMsg.ident = temp_can_message->identifier;
+    /* check if rtr flag is set in esp can message*/
+    if (temp_can_message->flags & CAN_MSG_FLAG_RTR)
+    {
+        rcvMsg.ident += (1 << 12); /* Set RTR flag in library message */
+    }
+    rcvMsg.DLC = temp_can_message->data_length_code; /* Set data length in library message */
+    for (uint8_t i = 0; i < temp_can_message->data_length_code; i++)
     {
-        can_message_t temp_can_message; //ESP data type can message
-        ESP_ERROR_CHECK(can_receive(&temp_can_message, pdMS_TO_TICKS(CAN_TICKS_TO_WAIT)));
+        rcvMsg.data[i] = temp_can_message->data[i]; /* copy data from esp can message to library message */
+    }
 
-        CO_CANrxMsg_t rcvMsg;      /* pointer to received message in CAN module */
-        uint16_t index;            /* index of received message */
-        uint32_t rcvMsgIdent;      /* identifier of the received message */
-        CO_CANrx_t *buffer = NULL; /* receive message buffer from CO_CANmodule_t object. */
-        bool_t msgMatched = false;
+    rcvMsgIdent = rcvMsg.ident;
+    /* Search rxArray form CANmodule for the same CAN-ID. */
+    buffer = CO_CANrxFind(CANmodule, rcvMsgIdent);
 
-        rcvMsg.ident = temp_can_message.identifier;
-        /* check if rtr flag is set in esp can message*/
-        if (temp_can_message.flags & CAN_MSG_FLAG_RTR)
-        {
-            rcvMsg.ident += (1 << 12); /* Set RTR flag in library message */
-        }
-        rcvMsg.DLC = temp_can_message.data_length_code; /* Set data length in library message */
-        for (uint8_t i = 0; i < temp_can_message.data_length_code; i++)
-        {
-            rcvMsg.data[i] = temp_can_message.data[i]; /* copy data from esp can message to library message */
-        }
+    CO_CAN_TRACE_FRAME(temp_can_message, 0U);
 
-        rcvMsgIdent = rcvMsg.ident;
-        if (CANmodule->useCANrxFilters)
-        {
-            ESP_LOGE("CO_CANinterrupt", "Filter system is not implemented");
-            /* CAN module filters are used. Message with known 11-bit identifier has */
-            /* been received */
-            index = 0; /* get index of the received message here. Or something similar */
-            if (index < CANmodule->rxSize)
-            {
-                buffer = &CANmodule->rxArray[index];
-                /* verify also RTR */
-                if (((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U)
-                {
-                    msgMatched = true;
-                }
-            }
-        }
-        else
-        {
-            /* CAN module filters are not used, message with any standard 11-bit identifier */
-            /* has been received. Search rxArray form CANmodule for the same CAN-ID. */
-            buffer = &CANmodule->rxArray[0];
-            for (index = CANmodule->rxSize; index > 0U; index--)
-            {
-                if (((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U)
-                {
-                    msgMatched = true;
-                    break;
-                }
-                buffer++;
-            }
-        }
-        /* Call specific function, which will process the message */
-        if (msgMatched && (buffer != NULL) && (buffer->pFunct != NULL))
-        {
-            buffer->pFunct(buffer->object, &rcvMsg);
-        }
-    
-     ESP_LOGI("CANReceive", "ID: %d ID hex: %x, DLC: %d, Data %d,%d,%d,%d,%d,%d,%d,%d   Data hex: %x,%x,%x,%x,%x,%x,%x,%x", temp_can_message.identifier,
-                                                                                                                    temp_can_message.identifier,
-                                                                                                                    temp_can_message.data_length_code, 
-                                                                                                                    temp_can_message.data[0], 
-                                                                                                                    temp_can_message.data[1], 
-                                                                                                                    temp_can_message.data[2], 
-                                                                                                                    temp_can_message.data[3], 
-                                                                                                                    temp_can_message.data[4], 
-                                                                                                                    temp_can_message.data[5],
-                                                                                                                    temp_can_message.data[6], 
-                                                                                                                    temp_can_message.data[7],  
-                                                                                                                    temp_can_message.data[0], 
-                                                                                                                    temp_can_message.data[1], 
-                                                                                                                    temp_can_message.data[2], 
-                                                                                                                    temp_can_message.data[3], 
-                                                                                                                    temp_can_message.data[4], 
-                                                                                                                    temp_can_message.data[5],
-                                                                                                                    temp_can_message.data[6], 
-                                                                                                                    temp_can_message.data[7]);
+    /* Call specific function, which will process the message */
+    if ((buffer != NULL) && (buffer->pFunct != NULL))
+    {
+        buffer->pFunct(buffer->object, &rcvMsg);
     }
 }
+
+/******************************************************************************/
+void CO_CANinterrupt(void *args)
+{
+    CO_CANmodule_t *CANmodule = (CO_CANmodule_t *)args;
+    can_message_t temp_can_message; //ESP data type can message
+
+    /* Wait for the first message, so module state is checked at least every CO_CAN_RX_TASK_TIMEOUT */
+    if (can_receive(&temp_can_message, pdMS_TO_TICKS(CO_CAN_RX_TASK_TIMEOUT)) != ESP_OK)
+    {
+        return;
+    }
+    /* Process it and all messages, which were queued in the meantime */
+    do
+    {
+        CO_CANrxMessage(CANmodule, &temp_can_message);
+    } while (can_receive(&temp_can_message, 0) == ESP_OK);
+}
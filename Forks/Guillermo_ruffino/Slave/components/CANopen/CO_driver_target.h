@@ -37,6 +37,8 @@ extern "C" {
 #include <stddef.h>         /* for 'NULL' */
 #include <stdint.h>         /* for 'int8_t' to 'uint64_t' */
 #include <stdbool.h>        /* for 'true', 'false' */
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 
 
 /**
@@ -121,7 +123,7 @@ extern "C" {
  * then sent by CAN TX interrupt as soon as CAN module is freed. Until message is
  * not copied to CAN module, its contents must not change. There may be multiple
  * _bufferFull_ flags in CO_CANtx_t array set to true. In that case messages with
- * lower index inside array will be sent first.
+ * lower CAN-ID will be sent first.
  */
 
 
@@ -159,15 +161,21 @@ extern "C" {
  * CO_SYNC_initCallback() function.
  * @{
  */
-/*TODO: No Lock-System in use. Implement if necessary*/
-#define CO_LOCK_CAN_SEND()  /**< Lock critical section in CO_CANsend() */
-#define CO_UNLOCK_CAN_SEND()/**< Unlock critical section in CO_CANsend() */
+/* CAN send and EMCY sections only copy a few bytes and use spinlocks, which
+ * also work between cores. OD sections call OD functions, which may log or
+ * reconfigure CAN buffers, so they use a mutex. */
+extern portMUX_TYPE CO_CANsendMux;      /**< Spinlock for CO_LOCK_CAN_SEND() */
+extern portMUX_TYPE CO_EMCYmux;         /**< Spinlock for CO_LOCK_EMCY() */
+extern SemaphoreHandle_t CO_ODmutex;    /**< Mutex for CO_LOCK_OD(), created by CO_CANmodule_init() */
 
-#define CO_LOCK_EMCY()      /**< Lock critical section in CO_errorReport() or CO_errorReset() */
-#define CO_UNLOCK_EMCY()    /**< Unlock critical section in CO_errorReport() or CO_errorReset() */
+#define CO_LOCK_CAN_SEND()  portENTER_CRITICAL(&CO_CANsendMux)  /**< Lock critical section in CO_CANsend() */
+#define CO_UNLOCK_CAN_SEND() portEXIT_CRITICAL(&CO_CANsendMux)  /**< Unlock critical section in CO_CANsend() */
 
-#define CO_LOCK_OD()        /**< Lock critical section when accessing Object Dictionary */
-#define CO_UNLOCK_OD()      /**< Unock critical section when accessing Object Dictionary */
+#define CO_LOCK_EMCY()      portENTER_CRITICAL(&CO_EMCYmux)     /**< Lock critical section in CO_errorReport() or CO_errorReset() */
+#define CO_UNLOCK_EMCY()    portEXIT_CRITICAL(&CO_EMCYmux)      /**< Unlock critical section in CO_errorReport() or CO_errorReset() */
+
+#define CO_LOCK_OD()        xSemaphoreTake(CO_ODmutex, portMAX_DELAY) /**< Lock critical section when accessing Object Dictionary */
+#define CO_UNLOCK_OD()      xSemaphoreGive(CO_ODmutex)          /**< Unock critical section when accessing Object Dictionary */
 /** @} */
 
 /**
@@ -185,13 +193,13 @@ extern "C" {
  * @{
  */
 /** Memory barrier */
-#define CANrxMemoryBarrier()
-/** Check if new message has arrived */
-#define IS_CANrxNew(rxNew) ((uintptr_t)rxNew)
-/** Set new message flag */
-#define SET_CANrxNew(rxNew) {CANrxMemoryBarrier(); rxNew = (void*)1L;}
+#define CANrxMemoryBarrier() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+/** Check if new message has arrived, acquires received message data */
+#define IS_CANrxNew(rxNew) ((uintptr_t)__atomic_load_n(&(rxNew), __ATOMIC_ACQUIRE))
+/** Set new message flag, releases received message data */
+#define SET_CANrxNew(rxNew) __atomic_store_n(&(rxNew), (void*)1L, __ATOMIC_RELEASE)
 /** Clear new message flag */
-#define CLEAR_CANrxNew(rxNew) {CANrxMemoryBarrier(); rxNew = (void*)0L;}
+#define CLEAR_CANrxNew(rxNew) __atomic_store_n(&(rxNew), (void*)0L, __ATOMIC_RELEASE)
 /** @} */
 
 /**
@@ -236,7 +244,7 @@ typedef struct{
 /**
  * Transmit message object.
  */
-typedef struct{
+typedef struct CO_CANtx{
     uint32_t            ident;          /**< CAN identifier as aligned in CAN module */
     uint32_t            mask;           //Add MASK-Flag for RTR-bit
     bool                rtr;            //RTR-Flag
@@ -245,9 +253,13 @@ typedef struct{
     volatile bool_t     bufferFull;     /**< True if previous message is still in buffer */
     /** Synchronous PDO messages has this flag set. It prevents them to be sent outside the synchronous window */
     volatile bool_t     syncFlag;
+    struct CO_CANtx    *next;           /**< Next pending message with higher or same CAN-ID */
 }CO_CANtx_t;
 
 
+/** Number of entries in CAN-ID lookup table, one for each standard 11-bit identifier */
+#define CO_CAN_RX_LOOKUP_SIZE   0x800U
+
 /**
  * CAN module object. It may be different in different microcontrollers.
  */
@@ -275,17 +287,36 @@ typedef struct{
     volatile bool_t     firstCANtxMessage;
     /** Number of messages in transmit buffer, which are waiting to be copied to the CAN module */
     volatile uint16_t   CANtxCount;
+    /** Messages waiting for space in esp can TX queue, sorted by CAN-ID, lowest first */
+    CO_CANtx_t         *txPending;
+    /** Estimate of messages in esp can TX queue, counted by CO_CANsend() and
+     * TX alerts. Alerts are coalesced, and TX_IDLE may be handled after
+     * CO_CANsend() on the other core has queued a new message, so the
+     * estimate can be too high or too low. It only decides, whether
+     * can_transmit() is tried directly. can_transmit() never waits, and a
+     * message it rejects goes to txPending, so a wrong estimate may delay
+     * a message to the next TX alert, but never loses it. */
+    volatile uint16_t   txInFlight;
     uint32_t            errOld;         /**< Previous state of CAN errors */
     void               *em;             /**< Emergency object */
+    /** CAN-ID lookup for received messages: rxArray index + 1 of the first
+      * buffer with full 11-bit mask for each standard identifier, 0 if none.
+      * Maintained by CO_CANrxBufferInit(). */
+    uint16_t            rxLookup[CO_CAN_RX_LOOKUP_SIZE];
+    /** Number of rxArray buffers with partial mask. Only those are searched
+      * linearly, if received CAN-ID is not found in rxLookup. */
+    uint16_t            rxMaskedCount;
 }CO_CANmodule_t;
 
 
 /**
- * Receives and transmits CAN messages.
+ * Receives CAN messages.
  *
- * Function must be called directly from high priority CAN interrupt.
+ * Function waits up to CO_CAN_RX_TASK_TIMEOUT for a message from esp can driver,
+ * then processes it and all other queued messages. It is called in a loop by
+ * CAN receive task, which is started by CO_CANsetNormalMode().
  *
- * @param CANmodule This object.
+ * @param args CAN module object.
  */
 void CO_CANinterrupt(void *args);
 
@@ -3,6 +3,7 @@
 #include <unistd.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "driver/gpio.h"
 #include "esp_err.h"
 #include "esp_log.h"
@@ -14,6 +15,7 @@
 #include "CANopen.h"
 #include "CO_OD.h"
 #include "CO_config.h"
+#include "CO_timebase.h"
 #include "modul_config.h"
 #include "dunker.h"
 #include "Gyro.h"
@@ -42,24 +44,54 @@ uint8_t counter = 0;
 volatile uint32_t coInterruptCounter = 0U; /* variable increments each millisecond */
 
 //Timer Interrupt Configuration
-static void coMainTask(void *arg);
+static void coTimerCallback(void *arg);
+static void coRtTask(void *pvParameter);
+static void coRtPark(void);
+static void coRtRelease(void);
+static void coMainSignal(void);
+static void coMainSignalInit(void);
+static TickType_t coSleepTicks(uint16_t time_ms);
 
 esp_timer_create_args_t coMainTaskArgs;
 //Timer Handle
 esp_timer_handle_t periodicTimer;
+//SYNC/PDO task handle, task is pinned to CO_RT_CORE
+static TaskHandle_t coRtTaskHandle = NULL;
+//Mainline task handle, notified by CANopen objects after message reception
+static TaskHandle_t mainTaskHandle = NULL;
+//Park handshake, coRtTask stays away from CANopen objects while mainline resets them.
+//Task starts parked, mainline releases it after the first communication reset.
+static volatile bool_t coRtParkRequest = true;
+static SemaphoreHandle_t coRtParked = NULL;   /* given by coRtTask, when it is parked */
+static SemaphoreHandle_t coRtReleased = NULL; /* given by mainline, when reset is done */
 
 void mainTask(void *pvParameter)
 {
 		ESP_LOGE("mainTask", "Starting Application");
-		coMainTaskArgs.callback = &coMainTask;
+		mainTaskHandle = xTaskGetCurrentTaskHandle();
+		coMainTaskArgs.callback = &coTimerCallback;
 		coMainTaskArgs.name = "coMainTask";
 		CO_NMT_reset_cmd_t reset = CO_RESET_NOT;
 		vTaskDelay(BOOT_WAIT / portTICK_PERIOD_MS);
+
+		/* SYNC/PDO processing runs on its own core, away from WiFi/LwIP and mainline */
+		coRtParked = xSemaphoreCreateBinary();
+		coRtReleased = xSemaphoreCreateBinary();
+		xTaskCreatePinnedToCore(&coRtTask, "coRtTask", CO_RT_TASK_STACK_SIZE, NULL,
+		                        CO_RT_TASK_PRIORITY, &coRtTaskHandle, CO_RT_CORE);
+
+		/* Configure Timer interrupt function for execution every CO_MAIN_TASK_INTERVAL */
+		ESP_ERROR_CHECK(esp_timer_create(&coMainTaskArgs, &periodicTimer));
+		ESP_ERROR_CHECK(esp_timer_start_periodic(periodicTimer, CO_MAIN_TASK_INTERVAL));
 		while (reset != CO_RESET_APP)
 		{
 				/* CANopen communication reset - initialize CANopen objects *******************/
 				CO_ReturnError_t err;
 				uint32_t coInterruptCounterPrevious;
+				CO_timebase_t mainTimebase;
+
+				/* SYNC/PDO task must not run, while its objects are initialized */
+				coRtPark();
 
 				/* initialize CANopen */
 				err = CO_init(NULL, NODE_ID_SELF /* NodeID */, CAN_BITRATE /* bit rate */);
@@ -69,17 +101,14 @@ void mainTask(void *pvParameter)
 						CO_errorReport(CO->em, CO_EM_MEMORY_ALLOCATION_ERROR, CO_EMC_SOFTWARE_INTERNAL, err);
 						esp_restart();
 				}
-				/* Configure Timer interrupt function for execution every CO_MAIN_TASK_INTERVAL */
-				ESP_ERROR_CHECK(esp_timer_create(&coMainTaskArgs, &periodicTimer));
-				ESP_ERROR_CHECK(esp_timer_start_periodic(periodicTimer, CO_MAIN_TASK_INTERVAL));
+				coMainSignalInit();
 
 				/* start CAN */
 				CO_CANsetNormalMode(CO->CANmodule[0]);
 				ESP_LOGE("mainTask", "CAN bus started");
-    /*WORKAROUND: INTERRUPT ALLOCATION FÜR CAN NICHT MÖGLICH DA BEREITS IM IDF TREIBER VERWENDET*/
-    /* Configure Timer interrupt function for execution every CO_CAN_PSEUDO_INTERRUPT_INTERVAL */
     /*Set Canmodule to normal mode*/
     			CO->CANmodule[0]->CANnormal = true;
+				coRtRelease();
 				reset = CO_RESET_NOT;
 				coInterruptCounterPrevious = coInterruptCounter;
 
@@ -98,14 +127,7 @@ void mainTask(void *pvParameter)
 				/* application init code goes here. */
 				//rosserialSetup();
 
-				uint32_t coInterruptCounterCopy;
-						uint32_t coInterruptCounterDiff;
-						coInterruptCounterCopy = coInterruptCounter;
-						coInterruptCounterDiff = coInterruptCounterCopy - coInterruptCounterPrevious;
-						coInterruptCounterPrevious = coInterruptCounterCopy;
-
-						/* CANopen process */
-					
+				CO_timebase_init(&mainTimebase);
 
 						uint8_t sdo_rx_data_buffer[13] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 					//	const twai_message_t msg_buffer = {.identifier = 0x61A, .data_length_code = 8, .data = {0x4C, 0x08,  0x10, 0x00, 0x00, 0x00, 0x00, 0x00} };
@@ -147,7 +169,8 @@ void mainTask(void *pvParameter)
 						 }	
 						i++;																						
 						/* loop for normal program execution ******************************************/
-						reset = CO_process(CO, coInterruptCounterDiff, NULL);
+						uint16_t timerNext_ms = MAIN_WAIT;
+						reset = CO_process(CO, CO_timebase_diff_ms(&mainTimebase), &timerNext_ms);
 						//ESP_LOGE("mainTask", "CO_Process init");
 						// /* Nonblocking application code may go here. */
 						// if (counter == 0)
@@ -195,7 +218,8 @@ void mainTask(void *pvParameter)
 
 						/* Wait */
 
-						vTaskDelay(MAIN_WAIT / portTICK_PERIOD_MS);
+						/* sleep until next CANopen timer expires or received message wakes us */
+						ulTaskNotifyTake(pdTRUE, coSleepTicks(timerNext_ms));
 				}
 		}
 		/* program exit
@@ -205,27 +229,98 @@ void mainTask(void *pvParameter)
 		esp_restart();
 }
 
-/* CanOpen-Task executes in constant intervals ********************************/
-static void coMainTask(void *arg)
+/* Called from CAN receive task after SDO or EMCY reception *******************/
+static void coMainSignal(void)
+{
+		if (mainTaskHandle != NULL)
+				xTaskNotifyGive(mainTaskHandle);
+}
+
+/* Register coMainSignal with objects processed by CO_process() ****************/
+static void coMainSignalInit(void)
 {
-		coInterruptCounter++;
+		int i;
+
+		CO_EM_initCallback(CO->em, coMainSignal);
+		for (i = 0; i < CO_NO_SDO_SERVER; i++)
+				CO_SDO_initCallback(CO->SDO[i], coMainSignal);
+#if CO_NO_SDO_CLIENT != 0
+		for (i = 0; i < CO_NO_SDO_CLIENT; i++)
+				CO_SDOclient_initCallback(CO->SDOclient[i], coMainSignal);
+#endif
+}
+
+/* Mainline sleep time in ticks, rounded up. At least one tick, so lower
+ * priority tasks on this core still run while CANopen asks for immediate call */
+static TickType_t coSleepTicks(uint16_t time_ms)
+{
+		TickType_t ticks = (time_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+		return ticks > 0 ? ticks : 1;
+}
+
+/* Periodic timer wakes SYNC/PDO task every CO_MAIN_TASK_INTERVAL ************/
+static void coTimerCallback(void *arg)
+{
+		if (coRtTaskHandle != NULL)
+				xTaskNotifyGive(coRtTaskHandle);
+}
 
-		if (CO->CANmodule[0]->CANnormal)
+/* Stop coRtTask before communication reset, called from mainline. Returns,
+ * when coRtTask has finished its current pass and waits for coRtRelease(). */
+static void coRtPark(void)
+{
+		coRtParkRequest = true;
+		xTaskNotifyGive(coRtTaskHandle);
+		xSemaphoreTake(coRtParked, portMAX_DELAY);
+}
+
+/* Let coRtTask run again with reinitialized CANopen objects */
+static void coRtRelease(void)
+{
+		coRtParkRequest = false;
+		xSemaphoreGive(coRtReleased);
+}
+
+/* SYNC/PDO task, pinned to CO_RT_CORE ******************************************/
+static void coRtTask(void *pvParameter)
+{
+		CO_timebase_t rtTimebase;
+
+		CO_timebase_init(&rtTimebase);
+		for (;;)
 		{
-				bool_t syncWas;
+				ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
-				/* Process Sync */
-				syncWas = CO_process_SYNC(CO, CO_MAIN_TASK_INTERVAL);
+				if (coRtParkRequest)
+				{
+						/* mainline resets CANopen objects, wait until it is done */
+						xSemaphoreGive(coRtParked);
+						xSemaphoreTake(coRtReleased, portMAX_DELAY);
+						CO_timebase_init(&rtTimebase);
+						continue;
+				}
 
-				/* Read inputs */
-				//CO_process_RPDO(CO, syncWas);
+				uint32_t timeDifference_us = CO_timebase_diff_us(&rtTimebase);
+				coInterruptCounter++;
+
+				if (CO->CANmodule[0]->CANnormal)
+				{
+						bool_t syncWas;
 
-				/* Write outputs */
-				//CO_process_TPDO(CO, syncWas, CO_MAIN_TASK_INTERVAL);
+						/* Process Sync */
+						syncWas = CO_process_SYNC(CO, timeDifference_us);
+
+						/* Read inputs */
+						//CO_process_RPDO(CO, syncWas);
+
+						/* Write outputs */
+						//CO_process_TPDO(CO, syncWas, timeDifference_us);
+				}
 		}
 }
 
 void app_main()
 {
-		xTaskCreate(&mainTask, "mainTask", 4096, NULL, 5, NULL);
+		xTaskCreatePinnedToCore(&mainTask, "mainTask", CO_MAIN_TASK_STACK_SIZE, NULL,
+		                        CO_MAIN_TASK_PRIORITY, NULL, CO_MAIN_CORE);
 }
@@ -25,6 +25,7 @@
  */
 
 #include "CANopen.h"
+#include "CO_OD_desc.h"
 
 #include <stdlib.h>
 
@@ -38,7 +39,22 @@ CO_t *CO = NULL;                                      /* Pointer to COO */
 static CO_CANrx_t *CO_CANmodule_rxArray0;
 static CO_CANtx_t *CO_CANmodule_txArray0;
 static CO_OD_extension_t *CO_SDO_ODExtensions;
+static CO_OD_index_t *CO_SDO_ODindex;
+static uint16_t *CO_SDO_ODindexSlot;
+static uint16_t *CO_SDO_ODindexDisp;
 static CO_HBconsNode_t *CO_HBcons_monitoredNodes;
+static uint32_t *CO_RPDOsched_pending;
+static uint32_t *CO_RPDOsched_received;
+static uint16_t *CO_RPDOsched_heap;
+static CO_RPDOplan_t *CO_RPDOplans;
+static CO_RPDOplanPool_t CO_RPDOplanPool;
+static CO_TPDOplan_t *CO_TPDOplans;
+static CO_TPDOplanPool_t CO_TPDOplanPool;
+static uint16_t *CO_TPDOsched_heap;
+static uint16_t *CO_TPDOsched_active;
+static uint16_t *CO_TPDOsched_sync;
+static uint16_t *CO_TPDOsched_syncDue;
+static CO_CANtx_t **CO_TPDOsched_burst;
 
 #if ((CO_CONFIG_GTW)&CO_CONFIG_GTW_ASCII) && !defined CO_GTWA_ENABLE
 #define CO_GTWA_ENABLE true
@@ -145,8 +161,22 @@ CO_ReturnError_t CO_new(uint32_t *heapMemoryUsed)
         CO_OD_NoOfElements, sizeof(CO_OD_extension_t));
     if (CO_SDO_ODExtensions == NULL)
         errCnt++;
+    CO_SDO_ODindex = (CO_OD_index_t *)calloc(1, sizeof(CO_OD_index_t));
+    if (CO_SDO_ODindex == NULL)
+        errCnt++;
+    CO_SDO_ODindexSlot = (uint16_t *)calloc(
+        CO_OD_INDEX_SLOTS(CO_OD_NoOfElements), sizeof(uint16_t));
+    if (CO_SDO_ODindexSlot == NULL)
+        errCnt++;
+    CO_SDO_ODindexDisp = (uint16_t *)calloc(
+        CO_OD_INDEX_BUCKETS(CO_OD_NoOfElements), sizeof(uint16_t));
+    if (CO_SDO_ODindexDisp == NULL)
+        errCnt++;
     CO_memoryUsed += sizeof(CO_SDO_t) * CO_NO_SDO_SERVER +
-                     sizeof(CO_OD_extension_t) * CO_OD_NoOfElements;
+                     sizeof(CO_OD_extension_t) * CO_OD_NoOfElements +
+                     sizeof(CO_OD_index_t) +
+                     sizeof(uint16_t) * (CO_OD_INDEX_SLOTS(CO_OD_NoOfElements) +
+                                         CO_OD_INDEX_BUCKETS(CO_OD_NoOfElements));
 
     /* Emergency */
     CO->em = (CO_EM_t *)calloc(1, sizeof(CO_EM_t));
@@ -181,24 +211,84 @@ CO_ReturnError_t CO_new(uint32_t *heapMemoryUsed)
     CO->TIME = NULL;
 #endif
 
-    /* RPDO */
-    for (i = 0; i < CO_NO_RPDO; i++)
-    {
-        CO->RPDO[i] = (CO_RPDO_t *)calloc(1, sizeof(CO_RPDO_t));
-        if (CO->RPDO[i] == NULL)
-            errCnt++;
-    }
+    /* RPDO, all objects in one block */
+    CO->RPDO[0] = (CO_RPDO_t *)calloc(CO_NO_RPDO, sizeof(CO_RPDO_t));
+    if (CO->RPDO[0] == NULL)
+        errCnt++;
+    else
+        for (i = 1; i < CO_NO_RPDO; i++)
+        {
+            CO->RPDO[i] = CO->RPDO[0] + i;
+        }
     CO_memoryUsed += sizeof(CO_RPDO_t) * CO_NO_RPDO;
 
-    /* TPDO */
-    for (i = 0; i < CO_NO_TPDO; i++)
-    {
-        CO->TPDO[i] = (CO_TPDO_t *)calloc(1, sizeof(CO_TPDO_t));
-        if (CO->TPDO[i] == NULL)
-            errCnt++;
-    }
+    /* RPDO copy plans, taken only by mapped RPDOs */
+#if CO_NO_RPDO_PLAN > 0
+    CO_RPDOplans = (CO_RPDOplan_t *)calloc(CO_NO_RPDO_PLAN, sizeof(CO_RPDOplan_t));
+    if (CO_RPDOplans == NULL)
+        errCnt++;
+    CO_memoryUsed += sizeof(CO_RPDOplan_t) * CO_NO_RPDO_PLAN;
+#else
+    CO_RPDOplans = NULL;
+#endif
+
+    /* RPDO scheduler */
+    CO->RPDOsched = (CO_RPDOsched_t *)calloc(1, sizeof(CO_RPDOsched_t));
+    if (CO->RPDOsched == NULL)
+        errCnt++;
+    CO_RPDOsched_pending = (uint32_t *)calloc(CO_RPDO_PENDING_WORDS(CO_NO_RPDO), sizeof(uint32_t));
+    if (CO_RPDOsched_pending == NULL)
+        errCnt++;
+    CO_RPDOsched_received = (uint32_t *)calloc(CO_RPDO_PENDING_WORDS(CO_NO_RPDO), sizeof(uint32_t));
+    if (CO_RPDOsched_received == NULL)
+        errCnt++;
+    CO_RPDOsched_heap = (uint16_t *)calloc(CO_NO_RPDO, sizeof(uint16_t));
+    if (CO_RPDOsched_heap == NULL)
+        errCnt++;
+    CO_memoryUsed += sizeof(CO_RPDOsched_t) + sizeof(uint32_t) * CO_RPDO_PENDING_WORDS(CO_NO_RPDO) * 2 + sizeof(uint16_t) * CO_NO_RPDO;
+
+    /* TPDO, all objects in one block */
+    CO->TPDO[0] = (CO_TPDO_t *)calloc(CO_NO_TPDO, sizeof(CO_TPDO_t));
+    if (CO->TPDO[0] == NULL)
+        errCnt++;
+    else
+        for (i = 1; i < CO_NO_TPDO; i++)
+        {
+            CO->TPDO[i] = CO->TPDO[0] + i;
+        }
     CO_memoryUsed += sizeof(CO_TPDO_t) * CO_NO_TPDO;
 
+    /* TPDO copy plans, taken only by mapped TPDOs */
+#if CO_NO_TPDO_PLAN > 0
+    CO_TPDOplans = (CO_TPDOplan_t *)calloc(CO_NO_TPDO_PLAN, sizeof(CO_TPDOplan_t));
+    if (CO_TPDOplans == NULL)
+        errCnt++;
+    CO_memoryUsed += sizeof(CO_TPDOplan_t) * CO_NO_TPDO_PLAN;
+#else
+    CO_TPDOplans = NULL;
+#endif
+
+    /* TPDO scheduler */
+    CO->TPDOsched = (CO_TPDOsched_t *)calloc(1, sizeof(CO_TPDOsched_t));
+    if (CO->TPDOsched == NULL)
+        errCnt++;
+    CO_TPDOsched_heap = (uint16_t *)calloc(CO_NO_TPDO, sizeof(uint16_t));
+    if (CO_TPDOsched_heap == NULL)
+        errCnt++;
+    CO_TPDOsched_active = (uint16_t *)calloc(CO_NO_TPDO, sizeof(uint16_t));
+    if (CO_TPDOsched_active == NULL)
+        errCnt++;
+    CO_TPDOsched_sync = (uint16_t *)calloc(CO_NO_TPDO, sizeof(uint16_t));
+    if (CO_TPDOsched_sync == NULL)
+        errCnt++;
+    CO_TPDOsched_syncDue = (uint16_t *)calloc(CO_NO_TPDO, sizeof(uint16_t));
+    if (CO_TPDOsched_syncDue == NULL)
+        errCnt++;
+    CO_TPDOsched_burst = (CO_CANtx_t **)calloc(CO_NO_TPDO, sizeof(CO_CANtx_t *));
+    if (CO_TPDOsched_burst == NULL)
+        errCnt++;
+    CO_memoryUsed += sizeof(CO_TPDOsched_t) + sizeof(uint16_t) * CO_NO_TPDO * 4 + sizeof(CO_CANtx_t *) * CO_NO_TPDO;
+
     /* Heartbeat consumer */
     CO->HBcons = (CO_HBconsumer_t *)calloc(1, sizeof(CO_HBconsumer_t));
     if (CO->HBcons == NULL)
@@ -342,17 +432,27 @@ void CO_delete(void *CANptr)
     free(CO_HBcons_monitoredNodes);
     free(CO->HBcons);
 
-    /* TPDO */
-    for (i = 0; i < CO_NO_TPDO; i++)
-    {
-        free(CO->TPDO[i]);
-    }
+    /* TPDO scheduler */
+    free(CO_TPDOsched_burst);
+    free(CO_TPDOsched_syncDue);
+    free(CO_TPDOsched_sync);
+    free(CO_TPDOsched_active);
+    free(CO_TPDOsched_heap);
+    free(CO->TPDOsched);
 
-    /* RPDO */
-    for (i = 0; i < CO_NO_RPDO; i++)
-    {
-        free(CO->RPDO[i]);
-    }
+    /* TPDO, all objects in one block */
+    free(CO_TPDOplans);
+    free(CO->TPDO[0]);
+
+    /* RPDO scheduler */
+    free(CO_RPDOsched_heap);
+    free(CO_RPDOsched_received);
+    free(CO_RPDOsched_pending);
+    free(CO->RPDOsched);
+
+    /* RPDO, all objects in one block */
+    free(CO_RPDOplans);
+    free(CO->RPDO[0]);
 
 #if CO_NO_TIME == 1
     /* TIME */
@@ -372,6 +472,9 @@ void CO_delete(void *CANptr)
     free(CO->em);
 
     /* SDOserver */
+    free(CO_SDO_ODindexDisp);
+    free(CO_SDO_ODindexSlot);
+    free(CO_SDO_ODindex);
     free(CO_SDO_ODExtensions);
     for (i = 0; i < CO_NO_SDO_SERVER; i++)
     {
@@ -395,6 +498,9 @@ static CO_CANrx_t COO_CANmodule_rxArray0[CO_RXCAN_NO_MSGS];
 static CO_CANtx_t COO_CANmodule_txArray0[CO_TXCAN_NO_MSGS];
 static CO_SDO_t COO_SDO[CO_NO_SDO_SERVER];
 static CO_OD_extension_t COO_SDO_ODExtensions[CO_OD_NoOfElements];
+static CO_OD_index_t COO_SDO_ODindex;
+static uint16_t COO_SDO_ODindexSlot[CO_OD_INDEX_SLOTS(CO_OD_NoOfElements)];
+static uint16_t COO_SDO_ODindexDisp[CO_OD_INDEX_BUCKETS(CO_OD_NoOfElements)];
 static CO_EM_t COO_EM;
 static CO_EMpr_t COO_EMpr;
 static CO_NMT_t COO_NMT;
@@ -406,6 +512,22 @@ static CO_TIME_t COO_TIME;
 #endif
 static CO_RPDO_t COO_RPDO[CO_NO_RPDO];
 static CO_TPDO_t COO_TPDO[CO_NO_TPDO];
+#if CO_NO_RPDO_PLAN > 0
+static CO_RPDOplan_t COO_RPDOplans[CO_NO_RPDO_PLAN];
+#endif
+#if CO_NO_TPDO_PLAN > 0
+static CO_TPDOplan_t COO_TPDOplans[CO_NO_TPDO_PLAN];
+#endif
+static CO_RPDOsched_t COO_RPDOsched;
+static uint32_t COO_RPDOsched_pending[CO_RPDO_PENDING_WORDS(CO_NO_RPDO)];
+static uint32_t COO_RPDOsched_received[CO_RPDO_PENDING_WORDS(CO_NO_RPDO)];
+static uint16_t COO_RPDOsched_heap[CO_NO_RPDO];
+static CO_TPDOsched_t COO_TPDOsched;
+static uint16_t COO_TPDOsched_heap[CO_NO_TPDO];
+static uint16_t COO_TPDOsched_active[CO_NO_TPDO];
+static uint16_t COO_TPDOsched_sync[CO_NO_TPDO];
+static uint16_t COO_TPDOsched_syncDue[CO_NO_TPDO];
+static CO_CANtx_t *COO_TPDOsched_burst[CO_NO_TPDO];
 static CO_HBconsumer_t COO_HBcons;
 static CO_HBconsNode_t COO_HBcons_monitoredNodes[CO_NO_HB_CONS];
 #if CO_NO_SDO_CLIENT != 0
@@ -456,6 +578,9 @@ CO_ReturnError_t CO_new(uint32_t *heapMemoryUsed)
         CO->SDO[i] = &COO_SDO[i];
     }
     CO_SDO_ODExtensions = &COO_SDO_ODExtensions[0];
+    CO_SDO_ODindex = &COO_SDO_ODindex;
+    CO_SDO_ODindexSlot = &COO_SDO_ODindexSlot[0];
+    CO_SDO_ODindexDisp = &COO_SDO_ODindexDisp[0];
 
     /* Emergency */
     CO->em = &COO_EM;
@@ -481,12 +606,36 @@ CO_ReturnError_t CO_new(uint32_t *heapMemoryUsed)
     {
         CO->RPDO[i] = &COO_RPDO[i];
     }
+#if CO_NO_RPDO_PLAN > 0
+    CO_RPDOplans = &COO_RPDOplans[0];
+#else
+    CO_RPDOplans = NULL;
+#endif
+
+    /* RPDO scheduler */
+    CO->RPDOsched = &COO_RPDOsched;
+    CO_RPDOsched_pending = &COO_RPDOsched_pending[0];
+    CO_RPDOsched_received = &COO_RPDOsched_received[0];
+    CO_RPDOsched_heap = &COO_RPDOsched_heap[0];
 
     /* TPDO */
     for (i = 0; i < CO_NO_TPDO; i++)
     {
         CO->TPDO[i] = &COO_TPDO[i];
     }
+#if CO_NO_TPDO_PLAN > 0
+    CO_TPDOplans = &COO_TPDOplans[0];
+#else
+    CO_TPDOplans = NULL;
+#endif
+
+    /* TPDO scheduler */
+    CO->TPDOsched = &COO_TPDOsched;
+    CO_TPDOsched_heap = &COO_TPDOsched_heap[0];
+    CO_TPDOsched_active = &COO_TPDOsched_active[0];
+    CO_TPDOsched_sync = &COO_TPDOsched_sync[0];
+    CO_TPDOsched_syncDue = &COO_TPDOsched_syncDue[0];
+    CO_TPDOsched_burst = &COO_TPDOsched_burst[0];
 
     /* Heartbeat consumer */
     CO->HBcons = &COO_HBcons;
@@ -680,6 +829,20 @@ CO_ReturnError_t CO_CANopenInit(uint8_t nodeId)
 
         if (err)
             return err;
+
+        /* Other SDO servers share index and descriptors of Object dictionary */
+        if (i == 0)
+        {
+            err = CO_OD_initIndex(CO->SDO[0],
+                                  CO_SDO_ODindex,
+                                  CO_SDO_ODindexSlot,
+                                  CO_SDO_ODindexDisp);
+            if (err)
+                return err;
+            err = CO_OD_initDesc(CO->SDO[0], &CO_OD_desc[0], &CO_OD_descFirst[0]);
+            if (err)
+                return err;
+        }
     }
 
     /* Emergency */
@@ -753,7 +916,8 @@ CO_ReturnError_t CO_CANopenInit(uint8_t nodeId)
         return err;
 #endif
 
-    /* RPDO */
+    /* RPDO, plans are taken again by mapped RPDOs */
+    CO_RPDOplanPool_init(&CO_RPDOplanPool, CO_RPDOplans, CO_NO_RPDO_PLAN);
     for (i = 0; i < CO_NO_RPDO; i++)
     {
         CO_CANmodule_t *CANdevRx = CO->CANmodule[0];
@@ -762,6 +926,7 @@ CO_ReturnError_t CO_CANopenInit(uint8_t nodeId)
         err = CO_RPDO_init(CO->RPDO[i],
                            CO->em,
                            CO->SDO[0],
+                           &CO_RPDOplanPool,
 #if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
                            CO->SYNC,
 #endif
@@ -778,14 +943,23 @@ CO_ReturnError_t CO_CANopenInit(uint8_t nodeId)
 
         if (err)
             return err;
+#if ((CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO) && defined OD_1FD0_objectDispatcherList
+        /* used, if RPDO is mapped as SAM MPDO */
+        CO_RPDO_initMPDO(CO->RPDO[i], &OD_objectDispatcherList[0],
+                         ODL_objectDispatcherList_arrayLength);
+#endif
     }
+    CO_RPDOsched_init(CO->RPDOsched, CO->RPDO, CO_RPDOsched_pending,
+                      CO_RPDOsched_received, CO_RPDOsched_heap, CO_NO_RPDO);
 
-    /* TPDO */
+    /* TPDO, plans are taken again by mapped TPDOs */
+    CO_TPDOplanPool_init(&CO_TPDOplanPool, CO_TPDOplans, CO_NO_TPDO_PLAN);
     for (i = 0; i < CO_NO_TPDO; i++)
     {
         err = CO_TPDO_init(CO->TPDO[i],
                            CO->em,
                            CO->SDO[0],
+                           &CO_TPDOplanPool,
 #if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
                            CO->SYNC,
 #endif
@@ -802,7 +976,14 @@ CO_ReturnError_t CO_CANopenInit(uint8_t nodeId)
 
         if (err)
             return err;
+#if ((CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO) && defined OD_1FA0_objectScannerList
+        /* used, if TPDO is mapped as SAM MPDO, DAM MPDO is sent to all nodes */
+        CO_TPDO_initMPDO(CO->TPDO[i], &OD_objectScannerList[0],
+                         ODL_objectScannerList_arrayLength, 0);
+#endif
     }
+    CO_TPDOsched_init(CO->TPDOsched, CO->TPDO, CO_TPDOsched_heap, CO_TPDOsched_active,
+                      CO_TPDOsched_sync, CO_TPDOsched_syncDue, CO_TPDOsched_burst, CO_NO_TPDO);
 
     /* Heartbeat consumer */
     err = CO_HBconsumer_init(CO->HBcons,
@@ -925,7 +1106,7 @@ CO_NMT_reset_cmd_t CO_process(CO_t *co,
 #endif
                     (CANerrorStatus & CO_CAN_ERRTX_BUS_OFF) != 0,
                     (CANerrorStatus & CO_CAN_ERR_WARN_PASSIVE) != 0,
-                    0, /* RPDO event timer timeout */
+                    unc ? false : CO_isError(co->em, CO_EM_RPDO_TIME_OUT),
                     unc ? false : CO_isError(co->em, CO_EM_SYNC_TIME_OUT),
                     unc ? false : (CO_isError(co->em, CO_EM_HEARTBEAT_CONSUMER) || CO_isError(co->em, CO_EM_HB_CONSUMER_REMOTE_RESET)),
                     OD_errorRegister != 0,
@@ -1034,10 +1215,10 @@ bool_t CO_process_SYNC(CO_t *co,
 
 /******************************************************************************/
 void CO_process_RPDO(CO_t *co,
-                     bool_t syncWas)
+                     bool_t syncWas,
+                     uint32_t timeDifference_us,
+                     uint32_t *timerNext_us)
 {
-    int16_t i;
-
 #if CO_NO_LSS_SLAVE == 1
     if (co->nodeIdUnconfigured)
     {
@@ -1045,10 +1226,8 @@ void CO_process_RPDO(CO_t *co,
     }
 #endif
 
-    for (i = 0; i < CO_NO_RPDO; i++)
-    {
-        CO_RPDO_process(co->RPDO[i], syncWas);
-    }
+    /* Process only RPDOs with received message and monitor deadlines */
+    CO_RPDOsched_process(co->RPDOsched, syncWas, timeDifference_us, timerNext_us);
 }
 
 /******************************************************************************/
@@ -1057,8 +1236,6 @@ void CO_process_TPDO(CO_t *co,
                      uint32_t timeDifference_us,
                      uint32_t *timerNext_us)
 {
-    int16_t i;
-
 #if CO_NO_LSS_SLAVE == 1
     if (co->nodeIdUnconfigured)
     {
@@ -1066,11 +1243,6 @@ void CO_process_TPDO(CO_t *co,
     }
 #endif
 
-    /* Verify PDO Change Of State and process PDOs */
-    for (i = 0; i < CO_NO_TPDO; i++)
-    {
-        if (!co->TPDO[i]->sendRequest)
-            co->TPDO[i]->sendRequest = CO_TPDOisCOS(co->TPDO[i]);
-        CO_TPDO_process(co->TPDO[i], syncWas, timeDifference_us, timerNext_us);
-    }
+    /* Verify PDO Change Of State, process PDOs and expired timers */
+    CO_TPDOsched_process(co->TPDOsched, syncWas, timeDifference_us, timerNext_us);
 }
@@ -167,6 +167,17 @@ extern "C" {
 #define CO_NO_RPDO (1 - 512)
 /** Number of TPDO objects, 1 to 512 producers (CANtx) */
 #define CO_NO_TPDO (1 - 512)
+/** Number of RPDO copy plans, 0 to CO_NO_RPDO, default CO_NO_RPDO. Only RPDO
+ * with mapped objects takes a plan, see CO_RPDOplanPool_init().
+ *
+ * On ESP32 each RPDO takes about 160 bytes with its scheduler entries and
+ * each RPDO plan 380 bytes, TPDO about 145 and its plan 270 bytes. 512 RPDOs
+ * and 512 TPDOs take about 155 kB, with 64 plans of each kind about 200 kB.
+ * All 512 + 512 mapped take about 490 kB, which ESP32 does not have, so
+ * there set plan counts to PDOs really mapped. */
+#define CO_NO_RPDO_PLAN (0 - CO_NO_RPDO)
+/** Number of TPDO copy plans, 0 to CO_NO_TPDO, default CO_NO_TPDO. */
+#define CO_NO_TPDO_PLAN (0 - CO_NO_TPDO)
 /** Number of SDO server objects, from 1 to 128 (CANrx + CANtx) */
 #define CO_NO_SDO_SERVER (1 - 128)
 /** Number of SDO client objects, from 0 to 128 (CANrx + CANtx) */
@@ -228,6 +239,14 @@ extern "C" {
 #else
 #define CO_NO_LSS_MASTER 0
 #endif
+
+/* Copy plans for all PDOs, if not configured otherwise */
+#ifndef CO_NO_RPDO_PLAN
+#define CO_NO_RPDO_PLAN CO_NO_RPDO
+#endif
+#ifndef CO_NO_TPDO_PLAN
+#define CO_NO_TPDO_PLAN CO_NO_TPDO
+#endif
 #endif /* CO_DOXYGEN */
 
 
@@ -269,7 +288,9 @@ typedef struct {
 #endif
     CO_TIME_t *TIME;                 /**< TIME object */
     CO_RPDO_t *RPDO[CO_NO_RPDO];     /**< RPDO objects */
+    CO_RPDOsched_t *RPDOsched;       /**< RPDO scheduler */
     CO_TPDO_t *TPDO[CO_NO_TPDO];     /**< TPDO objects */
+    CO_TPDOsched_t *TPDOsched;       /**< TPDO event timer scheduler */
     CO_HBconsumer_t *HBcons;         /**< Heartbeat consumer object*/
 #if CO_NO_SDO_CLIENT != 0 || defined CO_DOXYGEN
     CO_SDOclient_t *SDOclient[CO_NO_SDO_CLIENT]; /**< SDO client object */
@@ -424,8 +445,15 @@ bool_t CO_process_SYNC(CO_t *co,
  * @param co CANopen object.
  * @param syncWas True, if CANopen SYNC message was just received or
  * transmitted.
+ * @param timeDifference_us Time difference from previous function call in
+ * microseconds.
+ * @param [out] timerNext_us info to OS - see CO_process(). Set to the
+ * earliest reception deadline of monitored RPDOs.
  */
-void CO_process_RPDO(CO_t *co, bool_t syncWas);
+void CO_process_RPDO(CO_t *co,
+                     bool_t syncWas,
+                     uint32_t timeDifference_us,
+                     uint32_t *timerNext_us);
 
 
 /**
@@ -439,7 +467,8 @@ void CO_process_RPDO(CO_t *co, bool_t syncWas);
  * transmitted.
  * @param timeDifference_us Time difference from previous function call in
  * microseconds.
- * @param [out] timerNext_us info to OS - see CO_process().
+ * @param [out] timerNext_us info to OS - see CO_process(). Set to the
+ * earliest inhibit time or event timer deadline of all event driven TPDOs.
  */
 void CO_process_TPDO(CO_t *co,
                      bool_t syncWas,
@@ -206,7 +206,7 @@ typedef enum{
 #define CO_EM_CAN_TX_OVERFLOW           0x14U /**< 0x14, communication, critical, CAN transmit buffer has overflowed */
 #define CO_EM_TPDO_OUTSIDE_WINDOW       0x15U /**< 0x15, communication, critical, TPDO is outside SYNC window */
 #define CO_EM_16_unused                 0x16U /**< 0x16, (unused) */
-#define CO_EM_17_unused                 0x17U /**< 0x17, (unused) */
+#define CO_EM_RPDO_TIME_OUT             0x17U /**< 0x17, communication, critical, RPDO timeout */
 #define CO_EM_SYNC_TIME_OUT             0x18U /**< 0x18, communication, critical, SYNC message timeout */
 #define CO_EM_SYNC_LENGTH               0x19U /**< 0x19, communication, critical, Unexpected SYNC data length */
 #define CO_EM_PDO_WRONG_MAPPING         0x1AU /**< 0x1A, communication, critical, Error with PDO mapping */
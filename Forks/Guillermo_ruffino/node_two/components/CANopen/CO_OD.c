@@ -6,6 +6,13 @@
 
    This file was automatically generated with libedssharp Object
    Dictionary Editor v0.8-31-g22f13fb   DON'T EDIT THIS FILE MANUALLY !!!!
+
+   Manual changes, there is no EDS of this Object Dictionary to generate
+   them from. Repeat them, when file is generated again:
+    - 0x1400 to 0x1403, RPDO communication parameter: subindex 3 (inhibit
+      time), 4 (compatibility entry) and 5 (event timer), maxSubIndex 5.
+    - 0x1FA0 object scanner list and 0x1FD0 object dispatcher list for
+      MPDO, 8 entries each, CO_OD_NoOfElements 56 to 58.
 *******************************************************************************/
 
 
@@ -38,10 +45,10 @@ struct sCO_OD_ROM CO_OD_ROM = {
 /*1019*/ 0x0L,
 /*1029*/ {0x00, 0x00, 0x01, 0x00, 0x00, 0x00},
 /*1200*/ {{0x2L, 0x0600L, 0x0580L}},
-/*1400*/ {{0x2L, 0x0200L, 0xFFL},
-/*1401*/ {0x2L, 0x0300L, 0xFEL},
-/*1402*/ {0x2L, 0x0400L, 0xFEL},
-/*1403*/ {0x2L, 0x0500L, 0xFEL}},
+/*1400*/ {{0x5L, 0x0200L, 0xFFL, 0x00, 0x0L, 0x00},
+/*1401*/ {0x5L, 0x0300L, 0xFEL, 0x00, 0x0L, 0x00},
+/*1402*/ {0x5L, 0x0400L, 0xFEL, 0x00, 0x0L, 0x00},
+/*1403*/ {0x5L, 0x0500L, 0xFEL, 0x00, 0x0L, 0x00}},
 /*1600*/ {{0x2L, 0x62000108L, 0x62000208L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L},
 /*1601*/ {0x0L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L},
 /*1602*/ {0x0L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L},
@@ -55,6 +62,8 @@ struct sCO_OD_ROM CO_OD_ROM = {
 /*1A02*/ {0x0L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L},
 /*1A03*/ {0x0L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L}},
 /*1F80*/ 0x0008L,
+/*1FA0*/ {0x00000000L, 0x00000000L, 0x00000000L, 0x00000000L, 0x00000000L, 0x00000000L, 0x00000000L, 0x00000000L},
+/*1FD0*/ {0x0000000000000000LL, 0x0000000000000000LL, 0x0000000000000000LL, 0x0000000000000000LL, 0x0000000000000000LL, 0x0000000000000000LL, 0x0000000000000000LL, 0x0000000000000000LL},
 /*2101*/ 0x30L,
 /*2102*/ 0xFA,
 /*2111*/ {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
@@ -130,28 +139,40 @@ struct sCO_OD_EEPROM CO_OD_EEPROM = {
            {(void*)&CO_OD_RAM.SDOClientParameter[0].nodeIDOfTheSDOServer, 0x0E, 0x1 },
 };
 
-/*0x1400*/ const CO_OD_entryRecord_t OD_record1400[3] = {
+/*0x1400*/ const CO_OD_entryRecord_t OD_record1400[6] = {
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].maxSubIndex, 0x05, 0x1 },
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].COB_IDUsedByRPDO, 0x8D, 0x4 },
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].transmissionType, 0x0D, 0x1 },
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].inhibitTime, 0x8D, 0x2 },
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].compatibilityEntry, 0x0D, 0x1 },
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].eventTimer, 0x8D, 0x2 },
 };
 
-/*0x1401*/ const CO_OD_entryRecord_t OD_record1401[3] = {
+/*0x1401*/ const CO_OD_entryRecord_t OD_record1401[6] = {
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].maxSubIndex, 0x05, 0x1 },
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].COB_IDUsedByRPDO, 0x8D, 0x4 },
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].transmissionType, 0x0D, 0x1 },
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].inhibitTime, 0x8D, 0x2 },
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].compatibilityEntry, 0x0D, 0x1 },
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].eventTimer, 0x8D, 0x2 },
 };
 
-/*0x1402*/ const CO_OD_entryRecord_t OD_record1402[3] = {
+/*0x1402*/ const CO_OD_entryRecord_t OD_record1402[6] = {
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].maxSubIndex, 0x05, 0x1 },
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].COB_IDUsedByRPDO, 0x8D, 0x4 },
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].transmissionType, 0x0D, 0x1 },
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].inhibitTime, 0x8D, 0x2 },
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].compatibilityEntry, 0x0D, 0x1 },
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].eventTimer, 0x8D, 0x2 },
 };
 
-/*0x1403*/ const CO_OD_entryRecord_t OD_record1403[3] = {
+/*0x1403*/ const CO_OD_entryRecord_t OD_record1403[6] = {
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].maxSubIndex, 0x05, 0x1 },
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].COB_IDUsedByRPDO, 0x8D, 0x4 },
            {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].transmissionType, 0x0D, 0x1 },
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].inhibitTime, 0x8D, 0x2 },
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].compatibilityEntry, 0x0D, 0x1 },
+           {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].eventTimer, 0x8D, 0x2 },
 };
 
 /*0x1600*/ const CO_OD_entryRecord_t OD_record1600[9] = {
@@ -331,10 +352,10 @@ const CO_OD_entry_t CO_OD[CO_OD_NoOfElements] = {
 {0x1029, 0x06, 0x0D,  1, (void*)&CO_OD_ROM.errorBehavior[0]},
 {0x1200, 0x02, 0x00,  0, (void*)&OD_record1200},
 {0x1280, 0x03, 0x00,  0, (void*)&OD_record1280},
-{0x1400, 0x02, 0x00,  0, (void*)&OD_record1400},
-{0x1401, 0x02, 0x00,  0, (void*)&OD_record1401},
-{0x1402, 0x02, 0x00,  0, (void*)&OD_record1402},
-{0x1403, 0x02, 0x00,  0, (void*)&OD_record1403},
+{0x1400, 0x05, 0x00,  0, (void*)&OD_record1400},
+{0x1401, 0x05, 0x00,  0, (void*)&OD_record1401},
+{0x1402, 0x05, 0x00,  0, (void*)&OD_record1402},
+{0x1403, 0x05, 0x00,  0, (void*)&OD_record1403},
 {0x1600, 0x08, 0x00,  0, (void*)&OD_record1600},
 {0x1601, 0x08, 0x00,  0, (void*)&OD_record1601},
 {0x1602, 0x08, 0x00,  0, (void*)&OD_record1602},
@@ -348,6 +369,8 @@ const CO_OD_entry_t CO_OD[CO_OD_NoOfElements] = {
 {0x1A02, 0x08, 0x00,  0, (void*)&OD_record1A02},
 {0x1A03, 0x08, 0x00,  0, (void*)&OD_record1A03},
 {0x1F80, 0x00, 0x8D,  4, (void*)&CO_OD_ROM.NMTStartup},
+{0x1FA0, 0x08, 0x8D,  4, (void*)&CO_OD_ROM.objectScannerList[0]},
+{0x1FD0, 0x08, 0x8D,  8, (void*)&CO_OD_ROM.objectDispatcherList[0]},
 {0x2100, 0x00, 0x26, 10, (void*)&CO_OD_RAM.errorStatusBits},
 {0x2101, 0x00, 0x0D,  1, (void*)&CO_OD_ROM.CANNodeID},
 {0x2102, 0x00, 0x8D,  2, (void*)&CO_OD_ROM.CANBitRate},
@@ -6,6 +6,13 @@
 
    This file was automatically generated with libedssharp Object
    Dictionary Editor v0.8-31-g22f13fb   DON'T EDIT THIS FILE MANUALLY !!!!
+
+   Manual changes, there is no EDS of this Object Dictionary to generate
+   them from. Repeat them, when file is generated again:
+    - 0x1400 to 0x1403, RPDO communication parameter: subindex 3 (inhibit
+      time), 4 (compatibility entry) and 5 (event timer), maxSubIndex 5.
+    - 0x1FA0 object scanner list and 0x1FD0 object dispatcher list for
+      MPDO, 8 entries each, CO_OD_NoOfElements 56 to 58.
 *******************************************************************************/
 
 
@@ -89,7 +96,7 @@
 /*******************************************************************************
    OBJECT DICTIONARY
 *******************************************************************************/
-   #define CO_OD_NoOfElements             56
+   #define CO_OD_NoOfElements             58
 
 
 /*******************************************************************************
@@ -117,6 +124,9 @@
                UNSIGNED8      maxSubIndex;
                UNSIGNED32     COB_IDUsedByRPDO;
                UNSIGNED8      transmissionType;
+               UNSIGNED16     inhibitTime;
+               UNSIGNED8      compatibilityEntry;
+               UNSIGNED16     eventTimer;
                }              OD_RPDOCommunicationParameter_t;
 /*1600      */ typedef struct {
                UNSIGNED8      numberOfMappedObjects;
@@ -304,6 +314,9 @@
         #define OD_1400_0_RPDOCommunicationParameter_maxSubIndex    0
         #define OD_1400_1_RPDOCommunicationParameter_COB_IDUsedByRPDO 1
         #define OD_1400_2_RPDOCommunicationParameter_transmissionType 2
+        #define OD_1400_3_RPDOCommunicationParameter_inhibitTime    3
+        #define OD_1400_4_RPDOCommunicationParameter_compatibilityEntry 4
+        #define OD_1400_5_RPDOCommunicationParameter_eventTimer     5
 
 /*1401 */
         #define OD_1401_RPDOCommunicationParameter                  0x1401
@@ -311,6 +324,9 @@
         #define OD_1401_0_RPDOCommunicationParameter_maxSubIndex    0
         #define OD_1401_1_RPDOCommunicationParameter_COB_IDUsedByRPDO 1
         #define OD_1401_2_RPDOCommunicationParameter_transmissionType 2
+        #define OD_1401_3_RPDOCommunicationParameter_inhibitTime    3
+        #define OD_1401_4_RPDOCommunicationParameter_compatibilityEntry 4
+        #define OD_1401_5_RPDOCommunicationParameter_eventTimer     5
 
 /*1402 */
         #define OD_1402_RPDOCommunicationParameter                  0x1402
@@ -318,6 +334,9 @@
         #define OD_1402_0_RPDOCommunicationParameter_maxSubIndex    0
         #define OD_1402_1_RPDOCommunicationParameter_COB_IDUsedByRPDO 1
         #define OD_1402_2_RPDOCommunicationParameter_transmissionType 2
+        #define OD_1402_3_RPDOCommunicationParameter_inhibitTime    3
+        #define OD_1402_4_RPDOCommunicationParameter_compatibilityEntry 4
+        #define OD_1402_5_RPDOCommunicationParameter_eventTimer     5
 
 /*1403 */
         #define OD_1403_RPDOCommunicationParameter                  0x1403
@@ -325,6 +344,9 @@
         #define OD_1403_0_RPDOCommunicationParameter_maxSubIndex    0
         #define OD_1403_1_RPDOCommunicationParameter_COB_IDUsedByRPDO 1
         #define OD_1403_2_RPDOCommunicationParameter_transmissionType 2
+        #define OD_1403_3_RPDOCommunicationParameter_inhibitTime    3
+        #define OD_1403_4_RPDOCommunicationParameter_compatibilityEntry 4
+        #define OD_1403_5_RPDOCommunicationParameter_eventTimer     5
 
 /*1600 */
         #define OD_1600_RPDOMappingParameter                        0x1600
@@ -477,6 +499,32 @@
 /*1F80 */
         #define OD_1F80_NMTStartup                                  0x1F80
 
+/*1FA0 */
+        #define OD_1FA0_objectScannerList                           0x1FA0
+
+        #define OD_1FA0_0_objectScannerList_maxSubIndex             0
+        #define OD_1FA0_1_objectScannerList_objectScannerList     1
+        #define OD_1FA0_2_objectScannerList_objectScannerList     2
+        #define OD_1FA0_3_objectScannerList_objectScannerList     3
+        #define OD_1FA0_4_objectScannerList_objectScannerList     4
+        #define OD_1FA0_5_objectScannerList_objectScannerList     5
+        #define OD_1FA0_6_objectScannerList_objectScannerList     6
+        #define OD_1FA0_7_objectScannerList_objectScannerList     7
+        #define OD_1FA0_8_objectScannerList_objectScannerList     8
+
+/*1FD0 */
+        #define OD_1FD0_objectDispatcherList                        0x1FD0
+
+        #define OD_1FD0_0_objectDispatcherList_maxSubIndex          0
+        #define OD_1FD0_1_objectDispatcherList_objectDispatcherList 1
+        #define OD_1FD0_2_objectDispatcherList_objectDispatcherList 2
+        #define OD_1FD0_3_objectDispatcherList_objectDispatcherList 3
+        #define OD_1FD0_4_objectDispatcherList_objectDispatcherList 4
+        #define OD_1FD0_5_objectDispatcherList_objectDispatcherList 5
+        #define OD_1FD0_6_objectDispatcherList_objectDispatcherList 6
+        #define OD_1FD0_7_objectDispatcherList_objectDispatcherList 7
+        #define OD_1FD0_8_objectDispatcherList_objectDispatcherList 8
+
 /*2100 */
         #define OD_2100_errorStatusBits                             0x2100
 
@@ -683,6 +731,8 @@ struct sCO_OD_ROM{
 /*1800      */ OD_TPDOCommunicationParameter_t TPDOCommunicationParameter[4];
 /*1A00      */ OD_TPDOMappingParameter_t TPDOMappingParameter[4];
 /*1F80      */ UNSIGNED32     NMTStartup;
+/*1FA0      */ UNSIGNED32      objectScannerList[8];
+/*1FD0      */ UNSIGNED64      objectDispatcherList[8];
 /*2101      */ UNSIGNED8      CANNodeID;
 /*2102      */ UNSIGNED16     CANBitRate;
 /*2111      */ INTEGER32       variableROM_Int32[16];
@@ -833,6 +883,16 @@ extern struct sCO_OD_EEPROM CO_OD_EEPROM;
 /*1F80, Data Type: UNSIGNED32 */
         #define OD_NMTStartup                                       CO_OD_ROM.NMTStartup
 
+/*1FA0, Data Type: UNSIGNED32, Array[8] */
+        #define OD_objectScannerList                                CO_OD_ROM.objectScannerList
+        #define ODL_objectScannerList_arrayLength                   8
+        #define ODA_objectScannerList_objectScannerList             0
+
+/*1FD0, Data Type: UNSIGNED64, Array[8] */
+        #define OD_objectDispatcherList                             CO_OD_ROM.objectDispatcherList
+        #define ODL_objectDispatcherList_arrayLength                8
+        #define ODA_objectDispatcherList_objectDispatcherList       0
+
 /*2100, Data Type: OCTET_STRING */
         #define OD_errorStatusBits                                  CO_OD_RAM.errorStatusBits
         #define ODL_errorStatusBits_stringLength                    10
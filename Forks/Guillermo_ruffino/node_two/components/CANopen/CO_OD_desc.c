@@ -0,0 +1,399 @@
+// clang-format off
+/*******************************************************************************
+
+   File - CO_OD_desc.c/CO_OD_desc.h
+   Flat CANopen Object Dictionary descriptor table.
+
+   This file was automatically generated from CO_OD.c with tools/od_desc.py
+   DON'T EDIT THIS FILE MANUALLY !!!!
+*******************************************************************************/
+
+
+#include "CO_driver.h"
+#include "CO_OD_desc.h"
+
+
+/* Object Dictionary, data of array subindex 0 is its maxSubIndex */
+extern const CO_OD_entry_t CO_OD[CO_OD_NoOfElements];
+
+/*******************************************************************************
+   DESCRIPTORS, one for each index and subindex
+*******************************************************************************/
+const CO_OD_desc_t CO_OD_desc[CO_OD_NoOfDescriptors] = {
+/*1000 00*/ {(void*)&CO_OD_ROM.deviceType, 0x85, 4},
+/*1001 00*/ {(void*)&CO_OD_RAM.errorRegister, 0x26, 1},
+/*1002 00*/ {(void*)&CO_OD_RAM.manufacturerStatusRegister, 0xA6, 4},
+/*1003 00*/ {(void*)&CO_OD[3].maxSubIndex, 0x8E, 1},
+/*1003 01*/ {(void*)&CO_OD_RAM.preDefinedErrorField[0], 0x86, 4},
+/*1003 02*/ {(void*)&CO_OD_RAM.preDefinedErrorField[1], 0x86, 4},
+/*1003 03*/ {(void*)&CO_OD_RAM.preDefinedErrorField[2], 0x86, 4},
+/*1003 04*/ {(void*)&CO_OD_RAM.preDefinedErrorField[3], 0x86, 4},
+/*1003 05*/ {(void*)&CO_OD_RAM.preDefinedErrorField[4], 0x86, 4},
+/*1003 06*/ {(void*)&CO_OD_RAM.preDefinedErrorField[5], 0x86, 4},
+/*1003 07*/ {(void*)&CO_OD_RAM.preDefinedErrorField[6], 0x86, 4},
+/*1003 08*/ {(void*)&CO_OD_RAM.preDefinedErrorField[7], 0x86, 4},
+/*1005 00*/ {(void*)&CO_OD_ROM.COB_ID_SYNCMessage, 0x8D, 4},
+/*1006 00*/ {(void*)&CO_OD_ROM.communicationCyclePeriod, 0x8D, 4},
+/*1007 00*/ {(void*)&CO_OD_ROM.synchronousWindowLength, 0x8D, 4},
+/*1008 00*/ {(void*)&CO_OD_ROM.manufacturerDeviceName, 0x05, 11},
+/*1009 00*/ {(void*)&CO_OD_ROM.manufacturerHardwareVersion, 0x05, 4},
+/*100A 00*/ {(void*)&CO_OD_ROM.manufacturerSoftwareVersion, 0x05, 4},
+/*1010 00*/ {(void*)&CO_OD[10].maxSubIndex, 0x86, 1},
+/*1010 01*/ {(void*)&CO_OD_RAM.storeParameters[0], 0x8E, 4},
+/*1011 00*/ {(void*)&CO_OD[11].maxSubIndex, 0x86, 1},
+/*1011 01*/ {(void*)&CO_OD_RAM.restoreDefaultParameters[0], 0x8E, 4},
+/*1014 00*/ {(void*)&CO_OD_ROM.COB_ID_EMCY, 0x85, 4},
+/*1015 00*/ {(void*)&CO_OD_ROM.inhibitTimeEMCY, 0x8D, 2},
+/*1016 00*/ {(void*)&CO_OD[14].maxSubIndex, 0x85, 1},
+/*1016 01*/ {(void*)&CO_OD_ROM.consumerHeartbeatTime[0], 0x8D, 4},
+/*1016 02*/ {(void*)&CO_OD_ROM.consumerHeartbeatTime[1], 0x8D, 4},
+/*1016 03*/ {(void*)&CO_OD_ROM.consumerHeartbeatTime[2], 0x8D, 4},
+/*1016 04*/ {(void*)&CO_OD_ROM.consumerHeartbeatTime[3], 0x8D, 4},
+/*1017 00*/ {(void*)&CO_OD_ROM.producerHeartbeatTime, 0x8D, 2},
+/*1018 00*/ {(void*)&CO_OD_ROM.identity.maxSubIndex, 0x05, 1},
+/*1018 01*/ {(void*)&CO_OD_ROM.identity.vendorID, 0x85, 4},
+/*1018 02*/ {(void*)&CO_OD_ROM.identity.productCode, 0x85, 4},
+/*1018 03*/ {(void*)&CO_OD_ROM.identity.revisionNumber, 0x85, 4},
+/*1018 04*/ {(void*)&CO_OD_ROM.identity.serialNumber, 0x85, 4},
+/*1019 00*/ {(void*)&CO_OD_ROM.synchronousCounterOverflowValue, 0x0D, 1},
+/*1029 00*/ {(void*)&CO_OD[18].maxSubIndex, 0x05, 1},
+/*1029 01*/ {(void*)&CO_OD_ROM.errorBehavior[0], 0x0D, 1},
+/*1029 02*/ {(void*)&CO_OD_ROM.errorBehavior[1], 0x0D, 1},
+/*1029 03*/ {(void*)&CO_OD_ROM.errorBehavior[2], 0x0D, 1},
+/*1029 04*/ {(void*)&CO_OD_ROM.errorBehavior[3], 0x0D, 1},
+/*1029 05*/ {(void*)&CO_OD_ROM.errorBehavior[4], 0x0D, 1},
+/*1029 06*/ {(void*)&CO_OD_ROM.errorBehavior[5], 0x0D, 1},
+/*1200 00*/ {(void*)&CO_OD_ROM.SDOServerParameter[0].maxSubIndex, 0x05, 1},
+/*1200 01*/ {(void*)&CO_OD_ROM.SDOServerParameter[0].COB_IDClientToServer, 0x85, 4},
+/*1200 02*/ {(void*)&CO_OD_ROM.SDOServerParameter[0].COB_IDServerToClient, 0x85, 4},
+/*1280 00*/ {(void*)&CO_OD_RAM.SDOClientParameter[0].maxSubIndex, 0x06, 1},
+/*1280 01*/ {(void*)&CO_OD_RAM.SDOClientParameter[0].COB_IDClientToServer, 0xBE, 4},
+/*1280 02*/ {(void*)&CO_OD_RAM.SDOClientParameter[0].COB_IDServerToClient, 0xBE, 4},
+/*1280 03*/ {(void*)&CO_OD_RAM.SDOClientParameter[0].nodeIDOfTheSDOServer, 0x0E, 1},
+/*1400 00*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].maxSubIndex, 0x05, 1},
+/*1400 01*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].COB_IDUsedByRPDO, 0x8D, 4},
+/*1400 02*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].transmissionType, 0x0D, 1},
+/*1400 03*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].inhibitTime, 0x8D, 2},
+/*1400 04*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].compatibilityEntry, 0x0D, 1},
+/*1400 05*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[0].eventTimer, 0x8D, 2},
+/*1401 00*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].maxSubIndex, 0x05, 1},
+/*1401 01*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].COB_IDUsedByRPDO, 0x8D, 4},
+/*1401 02*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].transmissionType, 0x0D, 1},
+/*1401 03*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].inhibitTime, 0x8D, 2},
+/*1401 04*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].compatibilityEntry, 0x0D, 1},
+/*1401 05*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[1].eventTimer, 0x8D, 2},
+/*1402 00*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].maxSubIndex, 0x05, 1},
+/*1402 01*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].COB_IDUsedByRPDO, 0x8D, 4},
+/*1402 02*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].transmissionType, 0x0D, 1},
+/*1402 03*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].inhibitTime, 0x8D, 2},
+/*1402 04*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].compatibilityEntry, 0x0D, 1},
+/*1402 05*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[2].eventTimer, 0x8D, 2},
+/*1403 00*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].maxSubIndex, 0x05, 1},
+/*1403 01*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].COB_IDUsedByRPDO, 0x8D, 4},
+/*1403 02*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].transmissionType, 0x0D, 1},
+/*1403 03*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].inhibitTime, 0x8D, 2},
+/*1403 04*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].compatibilityEntry, 0x0D, 1},
+/*1403 05*/ {(void*)&CO_OD_ROM.RPDOCommunicationParameter[3].eventTimer, 0x8D, 2},
+/*1600 00*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[0].numberOfMappedObjects, 0x0D, 1},
+/*1600 01*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[0].mappedObject1, 0x8D, 4},
+/*1600 02*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[0].mappedObject2, 0x8D, 4},
+/*1600 03*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[0].mappedObject3, 0x8D, 4},
+/*1600 04*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[0].mappedObject4, 0x8D, 4},
+/*1600 05*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[0].mappedObject5, 0x8D, 4},
+/*1600 06*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[0].mappedObject6, 0x8D, 4},
+/*1600 07*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[0].mappedObject7, 0x8D, 4},
+/*1600 08*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[0].mappedObject8, 0x8D, 4},
+/*1601 00*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[1].numberOfMappedObjects, 0x0D, 1},
+/*1601 01*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[1].mappedObject1, 0x8D, 4},
+/*1601 02*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[1].mappedObject2, 0x8D, 4},
+/*1601 03*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[1].mappedObject3, 0x8D, 4},
+/*1601 04*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[1].mappedObject4, 0x8D, 4},
+/*1601 05*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[1].mappedObject5, 0x8D, 4},
+/*1601 06*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[1].mappedObject6, 0x8D, 4},
+/*1601 07*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[1].mappedObject7, 0x8D, 4},
+/*1601 08*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[1].mappedObject8, 0x8D, 4},
+/*1602 00*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[2].numberOfMappedObjects, 0x0D, 1},
+/*1602 01*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[2].mappedObject1, 0x8D, 4},
+/*1602 02*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[2].mappedObject2, 0x8D, 4},
+/*1602 03*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[2].mappedObject3, 0x8D, 4},
+/*1602 04*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[2].mappedObject4, 0x8D, 4},
+/*1602 05*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[2].mappedObject5, 0x8D, 4},
+/*1602 06*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[2].mappedObject6, 0x8D, 4},
+/*1602 07*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[2].mappedObject7, 0x8D, 4},
+/*1602 08*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[2].mappedObject8, 0x8D, 4},
+/*1603 00*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[3].numberOfMappedObjects, 0x0D, 1},
+/*1603 01*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[3].mappedObject1, 0x8D, 4},
+/*1603 02*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[3].mappedObject2, 0x8D, 4},
+/*1603 03*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[3].mappedObject3, 0x8D, 4},
+/*1603 04*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[3].mappedObject4, 0x8D, 4},
+/*1603 05*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[3].mappedObject5, 0x8D, 4},
+/*1603 06*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[3].mappedObject6, 0x8D, 4},
+/*1603 07*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[3].mappedObject7, 0x8D, 4},
+/*1603 08*/ {(void*)&CO_OD_ROM.RPDOMappingParameter[3].mappedObject8, 0x8D, 4},
+/*1800 00*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[0].maxSubIndex, 0x05, 1},
+/*1800 01*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[0].COB_IDUsedByTPDO, 0x8D, 4},
+/*1800 02*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[0].transmissionType, 0x0D, 1},
+/*1800 03*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[0].inhibitTime, 0x8D, 2},
+/*1800 04*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[0].compatibilityEntry, 0x0D, 1},
+/*1800 05*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[0].eventTimer, 0x8D, 2},
+/*1800 06*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[0].SYNCStartValue, 0x0D, 1},
+/*1801 00*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[1].maxSubIndex, 0x05, 1},
+/*1801 01*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[1].COB_IDUsedByTPDO, 0x8D, 4},
+/*1801 02*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[1].transmissionType, 0x0D, 1},
+/*1801 03*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[1].inhibitTime, 0x8D, 2},
+/*1801 04*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[1].compatibilityEntry, 0x0D, 1},
+/*1801 05*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[1].eventTimer, 0x8D, 2},
+/*1801 06*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[1].SYNCStartValue, 0x0D, 1},
+/*1802 00*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[2].maxSubIndex, 0x05, 1},
+/*1802 01*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[2].COB_IDUsedByTPDO, 0x8D, 4},
+/*1802 02*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[2].transmissionType, 0x0D, 1},
+/*1802 03*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[2].inhibitTime, 0x8D, 2},
+/*1802 04*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[2].compatibilityEntry, 0x0D, 1},
+/*1802 05*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[2].eventTimer, 0x8D, 2},
+/*1802 06*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[2].SYNCStartValue, 0x0D, 1},
+/*1803 00*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[3].maxSubIndex, 0x05, 1},
+/*1803 01*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[3].COB_IDUsedByTPDO, 0x8D, 4},
+/*1803 02*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[3].transmissionType, 0x0D, 1},
+/*1803 03*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[3].inhibitTime, 0x8D, 2},
+/*1803 04*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[3].compatibilityEntry, 0x0D, 1},
+/*1803 05*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[3].eventTimer, 0x8D, 2},
+/*1803 06*/ {(void*)&CO_OD_ROM.TPDOCommunicationParameter[3].SYNCStartValue, 0x0D, 1},
+/*1A00 00*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[0].numberOfMappedObjects, 0x0D, 1},
+/*1A00 01*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[0].mappedObject1, 0x8D, 4},
+/*1A00 02*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[0].mappedObject2, 0x8D, 4},
+/*1A00 03*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[0].mappedObject3, 0x8D, 4},
+/*1A00 04*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[0].mappedObject4, 0x8D, 4},
+/*1A00 05*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[0].mappedObject5, 0x8D, 4},
+/*1A00 06*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[0].mappedObject6, 0x8D, 4},
+/*1A00 07*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[0].mappedObject7, 0x8D, 4},
+/*1A00 08*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[0].mappedObject8, 0x8D, 4},
+/*1A01 00*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[1].numberOfMappedObjects, 0x0D, 1},
+/*1A01 01*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[1].mappedObject1, 0x8D, 4},
+/*1A01 02*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[1].mappedObject2, 0x8D, 4},
+/*1A01 03*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[1].mappedObject3, 0x8D, 4},
+/*1A01 04*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[1].mappedObject4, 0x8D, 4},
+/*1A01 05*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[1].mappedObject5, 0x8D, 4},
+/*1A01 06*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[1].mappedObject6, 0x8D, 4},
+/*1A01 07*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[1].mappedObject7, 0x8D, 4},
+/*1A01 08*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[1].mappedObject8, 0x8D, 4},
+/*1A02 00*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[2].numberOfMappedObjects, 0x0D, 1},
+/*1A02 01*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[2].mappedObject1, 0x8D, 4},
+/*1A02 02*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[2].mappedObject2, 0x8D, 4},
+/*1A02 03*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[2].mappedObject3, 0x8D, 4},
+/*1A02 04*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[2].mappedObject4, 0x8D, 4},
+/*1A02 05*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[2].mappedObject5, 0x8D, 4},
+/*1A02 06*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[2].mappedObject6, 0x8D, 4},
+/*1A02 07*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[2].mappedObject7, 0x8D, 4},
+/*1A02 08*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[2].mappedObject8, 0x8D, 4},
+/*1A03 00*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[3].numberOfMappedObjects, 0x0D, 1},
+/*1A03 01*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[3].mappedObject1, 0x8D, 4},
+/*1A03 02*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[3].mappedObject2, 0x8D, 4},
+/*1A03 03*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[3].mappedObject3, 0x8D, 4},
+/*1A03 04*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[3].mappedObject4, 0x8D, 4},
+/*1A03 05*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[3].mappedObject5, 0x8D, 4},
+/*1A03 06*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[3].mappedObject6, 0x8D, 4},
+/*1A03 07*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[3].mappedObject7, 0x8D, 4},
+/*1A03 08*/ {(void*)&CO_OD_ROM.TPDOMappingParameter[3].mappedObject8, 0x8D, 4},
+/*1F80 00*/ {(void*)&CO_OD_ROM.NMTStartup, 0x8D, 4},
+/*1FA0 00*/ {(void*)&CO_OD[38].maxSubIndex, 0x85, 1},
+/*1FA0 01*/ {(void*)&CO_OD_ROM.objectScannerList[0], 0x8D, 4},
+/*1FA0 02*/ {(void*)&CO_OD_ROM.objectScannerList[1], 0x8D, 4},
+/*1FA0 03*/ {(void*)&CO_OD_ROM.objectScannerList[2], 0x8D, 4},
+/*1FA0 04*/ {(void*)&CO_OD_ROM.objectScannerList[3], 0x8D, 4},
+/*1FA0 05*/ {(void*)&CO_OD_ROM.objectScannerList[4], 0x8D, 4},
+/*1FA0 06*/ {(void*)&CO_OD_ROM.objectScannerList[5], 0x8D, 4},
+/*1FA0 07*/ {(void*)&CO_OD_ROM.objectScannerList[6], 0x8D, 4},
+/*1FA0 08*/ {(void*)&CO_OD_ROM.objectScannerList[7], 0x8D, 4},
+/*1FD0 00*/ {(void*)&CO_OD[39].maxSubIndex, 0x85, 1},
+/*1FD0 01*/ {(void*)&CO_OD_ROM.objectDispatcherList[0], 0x8D, 8},
+/*1FD0 02*/ {(void*)&CO_OD_ROM.objectDispatcherList[1], 0x8D, 8},
+/*1FD0 03*/ {(void*)&CO_OD_ROM.objectDispatcherList[2], 0x8D, 8},
+/*1FD0 04*/ {(void*)&CO_OD_ROM.objectDispatcherList[3], 0x8D, 8},
+/*1FD0 05*/ {(void*)&CO_OD_ROM.objectDispatcherList[4], 0x8D, 8},
+/*1FD0 06*/ {(void*)&CO_OD_ROM.objectDispatcherList[5], 0x8D, 8},
+/*1FD0 07*/ {(void*)&CO_OD_ROM.objectDispatcherList[6], 0x8D, 8},
+/*1FD0 08*/ {(void*)&CO_OD_ROM.objectDispatcherList[7], 0x8D, 8},
+/*2100 00*/ {(void*)&CO_OD_RAM.errorStatusBits, 0x26, 10},
+/*2101 00*/ {(void*)&CO_OD_ROM.CANNodeID, 0x0D, 1},
+/*2102 00*/ {(void*)&CO_OD_ROM.CANBitRate, 0x8D, 2},
+/*2103 00*/ {(void*)&CO_OD_RAM.SYNCCounter, 0x8E, 2},
+/*2104 00*/ {(void*)&CO_OD_RAM.SYNCTime, 0x86, 2},
+/*2106 00*/ {(void*)&CO_OD_EEPROM.powerOnCounter, 0x87, 4},
+/*2107 00*/ {(void*)&CO_OD[46].maxSubIndex, 0xA6, 1},
+/*2107 01*/ {(void*)&CO_OD_RAM.performance[0], 0xBE, 2},
+/*2107 02*/ {(void*)&CO_OD_RAM.performance[1], 0xBE, 2},
+/*2107 03*/ {(void*)&CO_OD_RAM.performance[2], 0xBE, 2},
+/*2107 04*/ {(void*)&CO_OD_RAM.performance[3], 0xBE, 2},
+/*2107 05*/ {(void*)&CO_OD_RAM.performance[4], 0xBE, 2},
+/*2108 00*/ {(void*)&CO_OD[47].maxSubIndex, 0xA6, 1},
+/*2108 01*/ {(void*)&CO_OD_RAM.temperature[0], 0xA6, 2},
+/*2109 00*/ {(void*)&CO_OD[48].maxSubIndex, 0xA6, 1},
+/*2109 01*/ {(void*)&CO_OD_RAM.voltage[0], 0xA6, 2},
+/*2110 00*/ {(void*)&CO_OD[49].maxSubIndex, 0xE6, 1},
+/*2110 01*/ {(void*)&CO_OD_RAM.variableInt32[0], 0xFE, 4},
+/*2110 02*/ {(void*)&CO_OD_RAM.variableInt32[1], 0xFE, 4},
+/*2110 03*/ {(void*)&CO_OD_RAM.variableInt32[2], 0xFE, 4},
+/*2110 04*/ {(void*)&CO_OD_RAM.variableInt32[3], 0xFE, 4},
+/*2110 05*/ {(void*)&CO_OD_RAM.variableInt32[4], 0xFE, 4},
+/*2110 06*/ {(void*)&CO_OD_RAM.variableInt32[5], 0xFE, 4},
+/*2110 07*/ {(void*)&CO_OD_RAM.variableInt32[6], 0xFE, 4},
+/*2110 08*/ {(void*)&CO_OD_RAM.variableInt32[7], 0xFE, 4},
+/*2110 09*/ {(void*)&CO_OD_RAM.variableInt32[8], 0xFE, 4},
+/*2110 0A*/ {(void*)&CO_OD_RAM.variableInt32[9], 0xFE, 4},
+/*2110 0B*/ {(void*)&CO_OD_RAM.variableInt32[10], 0xFE, 4},
+/*2110 0C*/ {(void*)&CO_OD_RAM.variableInt32[11], 0xFE, 4},
+/*2110 0D*/ {(void*)&CO_OD_RAM.variableInt32[12], 0xFE, 4},
+/*2110 0E*/ {(void*)&CO_OD_RAM.variableInt32[13], 0xFE, 4},
+/*2110 0F*/ {(void*)&CO_OD_RAM.variableInt32[14], 0xFE, 4},
+/*2110 10*/ {(void*)&CO_OD_RAM.variableInt32[15], 0xFE, 4},
+/*2111 00*/ {(void*)&CO_OD[50].maxSubIndex, 0xE5, 1},
+/*2111 01*/ {(void*)&CO_OD_ROM.variableROM_Int32[0], 0xFD, 4},
+/*2111 02*/ {(void*)&CO_OD_ROM.variableROM_Int32[1], 0xFD, 4},
+/*2111 03*/ {(void*)&CO_OD_ROM.variableROM_Int32[2], 0xFD, 4},
+/*2111 04*/ {(void*)&CO_OD_ROM.variableROM_Int32[3], 0xFD, 4},
+/*2111 05*/ {(void*)&CO_OD_ROM.variableROM_Int32[4], 0xFD, 4},
+/*2111 06*/ {(void*)&CO_OD_ROM.variableROM_Int32[5], 0xFD, 4},
+/*2111 07*/ {(void*)&CO_OD_ROM.variableROM_Int32[6], 0xFD, 4},
+/*2111 08*/ {(void*)&CO_OD_ROM.variableROM_Int32[7], 0xFD, 4},
+/*2111 09*/ {(void*)&CO_OD_ROM.variableROM_Int32[8], 0xFD, 4},
+/*2111 0A*/ {(void*)&CO_OD_ROM.variableROM_Int32[9], 0xFD, 4},
+/*2111 0B*/ {(void*)&CO_OD_ROM.variableROM_Int32[10], 0xFD, 4},
+/*2111 0C*/ {(void*)&CO_OD_ROM.variableROM_Int32[11], 0xFD, 4},
+/*2111 0D*/ {(void*)&CO_OD_ROM.variableROM_Int32[12], 0xFD, 4},
+/*2111 0E*/ {(void*)&CO_OD_ROM.variableROM_Int32[13], 0xFD, 4},
+/*2111 0F*/ {(void*)&CO_OD_ROM.variableROM_Int32[14], 0xFD, 4},
+/*2111 10*/ {(void*)&CO_OD_ROM.variableROM_Int32[15], 0xFD, 4},
+/*2112 00*/ {(void*)&CO_OD[51].maxSubIndex, 0xE7, 1},
+/*2112 01*/ {(void*)&CO_OD_EEPROM.variableNV_Int32[0], 0xFF, 4},
+/*2112 02*/ {(void*)&CO_OD_EEPROM.variableNV_Int32[1], 0xFF, 4},
+/*2112 03*/ {(void*)&CO_OD_EEPROM.variableNV_Int32[2], 0xFF, 4},
+/*2112 04*/ {(void*)&CO_OD_EEPROM.variableNV_Int32[3], 0xFF, 4},
+/*2112 05*/ {(void*)&CO_OD_EEPROM.variableNV_Int32[4], 0xFF, 4},
+/*2112 06*/ {(void*)&CO_OD_EEPROM.variableNV_Int32[5], 0xFF, 4},
+/*2112 07*/ {(void*)&CO_OD_EEPROM.variableNV_Int32[6], 0xFF, 4},
+/*2112 08*/ {(void*)&CO_OD_EEPROM.variableNV_Int32[7], 0xFF, 4},
+/*2112 09*/ {(void*)&CO_OD_EEPROM.variableNV_Int32[8], 0xFF, 4},
+/*2112 0A*/ {(void*)&CO_OD_EEPROM.variableNV_Int32[9], 0xFF, 4},
+/*2112 0B*/ {(void*)&CO_OD_EEPROM.variableNV_Int32[10], 0xFF, 4},
+/*2112 0C*/ {(void*)&CO_OD_EEPROM.variableNV_Int32[11], 0xFF, 4},
+/*2112 0D*/ {(void*)&CO_OD_EEPROM.variableNV_Int32[12], 0xFF, 4},
+/*2112 0E*/ {(void*)&CO_OD_EEPROM.variableNV_Int32[13], 0xFF, 4},
+/*2112 0F*/ {(void*)&CO_OD_EEPROM.variableNV_Int32[14], 0xFF, 4},
+/*2112 10*/ {(void*)&CO_OD_EEPROM.variableNV_Int32[15], 0xFF, 4},
+/*2120 00*/ {(void*)&CO_OD_RAM.testVar.maxSubIndex, 0x06, 1},
+/*2120 01*/ {(void*)&CO_OD_RAM.testVar.I64, 0xBE, 8},
+/*2120 02*/ {(void*)&CO_OD_RAM.testVar.U64, 0xBE, 8},
+/*2120 03*/ {(void*)&CO_OD_RAM.testVar.R32, 0xBE, 4},
+/*2120 04*/ {(void*)&CO_OD_RAM.testVar.R64, 0xBE, 8},
+/*2120 05*/ {(void*)0, 0x0E, CO_CONFIG_SDO_BUFFER_SIZE},
+/*2130 00*/ {(void*)&CO_OD_RAM.time.maxSubIndex, 0x06, 1},
+/*2130 01*/ {(void*)&CO_OD_RAM.time.string, 0x06, 30},
+/*2130 02*/ {(void*)&CO_OD_RAM.time.epochTimeBaseMs, 0x8E, 8},
+/*2130 03*/ {(void*)&CO_OD_RAM.time.epochTimeOffsetMs, 0xBE, 4},
+/*6000 00*/ {(void*)&CO_OD[54].maxSubIndex, 0x66, 1},
+/*6000 01*/ {(void*)&CO_OD_RAM.readInput8Bit[0], 0x66, 1},
+/*6000 02*/ {(void*)&CO_OD_RAM.readInput8Bit[1], 0x66, 1},
+/*6000 03*/ {(void*)&CO_OD_RAM.readInput8Bit[2], 0x66, 1},
+/*6000 04*/ {(void*)&CO_OD_RAM.readInput8Bit[3], 0x66, 1},
+/*6000 05*/ {(void*)&CO_OD_RAM.readInput8Bit[4], 0x66, 1},
+/*6000 06*/ {(void*)&CO_OD_RAM.readInput8Bit[5], 0x66, 1},
+/*6000 07*/ {(void*)&CO_OD_RAM.readInput8Bit[6], 0x66, 1},
+/*6000 08*/ {(void*)&CO_OD_RAM.readInput8Bit[7], 0x66, 1},
+/*6200 00*/ {(void*)&CO_OD[55].maxSubIndex, 0x26, 1},
+/*6200 01*/ {(void*)&CO_OD_RAM.writeOutput8Bit[0], 0x3E, 1},
+/*6200 02*/ {(void*)&CO_OD_RAM.writeOutput8Bit[1], 0x3E, 1},
+/*6200 03*/ {(void*)&CO_OD_RAM.writeOutput8Bit[2], 0x3E, 1},
+/*6200 04*/ {(void*)&CO_OD_RAM.writeOutput8Bit[3], 0x3E, 1},
+/*6200 05*/ {(void*)&CO_OD_RAM.writeOutput8Bit[4], 0x3E, 1},
+/*6200 06*/ {(void*)&CO_OD_RAM.writeOutput8Bit[5], 0x3E, 1},
+/*6200 07*/ {(void*)&CO_OD_RAM.writeOutput8Bit[6], 0x3E, 1},
+/*6200 08*/ {(void*)&CO_OD_RAM.writeOutput8Bit[7], 0x3E, 1},
+/*6401 00*/ {(void*)&CO_OD[56].maxSubIndex, 0xA6, 1},
+/*6401 01*/ {(void*)&CO_OD_RAM.readAnalogueInput16Bit[0], 0xA6, 2},
+/*6401 02*/ {(void*)&CO_OD_RAM.readAnalogueInput16Bit[1], 0xA6, 2},
+/*6401 03*/ {(void*)&CO_OD_RAM.readAnalogueInput16Bit[2], 0xA6, 2},
+/*6401 04*/ {(void*)&CO_OD_RAM.readAnalogueInput16Bit[3], 0xA6, 2},
+/*6401 05*/ {(void*)&CO_OD_RAM.readAnalogueInput16Bit[4], 0xA6, 2},
+/*6401 06*/ {(void*)&CO_OD_RAM.readAnalogueInput16Bit[5], 0xA6, 2},
+/*6401 07*/ {(void*)&CO_OD_RAM.readAnalogueInput16Bit[6], 0xA6, 2},
+/*6401 08*/ {(void*)&CO_OD_RAM.readAnalogueInput16Bit[7], 0xA6, 2},
+/*6401 09*/ {(void*)&CO_OD_RAM.readAnalogueInput16Bit[8], 0xA6, 2},
+/*6401 0A*/ {(void*)&CO_OD_RAM.readAnalogueInput16Bit[9], 0xA6, 2},
+/*6401 0B*/ {(void*)&CO_OD_RAM.readAnalogueInput16Bit[10], 0xA6, 2},
+/*6401 0C*/ {(void*)&CO_OD_RAM.readAnalogueInput16Bit[11], 0xA6, 2},
+/*6411 00*/ {(void*)&CO_OD[57].maxSubIndex, 0xA6, 1},
+/*6411 01*/ {(void*)&CO_OD_RAM.writeAnalogueOutput16Bit[0], 0xBE, 2},
+/*6411 02*/ {(void*)&CO_OD_RAM.writeAnalogueOutput16Bit[1], 0xBE, 2},
+/*6411 03*/ {(void*)&CO_OD_RAM.writeAnalogueOutput16Bit[2], 0xBE, 2},
+/*6411 04*/ {(void*)&CO_OD_RAM.writeAnalogueOutput16Bit[3], 0xBE, 2},
+/*6411 05*/ {(void*)&CO_OD_RAM.writeAnalogueOutput16Bit[4], 0xBE, 2},
+/*6411 06*/ {(void*)&CO_OD_RAM.writeAnalogueOutput16Bit[5], 0xBE, 2},
+/*6411 07*/ {(void*)&CO_OD_RAM.writeAnalogueOutput16Bit[6], 0xBE, 2},
+/*6411 08*/ {(void*)&CO_OD_RAM.writeAnalogueOutput16Bit[7], 0xBE, 2},
+};
+
+
+/*******************************************************************************
+   FIRST DESCRIPTOR of each CO_OD[] entry, last element is the end of table
+*******************************************************************************/
+const uint16_t CO_OD_descFirst[CO_OD_NoOfElements + 1] = {
+/*1000*/ 0,
+/*1001*/ 1,
+/*1002*/ 2,
+/*1003*/ 3,
+/*1005*/ 12,
+/*1006*/ 13,
+/*1007*/ 14,
+/*1008*/ 15,
+/*1009*/ 16,
+/*100A*/ 17,
+/*1010*/ 18,
+/*1011*/ 20,
+/*1014*/ 22,
+/*1015*/ 23,
+/*1016*/ 24,
+/*1017*/ 29,
+/*1018*/ 30,
+/*1019*/ 35,
+/*1029*/ 36,
+/*1200*/ 43,
+/*1280*/ 46,
+/*1400*/ 50,
+/*1401*/ 56,
+/*1402*/ 62,
+/*1403*/ 68,
+/*1600*/ 74,
+/*1601*/ 83,
+/*1602*/ 92,
+/*1603*/ 101,
+/*1800*/ 110,
+/*1801*/ 117,
+/*1802*/ 124,
+/*1803*/ 131,
+/*1A00*/ 138,
+/*1A01*/ 147,
+/*1A02*/ 156,
+/*1A03*/ 165,
+/*1F80*/ 174,
+/*1FA0*/ 175,
+/*1FD0*/ 184,
+/*2100*/ 193,
+/*2101*/ 194,
+/*2102*/ 195,
+/*2103*/ 196,
+/*2104*/ 197,
+/*2106*/ 198,
+/*2107*/ 199,
+/*2108*/ 205,
+/*2109*/ 207,
+/*2110*/ 209,
+/*2111*/ 226,
+/*2112*/ 243,
+/*2120*/ 260,
+/*2130*/ 266,
+/*6000*/ 270,
+/*6200*/ 279,
+/*6401*/ 288,
+/*6411*/ 301,
+/*end */ 310,
+};
@@ -0,0 +1,29 @@
+// clang-format off
+/*******************************************************************************
+
+   File - CO_OD_desc.c/CO_OD_desc.h
+   Flat CANopen Object Dictionary descriptor table.
+
+   This file was automatically generated from CO_OD.c with tools/od_desc.py
+   DON'T EDIT THIS FILE MANUALLY !!!!
+*******************************************************************************/
+
+#ifndef CO_OD_DESC_H_
+#define CO_OD_DESC_H_
+
+#include "CO_OD.h"
+#include "CO_SDOserver.h"
+
+/* Number of OD entries, which table was generated for, must match CO_OD.h */
+   #define CO_OD_DESC_NoOfElements        58
+/* Number of descriptors, one for each index and subindex */
+   #define CO_OD_NoOfDescriptors          310
+
+#if CO_OD_DESC_NoOfElements != CO_OD_NoOfElements
+#error CO_OD_desc.c is out of date, run tools/od_desc.py
+#endif
+
+extern const CO_OD_desc_t CO_OD_desc[CO_OD_NoOfDescriptors];
+extern const uint16_t CO_OD_descFirst[CO_OD_NoOfElements + 1];
+
+#endif /* CO_OD_DESC_H_ */
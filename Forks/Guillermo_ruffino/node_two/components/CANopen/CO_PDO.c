@@ -28,25 +28,157 @@
 
 #include "CO_PDO.h"
 
+/* True, if time a is before time b on wrapping microsecond clock */
+#define CO_TPDO_BEFORE(a, b) ((int32_t)((uint32_t)(a) - (uint32_t)(b)) < 0)
+
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+/* Number of subindexes in MPDO scanner or dispatcher block, 0 is the same as 1 */
+#define CO_PDO_MPDO_BLOCK(size) (((size) == 0) ? 1U : (uint16_t)(size))
+
 /*
- * Read received message from CAN module.
+ * Find object, which is transferred by MPDO.
  *
- * Function will be called (by CAN receive interrupt) every time, when CAN
- * message with correct identifier will be received. For more information and
- * description of parameters see file CO_driver.h.
- * If new message arrives and previous message wasn't processed yet, then
- * previous message will be lost and overwritten by new message. That's OK with PDOs.
+ * @param SDO SDO object.
+ * @param index Index of object.
+ * @param subIndex Subindex of object.
+ * @param R_T 0 for RPDO, 1 for TPDO.
+ * @param pLength Pointer to returning parameter: length of object, 1 to 4 bytes.
+ * @param pMBvar Pointer to returning parameter: true for multibyte variable.
+ *
+ * @return Pointer to data of object or NULL, if object can not be mapped.
  */
-static void CO_PDO_receive(void *object, void *msg){
-    CO_RPDO_t *RPDO;
+static uint8_t *CO_PDOmpdoFind(
+        CO_SDO_t               *SDO,
+        uint16_t                index,
+        uint8_t                 subIndex,
+        uint8_t                 R_T,
+        uint8_t                *pLength,
+        bool_t                 *pMBvar)
+{
+    uint16_t entryNo;
+    uint8_t attr;
+    uint8_t length;
+
+    entryNo = CO_OD_find(SDO, index);
+    if(entryNo == 0xFFFF || subIndex > SDO->OD[entryNo].maxSubIndex)
+        return NULL;
+
+    attr = CO_OD_getAttribute(SDO, entryNo, subIndex);
+    if(R_T==0 && !((attr&CO_ODA_RPDO_MAPABLE) && (attr&CO_ODA_WRITEABLE))) return NULL;
+    if(R_T!=0 && !((attr&CO_ODA_TPDO_MAPABLE) && (attr&CO_ODA_READABLE))) return NULL;
+
+    /* MPDO carries at most 4 data bytes */
+    length = CO_OD_getLength(SDO, entryNo, subIndex);
+    if(length == 0 || length > 4) return NULL;
+
+    *pLength = length;
+    *pMBvar = (attr&CO_ODA_MB_VALUE) ? true : false;
+    return (uint8_t*) CO_OD_getDataPointer(SDO, entryNo, subIndex);
+}
+
+
+/* Copy MPDO value between CAN data (little endian) and Object Dictionary */
+static void CO_PDOmpdoCopy(uint8_t *dest, const uint8_t *src, uint8_t length, bool_t MBvar){
+#ifdef CO_BIG_ENDIAN
+    if(MBvar){
+        uint8_t i;
+
+        for(i=0; i<length; i++) dest[i] = src[length - 1 - i];
+        return;
+    }
+#else
+    (void)MBvar;
+#endif
+    memcpy(dest, src, length);
+}
+
+
+/*
+ * Queue received MPDO for CO_RPDO_process().
+ *
+ * Called from CO_PDO_receive(). Each MPDO may carry different object, so it
+ * can not be buffered like PDO. Object is resolved to local index and
+ * subindex here and written into Object Dictionary by CO_RPDOmpdoProcess().
+ *
+ * @param MPDO #CO_PDO_MPDO_SAM or #CO_PDO_MPDO_DAM from mapping, which
+ * receive function uses.
+ *
+ * @return true, if object was queued.
+ */
+static bool_t CO_RPDOmpdoReceive(CO_RPDO_t *RPDO, uint8_t MPDO, const uint8_t *data){
+    uint8_t address = data[0];
+    uint16_t index = (uint16_t)data[1] | ((uint16_t)data[2] << 8);
+    uint8_t subIndex = data[3];
+    uint8_t head, next;
+    CO_RPDOmpdoObj_t *obj;
+
+    if(MPDO == CO_PDO_MPDO_DAM){
+        /* address is 0x80 | node-ID of consumer or 0x80 for all nodes */
+        if((address & 0x80) == 0)
+            return false;
+        address &= 0x7F;
+        if(address != 0 && address != RPDO->nodeId)
+            return false;
+    }
+    else{
+        /* address is node-ID of producer, find local object in dispatcher */
+        const uint64_t *entry = RPDO->dispatcher;
+        uint8_t i;
+
+        if((address & 0x80) != 0)
+            return false;
+
+        for(i=0; i<RPDO->dispatcherCount; i++, entry++){
+            uint64_t e = *entry;
+            uint8_t first = (uint8_t)(e >> 8);
+            uint16_t sub;
+
+            if((uint8_t)e != address || (uint16_t)(e >> 16) != index ||
+               subIndex < first || (uint16_t)(subIndex - first) >= CO_PDO_MPDO_BLOCK((uint8_t)(e >> 56)))
+            {
+                continue;
+            }
+            sub = (uint16_t)((uint8_t)(e >> 32)) + (subIndex - first);
+            if(sub > 0xFF)
+                return false;
+            index = (uint16_t)(e >> 40);
+            subIndex = (uint8_t)sub;
+            break;
+        }
+        if(i == RPDO->dispatcherCount)
+            return false;
+    }
+
+    /* receive function is the only writer of MPDOhead */
+    head = RPDO->MPDOhead;
+    next = (head + 1U < CO_CONFIG_PDO_MPDO_QUEUE) ? head + 1U : 0U;
+    if(next == CO_FIFO_LOAD(RPDO->MPDOtail)){
+        RPDO->MPDOlost++;
+        return false;
+    }
+    obj = &RPDO->plan->MPDOqueue[head];
+    obj->index = index;
+    obj->subIndex = subIndex;
+    memcpy(obj->data, &data[4], sizeof(obj->data));
+    CO_FIFO_STORE(RPDO->MPDOhead, next);
+
+    return true;
+}
+#endif
+
+/*
+ * Read received message from CAN module, see CO_PDO_receive().
+ *
+ * @param map RPDO->rxMap, its dataLength, MPDO and plan->field are used.
+ */
+static void CO_PDO_receiveMap(CO_RPDO_t *RPDO, const CO_RPDO_t *map, void *msg){
     uint8_t DLC = CO_CANrxMsg_readDLC(msg);
     uint8_t *data = CO_CANrxMsg_readData(msg);
 
-    RPDO = (CO_RPDO_t*)object;   /* this is the correct pointer type of the first argument */
-
     if( (RPDO->valid) &&
         (*RPDO->operatingState == CO_NMT_OPERATIONAL) &&
-        (DLC >= RPDO->dataLength))
+        (DLC >= map->dataLength))
     {
 #if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
         const size_t index = RPDO->SYNC && RPDO->synchronous && RPDO->SYNC->CANrxToggle;
@@ -54,9 +186,37 @@ static void CO_PDO_receive(void *object, void *msg){
         const size_t index = 0;
 #endif
 
-        /* copy data into appropriate buffer and set 'new message' flag */
-        memcpy(RPDO->CANrxData[index], data, sizeof(RPDO->CANrxData[index]));
-        CO_FLAG_SET(RPDO->CANrxNew[index]);
+        /* restart reception deadline */
+        if(RPDO->receivedWord != NULL) {
+            CO_FLAG_SET_BITS(*RPDO->receivedWord, RPDO->pendingBit);
+        }
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+        if(map->MPDO != 0){
+            if(!CO_RPDOmpdoReceive(RPDO, map->MPDO, data))
+                return;
+        }
+        else
+#endif
+        {
+#if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLBACK_RX
+            /* Deliver data to application directly, before it is buffered. */
+            if(RPDO->pFunctRx != NULL &&
+               RPDO->pFunctRx(RPDO->functRxObject, data, map->plan->field, map->plan->fieldCount))
+            {
+                return;
+            }
+#endif
+
+            /* copy data into appropriate buffer and set 'new message' flag */
+            CO_SEQ_WRITE_BEGIN(RPDO->CANrxSeq[index]);
+            memcpy(RPDO->CANrxData[index], data, sizeof(RPDO->CANrxData[index]));
+            CO_SEQ_WRITE_END(RPDO->CANrxSeq[index]);
+            CO_FLAG_SET(RPDO->CANrxNew[index]);
+        }
+        if(RPDO->pendingWord != NULL) {
+            CO_FLAG_SET_BITS(*RPDO->pendingWord, RPDO->pendingBit);
+        }
 
 #if (CO_CONFIG_PDO) & CO_CONFIG_FLAG_CALLBACK_PRE
         /* Optional signal to RTOS, which can resume task, which handles RPDO. */
@@ -68,6 +228,27 @@ static void CO_PDO_receive(void *object, void *msg){
 }
 
 
+/*
+ * Read received message from CAN module.
+ *
+ * Function will be called (by CAN receive interrupt) every time, when CAN
+ * message with correct identifier will be received. For more information and
+ * description of parameters see file CO_driver.h.
+ * If new message arrives and previous message wasn't processed yet, then
+ * previous message will be lost and overwritten by new message. That's OK with PDOs.
+ */
+static void CO_PDO_receive(void *object, void *msg){
+    CO_RPDO_t *RPDO;
+
+    RPDO = (CO_RPDO_t*)object;   /* this is the correct pointer type of the first argument */
+
+    /* rxMap is not reused by CO_RPDOmapSwap(), until function has left */
+    CO_RCU_ENTER(RPDO->rxSeq);
+    CO_PDO_receiveMap(RPDO, CO_RCU_READ(RPDO->rxMap), msg);
+    CO_RCU_EXIT(RPDO->rxSeq);
+}
+
+
 /*
  * Configure RPDO Communication parameter.
  *
@@ -175,8 +356,12 @@ static void CO_TPDOconfigCom(CO_TPDO_t* TPDO, uint32_t COB_IDUsedByTPDO, uint8_t
  * @param map PDO mapping parameter.
  * @param R_T 0 for RPDO map, 1 for TPDO map.
  * @param ppData Pointer to returning parameter: pointer to data of mapped variable.
- * @param pLength Pointer to returning parameter: *add* length of mapped variable.
- * @param pSendIfCOSFlags Pointer to returning parameter: sendIfCOSFlags variable.
+ * @param pBitLength Pointer to returning parameter: *add* length of mapped
+ * variable in bits. On input it is position of the variable in PDO.
+ * @param pObjectLength Pointer to returning parameter: length of variable in
+ * Object Dictionary in bytes.
+ * @param pCOSmask Pointer to returning parameter: bits of the variable are set,
+ * if it detects Change of State.
  * @param pIsMultibyteVar Pointer to returning parameter: true for multibyte variable.
  *
  * @return 0 on success, otherwise SDO abort code.
@@ -186,29 +371,31 @@ static uint32_t CO_PDOfindMap(
         uint32_t                map,
         uint8_t                 R_T,
         uint8_t               **ppData,
-        uint8_t                *pLength,
-        uint8_t                *pSendIfCOSFlags,
+        uint8_t                *pBitLength,
+        uint8_t                *pObjectLength,
+        uint64_t               *pCOSmask,
         uint8_t                *pIsMultibyteVar)
 {
     uint16_t entryNo;
     uint16_t index;
     uint8_t subIndex;
     uint8_t dataLen;
+    uint8_t bitOffset;
+    bool_t aligned;
     uint8_t objectLen;
     uint8_t attr;
 
     index = (uint16_t)(map>>16);
     subIndex = (uint8_t)(map>>8);
     dataLen = (uint8_t) map;   /* data length in bits */
+    bitOffset = *pBitLength;
 
-    /* data length must be byte aligned */
-    if(dataLen&0x07) return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
+    /* total PDO length can not be more than 64 bits */
+    if((uint16_t)bitOffset + dataLen > 64) return CO_SDO_AB_MAP_LEN;  /* The number and length of the objects to be mapped would exceed PDO length. */
+    *pBitLength += dataLen;
 
-    dataLen >>= 3;    /* new data length is in bytes */
-    *pLength += dataLen;
-
-    /* total PDO length can not be more than 8 bytes */
-    if(*pLength > 8) return CO_SDO_AB_MAP_LEN;  /* The number and length of the objects to be mapped would exceed PDO length. */
+    /* byte aligned variable is copied by copy plan, other by shift and mask */
+    aligned = ((bitOffset | dataLen) & 0x07) == 0;
 
     /* is there a reference to dummy entries */
     if(index <=7 && subIndex == 0){
@@ -216,16 +403,18 @@ static uint32_t CO_PDOfindMap(
         static uint32_t dummyRX;
         uint8_t dummySize = 4;
 
-        if(index<2) dummySize = 0;
-        else if(index==2 || index==5) dummySize = 1;
+        if(index==0) dummySize = 0;
+        else if(index<=2 || index==5) dummySize = 1;   /* BOOLEAN, INTEGER8, UNSIGNED8 */
         else if(index==3 || index==6) dummySize = 2;
 
         /* is size of variable big enough for map */
-        if(dummySize < dataLen) return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
+        if(dummySize * 8 < dataLen) return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
 
         /* Data and ODE pointer */
         if(R_T == 0) *ppData = (uint8_t*) &dummyRX;
         else         *ppData = (uint8_t*) &dummyTX;
+        *pObjectLength = dummySize;
+        *pIsMultibyteVar = 0;
 
         return 0;
     }
@@ -245,7 +434,10 @@ static uint32_t CO_PDOfindMap(
 
     /* is size of variable big enough for map */
     objectLen = CO_OD_getLength(SDO, entryNo, subIndex);
-    if(objectLen < dataLen) return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
+    if(objectLen * 8 < dataLen) return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
+    /* bit field is shifted as integer value, at most 64 bits */
+    if(!aligned && objectLen > 8) return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
+    *pObjectLength = objectLen;
 
     /* mark multibyte variable */
     *pIsMultibyteVar = (attr&CO_ODA_MB_VALUE) ? 1 : 0;
@@ -254,17 +446,15 @@ static uint32_t CO_PDOfindMap(
     *ppData = (uint8_t*) CO_OD_getDataPointer(SDO, entryNo, subIndex);
 #ifdef CO_BIG_ENDIAN
     /* skip unused MSB bytes */
-    if(*pIsMultibyteVar){
-        *ppData += objectLen - dataLen;
+    if(*pIsMultibyteVar && aligned){
+        *ppData += objectLen - (dataLen >> 3);
     }
 #endif
 
     /* setup change of state flags */
-    if(attr&CO_ODA_TPDO_DETECT_COS){
-        int16_t i;
-        for(i=*pLength-dataLen; i<*pLength; i++){
-            *pSendIfCOSFlags |= 1<<i;
-        }
+    if((attr&CO_ODA_TPDO_DETECT_COS) && dataLen > 0){
+        uint64_t bits = (dataLen < 64) ? ((1ULL << dataLen) - 1) : ~0ULL;
+        *pCOSmask |= bits << bitOffset;
     }
 
     return 0;
@@ -272,200 +462,726 @@ static uint32_t CO_PDOfindMap(
 
 
 /*
- * Configure RPDO Mapping parameter.
- *
- * Function is called from communication reset or when parameter changes.
+ * Build PDO copy plan from mapPointer.
  *
- * Function configures following variables from CO_RPDO_t: _dataLength_ and
- * _mapPointer_.
+ * Neighbouring PDO bytes, which also point to neighbouring bytes in Object
+ * Dictionary, are joined into one run. Little endian multibyte variables and
+ * variables mapped one after another in the same OD array result in single
+ * run. Reversed bytes (big endian) result in runs of one byte. Bytes with NULL
+ * pointer belong to bit fields and are skipped.
  *
- * @param RPDO RPDO object.
- * @param noOfMappedObjects Number of mapped object (from OD).
+ * @param mapPointer Array of pointers to OD data, one per PDO byte.
+ * @param dataLength Number of PDO bytes.
+ * @param copyRun Array of 8 elements, where plan is written.
  *
- * @return 0 on success, otherwise SDO abort code.
+ * @return Number of runs.
  */
-static uint32_t CO_RPDOconfigMap(CO_RPDO_t* RPDO, uint8_t noOfMappedObjects){
-    int16_t i;
-    uint8_t length = 0;
-    uint32_t ret = 0;
-    const uint32_t* pMap = &RPDO->RPDOMapPar->mappedObject1;
-
-    for(i=noOfMappedObjects; i>0; i--){
-        int16_t j;
-        uint8_t* pData;
-        uint8_t dummy = 0;
-        uint8_t prevLength = length;
-        uint8_t MBvar;
-        uint32_t map = *(pMap++);
-
-        /* function do much checking of errors in map */
-        ret = CO_PDOfindMap(
-                RPDO->SDO,
-                map,
-                0,
-                &pData,
-                &length,
-                &dummy,
-                &MBvar);
-        if(ret){
-            length = 0;
-            CO_errorReport(RPDO->em, CO_EM_PDO_WRONG_MAPPING, CO_EMC_PROTOCOL_ERROR, map);
-            break;
-        }
-
-        /* write PDO data pointers */
-#ifdef CO_BIG_ENDIAN
-        if(MBvar){
-            for(j=length-1; j>=prevLength; j--)
-                RPDO->mapPointer[j] = pData++;
+static uint8_t CO_PDOconfigCopyPlan(
+        uint8_t               **mapPointer,
+        uint8_t                 dataLength,
+        CO_PDOcopyRun_t        *copyRun)
+{
+    uint8_t count = 0;
+    uint8_t i;
+
+    for(i=0; i<dataLength; i++){
+        if(mapPointer[i] == NULL) continue;
+        if(count > 0 && (copyRun[count-1].PDOoffset + copyRun[count-1].length) == i &&
+           mapPointer[i] == (copyRun[count-1].ODdata + copyRun[count-1].length))
+        {
+            copyRun[count-1].length++;
         }
         else{
-            for(j=prevLength; j<length; j++)
-                RPDO->mapPointer[j] = pData++;
-        }
-#else
-        for(j=prevLength; j<length; j++){
-            RPDO->mapPointer[j] = pData++;
+            copyRun[count].ODdata = mapPointer[i];
+            copyRun[count].PDOoffset = i;
+            copyRun[count].length = 1;
+            count++;
         }
-#endif
-
     }
 
-    RPDO->dataLength = length;
-
-    return ret;
+    return count;
 }
 
 
 /*
- * Configure TPDO Mapping parameter.
- *
- * Function is called from communication reset or when parameter changes.
+ * Keep per-byte copy through mapPointer for copy plan with short runs.
  *
- * Function configures following variables from CO_TPDO_t: _dataLength_,
- * _mapPointer_ and _sendIfCOSFlags_.
+ * One run costs about as much as four bytes copied through mapPointer
+ * (host_test/test_pdo_bits), so copy plan is used, if its runs are at least
+ * four bytes long on average. PDO with bit fields always uses copy plan.
  *
- * @param TPDO TPDO object.
- * @param noOfMappedObjects Number of mapped object (from OD).
+ * @param mapPointer Array of pointers to OD data, one per PDO byte.
+ * @param dataLength Number of PDO bytes.
+ * @param copyRunCount Number of runs in copy plan.
+ * @param bytePointer Array of 8 elements, where mapPointer is copied.
  *
- * @return 0 on success, otherwise SDO abort code.
+ * @return Number of PDO bytes to copy through bytePointer, 0 for copy plan.
  */
-static uint32_t CO_TPDOconfigMap(CO_TPDO_t* TPDO, uint8_t noOfMappedObjects){
-    int16_t i;
-    uint8_t length = 0;
-    uint32_t ret = 0;
-    const uint32_t* pMap = &TPDO->TPDOMapPar->mappedObject1;
+static uint8_t CO_PDOconfigByteCopy(
+        uint8_t               **mapPointer,
+        uint8_t                 dataLength,
+        uint8_t                 copyRunCount,
+        uint8_t               **bytePointer)
+{
+    uint8_t i;
 
-    TPDO->sendIfCOSFlags = 0;
+    if(dataLength >= copyRunCount * 4) return 0;
 
-    for(i=noOfMappedObjects; i>0; i--){
-        int16_t j;
-        uint8_t* pData;
-        uint8_t prevLength = length;
-        uint8_t MBvar;
-        uint32_t map = *(pMap++);
+    for(i=0; i<dataLength; i++){
+        if(mapPointer[i] == NULL) return 0;
+        bytePointer[i] = mapPointer[i];
+    }
 
-        /* function do much checking of errors in map */
-        ret = CO_PDOfindMap(
-                TPDO->SDO,
-                map,
-                1,
-                &pData,
-                &length,
-                &TPDO->sendIfCOSFlags,
-                &MBvar);
-        if(ret){
-            length = 0;
-            CO_errorReport(TPDO->em, CO_EM_PDO_WRONG_MAPPING, CO_EMC_PROTOCOL_ERROR, map);
+    return dataLength;
+}
+
+
+/*
+ * Copy one run of PDO copy plan. Variable sizes are copied with fixed size
+ * memcpy, which compiler inlines, other lengths with up to three of them.
+ */
+static inline void CO_PDOcopy(uint8_t *dest, const uint8_t *src, uint8_t length){
+    switch(length){
+        case 1: *dest = *src; break;
+        case 2: memcpy(dest, src, 2); break;
+        case 4: memcpy(dest, src, 4); break;
+        case 8: memcpy(dest, src, 8); break;
+        default:
+            if(length & 4){ memcpy(dest, src, 4); dest += 4; src += 4; }
+            if(length & 2){ memcpy(dest, src, 2); dest += 2; src += 2; }
+            if(length & 1) *dest = *src;
             break;
-        }
+    }
+}
 
-        /* write PDO data pointers */
+
+/* Copy byte aligned PDO data from Object Dictionary, see CO_PDOconfigByteCopy() */
+static inline void CO_PDOgather(
+        uint8_t                *data,
+        const CO_PDOcopyRun_t  *run,
+        uint8_t                 copyRunCount,
+        uint8_t *const         *mapPointer,
+        uint8_t                 mapPointerCount)
+{
+    if(mapPointerCount > 0){
+        for(; mapPointerCount>0; mapPointerCount--) *(data++) = **(mapPointer++);
+        return;
+    }
+    for(; copyRunCount>0; copyRunCount--, run++){
+        CO_PDOcopy(&data[run->PDOoffset], run->ODdata, run->length);
+    }
+}
+
+
+/* Copy byte aligned PDO data to Object Dictionary, see CO_PDOconfigByteCopy() */
+static inline void CO_PDOscatter(
+        const uint8_t          *data,
+        const CO_PDOcopyRun_t  *run,
+        uint8_t                 copyRunCount,
+        uint8_t *const         *mapPointer,
+        uint8_t                 mapPointerCount)
+{
+    if(mapPointerCount > 0){
+        for(; mapPointerCount>0; mapPointerCount--) **(mapPointer++) = *(data++);
+        return;
+    }
+    for(; copyRunCount>0; copyRunCount--, run++){
+        CO_PDOcopy(run->ODdata, &data[run->PDOoffset], run->length);
+    }
+}
+
+
+/*
+ * Write PDO data pointers of one mapped object.
+ *
+ * Byte aligned object gets one pointer for each of its PDO bytes. Other object
+ * is added to the list of bit fields and its PDO bytes get NULL pointer, so
+ * copy plan skips them. Bit fields of dummy entries are not added.
+ *
+ * @param mapPointer Array of pointers to OD data, one per PDO byte.
+ * @param bitField Array of 8 bit fields.
+ * @param bitFieldCount Pointer to number of used elements in bitField.
+ * @param map PDO mapping parameter.
+ * @param pData Pointer to data of mapped variable, from CO_PDOfindMap().
+ * @param bitOffset Position of mapped variable in PDO in bits.
+ * @param bitEnd Position after mapped variable in PDO in bits.
+ * @param objectLength Length of variable in Object Dictionary in bytes.
+ * @param MBvar True for multibyte variable.
+ */
+static void CO_PDOconfigPointers(
+        uint8_t               **mapPointer,
+        CO_PDObitField_t       *bitField,
+        uint8_t                *bitFieldCount,
+        uint32_t                map,
+        uint8_t                *pData,
+        uint8_t                 bitOffset,
+        uint8_t                 bitEnd,
+        uint8_t                 objectLength,
+        uint8_t                 MBvar)
+{
+    int16_t j;
+    int16_t prevLength = bitOffset >> 3;
+    int16_t length = (bitEnd + 7) >> 3;
+    CO_PDObitField_t *f;
+
+    if(((bitOffset | bitEnd) & 0x07) == 0){
 #ifdef CO_BIG_ENDIAN
         if(MBvar){
             for(j=length-1; j>=prevLength; j--)
-                TPDO->mapPointer[j] = pData++;
+                mapPointer[j] = pData++;
         }
         else{
             for(j=prevLength; j<length; j++)
-                TPDO->mapPointer[j] = pData++;
+                mapPointer[j] = pData++;
         }
 #else
         for(j=prevLength; j<length; j++){
-            TPDO->mapPointer[j] = pData++;
+            mapPointer[j] = pData++;
         }
 #endif
+        return;
+    }
 
+    for(j=prevLength; j<length; j++){
+        mapPointer[j] = NULL;
     }
 
-    TPDO->dataLength = length;
+    /* dummy entry is not copied */
+    if((uint16_t)(map>>16) <= 7 && (uint8_t)(map>>8) == 0) return;
 
-    return ret;
+    f = &bitField[(*bitFieldCount)++];
+    f->ODdata = pData;
+    f->bitOffset = bitOffset;
+    f->bitLength = bitEnd - bitOffset;
+    f->ODlength = objectLength;
+    f->MBvar = MBvar;
 }
 
 
-/*
- * Function for accessing _RPDO communication parameter_ (index 0x1400+) from SDO server.
- *
- * For more information see file CO_SDOserver.h.
- */
-static CO_SDO_abortCode_t CO_ODF_RPDOcom(CO_ODF_arg_t *ODF_arg){
-    CO_RPDO_t *RPDO;
+/* Value of PDO data as 64-bit integer, first byte is least significant */
+static inline uint64_t CO_PDOgetBits(const uint8_t *data){
+    uint64_t value = 0;
+#ifdef CO_BIG_ENDIAN
+    int16_t i;
 
-    RPDO = (CO_RPDO_t*) ODF_arg->object;
+    for(i=7; i>=0; i--){
+        value = (value << 8) | data[i];
+    }
+#else
+    memcpy(&value, data, sizeof(value));
+#endif
+    return value;
+}
 
-    /* Reading Object Dictionary variable */
-    if(ODF_arg->reading){
-        if(ODF_arg->subIndex == 1){
-            uint32_t value = CO_getUint32(ODF_arg->data);
 
-            /* if default COB ID is used, write default value here */
-            if(((value)&0xFFFF) == RPDO->defaultCOB_ID && RPDO->defaultCOB_ID)
-                value += RPDO->nodeId;
+/* Value of bytes of one copy run as integer, first byte is least significant */
+static inline uint64_t CO_PDOrunBits(const uint8_t *ODdata, uint8_t length){
+#ifndef CO_BIG_ENDIAN
+    uint16_t v16;
+    uint32_t v32;
+    uint64_t v64;
 
-            /* If PDO is not valid, set bit 31 */
-            if(!RPDO->valid) value |= 0x80000000L;
+    switch(length){
+        case 1: return *ODdata;
+        case 2: memcpy(&v16, ODdata, 2); return v16;
+        case 4: memcpy(&v32, ODdata, 4); return v32;
+        case 8: memcpy(&v64, ODdata, 8); return v64;
+        default: break;
+    }
+#endif
+    {
+        uint64_t value = 0;
 
-            CO_setUint32(ODF_arg->data, value);
+        while(length > 0){
+            length--;
+            value = (value << 8) | ODdata[length];
         }
-        return CO_SDO_AB_NONE;
+        return value;
     }
+}
 
-    /* Writing Object Dictionary variable */
-    if(RPDO->restrictionFlags & 0x04)
-        return CO_SDO_AB_READONLY;  /* Attempt to write a read only object. */
-    if(*RPDO->operatingState == CO_NMT_OPERATIONAL && (RPDO->restrictionFlags & 0x01))
-        return CO_SDO_AB_DATA_DEV_STATE;   /* Data cannot be transferred or stored to the application because of the present device state. */
 
-    if(ODF_arg->subIndex == 1){   /* COB_ID */
-        uint32_t value = CO_getUint32(ODF_arg->data);
+/* Read integer value of bit field variable from Object Dictionary */
+static inline uint64_t CO_PDObitRead(const CO_PDObitField_t *f){
+    uint64_t value = 0;
+    int16_t k;
 
-        /* bits 11...29 must be zero */
-        if(value & 0x3FFF8000L)
-            return CO_SDO_AB_INVALID_VALUE;  /* Invalid value for parameter (download only). */
+#ifdef CO_BIG_ENDIAN
+    if(f->MBvar){
+        for(k=0; k<f->ODlength; k++)
+            value = (value << 8) | f->ODdata[k];
+        return value;
+    }
+#endif
+    for(k=f->ODlength-1; k>=0; k--){
+        value = (value << 8) | f->ODdata[k];
+    }
+    return value;
+}
 
-        /* if default COB-ID is being written, write defaultCOB_ID without nodeId */
-        if(((value)&0xFFFF) == (RPDO->defaultCOB_ID + RPDO->nodeId)){
-            value &= 0xC0000000L;
-            value += RPDO->defaultCOB_ID;
-            CO_setUint32(ODF_arg->data, value);
-        }
 
-        /* if PDO is valid, bits 0..29 can not be changed */
-        if(RPDO->valid && ((value ^ RPDO->RPDOCommPar->COB_IDUsedByRPDO) & 0x3FFFFFFFL))
-            return CO_SDO_AB_INVALID_VALUE;  /* Invalid value for parameter (download only). */
+/* Write integer value of bit field variable to Object Dictionary */
+static inline void CO_PDObitWrite(const CO_PDObitField_t *f, uint64_t value){
+    int16_t k;
 
-        /* configure RPDO */
-        CO_RPDOconfigCom(RPDO, value);
+#ifdef CO_BIG_ENDIAN
+    if(f->MBvar){
+        for(k=f->ODlength-1; k>=0; k--){
+            f->ODdata[k] = (uint8_t)value;
+            value >>= 8;
+        }
+        return;
     }
-    else if(ODF_arg->subIndex == 2){   /* Transmission_type */
-        uint8_t *value = (uint8_t*) ODF_arg->data;
-#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
-        bool_t synchronousPrev = RPDO->synchronous;
+#endif
+    for(k=0; k<f->ODlength; k++){
+        f->ODdata[k] = (uint8_t)value;
+        value >>= 8;
+    }
+}
 
-        /* values from 241...253 are not valid */
-        if(*value >= 241 && *value <= 253)
-            return CO_SDO_AB_INVALID_VALUE;  /* Invalid value for parameter (download only). */
+
+/* Mask of bit field value, bit fields are shorter than 64 bits */
+#define CO_PDO_BIT_MASK(f) ((1ULL << (f)->bitLength) - 1)
+
+
+#if (CO_CONFIG_PDO) & (CO_CONFIG_RPDO_CALLS_EXTENSION | CO_CONFIG_TPDO_CALLS_EXTENSION)
+/*
+ * Resolve Object Dictionary extensions of mapped objects.
+ *
+ * Extension slot is stored, not extension function, so extensions configured
+ * by CO_OD_configure() after PDO mapping are also called.
+ *
+ * @param SDO SDO object.
+ * @param pMap Pointer to first mapped object in PDO mapping parameter.
+ * @param noOfMappedObjects Number of mapped objects.
+ * @param ext Array of 8 elements, where resolved extensions are written.
+ *
+ * @return Number of resolved extensions.
+ */
+static uint8_t CO_PDOconfigExt(
+        CO_SDO_t               *SDO,
+        const uint32_t         *pMap,
+        uint8_t                 noOfMappedObjects,
+        CO_PDOext_t            *ext)
+{
+    uint8_t count = 0;
+
+    if(SDO->ODExtensions == NULL) return 0;
+
+    for(; noOfMappedObjects>0; noOfMappedObjects--){
+        uint32_t map = *(pMap++);
+        uint16_t index = (uint16_t)(map>>16);
+        uint8_t subIndex = (uint8_t)(map>>8);
+        uint16_t entryNo;
+
+        /* dummy entries have no extension */
+        if(index <= 7 && subIndex == 0) continue;
+
+        entryNo = CO_OD_find(SDO, index);
+        if(entryNo == 0xFFFF) continue;
+
+        ext[count].ext = &SDO->ODExtensions[entryNo];
+        ext[count].data = CO_OD_getDataPointer(SDO, entryNo, subIndex);
+        ext[count].dataLength = CO_OD_getLength(SDO, entryNo, subIndex);
+        ext[count].attribute = CO_OD_getAttribute(SDO, entryNo, subIndex);
+        ext[count].index = index;
+        ext[count].subIndex = subIndex;
+        count++;
+    }
+
+    return count;
+}
+
+
+/*
+ * Call Object Dictionary extension functions of mapped objects.
+ *
+ * @param ext Array of resolved extensions.
+ * @param extCount Number of elements in ext.
+ * @param reading True for TPDO (data read from OD), false for RPDO.
+ */
+static void CO_PDOcallExt(const CO_PDOext_t *ext, uint8_t extCount, bool_t reading){
+    for(; extCount>0; extCount--, ext++){
+        CO_OD_extension_t *pExt = ext->ext;
+        CO_ODF_arg_t ODF_arg;
+
+        if(pExt->pODFunc == NULL) continue;
+
+        ODF_arg.object = pExt->object;
+        ODF_arg.data = (uint8_t*)ext->data; //https://github.com/CANopenNode/CANopenNode/issues/100
+        ODF_arg.ODdataStorage = NULL;
+        ODF_arg.dataLength = ext->dataLength;
+        ODF_arg.attribute = ext->attribute;
+        ODF_arg.pFlags = (pExt->flags != NULL) ? &pExt->flags[ext->subIndex] : NULL;
+        ODF_arg.index = ext->index;
+        ODF_arg.subIndex = ext->subIndex;
+        ODF_arg.reading = reading;
+        ODF_arg.firstSegment = false;
+        ODF_arg.lastSegment = false;
+        ODF_arg.dataLengthTotal = 0;
+        ODF_arg.offset = 0;
+        pExt->pODFunc(&ODF_arg);
+    }
+}
+#endif
+
+
+/* Plan of PDO, which is not mapped, see CO_RPDOplan_t */
+static CO_RPDOplan_t CO_RPDOplanNone;
+static CO_TPDOplan_t CO_TPDOplanNone;
+
+
+/******************************************************************************/
+void CO_RPDOplanPool_init(CO_RPDOplanPool_t *pool, CO_RPDOplan_t *plans, uint16_t count){
+    if(pool != NULL){
+        pool->plans = plans;
+        pool->count = (plans != NULL) ? count : 0;
+        pool->used = 0;
+    }
+}
+
+
+/******************************************************************************/
+void CO_TPDOplanPool_init(CO_TPDOplanPool_t *pool, CO_TPDOplan_t *plans, uint16_t count){
+    if(pool != NULL){
+        pool->plans = plans;
+        pool->count = (plans != NULL) ? count : 0;
+        pool->used = 0;
+    }
+}
+
+
+/*
+ * Take empty plan from pool for PDO, which has none yet.
+ *
+ * @return Plan or NULL, if pool is empty.
+ */
+static CO_RPDOplan_t *CO_RPDOplanTake(CO_RPDOplanPool_t *pool){
+    CO_RPDOplan_t *plan;
+
+    if(pool == NULL || pool->used >= pool->count) return NULL;
+    plan = &pool->plans[pool->used++];
+    memset(plan, 0, sizeof(*plan));
+    return plan;
+}
+
+static CO_TPDOplan_t *CO_TPDOplanTake(CO_TPDOplanPool_t *pool){
+    CO_TPDOplan_t *plan;
+
+    if(pool == NULL || pool->used >= pool->count) return NULL;
+    plan = &pool->plans[pool->used++];
+    memset(plan, 0, sizeof(*plan));
+    return plan;
+}
+
+
+/*
+ * Configure RPDO Mapping parameter.
+ *
+ * Function is called from communication reset or when parameter changes.
+ *
+ * Function configures _dataLength_ and _plan_ of CO_RPDO_t. RPDO without plan
+ * takes one from pool, if it has mapped objects.
+ *
+ * @param RPDO RPDO object.
+ * @param noOfMappedObjects Number of mapped object (from OD).
+ *
+ * @return 0 on success, otherwise SDO abort code.
+ */
+static uint32_t CO_RPDOconfigMap(CO_RPDO_t* RPDO, uint8_t noOfMappedObjects){
+    int16_t i;
+    uint8_t bitLength = 0;
+    uint8_t length;
+    uint32_t ret = 0;
+    uint64_t COSmask = 0;
+    uint8_t *mapPointer[8];
+    const uint32_t* pMap = &RPDO->RPDOMapPar->mappedObject1;
+    CO_RPDOplan_t *plan;
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+    RPDO->MPDO = 0;
+#endif
+    if(RPDO->plan == NULL) RPDO->plan = &CO_RPDOplanNone;
+    if(noOfMappedObjects == 0 && RPDO->plan == &CO_RPDOplanNone){
+        RPDO->dataLength = 0;
+        return 0;
+    }
+    if(RPDO->plan == &CO_RPDOplanNone){
+        plan = CO_RPDOplanTake(RPDO->planPool);
+        if(plan == NULL){
+            RPDO->dataLength = 0;
+            CO_errorReport(RPDO->em, CO_EM_MEMORY_ALLOCATION_ERROR, CO_EMC_SOFTWARE_INTERNAL, RPDO->defaultCOB_ID);
+            return CO_SDO_AB_OUT_OF_MEM;
+        }
+        RPDO->plan = plan;
+    }
+    plan = RPDO->plan;
+    plan->bitFieldCount = 0;
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+    /* MPDO has no static mapping, objects are written by CO_RPDOmpdoProcess() */
+    if(noOfMappedObjects == CO_PDO_MPDO_SAM || noOfMappedObjects == CO_PDO_MPDO_DAM){
+        RPDO->MPDO = noOfMappedObjects;
+        RPDO->dataLength = 8;
+        plan->copyRunCount = 0;
+        plan->mapPointerCount = 0;
+#if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLBACK_RX
+        plan->fieldCount = 0;
+#endif
+#if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLS_EXTENSION
+        plan->extCount = 0;
+#endif
+        return 0;
+    }
+#endif
+
+    for(i=noOfMappedObjects; i>0; i--){
+        uint8_t* pData;
+        uint8_t prevBitLength = bitLength;
+        uint8_t objectLength;
+        uint8_t MBvar;
+        uint32_t map = *(pMap++);
+
+        /* function do much checking of errors in map */
+        ret = CO_PDOfindMap(
+                RPDO->SDO,
+                map,
+                0,
+                &pData,
+                &bitLength,
+                &objectLength,
+                &COSmask,
+                &MBvar);
+        if(ret){
+            bitLength = 0;
+            CO_errorReport(RPDO->em, CO_EM_PDO_WRONG_MAPPING, CO_EMC_PROTOCOL_ERROR, map);
+            break;
+        }
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLBACK_RX
+        /* describe mapped object for receive callback */
+        plan->field[noOfMappedObjects - i].index = (uint16_t)(map >> 16);
+        plan->field[noOfMappedObjects - i].subIndex = (uint8_t)(map >> 8);
+        plan->field[noOfMappedObjects - i].bitOffset = prevBitLength;
+        plan->field[noOfMappedObjects - i].bitLength = bitLength - prevBitLength;
+#endif
+
+        /* write PDO data pointers */
+        CO_PDOconfigPointers(mapPointer, plan->bitField, &plan->bitFieldCount,
+                             map, pData, prevBitLength, bitLength, objectLength, MBvar);
+    }
+
+    length = (bitLength + 7) >> 3;
+    if(length == 0) plan->bitFieldCount = 0;
+    RPDO->dataLength = length;
+    plan->copyRunCount = CO_PDOconfigCopyPlan(mapPointer, length, plan->copyRun);
+    plan->mapPointerCount = CO_PDOconfigByteCopy(mapPointer, length, plan->copyRunCount, plan->mapPointer);
+#if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLBACK_RX
+    plan->fieldCount = (length > 0) ? noOfMappedObjects : 0;
+#endif
+#if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLS_EXTENSION
+    plan->extCount = (length > 0) ? CO_PDOconfigExt(RPDO->SDO, &RPDO->RPDOMapPar->mappedObject1,
+                                                    noOfMappedObjects, plan->ext) : 0;
+#endif
+
+    return ret;
+}
+
+
+/*
+ * Configure TPDO Mapping parameter.
+ *
+ * Function is called from communication reset or when parameter changes.
+ *
+ * Function configures _dataLength_, _plan_, _bitBytes_, _COSmask_ and
+ * _sendIfCOSFlags_ of CO_TPDO_t. TPDO without plan takes one from pool, if it
+ * has mapped objects.
+ *
+ * @param TPDO TPDO object.
+ * @param noOfMappedObjects Number of mapped object (from OD).
+ *
+ * @return 0 on success, otherwise SDO abort code.
+ */
+static uint32_t CO_TPDOconfigMap(CO_TPDO_t* TPDO, uint8_t noOfMappedObjects){
+    int16_t i;
+    uint8_t bitLength = 0;
+    uint8_t length;
+    uint32_t ret = 0;
+    uint64_t COSmask = 0;
+    uint8_t *mapPointer[8];
+    const uint32_t* pMap = &TPDO->TPDOMapPar->mappedObject1;
+    CO_TPDOplan_t *plan;
+
+    TPDO->sendIfCOSFlags = 0;
+    TPDO->bitBytes = 0;
+    TPDO->COSmask = 0;
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+    TPDO->MPDO = 0;
+    TPDO->MPDOdata = NULL;
+#endif
+    if(TPDO->plan == NULL) TPDO->plan = &CO_TPDOplanNone;
+    if(noOfMappedObjects == 0 && TPDO->plan == &CO_TPDOplanNone){
+        TPDO->dataLength = 0;
+        return 0;
+    }
+    if(TPDO->plan == &CO_TPDOplanNone){
+        plan = CO_TPDOplanTake(TPDO->planPool);
+        if(plan == NULL){
+            TPDO->dataLength = 0;
+            CO_errorReport(TPDO->em, CO_EM_MEMORY_ALLOCATION_ERROR, CO_EMC_SOFTWARE_INTERNAL, TPDO->defaultCOB_ID);
+            return CO_SDO_AB_OUT_OF_MEM;
+        }
+        TPDO->plan = plan;
+    }
+    plan = TPDO->plan;
+    plan->bitFieldCount = 0;
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+    /* MPDO has no static mapping, object is written by CO_TPDOmpdoGather() */
+    if(noOfMappedObjects == CO_PDO_MPDO_SAM || noOfMappedObjects == CO_PDO_MPDO_DAM){
+        plan->copyRunCount = 0;
+        plan->mapPointerCount = 0;
+#if (CO_CONFIG_PDO) & CO_CONFIG_TPDO_CALLS_EXTENSION
+        plan->extCount = 0;
+#endif
+
+        /* DAM MPDO sends the first mapped object */
+        if(noOfMappedObjects == CO_PDO_MPDO_DAM){
+            uint32_t map = *pMap;
+
+            TPDO->MPDOindex = (uint16_t)(map>>16);
+            TPDO->MPDOsubIndex = (uint8_t)(map>>8);
+            TPDO->MPDOdata = CO_PDOmpdoFind(TPDO->SDO, TPDO->MPDOindex, TPDO->MPDOsubIndex,
+                                            1, &TPDO->MPDOlength, &TPDO->MPDOmultibyte);
+            if(TPDO->MPDOdata == NULL){
+                TPDO->dataLength = 0;
+                CO_errorReport(TPDO->em, CO_EM_PDO_WRONG_MAPPING, CO_EMC_PROTOCOL_ERROR, map);
+                return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
+            }
+        }
+        TPDO->MPDO = noOfMappedObjects;
+        TPDO->dataLength = 8;
+        return 0;
+    }
+#endif
+
+    for(i=noOfMappedObjects; i>0; i--){
+        uint8_t* pData;
+        uint8_t prevBitLength = bitLength;
+        uint8_t objectLength;
+        uint8_t MBvar;
+        uint32_t map = *(pMap++);
+
+        /* function do much checking of errors in map */
+        ret = CO_PDOfindMap(
+                TPDO->SDO,
+                map,
+                1,
+                &pData,
+                &bitLength,
+                &objectLength,
+                &COSmask,
+                &MBvar);
+        if(ret){
+            bitLength = 0;
+            COSmask = 0;
+            CO_errorReport(TPDO->em, CO_EM_PDO_WRONG_MAPPING, CO_EMC_PROTOCOL_ERROR, map);
+            break;
+        }
+
+        /* write PDO data pointers */
+        CO_PDOconfigPointers(mapPointer, plan->bitField, &plan->bitFieldCount,
+                             map, pData, prevBitLength, bitLength, objectLength, MBvar);
+    }
+
+    length = (bitLength + 7) >> 3;
+    if(length == 0) plan->bitFieldCount = 0;
+    TPDO->dataLength = length;
+    plan->copyRunCount = CO_PDOconfigCopyPlan(mapPointer, length, plan->copyRun);
+    plan->mapPointerCount = CO_PDOconfigByteCopy(mapPointer, length, plan->copyRunCount, plan->mapPointer);
+
+    /* PDO bytes, which are assembled from bit fields */
+    for(i=0; i<length; i++){
+        if(mapPointer[i] == NULL) TPDO->bitBytes |= 1<<i;
+    }
+
+    /* COS bits for CO_TPDOisCOS(), one flag per byte in sendIfCOSFlags */
+    TPDO->COSmask = COSmask;
+    for(i=0; i<8; i++){
+        if((uint8_t)(COSmask >> (i * 8)) != 0) TPDO->sendIfCOSFlags |= 1<<i;
+    }
+#if (CO_CONFIG_PDO) & CO_CONFIG_TPDO_CALLS_EXTENSION
+    plan->extCount = (length > 0) ? CO_PDOconfigExt(TPDO->SDO, &TPDO->TPDOMapPar->mappedObject1,
+                                                    noOfMappedObjects, plan->ext) : 0;
+#endif
+
+    return ret;
+}
+
+
+/*
+ * Function for accessing _RPDO communication parameter_ (index 0x1400+) from SDO server.
+ *
+ * For more information see file CO_SDOserver.h.
+ */
+static CO_SDO_abortCode_t CO_ODF_RPDOcom(CO_ODF_arg_t *ODF_arg){
+    CO_RPDO_t *RPDO;
+
+    RPDO = (CO_RPDO_t*) ODF_arg->object;
+
+    /* Reading Object Dictionary variable */
+    if(ODF_arg->reading){
+        if(ODF_arg->subIndex == 1){
+            uint32_t value = CO_getUint32(ODF_arg->data);
+
+            /* if default COB ID is used, write default value here */
+            if(((value)&0xFFFF) == RPDO->defaultCOB_ID && RPDO->defaultCOB_ID)
+                value += RPDO->nodeId;
+
+            /* If PDO is not valid, set bit 31 */
+            if(!RPDO->valid) value |= 0x80000000L;
+
+            CO_setUint32(ODF_arg->data, value);
+        }
+        return CO_SDO_AB_NONE;
+    }
+
+    /* Writing Object Dictionary variable */
+    if(RPDO->restrictionFlags & 0x04)
+        return CO_SDO_AB_READONLY;  /* Attempt to write a read only object. */
+    if(*RPDO->operatingState == CO_NMT_OPERATIONAL && (RPDO->restrictionFlags & 0x01))
+        return CO_SDO_AB_DATA_DEV_STATE;   /* Data cannot be transferred or stored to the application because of the present device state. */
+
+    if(ODF_arg->subIndex == 1){   /* COB_ID */
+        uint32_t value = CO_getUint32(ODF_arg->data);
+
+        /* bits 11...29 must be zero */
+        if(value & 0x3FFF8000L)
+            return CO_SDO_AB_INVALID_VALUE;  /* Invalid value for parameter (download only). */
+
+        /* if default COB-ID is being written, write defaultCOB_ID without nodeId */
+        if(((value)&0xFFFF) == (RPDO->defaultCOB_ID + RPDO->nodeId)){
+            value &= 0xC0000000L;
+            value += RPDO->defaultCOB_ID;
+            CO_setUint32(ODF_arg->data, value);
+        }
+
+        /* if PDO is valid, bits 0..29 can not be changed */
+        if(RPDO->valid && ((value ^ RPDO->RPDOCommPar->COB_IDUsedByRPDO) & 0x3FFFFFFFL))
+            return CO_SDO_AB_INVALID_VALUE;  /* Invalid value for parameter (download only). */
+
+        /* configure RPDO */
+        CO_RPDOconfigCom(RPDO, value);
+        if(RPDO->sched != NULL) RPDO->sched->update = true;
+    }
+    else if(ODF_arg->subIndex == 2){   /* Transmission_type */
+        uint8_t *value = (uint8_t*) ODF_arg->data;
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
+        bool_t synchronousPrev = RPDO->synchronous;
+
+        /* values from 241...253 are not valid */
+        if(*value >= 241 && *value <= 253)
+            return CO_SDO_AB_INVALID_VALUE;  /* Invalid value for parameter (download only). */
 
         RPDO->synchronous = (*value <= 240) ? true : false;
 
@@ -479,6 +1195,10 @@ static CO_SDO_abortCode_t CO_ODF_RPDOcom(CO_ODF_arg_t *ODF_arg){
             return CO_SDO_AB_INVALID_VALUE;  /* Invalid value for parameter (download only). */
 #endif
     }
+    else if(ODF_arg->subIndex == 5){   /* Event_Timer */
+        /* new value is used from next reception */
+        if(RPDO->sched != NULL) RPDO->sched->update = true;
+    }
 
     return CO_SDO_AB_NONE;
 }
@@ -540,9 +1260,8 @@ static CO_SDO_abortCode_t CO_ODF_TPDOcom(CO_ODF_arg_t *ODF_arg){
 
         /* configure TPDO */
         CO_TPDOconfigCom(TPDO, value, TPDO->CANtxBuff->syncFlag);
-#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
-        TPDO->syncCounter = 255;
-#endif
+        CO_FLAG_SET_BITS(TPDO->commChanged, CO_TPDO_COMM_SYNC);
+        if(TPDO->sched != NULL) TPDO->sched->update = true;
     }
     else if(ODF_arg->subIndex == 2){   /* Transmission_type */
         uint8_t *value = (uint8_t*) ODF_arg->data;
@@ -551,8 +1270,8 @@ static CO_SDO_abortCode_t CO_ODF_TPDOcom(CO_ODF_arg_t *ODF_arg){
         /* values from 241...253 are not valid */
         if(*value >= 241 && *value <= 253)
             return CO_SDO_AB_INVALID_VALUE;  /* Invalid value for parameter (download only). */
-        TPDO->CANtxBuff->syncFlag = (*value <= 240) ? 1 : 0;
-        TPDO->syncCounter = 255;
+        CO_FLAG_SET_BITS(TPDO->commChanged, CO_TPDO_COMM_SYNC);
+        if(TPDO->sched != NULL) TPDO->sched->update = true;
 #else
         /* values from 0...253 are not valid */
         if(*value <= 253)
@@ -564,12 +1283,12 @@ static CO_SDO_abortCode_t CO_ODF_TPDOcom(CO_ODF_arg_t *ODF_arg){
         if(TPDO->valid)
             return CO_SDO_AB_INVALID_VALUE;  /* Invalid value for parameter (download only). */
 
-        TPDO->inhibitTimer = 0;
+        CO_FLAG_SET_BITS(TPDO->commChanged, CO_TPDO_COMM_INHIBIT);
+        if(TPDO->sched != NULL) TPDO->sched->update = true;
     }
     else if(ODF_arg->subIndex == 5){   /* Event_Timer */
-        uint16_t value = CO_getUint16(ODF_arg->data);
-
-        TPDO->eventTimer = ((uint32_t) value) * 1000;
+        CO_FLAG_SET_BITS(TPDO->commChanged, CO_TPDO_COMM_EVENT);
+        if(TPDO->sched != NULL) TPDO->sched->update = true;
     }
     else if(ODF_arg->subIndex == 6){   /* SYNC start value */
         uint8_t *value = (uint8_t*) ODF_arg->data;
@@ -613,6 +1332,8 @@ static CO_SDO_abortCode_t CO_ODF_RPDOmap(CO_ODF_arg_t *ODF_arg){
         return CO_SDO_AB_READONLY;  /* Attempt to write a read only object. */
     if(*RPDO->operatingState == CO_NMT_OPERATIONAL && (RPDO->restrictionFlags & 0x02))
         return CO_SDO_AB_DATA_DEV_STATE;   /* Data cannot be transferred or stored to the application because of the present device state. */
+    if(RPDO->sched != NULL && CO_FLAG_READ(RPDO->sched->stagedNew) && RPDO->sched->staged == RPDO)
+        return CO_SDO_AB_DATA_DEV_STATE;   /* Staged mapping is not swapped in yet. */
     if(RPDO->valid)
         return CO_SDO_AB_UNSUPPORTED_ACCESS;  /* Unsupported access to an object. */
 
@@ -620,7 +1341,11 @@ static CO_SDO_abortCode_t CO_ODF_RPDOmap(CO_ODF_arg_t *ODF_arg){
     if(ODF_arg->subIndex == 0){
         uint8_t *value = (uint8_t*) ODF_arg->data;
 
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+        if(*value > 8 && *value != CO_PDO_MPDO_SAM && *value != CO_PDO_MPDO_DAM)
+#else
         if(*value > 8)
+#endif
             return CO_SDO_AB_MAP_LEN;  /* Number and length of object to be mapped exceeds PDO length. */
 
         /* configure mapping */
@@ -631,8 +1356,9 @@ static CO_SDO_abortCode_t CO_ODF_RPDOmap(CO_ODF_arg_t *ODF_arg){
     else{
         uint32_t value = CO_getUint32(ODF_arg->data);
         uint8_t* pData;
-        uint8_t length = 0;
-        uint8_t dummy = 0;
+        uint8_t bitLength = 0;
+        uint8_t objectLength;
+        uint64_t COSmask = 0;
         uint8_t MBvar;
 
         if(RPDO->dataLength)
@@ -644,8 +1370,9 @@ static CO_SDO_abortCode_t CO_ODF_RPDOmap(CO_ODF_arg_t *ODF_arg){
                 value,
                 0,
                &pData,
-               &length,
-               &dummy,
+               &bitLength,
+               &objectLength,
+               &COSmask,
                &MBvar);
     }
 
@@ -679,6 +1406,8 @@ static CO_SDO_abortCode_t CO_ODF_TPDOmap(CO_ODF_arg_t *ODF_arg){
         return CO_SDO_AB_READONLY;  /* Attempt to write a read only object. */
     if(*TPDO->operatingState == CO_NMT_OPERATIONAL && (TPDO->restrictionFlags & 0x02))
         return CO_SDO_AB_DATA_DEV_STATE;   /* Data cannot be transferred or stored to the application because of the present device state. */
+    if(TPDO->sched != NULL && CO_FLAG_READ(TPDO->sched->stagedNew) && TPDO->sched->staged == TPDO)
+        return CO_SDO_AB_DATA_DEV_STATE;   /* Staged mapping is not swapped in yet. */
     if(TPDO->valid)
         return CO_SDO_AB_UNSUPPORTED_ACCESS;  /* Unsupported access to an object. */
 
@@ -686,7 +1415,11 @@ static CO_SDO_abortCode_t CO_ODF_TPDOmap(CO_ODF_arg_t *ODF_arg){
     if(ODF_arg->subIndex == 0){
         uint8_t *value = (uint8_t*) ODF_arg->data;
 
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+        if(*value > 8 && *value != CO_PDO_MPDO_SAM && *value != CO_PDO_MPDO_DAM)
+#else
         if(*value > 8)
+#endif
             return CO_SDO_AB_MAP_LEN;  /* Number and length of object to be mapped exceeds PDO length. */
 
         /* configure mapping */
@@ -697,8 +1430,9 @@ static CO_SDO_abortCode_t CO_ODF_TPDOmap(CO_ODF_arg_t *ODF_arg){
     else{
         uint32_t value = CO_getUint32(ODF_arg->data);
         uint8_t* pData;
-        uint8_t length = 0;
-        uint8_t dummy = 0;
+        uint8_t bitLength = 0;
+        uint8_t objectLength;
+        uint64_t COSmask = 0;
         uint8_t MBvar;
 
         if(TPDO->dataLength)
@@ -710,8 +1444,9 @@ static CO_SDO_abortCode_t CO_ODF_TPDOmap(CO_ODF_arg_t *ODF_arg){
                 value,
                 1,
                &pData,
-               &length,
-               &dummy,
+               &bitLength,
+               &objectLength,
+               &COSmask,
                &MBvar);
     }
 
@@ -724,6 +1459,7 @@ CO_ReturnError_t CO_RPDO_init(
         CO_RPDO_t              *RPDO,
         CO_EM_t                *em,
         CO_SDO_t               *SDO,
+        CO_RPDOplanPool_t      *planPool,
 #if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
         CO_SYNC_t              *SYNC,
 #endif
@@ -747,6 +1483,8 @@ CO_ReturnError_t CO_RPDO_init(
     /* Configure object variables */
     RPDO->em = em;
     RPDO->SDO = SDO;
+    RPDO->planPool = planPool;
+    RPDO->plan = &CO_RPDOplanNone;
 #if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
     RPDO->SYNC = SYNC;
 #endif
@@ -756,10 +1494,29 @@ CO_ReturnError_t CO_RPDO_init(
     RPDO->nodeId = nodeId;
     RPDO->defaultCOB_ID = defaultCOB_ID;
     RPDO->restrictionFlags = restrictionFlags;
+    RPDO->pendingWord = NULL;
+    RPDO->receivedWord = NULL;
+    RPDO->sched = NULL;
+    RPDO->heapPos = CO_RPDO_NOT_SCHEDULED;
+    RPDO->timedOut = false;
+    RPDO->rxMap = RPDO;
+    RPDO->rxSeq = 0;
+    RPDO->swapStep = 0;
 #if (CO_CONFIG_PDO) & CO_CONFIG_FLAG_CALLBACK_PRE
     RPDO->pFunctSignalPre = NULL;
     RPDO->functSignalObjectPre = NULL;
 #endif
+#if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLBACK_RX
+    RPDO->pFunctRx = NULL;
+    RPDO->functRxObject = NULL;
+#endif
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+    RPDO->dispatcher = NULL;
+    RPDO->dispatcherCount = 0;
+    RPDO->MPDOhead = 0;
+    RPDO->MPDOtail = 0;
+    RPDO->MPDOlost = 0;
+#endif
 
     /* Configure Object dictionary entry at index 0x1400+ and 0x1600+ */
     CO_OD_configure(SDO, idx_RPDOCommPar, CO_ODF_RPDOcom, (void*)RPDO, 0, 0);
@@ -795,17 +1552,49 @@ void CO_RPDO_initCallbackPre(
 #endif
 
 
+#if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLBACK_RX
 /******************************************************************************/
-CO_ReturnError_t CO_TPDO_init(
-        CO_TPDO_t              *TPDO,
-        CO_EM_t                *em,
-        CO_SDO_t               *SDO,
-#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
-        CO_SYNC_t              *SYNC,
-#endif
-        CO_NMT_internalState_t *operatingState,
-        uint8_t                 nodeId,
-        uint16_t                defaultCOB_ID,
+void CO_RPDO_initCallbackRx(
+        CO_RPDO_t              *RPDO,
+        void                   *object,
+        bool_t                (*pFunctRx)(void *object, const uint8_t *data,
+                                          const CO_PDOfield_t *field, uint8_t fieldCount))
+{
+    if(RPDO != NULL){
+        RPDO->functRxObject = object;
+        RPDO->pFunctRx = pFunctRx;
+    }
+}
+#endif
+
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+/******************************************************************************/
+void CO_RPDO_initMPDO(
+        CO_RPDO_t              *RPDO,
+        const uint64_t         *dispatcher,
+        uint8_t                 dispatcherCount)
+{
+    if(RPDO != NULL){
+        RPDO->dispatcher = dispatcher;
+        RPDO->dispatcherCount = (dispatcher != NULL) ? dispatcherCount : 0;
+    }
+}
+#endif
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_TPDO_init(
+        CO_TPDO_t              *TPDO,
+        CO_EM_t                *em,
+        CO_SDO_t               *SDO,
+        CO_TPDOplanPool_t      *planPool,
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
+        CO_SYNC_t              *SYNC,
+#endif
+        CO_NMT_internalState_t *operatingState,
+        uint8_t                 nodeId,
+        uint16_t                defaultCOB_ID,
         uint8_t                 restrictionFlags,
         const CO_TPDOCommPar_t *TPDOCommPar,
         const CO_TPDOMapPar_t  *TPDOMapPar,
@@ -823,6 +1612,8 @@ CO_ReturnError_t CO_TPDO_init(
     /* Configure object variables */
     TPDO->em = em;
     TPDO->SDO = SDO;
+    TPDO->planPool = planPool;
+    TPDO->plan = &CO_TPDOplanNone;
 #if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
     TPDO->SYNC = SYNC;
 #endif
@@ -840,13 +1631,22 @@ CO_ReturnError_t CO_TPDO_init(
     /* configure communication and mapping */
     TPDO->CANdevTx = CANdevTx;
     TPDO->CANdevTxIdx = CANdevTxIdx;
-    TPDO->inhibitTimer = 0;
-    TPDO->eventTimer = ((uint32_t) TPDOCommPar->eventTimer) * 1000;
+    TPDO->heapPos = CO_TPDO_NOT_SCHEDULED;
+    TPDO->sched = NULL;
+    TPDO->commChanged = 0;
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+    TPDO->MPDOdest = 0;
+    TPDO->scanner = NULL;
+    TPDO->scannerCount = 0;
+    TPDO->scanEntry = 0;
+    TPDO->scanSub = 0;
+#endif
     if(TPDOCommPar->transmissionType>=254) TPDO->sendRequest = 1;
 
     CO_TPDOconfigMap(TPDO, TPDOMapPar->numberOfMappedObjects);
 #if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
     TPDO->syncCounter = 255;
+    TPDO->syncDue = false;
     CO_TPDOconfigCom(TPDO, TPDOCommPar->COB_IDUsedByTPDO, ((TPDOCommPar->transmissionType<=240) ? 1 : 0));
 
     if((TPDOCommPar->transmissionType>240 &&
@@ -865,76 +1665,404 @@ CO_ReturnError_t CO_TPDO_init(
 
 
 /******************************************************************************/
-uint8_t CO_TPDOisCOS(CO_TPDO_t *TPDO){
+/* Value of bit fields of TPDO as PDO data integer, other bits are zero */
+static uint64_t CO_TPDObitValue(const CO_TPDOplan_t *plan){
+    uint64_t bits = 0;
+    int16_t i;
 
-    /* Prepare TPDO data automatically from Object Dictionary variables */
-    uint8_t* pPDOdataByte;
-    uint8_t** ppODdataByte;
+    for(i=0; i<plan->bitFieldCount; i++){
+        const CO_PDObitField_t *f = &plan->bitField[i];
+        bits |= (CO_PDObitRead(f) & CO_PDO_BIT_MASK(f)) << f->bitOffset;
+    }
+    return bits;
+}
 
-    pPDOdataByte = &TPDO->CANtxBuff->data[TPDO->dataLength];
-    ppODdataByte = &TPDO->mapPointer[TPDO->dataLength];
 
-    switch(TPDO->dataLength){
-        case 8: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x80)) return 1; // fallthrough
-        case 7: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x40)) return 1; // fallthrough
-        case 6: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x20)) return 1; // fallthrough
-        case 5: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x10)) return 1; // fallthrough
-        case 4: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x08)) return 1; // fallthrough
-        case 3: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x04)) return 1; // fallthrough
-        case 2: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x02)) return 1; // fallthrough
-        case 1: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x01)) return 1; // fallthrough
-    }
+/*
+ * Assemble PDO bytes, which belong to bit fields, from Object Dictionary.
+ */
+static void CO_TPDObitGather(const CO_TPDO_t *TPDO, uint8_t *data){
+    uint64_t bits = CO_TPDObitValue(TPDO->plan);
+    int16_t i;
 
-    return 0;
+    for(i=0; i<8; i++){
+        if(TPDO->bitBytes & (1<<i)) data[i] = (uint8_t)(bits >> (i * 8));
+    }
 }
 
+
 /******************************************************************************/
-int16_t CO_TPDOsend(CO_TPDO_t *TPDO){
+uint8_t CO_TPDOisCOS(CO_TPDO_t *TPDO){
+    const CO_TPDOplan_t *plan = TPDO->plan;
+    uint64_t current = 0;
     int16_t i;
-    uint8_t* pPDOdataByte;
-    uint8_t** ppODdataByte;
 
-#if (CO_CONFIG_PDO) & CO_CONFIG_TPDO_CALLS_EXTENSION
-    if(TPDO->SDO->ODExtensions){
-        /* for each mapped OD, check mapping to see if an OD extension is available, and call it if it is */
-        const uint32_t* pMap = &TPDO->TPDOMapPar->mappedObject1;
-        CO_SDO_t *pSDO = TPDO->SDO;
-
-        for(i=TPDO->TPDOMapPar->numberOfMappedObjects; i>0; i--){
-            uint32_t map = *(pMap++);
-            uint16_t index = (uint16_t)(map>>16);
-            uint8_t subIndex = (uint8_t)(map>>8);
-            uint16_t entryNo = CO_OD_find(pSDO, index);
-            if ( entryNo == 0xFFFF ) continue;
-            CO_OD_extension_t *ext = &pSDO->ODExtensions[entryNo];
-            if( ext->pODFunc == NULL) continue;
-            CO_ODF_arg_t ODF_arg;
-            memset((void*)&ODF_arg, 0, sizeof(CO_ODF_arg_t));
-            ODF_arg.reading = true;
-            ODF_arg.index = index;
-            ODF_arg.subIndex = subIndex;
-            ODF_arg.object = ext->object;
-            ODF_arg.attribute = CO_OD_getAttribute(pSDO, entryNo, subIndex);
-            ODF_arg.pFlags = CO_OD_getFlagsPointer(pSDO, entryNo, subIndex);
-            ODF_arg.data = CO_OD_getDataPointer(pSDO, entryNo, subIndex); //https://github.com/CANopenNode/CANopenNode/issues/100
-            ODF_arg.dataLength = CO_OD_getLength(pSDO, entryNo, subIndex);
-            ext->pODFunc(&ODF_arg);
+    /* no mapped variable detects COS */
+    if(TPDO->COSmask == 0) return 0;
+
+    /* Short runs: compare masked bytes one by one, as they are copied */
+    if(plan->mapPointerCount > 0){
+        uint8_t *const *mapPointer = &plan->mapPointer[0];
+        const uint8_t *sent = &TPDO->CANtxBuff->data[0];
+        const uint64_t mask = TPDO->COSmask;
+
+        switch(plan->mapPointerCount){
+            case 8: if((*mapPointer[7] ^ sent[7]) & (uint8_t)(mask >> 56)) return 1; // fallthrough
+            case 7: if((*mapPointer[6] ^ sent[6]) & (uint8_t)(mask >> 48)) return 1; // fallthrough
+            case 6: if((*mapPointer[5] ^ sent[5]) & (uint8_t)(mask >> 40)) return 1; // fallthrough
+            case 5: if((*mapPointer[4] ^ sent[4]) & (uint8_t)(mask >> 32)) return 1; // fallthrough
+            case 4: if((*mapPointer[3] ^ sent[3]) & (uint8_t)(mask >> 24)) return 1; // fallthrough
+            case 3: if((*mapPointer[2] ^ sent[2]) & (uint8_t)(mask >> 16)) return 1; // fallthrough
+            case 2: if((*mapPointer[1] ^ sent[1]) & (uint8_t)(mask >> 8)) return 1; // fallthrough
+            case 1: if((*mapPointer[0] ^ sent[0]) & (uint8_t)mask) return 1; // fallthrough
+            default: break;
         }
+        return 0;
     }
+
+    /* Assemble current Object Dictionary values in a register, without
+     * writing them to memory, and compare them with the last sent data in
+     * one masked 64-bit operation. */
+    {
+        const CO_PDOcopyRun_t *run = &plan->copyRun[0];
+
+        for(i=plan->copyRunCount; i>0; i--, run++){
+            current |= CO_PDOrunBits(run->ODdata, run->length) << (run->PDOoffset * 8);
+        }
+    }
+    if(TPDO->bitBytes != 0) current |= CO_TPDObitValue(plan);
+
+    return ((current ^ CO_PDOgetBits(TPDO->CANtxBuff->data)) & TPDO->COSmask) ? 1 : 0;
+}
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+/*
+ * Write one object into CAN transmit buffer of MPDO.
+ */
+static void CO_TPDOmpdoFrame(
+        CO_TPDO_t              *TPDO,
+        uint8_t                 address,
+        uint16_t                index,
+        uint8_t                 subIndex,
+        const uint8_t          *ODdata,
+        uint8_t                 length,
+        bool_t                  MBvar)
+{
+    uint8_t *data = TPDO->CANtxBuff->data;
+
+    data[0] = address;
+    data[1] = (uint8_t)index;
+    data[2] = (uint8_t)(index >> 8);
+    data[3] = subIndex;
+    memset(&data[4], 0, 4);
+    CO_PDOmpdoCopy(&data[4], ODdata, length, MBvar);
+}
+
+
+/*
+ * Write next object of MPDO into CAN transmit buffer of TPDO.
+ *
+ * SAM MPDO sends objects from scanner one after another, objects, which can
+ * not be mapped, are skipped. DAM MPDO always sends the first mapped object.
+ *
+ * @return false, if there is no object to send.
+ */
+static bool_t CO_TPDOmpdoGather(CO_TPDO_t *TPDO){
+    uint8_t entries = 0;
+
+    if(TPDO->MPDO == CO_PDO_MPDO_DAM){
+        if(TPDO->MPDOdata == NULL) return false;
+        CO_TPDOmpdoFrame(TPDO, 0x80 | TPDO->MPDOdest, TPDO->MPDOindex, TPDO->MPDOsubIndex,
+                         TPDO->MPDOdata, TPDO->MPDOlength, TPDO->MPDOmultibyte);
+        return true;
+    }
+
+    /* visit each scanner entry at most once */
+    while(entries < TPDO->scannerCount){
+        uint32_t e;
+        uint16_t index;
+        uint16_t sub;
+        uint8_t *ODdata = NULL;
+        uint8_t length;
+        bool_t MBvar;
+
+        if(TPDO->scanEntry >= TPDO->scannerCount){
+            TPDO->scanEntry = 0;
+            TPDO->scanSub = 0;
+        }
+        e = TPDO->scanner[TPDO->scanEntry];
+        index = (uint16_t)(e >> 8);
+        sub = (uint16_t)((uint8_t)e) + TPDO->scanSub;
+
+        /* index 0 is unused entry */
+        if(index != 0 && sub <= 0xFF)
+            ODdata = CO_PDOmpdoFind(TPDO->SDO, index, (uint8_t)sub, 1, &length, &MBvar);
+
+        /* advance cursor */
+        if(index == 0 || sub >= 0xFF ||
+           ++TPDO->scanSub >= CO_PDO_MPDO_BLOCK((uint8_t)(e >> 24)))
+        {
+            TPDO->scanSub = 0;
+            TPDO->scanEntry++;
+            entries++;
+        }
+
+        if(ODdata != NULL){
+            CO_TPDOmpdoFrame(TPDO, TPDO->nodeId & 0x7F, index, (uint8_t)sub, ODdata, length, MBvar);
+            return true;
+        }
+    }
+
+    return false;
+}
 #endif
-    i = TPDO->dataLength;
-    pPDOdataByte = &TPDO->CANtxBuff->data[0];
-    ppODdataByte = &TPDO->mapPointer[0];
 
-    /* Copy data from Object dictionary. */
-    for(; i>0; i--) {
-        *(pPDOdataByte++) = **(ppODdataByte++);
+
+/*
+ * Copy mapped data from Object dictionary into CAN transmit buffer of TPDO.
+ *
+ * @return false, if there is nothing to send (MPDO without object).
+ */
+static bool_t CO_TPDOgather(CO_TPDO_t *TPDO){
+    const CO_TPDOplan_t *plan = TPDO->plan;
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+    if(TPDO->MPDO != 0){
+        TPDO->sendRequest = 0;
+        return CO_TPDOmpdoGather(TPDO);
     }
+#endif
+#if (CO_CONFIG_PDO) & CO_CONFIG_TPDO_CALLS_EXTENSION
+    /* call OD extensions of mapped objects, resolved by CO_TPDOconfigMap() */
+    CO_PDOcallExt(TPDO->plan->ext, TPDO->plan->extCount, true);
+#endif
+
+    /* Copy data from Object dictionary. */
+    CO_PDOgather(TPDO->CANtxBuff->data, plan->copyRun, plan->copyRunCount, plan->mapPointer, plan->mapPointerCount);
+    if(TPDO->bitBytes != 0) CO_TPDObitGather(TPDO, TPDO->CANtxBuff->data);
 
     TPDO->sendRequest = 0;
+    return true;
+}
+
+/******************************************************************************/
+int16_t CO_TPDOsend(CO_TPDO_t *TPDO){
+    if(!CO_TPDOgather(TPDO))
+        return CO_ERROR_TX_UNCONFIGURED;
+
+    return CO_CANsend(TPDO->CANdevTx, TPDO->CANtxBuff);
+}
+
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+/******************************************************************************/
+void CO_TPDO_initMPDO(
+        CO_TPDO_t              *TPDO,
+        const uint32_t         *scanner,
+        uint8_t                 scannerCount,
+        uint8_t                 destNodeId)
+{
+    if(TPDO != NULL){
+        TPDO->scanner = scanner;
+        TPDO->scannerCount = (scanner != NULL) ? scannerCount : 0;
+        TPDO->scanEntry = 0;
+        TPDO->scanSub = 0;
+        TPDO->MPDOdest = destNodeId & 0x7F;
+    }
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_TPDO_sendMPDO(CO_TPDO_t *TPDO, uint16_t index, uint8_t subIndex){
+    uint8_t *ODdata;
+    uint8_t length;
+    bool_t MBvar;
+    uint8_t i;
+
+    if(TPDO == NULL || TPDO->MPDO != CO_PDO_MPDO_SAM || index == 0)
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    if(!TPDO->valid || *TPDO->operatingState != CO_NMT_OPERATIONAL)
+        return CO_ERROR_WRONG_NMT_STATE;
+
+    /* object must be in scanner */
+    for(i=0; i<TPDO->scannerCount; i++){
+        uint32_t e = TPDO->scanner[i];
+        uint8_t first = (uint8_t)e;
+
+        if((uint16_t)(e >> 8) == index && subIndex >= first &&
+           (uint16_t)(subIndex - first) < CO_PDO_MPDO_BLOCK((uint8_t)(e >> 24)))
+        {
+            break;
+        }
+    }
+    if(i == TPDO->scannerCount)
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+
+    ODdata = CO_PDOmpdoFind(TPDO->SDO, index, subIndex, 1, &length, &MBvar);
+    if(ODdata == NULL)
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+
+    CO_TPDOmpdoFrame(TPDO, TPDO->nodeId & 0x7F, index, subIndex, ODdata, length, MBvar);
 
     return CO_CANsend(TPDO->CANdevTx, TPDO->CANtxBuff);
 }
+#endif
+
+/*
+ * Copy received data of RPDO into data, without tearing.
+ *
+ * Receive function is the only writer of CANrxData[bufNo]. Copy is repeated
+ * only, if receive function completed writing in the meantime.
+ *
+ * @return false, if receive function is just writing. It will set CANrxNew
+ * again, when finished, so message is processed in next call.
+ */
+static bool_t CO_RPDOsnapshot(CO_RPDO_t *RPDO, uint8_t bufNo, uint8_t data[8]){
+    uint32_t seq;
+
+    do{
+        seq = CO_SEQ_READ_BEGIN(RPDO->CANrxSeq[bufNo]);
+        if(seq & 1U) return false;
+        memcpy(data, RPDO->CANrxData[bufNo], 8);
+    }while(CO_SEQ_READ_RETRY(RPDO->CANrxSeq[bufNo], seq));
+
+    return true;
+}
+
+
+/*
+ * Swap staged mapping into RPDO. Called from the same thread as
+ * CO_RPDO_process(), so processing never sees half of the mapping.
+ *
+ * Receive function is switched to the shadow, which is complete, by one
+ * pointer. When it has left the RPDO, the RPDO takes over the mapping for
+ * receive function and it is switched back. Receive function keeps running,
+ * one step waits for the next call only, if it was just inside.
+ *
+ * @return true, when mapping is swapped in and staging slot is free.
+ */
+static bool_t CO_RPDOmapSwap(CO_RPDO_t *RPDO, const CO_RPDOstaged_t *staged){
+    const CO_RPDO_t *src = &staged->shadow;
+
+    if(RPDO->swapStep == 0){
+        CO_LOCK_OD();
+        memcpy((void*)RPDO->RPDOMapPar, &staged->mapPar, sizeof(staged->mapPar));
+        CO_UNLOCK_OD();
+
+        /* Plan, taken by CO_RPDOsched_stageMap(), is empty, like the one it
+         * replaces. Receive function sees it before the shadow. */
+        if(staged->take != NULL) RPDO->plan = staged->take;
+        RPDO->rxSeqSwap = CO_RCU_REPLACE(RPDO->rxMap, src, RPDO->rxSeq);
+        memcpy(RPDO->plan->copyRun, src->plan->copyRun, sizeof(RPDO->plan->copyRun));
+        RPDO->plan->copyRunCount = src->plan->copyRunCount;
+        memcpy(RPDO->plan->mapPointer, src->plan->mapPointer, sizeof(RPDO->plan->mapPointer));
+        RPDO->plan->mapPointerCount = src->plan->mapPointerCount;
+        memcpy(RPDO->plan->bitField, src->plan->bitField, sizeof(RPDO->plan->bitField));
+        RPDO->plan->bitFieldCount = src->plan->bitFieldCount;
+#if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLS_EXTENSION
+        memcpy(RPDO->plan->ext, src->plan->ext, sizeof(RPDO->plan->ext));
+        RPDO->plan->extCount = src->plan->extCount;
+#endif
+        RPDO->swapStep = 1;
+    }
+
+    if(RPDO->swapStep == 1 && CO_RCU_QUIET(RPDO->rxSeq, RPDO->rxSeqSwap)){
+        /* receive function uses the shadow now */
+#if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLBACK_RX
+        memcpy(RPDO->plan->field, src->plan->field, sizeof(RPDO->plan->field));
+        RPDO->plan->fieldCount = src->plan->fieldCount;
+#endif
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+        RPDO->MPDO = src->MPDO;
+#endif
+        RPDO->dataLength = src->dataLength;
+        RPDO->rxSeqSwap = CO_RCU_REPLACE(RPDO->rxMap, RPDO, RPDO->rxSeq);
+        RPDO->swapStep = 2;
+    }
+
+    if(RPDO->swapStep == 2 && CO_RCU_QUIET(RPDO->rxSeq, RPDO->rxSeqSwap)){
+        RPDO->swapStep = 0;
+        return true;
+    }
+
+    return false;
+}
+
+
+/*
+ * Swap staged mapping into TPDO, see CO_RPDOmapSwap(). TPDO is used only
+ * from the thread, which calls this function, so mapping is copied at once.
+ */
+static void CO_TPDOmapApply(CO_TPDO_t *TPDO, const CO_TPDOstaged_t *staged){
+    const CO_TPDO_t *src = &staged->shadow;
+
+    CO_LOCK_OD();
+    memcpy((void*)TPDO->TPDOMapPar, &staged->mapPar, sizeof(staged->mapPar));
+    CO_UNLOCK_OD();
+
+    if(staged->take != NULL) TPDO->plan = staged->take;
+    memcpy(TPDO->plan->copyRun, src->plan->copyRun, sizeof(TPDO->plan->copyRun));
+    TPDO->plan->copyRunCount = src->plan->copyRunCount;
+    memcpy(TPDO->plan->mapPointer, src->plan->mapPointer, sizeof(TPDO->plan->mapPointer));
+    TPDO->plan->mapPointerCount = src->plan->mapPointerCount;
+    memcpy(TPDO->plan->bitField, src->plan->bitField, sizeof(TPDO->plan->bitField));
+    TPDO->plan->bitFieldCount = src->plan->bitFieldCount;
+    TPDO->bitBytes = src->bitBytes;
+#if (CO_CONFIG_PDO) & CO_CONFIG_TPDO_CALLS_EXTENSION
+    memcpy(TPDO->plan->ext, src->plan->ext, sizeof(TPDO->plan->ext));
+    TPDO->plan->extCount = src->plan->extCount;
+#endif
+    TPDO->sendIfCOSFlags = src->sendIfCOSFlags;
+    TPDO->COSmask = src->COSmask;
+    TPDO->dataLength = src->dataLength;
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+    TPDO->MPDO = src->MPDO;
+    TPDO->MPDOdata = src->MPDOdata;
+    TPDO->MPDOindex = src->MPDOindex;
+    TPDO->MPDOsubIndex = src->MPDOsubIndex;
+    TPDO->MPDOlength = src->MPDOlength;
+    TPDO->MPDOmultibyte = src->MPDOmultibyte;
+#endif
+
+    CO_LOCK_CAN_SEND();
+    TPDO->CANtxBuff->DLC = src->dataLength;
+    CO_UNLOCK_CAN_SEND();
+}
+
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+/*
+ * Write MPDO objects, queued by CO_RPDOmpdoReceive(), into Object Dictionary
+ * and call their extensions. Objects, which can not be mapped, are skipped.
+ */
+static void CO_RPDOmpdoProcess(CO_RPDO_t *RPDO){
+    uint8_t tail = RPDO->MPDOtail;
+    uint8_t head = CO_FIFO_LOAD(RPDO->MPDOhead);
+
+    while(tail != head){
+        const CO_RPDOmpdoObj_t *obj = &RPDO->plan->MPDOqueue[tail];
+        uint8_t *ODdata;
+        uint8_t length;
+        bool_t MBvar;
+
+        ODdata = CO_PDOmpdoFind(RPDO->SDO, obj->index, obj->subIndex, 0, &length, &MBvar);
+        if(ODdata != NULL){
+            CO_PDOmpdoCopy(ODdata, obj->data, length, MBvar);
+#if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLS_EXTENSION
+            {
+                uint32_t map = ((uint32_t)obj->index << 16) | ((uint32_t)obj->subIndex << 8) | (length * 8U);
+                CO_PDOext_t ext;
+
+                CO_PDOcallExt(&ext, CO_PDOconfigExt(RPDO->SDO, &map, 1, &ext), false);
+            }
+#endif
+        }
+        tail = (tail + 1U < CO_CONFIG_PDO_MPDO_QUEUE) ? tail + 1U : 0U;
+        CO_FIFO_STORE(RPDO->MPDOtail, tail);
+    }
+}
+#endif
+
 
 /******************************************************************************/
 void CO_RPDO_process(CO_RPDO_t *RPDO, bool_t syncWas){
@@ -950,8 +2078,18 @@ void CO_RPDO_process(CO_RPDO_t *RPDO, bool_t syncWas){
         CO_FLAG_CLEAR(RPDO->CANrxNew[0]);
 #if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
         CO_FLAG_CLEAR(RPDO->CANrxNew[1]);
+#endif
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+        CO_FIFO_STORE(RPDO->MPDOtail, CO_FIFO_LOAD(RPDO->MPDOhead));
 #endif
     }
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+    else if(RPDO->MPDO != 0)
+    {
+        /* each MPDO carries one object, write them as received */
+        CO_RPDOmpdoProcess(RPDO);
+    }
+#endif
     else if(process_rpdo)
     {
 #if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLS_EXTENSION
@@ -967,52 +2105,34 @@ void CO_RPDO_process(CO_RPDO_t *RPDO, bool_t syncWas){
         }
 #endif
 
-        while(CO_FLAG_READ(RPDO->CANrxNew[bufNo])){
-            int16_t i;
-            uint8_t* pPDOdataByte;
-            uint8_t** ppODdataByte;
+        /* Take consistent snapshot of received data, then copy it to Object
+         * dictionary. Message, which arrives later, sets CANrxNew again. */
+        if(CO_FLAG_READ(RPDO->CANrxNew[bufNo])){
+            uint8_t data[8];
 
-            i = RPDO->dataLength;
-            pPDOdataByte = &RPDO->CANrxData[bufNo][0];
-            ppODdataByte = &RPDO->mapPointer[0];
-
-            /* Copy data to Object dictionary. If between the copy operation CANrxNew
-             * is set to true by receive thread, then copy the latest data again. */
             CO_FLAG_CLEAR(RPDO->CANrxNew[bufNo]);
-            for(; i>0; i--) {
-                **(ppODdataByte++) = *(pPDOdataByte++);
-            }
+            if(CO_RPDOsnapshot(RPDO, bufNo, data)){
+                int16_t i;
+                const CO_RPDOplan_t *plan = RPDO->plan;
+
+                CO_PDOscatter(data, plan->copyRun, plan->copyRunCount, plan->mapPointer, plan->mapPointerCount);
+                if(plan->bitFieldCount > 0){
+                    uint64_t bits = CO_PDOgetBits(data);
+
+                    for(i=0; i<plan->bitFieldCount; i++){
+                        const CO_PDObitField_t *f = &plan->bitField[i];
+                        CO_PDObitWrite(f, (bits >> f->bitOffset) & CO_PDO_BIT_MASK(f));
+                    }
+                }
 #if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLS_EXTENSION
-            update = true;
+                update = true;
 #endif
+            }
         }
 #if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLS_EXTENSION
-        if(update && RPDO->SDO->ODExtensions){
-            int16_t i;
-            /* for each mapped OD, check mapping to see if an OD extension is available, and call it if it is */
-            const uint32_t* pMap = &RPDO->RPDOMapPar->mappedObject1;
-            CO_SDO_t *pSDO = RPDO->SDO;
-
-            for(i=RPDO->RPDOMapPar->numberOfMappedObjects; i>0; i--){
-                uint32_t map = *(pMap++);
-                uint16_t index = (uint16_t)(map>>16);
-                uint8_t subIndex = (uint8_t)(map>>8);
-                uint16_t entryNo = CO_OD_find(pSDO, index);
-                if ( entryNo == 0xFFFF ) continue;
-                CO_OD_extension_t *ext = &pSDO->ODExtensions[entryNo];
-                if( ext->pODFunc == NULL) continue;
-                CO_ODF_arg_t ODF_arg;
-                memset((void*)&ODF_arg, 0, sizeof(CO_ODF_arg_t));
-                ODF_arg.reading = false;
-                ODF_arg.index = index;
-                ODF_arg.subIndex = subIndex;
-                ODF_arg.object = ext->object;
-                ODF_arg.attribute = CO_OD_getAttribute(pSDO, entryNo, subIndex);
-                ODF_arg.pFlags = CO_OD_getFlagsPointer(pSDO, entryNo, subIndex);
-                ODF_arg.data = CO_OD_getDataPointer(pSDO, entryNo, subIndex); //https://github.com/CANopenNode/CANopenNode/issues/100
-                ODF_arg.dataLength = CO_OD_getLength(pSDO, entryNo, subIndex);
-                ext->pODFunc(&ODF_arg);
-            }
+        if(update){
+            /* call OD extensions of mapped objects, resolved by CO_RPDOconfigMap() */
+            CO_PDOcallExt(RPDO->plan->ext, RPDO->plan->extCount, false);
         }
 #endif
     }
@@ -1020,67 +2140,584 @@ void CO_RPDO_process(CO_RPDO_t *RPDO, bool_t syncWas){
 
 
 /******************************************************************************/
-void CO_TPDO_process(
-        CO_TPDO_t              *TPDO,
+void CO_RPDOsched_init(
+        CO_RPDOsched_t         *sched,
+        CO_RPDO_t             **RPDO,
+        uint32_t               *pending,
+        uint32_t               *received,
+        uint16_t               *heap,
+        uint16_t                count)
+{
+    uint16_t i;
+
+    sched->RPDO = RPDO;
+    sched->pending = pending;
+    sched->received = received;
+    sched->heap = heap;
+    sched->count = count;
+    sched->heapCount = 0;
+    sched->timeoutCount = 0;
+    sched->update = false;
+    sched->operationalPrev = false;
+    CO_FLAG_CLEAR(sched->stagedNew);
+    /* now_us keeps running through communication reset */
+
+    for(i=0; i<CO_RPDO_PENDING_WORDS(count); i++){
+        pending[i] = 0;
+        received[i] = 0;
+    }
+    for(i=0; i<count; i++){
+        RPDO[i]->pendingBit = 1UL << (i % 32U);
+        RPDO[i]->pendingWord = &pending[i / 32U];
+        RPDO[i]->receivedWord = &received[i / 32U];
+        RPDO[i]->sched = sched;
+        RPDO[i]->heapPos = CO_RPDO_NOT_SCHEDULED;
+        RPDO[i]->timedOut = false;
+    }
+}
+
+
+/*
+ * Binary min-heap of RPDO reception deadlines, see CO_TPDOheapUp().
+ */
+static void CO_RPDOheapSet(CO_RPDOsched_t *sched, uint16_t pos, uint16_t idx){
+    sched->heap[pos] = idx;
+    sched->RPDO[idx]->heapPos = pos;
+}
+
+static void CO_RPDOheapUp(CO_RPDOsched_t *sched, uint16_t pos){
+    uint16_t idx = sched->heap[pos];
+    uint32_t deadline = sched->RPDO[idx]->deadline;
+
+    while(pos > 0){
+        uint16_t parent = (pos - 1) / 2;
+        if(!CO_TPDO_BEFORE(deadline, sched->RPDO[sched->heap[parent]]->deadline)) break;
+        CO_RPDOheapSet(sched, pos, sched->heap[parent]);
+        pos = parent;
+    }
+    CO_RPDOheapSet(sched, pos, idx);
+}
+
+static void CO_RPDOheapDown(CO_RPDOsched_t *sched, uint16_t pos){
+    uint16_t idx = sched->heap[pos];
+    uint32_t deadline = sched->RPDO[idx]->deadline;
+
+    for(;;){
+        uint16_t child = pos * 2 + 1;
+        if(child >= sched->heapCount) break;
+        if((child + 1) < sched->heapCount &&
+           CO_TPDO_BEFORE(sched->RPDO[sched->heap[child + 1]]->deadline,
+                          sched->RPDO[sched->heap[child]]->deadline))
+        {
+            child++;
+        }
+        if(!CO_TPDO_BEFORE(sched->RPDO[sched->heap[child]]->deadline, deadline)) break;
+        CO_RPDOheapSet(sched, pos, sched->heap[child]);
+        pos = child;
+    }
+    CO_RPDOheapSet(sched, pos, idx);
+}
+
+static void CO_RPDOheapRemove(CO_RPDOsched_t *sched, CO_RPDO_t *RPDO){
+    uint16_t pos = RPDO->heapPos;
+
+    RPDO->heapPos = CO_RPDO_NOT_SCHEDULED;
+    sched->heapCount--;
+    if(pos < sched->heapCount){
+        /* move last element into the gap, then restore heap order */
+        uint16_t idx = sched->heap[sched->heapCount];
+
+        CO_RPDOheapSet(sched, pos, idx);
+        CO_RPDOheapUp(sched, pos);
+        CO_RPDOheapDown(sched, sched->RPDO[idx]->heapPos);
+    }
+}
+
+
+/*
+ * Clear timeout of RPDO and reset emergency, when no RPDO is timed out.
+ */
+static void CO_RPDOtimeoutClear(CO_RPDOsched_t *sched, CO_RPDO_t *RPDO, uint16_t idx){
+    if(RPDO->timedOut){
+        RPDO->timedOut = false;
+        if(--sched->timeoutCount == 0)
+            CO_errorReset(RPDO->em, CO_EM_RPDO_TIME_OUT, idx);
+    }
+}
+
+
+/*
+ * Monitor reception deadlines of RPDOs.
+ */
+static void CO_RPDOmonitor(
+        CO_RPDOsched_t         *sched,
+        uint32_t                timeDifference_us,
+        uint32_t               *timerNext_us)
+{
+    uint16_t i;
+    uint32_t now;
+    bool_t operational;
+
+    if(sched->count == 0) return;
+
+    sched->now_us += timeDifference_us;
+    now = sched->now_us;
+    operational = *sched->RPDO[0]->operatingState == CO_NMT_OPERATIONAL;
+
+    /* Stop monitoring of RPDOs, which are not valid or have no event timer.
+     * Outside NMT operational all monitoring stops. Wait until SDO server
+     * finished writing. */
+    if(sched->update || operational != sched->operationalPrev){
+        CO_LOCK_OD();
+        sched->update = false;
+        sched->operationalPrev = operational;
+        for(i=0; i<sched->count; i++){
+            CO_RPDO_t *RPDO = sched->RPDO[i];
+
+            if(operational && RPDO->valid && RPDO->RPDOCommPar->eventTimer != 0)
+                continue;
+            if(RPDO->heapPos != CO_RPDO_NOT_SCHEDULED)
+                CO_RPDOheapRemove(sched, RPDO);
+            CO_RPDOtimeoutClear(sched, RPDO, i);
+        }
+        CO_UNLOCK_OD();
+    }
+    if(!operational) return;
+
+    /* Received RPDOs, restart their deadline */
+    for(i=0; i<CO_RPDO_PENDING_WORDS(sched->count); i++){
+        uint32_t bits;
+
+        if(sched->received[i] == 0) continue;
+        bits = CO_FLAG_TAKE_BITS(sched->received[i]);
+
+        while(bits != 0){
+            uint16_t idx = i * 32U + (uint16_t)__builtin_ctz(bits);
+            CO_RPDO_t *RPDO = sched->RPDO[idx];
+            uint16_t eventTimer = RPDO->RPDOCommPar->eventTimer;
+
+            bits &= bits - 1U;
+            CO_RPDOtimeoutClear(sched, RPDO, idx);
+            if(!RPDO->valid || eventTimer == 0)
+                continue;
+
+            /* deadline only moves later */
+            RPDO->deadline = now + ((uint32_t) eventTimer) * 1000;
+            if(RPDO->heapPos == CO_RPDO_NOT_SCHEDULED){
+                sched->heapCount++;
+                CO_RPDOheapSet(sched, sched->heapCount - 1, idx);
+                CO_RPDOheapUp(sched, RPDO->heapPos);
+            }
+            else{
+                CO_RPDOheapDown(sched, RPDO->heapPos);
+            }
+        }
+    }
+
+    /* RPDOs, which missed their deadline */
+    while(sched->heapCount > 0){
+        uint16_t idx = sched->heap[0];
+        CO_RPDO_t *RPDO = sched->RPDO[idx];
+
+        if(CO_TPDO_BEFORE(now, RPDO->deadline)) break;
+        CO_RPDOheapRemove(sched, RPDO);
+        RPDO->timedOut = true;
+        sched->timeoutCount++;
+        CO_errorReport(RPDO->em, CO_EM_RPDO_TIME_OUT, CO_EMC_RPDO_TIMEOUT, idx);
+    }
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_FLAG_TIMERNEXT
+    if(timerNext_us != NULL && sched->heapCount > 0){
+        uint32_t diff = sched->RPDO[sched->heap[0]]->deadline - now;
+
+        if(*timerNext_us > diff){
+            *timerNext_us = diff;
+        }
+    }
+#endif
+}
+
+
+/******************************************************************************/
+void CO_RPDOsched_process(
+        CO_RPDOsched_t         *sched,
         bool_t                  syncWas,
         uint32_t                timeDifference_us,
         uint32_t               *timerNext_us)
 {
-    /* update timers */
-    TPDO->inhibitTimer = (TPDO->inhibitTimer > timeDifference_us) ? (TPDO->inhibitTimer - timeDifference_us) : 0;
-    TPDO->eventTimer = (TPDO->eventTimer > timeDifference_us) ? (TPDO->eventTimer - timeDifference_us) : 0;
+    uint16_t w;
+
+    for(w=0; w<CO_RPDO_PENDING_WORDS(sched->count); w++){
+        uint32_t bits;
+
+        if(sched->pending[w] == 0) continue;
+        bits = CO_FLAG_TAKE_BITS(sched->pending[w]);
+
+        while(bits != 0){
+            uint32_t bit = bits & (~bits + 1U);
+            CO_RPDO_t *RPDO = sched->RPDO[w * 32U + (uint16_t)__builtin_ctz(bits)];
+
+            bits ^= bit;
+            CO_RPDO_process(RPDO, syncWas);
+
+            /* synchronous RPDO waits for SYNC, keep it marked */
+            if(CO_FLAG_READ(RPDO->CANrxNew[0])
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
+               || CO_FLAG_READ(RPDO->CANrxNew[1])
+#endif
+            ){
+                CO_FLAG_SET_BITS(sched->pending[w], bit);
+            }
+        }
+    }
+
+    CO_RPDOmonitor(sched, timeDifference_us, timerNext_us);
+
+    /* Swap in staged mapping. Synchronous RPDO waits for SYNC, messages
+     * received with old mapping were just processed. Staging slot is free
+     * again for CO_RPDOsched_stageMap(), when flag is cleared. */
+    if(CO_FLAG_READ(sched->stagedNew)){
+        CO_RPDO_t *RPDO = sched->staged;
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
+        if(RPDO->swapStep == 0 && RPDO->synchronous && !syncWas)
+            return;
+#endif
+        if(CO_RPDOmapSwap(RPDO, &sched->staging))
+            CO_FLAG_CLEAR(sched->stagedNew);
+    }
+}
+
+
+/******************************************************************************/
+CO_SDO_abortCode_t CO_RPDOsched_stageMap(
+        CO_RPDOsched_t         *sched,
+        uint16_t                index,
+        const uint32_t         *map,
+        uint8_t                 noOfMappedObjects)
+{
+    CO_RPDO_t *RPDO;
+    CO_RPDOstaged_t *staged;
+    uint32_t *pMap;
+    uint32_t ret;
+    uint8_t i;
+    uint8_t n;
+
+    if(sched == NULL || index >= sched->count || map == NULL)
+        return CO_SDO_AB_INVALID_VALUE;
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+    if(noOfMappedObjects == 0 ||
+       (noOfMappedObjects > 8 && noOfMappedObjects != CO_PDO_MPDO_SAM && noOfMappedObjects != CO_PDO_MPDO_DAM))
+#else
+    if(noOfMappedObjects == 0 || noOfMappedObjects > 8)
+#endif
+        return CO_SDO_AB_MAP_LEN;
+    if(CO_FLAG_READ(sched->stagedNew))
+        return CO_SDO_AB_DATA_DEV_STATE;
+    RPDO = sched->RPDO[index];
+    staged = &sched->staging;
+
+    /* new mapping parameters */
+    staged->mapPar.numberOfMappedObjects = noOfMappedObjects;
+    pMap = &staged->mapPar.mappedObject1;
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+    /* MPDO uses at most the first mapping entry */
+    n = (noOfMappedObjects > 8) ? 1 : noOfMappedObjects;
+#else
+    n = noOfMappedObjects;
+#endif
+    for(i=0; i<8; i++){
+        pMap[i] = (i < n) ? map[i] : 0;
+    }
+
+    /* build copy plan in shadow object */
+    memcpy(&staged->shadow, RPDO, sizeof(staged->shadow));
+    staged->shadow.RPDOMapPar = &staged->mapPar;
+    staged->shadow.plan = &staged->plan;
+    ret = CO_RPDOconfigMap(&staged->shadow, noOfMappedObjects);
+    if(ret != 0)
+        return (CO_SDO_abortCode_t) ret;
+
+    /* RPDO, which was not mapped yet, gets its plan, when mapping is swapped */
+    staged->take = NULL;
+    if(RPDO->plan == &CO_RPDOplanNone){
+        staged->take = CO_RPDOplanTake(RPDO->planPool);
+        if(staged->take == NULL)
+            return CO_SDO_AB_OUT_OF_MEM;
+    }
+
+    sched->staged = RPDO;
+    CO_FLAG_SET(sched->stagedNew);
+
+    return CO_SDO_AB_NONE;
+}
+
+
+/*
+ * TPDO scheduler heap.
+ *
+ * Binary min-heap of indexes into sched->TPDO, ordered by CO_TPDO_t::deadline.
+ * Each TPDO knows its heap position, so it can be moved or removed in
+ * O(log n).
+ */
+static void CO_TPDOheapSet(CO_TPDOsched_t *sched, uint16_t pos, uint16_t idx){
+    sched->heap[pos] = idx;
+    sched->TPDO[idx]->heapPos = pos;
+}
+
+static void CO_TPDOheapUp(CO_TPDOsched_t *sched, uint16_t pos){
+    uint16_t idx = sched->heap[pos];
+    uint32_t deadline = sched->TPDO[idx]->deadline;
+
+    while(pos > 0){
+        uint16_t parent = (pos - 1) / 2;
+        if(!CO_TPDO_BEFORE(deadline, sched->TPDO[sched->heap[parent]]->deadline)) break;
+        CO_TPDOheapSet(sched, pos, sched->heap[parent]);
+        pos = parent;
+    }
+    CO_TPDOheapSet(sched, pos, idx);
+}
+
+static void CO_TPDOheapDown(CO_TPDOsched_t *sched, uint16_t pos){
+    uint16_t idx = sched->heap[pos];
+    uint32_t deadline = sched->TPDO[idx]->deadline;
+
+    for(;;){
+        uint16_t child = pos * 2 + 1;
+        if(child >= sched->heapCount) break;
+        if((child + 1) < sched->heapCount &&
+           CO_TPDO_BEFORE(sched->TPDO[sched->heap[child + 1]]->deadline,
+                          sched->TPDO[sched->heap[child]]->deadline))
+        {
+            child++;
+        }
+        if(!CO_TPDO_BEFORE(sched->TPDO[sched->heap[child]]->deadline, deadline)) break;
+        CO_TPDOheapSet(sched, pos, sched->heap[child]);
+        pos = child;
+    }
+    CO_TPDOheapSet(sched, pos, idx);
+}
+
+static void CO_TPDOheapRemove(CO_TPDOsched_t *sched, CO_TPDO_t *TPDO){
+    uint16_t pos = TPDO->heapPos;
+
+    TPDO->heapPos = CO_TPDO_NOT_SCHEDULED;
+    sched->heapCount--;
+    if(pos < sched->heapCount){
+        /* move last element into the gap, then restore heap order */
+        uint16_t idx = sched->heap[sched->heapCount];
+
+        CO_TPDOheapSet(sched, pos, idx);
+        CO_TPDOheapUp(sched, pos);
+        CO_TPDOheapDown(sched, sched->TPDO[idx]->heapPos);
+    }
+}
+
+
+/*
+ * Calculate next deadline of TPDO and put it into, move it inside or remove
+ * it from scheduler heap.
+ *
+ * Deadlines are compared wrap around safe, so they are valid for less than
+ * half of scheduler clock range (about 35 minutes). They are used only while
+ * TPDO is in heap, which visits it at the deadline. Event timer of TPDO, which
+ * was not in heap, is restarted when TPDO enters heap.
+ */
+static void CO_TPDOschedUpdate(CO_TPDO_t *TPDO){
+    CO_TPDOsched_t *sched = TPDO->sched;
+    bool_t scheduled = false;
+    uint32_t deadline = 0;
+
+    if(TPDO->valid && *TPDO->operatingState == CO_NMT_OPERATIONAL &&
+       TPDO->TPDOCommPar->transmissionType >= 253)
+    {
+        if(TPDO->heapPos == CO_TPDO_NOT_SCHEDULED && !TPDO->inhibitRunning)
+            TPDO->eventDeadline = sched->now_us + ((uint32_t) TPDO->TPDOCommPar->eventTimer) * 1000;
+
+        if(TPDO->sendRequest){
+            /* send request waits for end of inhibit time */
+            deadline = TPDO->inhibitRunning ? TPDO->inhibitDeadline : sched->now_us;
+            scheduled = true;
+        }
+        else if(TPDO->TPDOCommPar->eventTimer){
+            deadline = TPDO->eventDeadline;
+            if(TPDO->inhibitRunning && CO_TPDO_BEFORE(deadline, TPDO->inhibitDeadline))
+                deadline = TPDO->inhibitDeadline;
+            scheduled = true;
+        }
+        else if(TPDO->inhibitRunning){
+            /* visit TPDO, when inhibit time expires */
+            deadline = TPDO->inhibitDeadline;
+            scheduled = true;
+        }
+    }
+
+    if(!scheduled){
+        /* inhibit time is not tracked outside of heap */
+        TPDO->inhibitRunning = false;
+        if(TPDO->heapPos != CO_TPDO_NOT_SCHEDULED)
+            CO_TPDOheapRemove(sched, TPDO);
+    }
+    else if(TPDO->heapPos == CO_TPDO_NOT_SCHEDULED){
+        TPDO->deadline = deadline;
+        sched->heapCount++;
+        CO_TPDOheapSet(sched, sched->heapCount - 1, TPDO->schedIndex);
+        CO_TPDOheapUp(sched, TPDO->heapPos);
+    }
+    else if(TPDO->deadline != deadline){
+        bool_t earlier = CO_TPDO_BEFORE(deadline, TPDO->deadline);
+
+        TPDO->deadline = deadline;
+        if(earlier) CO_TPDOheapUp(sched, TPDO->heapPos);
+        else        CO_TPDOheapDown(sched, TPDO->heapPos);
+    }
+}
+
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
+/*
+ * Advance synchronous TPDO on SYNC.
+ *
+ * @return true, if TPDO must be sent on this SYNC.
+ */
+static bool_t CO_TPDOsyncStep(CO_TPDO_t *TPDO){
+    /* send synchronous acyclic PDO */
+    if(TPDO->TPDOCommPar->transmissionType == 0){
+        return TPDO->sendRequest ? true : false;
+    }
+
+    /* send synchronous cyclic PDO */
+    /* is the start of synchronous TPDO transmission */
+    if(TPDO->syncCounter == 255){
+        if(TPDO->SYNC->counterOverflowValue && TPDO->TPDOCommPar->SYNCStartValue)
+            TPDO->syncCounter = 254;   /* SYNCStartValue is in use */
+        else
+            TPDO->syncCounter = TPDO->TPDOCommPar->transmissionType;
+    }
+    /* if the SYNCStartValue is in use, start first TPDO after SYNC with matched SYNCStartValue. */
+    if(TPDO->syncCounter == 254){
+        if(TPDO->SYNC->counter == TPDO->TPDOCommPar->SYNCStartValue){
+            TPDO->syncCounter = TPDO->TPDOCommPar->transmissionType;
+            return true;
+        }
+    }
+    /* Send PDO after every N-th Sync */
+    else if(--TPDO->syncCounter == 0){
+        TPDO->syncCounter = TPDO->TPDOCommPar->transmissionType;
+        return true;
+    }
+    return false;
+}
+
+
+/*
+ * True, if CO_TPDOsyncStep() may return true on next SYNC. Otherwise next SYNC
+ * only decrements syncCounter.
+ */
+static bool_t CO_TPDOsyncCandidate(const CO_TPDO_t *TPDO){
+    return TPDO->TPDOCommPar->transmissionType == 0
+        || TPDO->syncCounter == 1 || TPDO->syncCounter >= 254;
+}
+
+
+/*
+ * Stage synchronous TPDOs, which may be sent on next SYNC.
+ */
+static void CO_TPDOsyncStage(CO_TPDOsched_t *sched){
+    uint16_t i;
+
+    sched->syncDueCount = 0;
+    for(i=0; i<sched->syncCount; i++){
+        CO_TPDO_t *TPDO = sched->TPDO[sched->sync[i]];
+
+        TPDO->syncDue = CO_TPDOsyncCandidate(TPDO);
+        if(TPDO->syncDue)
+            sched->syncDue[sched->syncDueCount++] = sched->sync[i];
+    }
+}
+
+
+/*
+ * Send synchronous TPDOs on SYNC.
+ *
+ * Only staged TPDOs are checked. Data of TPDOs, which are due, is sampled from
+ * Object dictionary first, then all frames are passed to CAN driver in one
+ * burst. Counters of other synchronous TPDOs are advanced after that and
+ * TPDOs for next SYNC are staged.
+ */
+static void CO_TPDOsyncBurst(CO_TPDOsched_t *sched){
+    CO_CANmodule_t *CANdevTx = NULL;
+    uint16_t i;
+    uint16_t n = 0;
+
+    sched->syncSent = 0;
+    for(i=0; i<sched->syncDueCount; i++){
+        CO_TPDO_t *TPDO = sched->TPDO[sched->syncDue[i]];
+
+        if(TPDO->TPDOCommPar->transmissionType == 0 && !TPDO->sendRequest)
+            TPDO->sendRequest = CO_TPDOisCOS(TPDO);
+        if(!CO_TPDOsyncStep(TPDO) || !CO_TPDOgather(TPDO))
+            continue;
+
+        /* one burst per CAN module */
+        if(TPDO->CANdevTx != CANdevTx && n > 0){
+            CO_CANsendBurst(CANdevTx, sched->burst, n);
+            n = 0;
+        }
+        CANdevTx = TPDO->CANdevTx;
+        sched->burst[n++] = TPDO->CANtxBuff;
+        sched->syncSent++;
+    }
+    if(n > 0)
+        CO_CANsendBurst(CANdevTx, sched->burst, n);
+
+    /* advance TPDOs, which were not staged */
+    for(i=0; i<sched->syncCount; i++){
+        CO_TPDO_t *TPDO = sched->TPDO[sched->sync[i]];
+
+        if(!TPDO->syncDue)
+            (void)CO_TPDOsyncStep(TPDO);
+    }
+    CO_TPDOsyncStage(sched);
+}
+#endif
+
+
+/******************************************************************************/
+void CO_TPDO_process(CO_TPDO_t *TPDO, bool_t syncWas){
+    uint32_t now = TPDO->sched->now_us;
 
     if(TPDO->valid && *TPDO->operatingState == CO_NMT_OPERATIONAL){
 
         /* Send PDO by application request or by Event timer */
         if(TPDO->TPDOCommPar->transmissionType >= 253){
-            if(TPDO->inhibitTimer == 0 && (TPDO->sendRequest || (TPDO->TPDOCommPar->eventTimer && TPDO->eventTimer == 0))){
-                if(CO_TPDOsend(TPDO) == CO_ERROR_NO){
-                    /* successfully sent */
-                    TPDO->inhibitTimer = ((uint32_t) TPDO->TPDOCommPar->inhibitTime) * 100;
-                    TPDO->eventTimer = ((uint32_t) TPDO->TPDOCommPar->eventTimer) * 1000;
+            bool_t eventDue = TPDO->TPDOCommPar->eventTimer && TPDO->heapPos != CO_TPDO_NOT_SCHEDULED &&
+                              !CO_TPDO_BEFORE(now, TPDO->eventDeadline);
+
+            if(TPDO->inhibitRunning && !CO_TPDO_BEFORE(now, TPDO->inhibitDeadline))
+                TPDO->inhibitRunning = false;
+
+            if(!TPDO->inhibitRunning && (TPDO->sendRequest || eventDue)){
+                int16_t err = CO_TPDOsend(TPDO);
+
+                /* successfully sent or MPDO without object, wait next event */
+                if(err == CO_ERROR_NO || err == CO_ERROR_TX_UNCONFIGURED){
+                    TPDO->inhibitDeadline = now + ((uint32_t) TPDO->TPDOCommPar->inhibitTime) * 100;
+                    TPDO->inhibitRunning = TPDO->TPDOCommPar->inhibitTime != 0;
+                    TPDO->eventDeadline = now + ((uint32_t) TPDO->TPDOCommPar->eventTimer) * 1000;
                 }
-            }
-#if (CO_CONFIG_PDO) & CO_CONFIG_FLAG_TIMERNEXT
-            if(timerNext_us != NULL){
-                if(TPDO->sendRequest && *timerNext_us > TPDO->inhibitTimer){
-                    *timerNext_us = TPDO->inhibitTimer; /* Schedule for just beyond inhibit window */
-                }else if(TPDO->TPDOCommPar->eventTimer && *timerNext_us > TPDO->eventTimer){
-                    *timerNext_us = TPDO->eventTimer; /* Schedule for next maximum event time */
+                /* CAN transmit buffer is full, keep expired event deadline
+                 * from getting older while retrying */
+                else if(eventDue){
+                    TPDO->eventDeadline = now;
                 }
             }
-#endif
         }
 
 #if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
         /* Synchronous PDOs */
         else if(TPDO->SYNC && syncWas){
-            /* send synchronous acyclic PDO */
-            if(TPDO->TPDOCommPar->transmissionType == 0){
-                if(TPDO->sendRequest) CO_TPDOsend(TPDO);
-            }
-            /* send synchronous cyclic PDO */
-            else{
-                /* is the start of synchronous TPDO transmission */
-                if(TPDO->syncCounter == 255){
-                    if(TPDO->SYNC->counterOverflowValue && TPDO->TPDOCommPar->SYNCStartValue)
-                        TPDO->syncCounter = 254;   /* SYNCStartValue is in use */
-                    else
-                        TPDO->syncCounter = TPDO->TPDOCommPar->transmissionType;
-                }
-                /* if the SYNCStartValue is in use, start first TPDO after SYNC with matched SYNCStartValue. */
-                if(TPDO->syncCounter == 254){
-                    if(TPDO->SYNC->counter == TPDO->TPDOCommPar->SYNCStartValue){
-                        TPDO->syncCounter = TPDO->TPDOCommPar->transmissionType;
-                        CO_TPDOsend(TPDO);
-                    }
-                }
-                /* Send PDO after every N-th Sync */
-                else if(--TPDO->syncCounter == 0){
-                    TPDO->syncCounter = TPDO->TPDOCommPar->transmissionType;
-                    CO_TPDOsend(TPDO);
-                }
-            }
+            if(CO_TPDOsyncStep(TPDO)) CO_TPDOsend(TPDO);
         }
 #endif
 
@@ -1090,4 +2727,258 @@ void CO_TPDO_process(
         if(TPDO->TPDOCommPar->transmissionType>=254) TPDO->sendRequest = 1;
         else                                         TPDO->sendRequest = 0;
     }
+
+    CO_TPDOschedUpdate(TPDO);
+}
+
+
+/******************************************************************************/
+void CO_TPDOsched_init(
+        CO_TPDOsched_t         *sched,
+        CO_TPDO_t             **TPDO,
+        uint16_t               *heap,
+        uint16_t               *active,
+        uint16_t               *sync,
+        uint16_t               *syncDue,
+        CO_CANtx_t            **burst,
+        uint16_t                count)
+{
+    uint16_t i;
+
+    sched->TPDO = TPDO;
+    sched->heap = heap;
+    sched->active = active;
+    sched->count = count;
+    sched->heapCount = 0;
+    sched->activeCount = 0;
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
+    sched->sync = sync;
+    sched->syncDue = syncDue;
+    sched->burst = burst;
+    sched->syncCount = 0;
+    sched->syncDueCount = 0;
+    sched->syncSent = 0;
+#else
+    (void)sync;
+    (void)syncDue;
+    (void)burst;
+#endif
+    sched->update = true;
+    sched->operationalPrev = false;
+    CO_FLAG_CLEAR(sched->stagedNew);
+    /* now_us keeps running through communication reset */
+
+    for(i=0; i<count; i++){
+        CO_TPDO_t *T = TPDO[i];
+
+        T->sched = sched;
+        T->schedIndex = i;
+        T->heapPos = CO_TPDO_NOT_SCHEDULED;
+        T->inhibitDeadline = sched->now_us;
+        T->inhibitRunning = false;
+        T->eventDeadline = sched->now_us + ((uint32_t) T->TPDOCommPar->eventTimer) * 1000;
+    }
+}
+
+
+/*
+ * Apply communication parameter changes, which SDO server has written, to
+ * scheduler state of TPDO. Called with CO_LOCK_OD held.
+ */
+static void CO_TPDOcommApply(CO_TPDO_t *TPDO, uint32_t changed){
+    uint32_t now = TPDO->sched->now_us;
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
+    if(changed & CO_TPDO_COMM_SYNC){
+        if(TPDO->CANtxBuff != NULL)
+            TPDO->CANtxBuff->syncFlag = (TPDO->TPDOCommPar->transmissionType <= 240) ? 1 : 0;
+        TPDO->syncCounter = 255;
+    }
+#endif
+    if(changed & CO_TPDO_COMM_INHIBIT)
+        TPDO->inhibitRunning = false;
+    if(changed & CO_TPDO_COMM_EVENT)
+        TPDO->eventDeadline = now + ((uint32_t) TPDO->TPDOCommPar->eventTimer) * 1000;
+}
+
+
+/******************************************************************************/
+void CO_TPDOsched_process(
+        CO_TPDOsched_t         *sched,
+        bool_t                  syncWas,
+        uint32_t                timeDifference_us,
+        uint32_t               *timerNext_us)
+{
+    uint16_t i;
+    uint32_t now;
+    bool_t operational;
+
+    if(sched->count == 0) return;
+
+    sched->now_us += timeDifference_us;
+    now = sched->now_us;
+    operational = *sched->TPDO[0]->operatingState == CO_NMT_OPERATIONAL;
+
+    /* Swap in staged mapping before TPDOs are sent. Synchronous TPDO waits
+     * for SYNC. Staging slot is free again, when flag is cleared. */
+    if(CO_FLAG_READ(sched->stagedNew)){
+        CO_TPDO_t *TPDO = sched->staged;
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
+        if(TPDO->TPDOCommPar->transmissionType > 240 || syncWas)
+#endif
+        {
+            CO_TPDOmapApply(TPDO, &sched->staging);
+            CO_FLAG_CLEAR(sched->stagedNew);
+        }
+    }
+
+    /* NMT state changed, schedule or unschedule all TPDOs */
+    if(operational != sched->operationalPrev){
+        sched->operationalPrev = operational;
+        sched->update = true;
+        for(i=0; i<sched->count; i++){
+            CO_TPDO_process(sched->TPDO[i], false);
+        }
+    }
+    if(!operational) return;
+
+    /* Communication parameter changed, recalculate deadlines and list of valid
+     * TPDOs. Wait until SDO server finished writing. */
+    if(sched->update){
+        CO_LOCK_OD();
+        sched->update = false;
+        sched->activeCount = 0;
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
+        sched->syncCount = 0;
+#endif
+        for(i=0; i<sched->count; i++){
+            CO_TPDO_t *TPDO = sched->TPDO[i];
+            uint32_t changed = CO_FLAG_TAKE_BITS(TPDO->commChanged);
+
+            if(changed) CO_TPDOcommApply(TPDO, changed);
+            CO_TPDOschedUpdate(TPDO);
+            if(!TPDO->valid) continue;
+            sched->active[sched->activeCount++] = i;
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
+            if(TPDO->SYNC && TPDO->TPDOCommPar->transmissionType <= 240)
+                sched->sync[sched->syncCount++] = i;
+#endif
+        }
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
+        CO_TPDOsyncStage(sched);
+#endif
+        CO_UNLOCK_OD();
+    }
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE
+    /* Synchronous TPDOs first, right after SYNC */
+    if(syncWas)
+        CO_TPDOsyncBurst(sched);
+#endif
+
+    /* Send requests and Change of State. Only flags of valid TPDOs are checked
+     * here, timers are handled by heap below. Change of State of synchronous
+     * acyclic TPDOs is latched in sendRequest until next SYNC. */
+    for(i=0; i<sched->activeCount; i++){
+        CO_TPDO_t *TPDO = sched->TPDO[sched->active[i]];
+
+        if(!TPDO->sendRequest)
+            TPDO->sendRequest = CO_TPDOisCOS(TPDO);
+
+        if(TPDO->TPDOCommPar->transmissionType >= 253){
+            if(TPDO->sendRequest){
+                if(!TPDO->inhibitRunning || !CO_TPDO_BEFORE(now, TPDO->inhibitDeadline))
+                    CO_TPDO_process(TPDO, syncWas);
+                else if(TPDO->heapPos == CO_TPDO_NOT_SCHEDULED || TPDO->deadline != TPDO->inhibitDeadline)
+                    CO_TPDOschedUpdate(TPDO);
+            }
+        }
+    }
+
+    /* TPDOs, which event timer or inhibit time expired */
+    while(sched->heapCount > 0){
+        CO_TPDO_t *TPDO = sched->TPDO[sched->heap[0]];
+
+        if(CO_TPDO_BEFORE(now, TPDO->deadline)) break;
+        CO_TPDO_process(TPDO, syncWas);
+
+        /* still due, CAN transmit buffer is full, retry on next call */
+        if(TPDO->heapPos == 0 && !CO_TPDO_BEFORE(now, TPDO->deadline)) break;
+    }
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_FLAG_TIMERNEXT
+    if(timerNext_us != NULL && sched->heapCount > 0){
+        uint32_t deadline = sched->TPDO[sched->heap[0]]->deadline;
+        uint32_t diff = CO_TPDO_BEFORE(now, deadline) ? (deadline - now) : 0;
+
+        if(*timerNext_us > diff){
+            *timerNext_us = diff;
+        }
+    }
+#endif
+}
+
+
+/******************************************************************************/
+CO_SDO_abortCode_t CO_TPDOsched_stageMap(
+        CO_TPDOsched_t         *sched,
+        uint16_t                index,
+        const uint32_t         *map,
+        uint8_t                 noOfMappedObjects)
+{
+    CO_TPDO_t *TPDO;
+    CO_TPDOstaged_t *staged;
+    uint32_t *pMap;
+    uint32_t ret;
+    uint8_t i;
+    uint8_t n;
+
+    if(sched == NULL || index >= sched->count || map == NULL)
+        return CO_SDO_AB_INVALID_VALUE;
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+    if(noOfMappedObjects == 0 ||
+       (noOfMappedObjects > 8 && noOfMappedObjects != CO_PDO_MPDO_SAM && noOfMappedObjects != CO_PDO_MPDO_DAM))
+#else
+    if(noOfMappedObjects == 0 || noOfMappedObjects > 8)
+#endif
+        return CO_SDO_AB_MAP_LEN;
+    if(CO_FLAG_READ(sched->stagedNew))
+        return CO_SDO_AB_DATA_DEV_STATE;
+    TPDO = sched->TPDO[index];
+    staged = &sched->staging;
+
+    /* new mapping parameters */
+    staged->mapPar.numberOfMappedObjects = noOfMappedObjects;
+    pMap = &staged->mapPar.mappedObject1;
+#if (CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO
+    /* MPDO uses at most the first mapping entry */
+    n = (noOfMappedObjects > 8) ? 1 : noOfMappedObjects;
+#else
+    n = noOfMappedObjects;
+#endif
+    for(i=0; i<8; i++){
+        pMap[i] = (i < n) ? map[i] : 0;
+    }
+
+    /* build copy plan in shadow object */
+    memcpy(&staged->shadow, TPDO, sizeof(staged->shadow));
+    staged->shadow.TPDOMapPar = &staged->mapPar;
+    staged->shadow.plan = &staged->plan;
+    ret = CO_TPDOconfigMap(&staged->shadow, noOfMappedObjects);
+    if(ret != 0)
+        return (CO_SDO_abortCode_t) ret;
+
+    /* TPDO, which was not mapped yet, gets its plan, when mapping is swapped */
+    staged->take = NULL;
+    if(TPDO->plan == &CO_TPDOplanNone){
+        staged->take = CO_TPDOplanTake(TPDO->planPool);
+        if(staged->take == NULL)
+            return CO_SDO_AB_OUT_OF_MEM;
+    }
+
+    sched->staged = TPDO;
+    CO_FLAG_SET(sched->stagedNew);
+
+    return CO_SDO_AB_NONE;
 }
@@ -57,22 +57,87 @@ extern "C" {
  *
  * Features of the PDO as implemented here, in CANopenNode:
  *  - Dynamic PDO mapping.
- *  - Map granularity of one byte.
+ *  - Map granularity of one bit. Byte aligned variables are copied by copy
+ *    plan, other variables are bit fields, copied by shift and mask.
  *  - After RPDO is received from CAN bus, its data are copied to buffer.
+ *    Buffer is protected by sequence counter, so CO_RPDO_process() takes
+ *    consistent snapshot of it in one pass, without locking.
  *    Function CO_RPDO_process() (called by application) copies data to
  *    mapped objects in Object Dictionary. Synchronous RPDOs are processed AFTER
  *    reception of the next SYNC message.
  *  - Function CO_TPDO_process() (called by application) sends TPDO if
  *    necessary. There are possible different transmission types, including
  *    automatic detection of Change of State of specific variable.
+ *  - Event timers of RPDOs are reception deadlines, kept in min-heap of
+ *    #CO_RPDOsched_t. If RPDO misses its deadline, emergency is sent.
+ *  - Multiplexed PDO (MPDO) carries one object per CAN message, so many
+ *    objects share one COB-ID. PDO is MPDO, if _numberOfMappedObjects_ is
+ *    #CO_PDO_MPDO_SAM or #CO_PDO_MPDO_DAM. See CO_TPDO_sendMPDO().
+ *  - Inhibit and event timers of TPDOs are deadlines on common clock of
+ *    #CO_TPDOsched_t. CO_TPDOsched_process() keeps TPDOs with pending timer in
+ *    min-heap and processes only TPDOs, which are due or have send request.
+ *  - Synchronous TPDOs, which may be due on next SYNC, are staged in a list
+ *    after each SYNC. On SYNC their data is sampled and all frames are passed
+ *    to CAN driver in one burst with CO_CANsendBurst().
  */
 
 
+/** Value of CO_TPDO_t::heapPos, if TPDO is not in scheduler heap */
+#define CO_TPDO_NOT_SCHEDULED 0xFFFFU
+/** Value of CO_RPDO_t::heapPos, if RPDO is not in scheduler heap */
+#define CO_RPDO_NOT_SCHEDULED 0xFFFFU
+
+/**
+ * @defgroup CO_TPDO_COMM TPDO communication parameter changes
+ * Bits in CO_TPDO_t::commChanged, set by SDO write of 0x1800+ and applied by
+ * CO_TPDOsched_process().
+ * @{
+ */
+#define CO_TPDO_COMM_SYNC    0x01U  /**< Restart SYNC counter, update syncFlag */
+#define CO_TPDO_COMM_INHIBIT 0x02U  /**< Restart inhibit time */
+#define CO_TPDO_COMM_EVENT   0x04U  /**< Restart event timer */
+/** @} */
+
+/**
+ * @defgroup CO_PDO_MPDO Multiplexed PDO
+ * @{
+ *
+ * MPDO data: byte 0 is address, bytes 1-2 index, byte 3 subindex and bytes
+ * 4-7 value of one object, little endian.
+ * Bit 7 of address selects the mode, as in CiA 301.
+ *  - Source address mode (SAM): address is node-ID of producer, bit 7 is 0.
+ *    Producer sends objects from _object scanner list_ (index 0x1FA0), entry:
+ *    bits 31-24 block size, bits 23-8 index, bits 7-0 subindex. Consumer finds
+ *    object in _object dispatcher list_ (index 0x1FD0), entry: bits 63-56
+ *    block size, bits 55-40 local index, bits 39-32 local subindex, bits
+ *    31-16 producer index, bits 15-8 producer subindex, bits 7-0 producer
+ *    node-ID. Block size is number of consecutive subindexes, 0 is the same
+ *    as 1.
+ *  - Destination address mode (DAM): address is 0x80 | node-ID of consumer
+ *    or 0x80 for all nodes. Producer sends the first mapped object, consumer
+ *    writes it to the same index and subindex of its Object Dictionary.
+ */
+/** _numberOfMappedObjects_ of MPDO in source address mode */
+#define CO_PDO_MPDO_SAM 0xFEU
+/** _numberOfMappedObjects_ of MPDO in destination address mode */
+#define CO_PDO_MPDO_DAM 0xFFU
+
+/**
+ * Received MPDO object, queued by CAN receive function for CO_RPDO_process().
+ */
+typedef struct{
+    uint16_t            index;          /**< Local index of object */
+    uint8_t             subIndex;       /**< Local subindex of object */
+    uint8_t             data[4];        /**< Value, little endian */
+}CO_RPDOmpdoObj_t;
+/** @} */
+
+
 /**
  * RPDO communication parameter. The same as record from Object dictionary (index 0x1400+).
  */
 typedef struct{
-    uint8_t             maxSubIndex;    /**< Equal to 2 */
+    uint8_t             maxSubIndex;    /**< Equal to 5 */
     /** Communication object identifier for message received. Meaning of the specific bits:
         - Bit  0-10: COB-ID for PDO, to change it bit 31 must be set.
         - Bit 11-29: set to 0 for 11 bit COB-ID.
@@ -85,6 +150,14 @@ typedef struct{
         - 254:     Manufacturer specific.
         - 255:     Asynchronous. */
     uint8_t             transmissionType;
+    /** Not used for RPDO */
+    uint16_t            inhibitTime;
+    /** Not used */
+    uint8_t             compatibilityEntry;
+    /** Reception deadline in milliseconds. If nonzero, emergency is sent, if
+    RPDO is not received within this time. Monitoring starts with the first
+    reception. */
+    uint16_t            eventTimer;
 }CO_RPDOCommPar_t;
 
 
@@ -168,9 +241,153 @@ typedef struct{
 
 
 /**
- * RPDO object.
+ * Part of PDO copy plan: bytes, which are contiguous in both, Object
+ * Dictionary variable and PDO data. Built from byte pointers, when mapping is
+ * configured, so PDO data is copied with few memcpy instead of byte by byte.
+ */
+typedef struct{
+    uint8_t            *ODdata;         /**< Pointer to first byte in Object Dictionary */
+    uint8_t             PDOoffset;      /**< Offset of first byte in PDO data */
+    uint8_t             length;         /**< Number of bytes */
+}CO_PDOcopyRun_t;
+
+
+/**
+ * Mapped variable, which is not byte aligned in PDO data. Its value is
+ * shifted and masked as integer of ODlength bytes.
+ */
+typedef struct{
+    uint8_t            *ODdata;         /**< Pointer to variable in Object Dictionary */
+    uint8_t             bitOffset;      /**< Position in PDO data in bits */
+    uint8_t             bitLength;      /**< Number of bits, less than 64 */
+    uint8_t             ODlength;       /**< Length of variable in bytes, up to 8 */
+    uint8_t             MBvar;          /**< True for multibyte variable */
+}CO_PDObitField_t;
+
+
+/**
+ * Object Dictionary extension of one mapped object, resolved when mapping is
+ * configured. Used for calling @ref CO_SDO_OD_function on PDO transfer without
+ * searching Object Dictionary each time.
+ */
+typedef struct{
+    CO_OD_extension_t  *ext;            /**< Extension slot of the OD entry */
+    void               *data;           /**< Pointer to data in Object Dictionary */
+    uint16_t            dataLength;     /**< Length of variable in bytes */
+    uint16_t            attribute;      /**< See #CO_SDO_OD_attributes_t */
+    uint16_t            index;          /**< Index of mapped object */
+    uint8_t             subIndex;       /**< Subindex of mapped object */
+}CO_PDOext_t;
+
+
+/**
+ * One mapped object inside received PDO data, see CO_RPDO_initCallbackRx().
+ * PDO data are little endian. Byte aligned value is at data[bitOffset / 8] and
+ * can be read with CO_getUint16() and similar functions.
+ */
+typedef struct{
+    uint16_t            index;          /**< Index of mapped object */
+    uint8_t             subIndex;       /**< Subindex of mapped object */
+    uint8_t             bitOffset;      /**< Position in PDO data in bits */
+    uint8_t             bitLength;      /**< Length in bits */
+}CO_PDOfield_t;
+
+
+/**
+ * RPDO copy plan, built from mapping parameters.
+ *
+ * It is kept apart from CO_RPDO_t, so RPDO without mapped objects takes no
+ * memory for it. RPDO takes plan from #CO_RPDOplanPool_t, when its mapping is
+ * first configured with objects or as MPDO, and keeps it until communication
+ * reset.
+ */
+typedef struct{
+    /** Copy plan, see #CO_PDOcopyRun_t */
+    CO_PDOcopyRun_t     copyRun[8];
+    /** Number of used entries in copyRun */
+    uint8_t             copyRunCount;
+    /** PDO data pointers, one per byte, used instead of copyRun, if its runs
+    are short */
+    uint8_t            *mapPointer[8];
+    /** Number of used entries in mapPointer, 0 if copyRun is used */
+    uint8_t             mapPointerCount;
+    /** Mapped variables, which are not byte aligned, see #CO_PDObitField_t */
+    CO_PDObitField_t    bitField[8];
+    /** Number of used entries in bitField */
+    uint8_t             bitFieldCount;
+#if ((CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLS_EXTENSION) || defined CO_DOXYGEN
+    /** Extensions of mapped objects, see #CO_PDOext_t */
+    CO_PDOext_t         ext[8];
+    /** Number of used entries in ext */
+    uint8_t             extCount;
+#endif
+#if ((CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLBACK_RX) || defined CO_DOXYGEN
+    /** Mapped objects, built from mapping parameters */
+    CO_PDOfield_t       field[8];
+    /** Number of used entries in field */
+    uint8_t             fieldCount;
+#endif
+#if ((CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO) || defined CO_DOXYGEN
+    /** Received MPDO objects, written into Object Dictionary by
+    CO_RPDO_process(), see CO_RPDO_t::MPDOhead */
+    CO_RPDOmpdoObj_t    MPDOqueue[CO_CONFIG_PDO_MPDO_QUEUE];
+#endif
+}CO_RPDOplan_t;
+
+
+/**
+ * TPDO copy plan, built from mapping parameters, see #CO_RPDOplan_t.
+ */
+typedef struct{
+    /** Copy plan, see #CO_PDOcopyRun_t */
+    CO_PDOcopyRun_t     copyRun[8];
+    /** Number of used entries in copyRun */
+    uint8_t             copyRunCount;
+    /** PDO data pointers, one per byte, used instead of copyRun, if its runs
+    are short */
+    uint8_t            *mapPointer[8];
+    /** Number of used entries in mapPointer, 0 if copyRun is used */
+    uint8_t             mapPointerCount;
+    /** Mapped variables, which are not byte aligned, see #CO_PDObitField_t */
+    CO_PDObitField_t    bitField[8];
+    /** Number of used entries in bitField */
+    uint8_t             bitFieldCount;
+#if ((CO_CONFIG_PDO) & CO_CONFIG_TPDO_CALLS_EXTENSION) || defined CO_DOXYGEN
+    /** Extensions of mapped objects, see #CO_PDOext_t */
+    CO_PDOext_t         ext[8];
+    /** Number of used entries in ext */
+    uint8_t             extCount;
+#endif
+}CO_TPDOplan_t;
+
+
+/**
+ * Copy plans for RPDOs, see CO_RPDOplanPool_init().
+ *
+ * Plans are taken by SDO server and by CO_RPDO_init() only, so they are not
+ * locked. They are returned all at once, when pool is initialized again.
  */
 typedef struct{
+    CO_RPDOplan_t      *plans;          /**< From CO_RPDOplanPool_init() */
+    uint16_t            count;          /**< From CO_RPDOplanPool_init() */
+    uint16_t            used;           /**< Number of plans taken by RPDOs */
+}CO_RPDOplanPool_t;
+
+
+/**
+ * Copy plans for TPDOs, see #CO_RPDOplanPool_t.
+ */
+typedef struct{
+    CO_TPDOplan_t      *plans;          /**< From CO_TPDOplanPool_init() */
+    uint16_t            count;          /**< From CO_TPDOplanPool_init() */
+    uint16_t            used;           /**< Number of plans taken by TPDOs */
+}CO_TPDOplanPool_t;
+
+
+/**
+ * RPDO object.
+ */
+typedef struct CO_RPDO{
     CO_EM_t            *em;             /**< From CO_RPDO_init() */
     CO_SDO_t           *SDO;            /**< From CO_RPDO_init() */
     const CO_RPDOCommPar_t *RPDOCommPar;/**< From CO_RPDO_init() */
@@ -183,18 +400,37 @@ typedef struct{
     bool_t              valid;
     /** Data length of the received PDO message. Calculated from mapping */
     uint8_t             dataLength;
-    /** Pointers to 8 data objects, where PDO will be copied */
-    uint8_t            *mapPointer[8];
+    /** Copy plan, taken from planPool, when RPDO is mapped. Points to empty
+    plan before */
+    CO_RPDOplan_t      *plan;
+    CO_RPDOplanPool_t  *planPool;       /**< From CO_RPDO_init() */
+#if ((CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO) || defined CO_DOXYGEN
+    /** 0, #CO_PDO_MPDO_SAM or #CO_PDO_MPDO_DAM, from mapping parameters */
+    uint8_t             MPDO;
+    /** SAM: object dispatcher list, from CO_RPDO_initMPDO() or NULL */
+    const uint64_t     *dispatcher;
+    /** Number of entries in dispatcher */
+    uint8_t             dispatcherCount;
+    /** Next entry of CO_RPDOplan_t::MPDOqueue written by CAN receive function */
+    volatile uint8_t    MPDOhead;
+    /** Next entry of CO_RPDOplan_t::MPDOqueue read by CO_RPDO_process() */
+    volatile uint8_t    MPDOtail;
+    /** Number of objects lost, because MPDOqueue was full */
+    uint16_t            MPDOlost;
+#endif
 #if ((CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE) || defined CO_DOXYGEN
     CO_SYNC_t          *SYNC;           /**< From CO_RPDO_init() */
     /** True, if PDO synchronous (transmissionType <= 240) */
     bool_t              synchronous;
     /** Variable indicates, if new PDO message received from CAN bus. */
     volatile void      *CANrxNew[2];
+    /** Sequence counter of CANrxData, odd while receive function writes it */
+    volatile uint32_t   CANrxSeq[2];
     /** 8 data bytes of the received message. */
     uint8_t             CANrxData[2][8];
 #else
     volatile void      *CANrxNew[1];
+    volatile uint32_t   CANrxSeq[1];
     uint8_t             CANrxData[1][8];
 #endif
 #if ((CO_CONFIG_PDO) & CO_CONFIG_FLAG_CALLBACK_PRE) || defined CO_DOXYGEN
@@ -203,11 +439,93 @@ typedef struct{
     /** From CO_RPDO_initCallbackPre() or NULL */
     void               *functSignalObjectPre;
 #endif
+#if ((CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLBACK_RX) || defined CO_DOXYGEN
+    /** From CO_RPDO_initCallbackRx() or NULL */
+    bool_t            (*pFunctRx)(void *object, const uint8_t *data,
+                                  const CO_PDOfield_t *field, uint8_t fieldCount);
+    /** From CO_RPDO_initCallbackRx() or NULL */
+    void               *functRxObject;
+#endif
+    /** Word in CO_RPDOsched_t::pending, from CO_RPDOsched_init() or NULL */
+    uint32_t           *pendingWord;
+    /** Bit of this RPDO in pendingWord and in receivedWord */
+    uint32_t            pendingBit;
+    /** Word in CO_RPDOsched_t::received, from CO_RPDOsched_init() or NULL */
+    uint32_t           *receivedWord;
+    struct CO_RPDOsched *sched;         /**< From CO_RPDOsched_init() */
+    /** Reception deadline from _event timer_, valid if RPDO is in heap */
+    uint32_t            deadline;
+    /** Position in CO_RPDOsched_t::heap or CO_RPDO_NOT_SCHEDULED */
+    uint16_t            heapPos;
+    /** True, if RPDO missed its reception deadline */
+    bool_t              timedOut;
+    /** Receive function uses dataLength, MPDO and plan->field of this
+    object. It is this RPDO or, while staged mapping is swapped in, its shadow */
+    const struct CO_RPDO *volatile rxMap;
+    /** Incremented by receive function on entry and on exit, see CO_RCU_ENTER() */
+    volatile uint32_t   rxSeq;
+    /** rxSeq, when rxMap was last replaced */
+    uint32_t            rxSeqSwap;
+    /** Step of swapping staged mapping in, 0 if not started */
+    uint8_t             swapStep;
     CO_CANmodule_t     *CANdevRx;       /**< From CO_RPDO_init() */
     uint16_t            CANdevRxIdx;    /**< From CO_RPDO_init() */
 }CO_RPDO_t;
 
 
+/**
+ * RPDO mapping prepared off to the side, see CO_RPDOsched_stageMap(). One of
+ * them is in CO_RPDOsched_t, it is shared by all RPDOs.
+ */
+typedef struct CO_RPDOstaged{
+    CO_RPDO_t           shadow;         /**< Copy of RPDO with new mapping, its plan is plan */
+    CO_RPDOplan_t       plan;           /**< New copy plan */
+    CO_RPDOMapPar_t     mapPar;         /**< New mapping parameters */
+    /** Plan from pool for RPDO, which has none yet, or NULL */
+    CO_RPDOplan_t      *take;
+}CO_RPDOstaged_t;
+
+
+/** Number of 32-bit words in CO_RPDOsched_t::pending for count RPDOs */
+#define CO_RPDO_PENDING_WORDS(count) (((count) + 31U) / 32U)
+
+/**
+ * RPDO scheduler.
+ *
+ * Receive function marks RPDO in pending bitmap, so CO_RPDOsched_process()
+ * processes only RPDOs with received message, not all of them.
+ *
+ * RPDOs with nonzero _event timer_ are monitored after their first reception.
+ * Their reception deadlines are kept in binary min-heap, ordered by
+ * CO_RPDO_t::deadline, so only the earliest deadline is checked. Receive
+ * function marks RPDO also in received bitmap, which restarts its deadline.
+ */
+typedef struct CO_RPDOsched{
+    CO_RPDO_t         **RPDO;           /**< From CO_RPDOsched_init() */
+    /** From CO_RPDOsched_init(), CO_RPDO_PENDING_WORDS(count) elements */
+    uint32_t           *pending;
+    /** From CO_RPDOsched_init(), CO_RPDO_PENDING_WORDS(count) elements */
+    uint32_t           *received;
+    /** From CO_RPDOsched_init(), indexes into RPDO */
+    uint16_t           *heap;
+    uint16_t            count;          /**< From CO_RPDOsched_init() */
+    uint16_t            heapCount;      /**< Number of RPDOs in heap */
+    /** Number of RPDOs, which missed their deadline */
+    uint16_t            timeoutCount;
+    /** Set after SDO write to communication parameters, scheduler then
+    stops monitoring of RPDOs, which are not valid or have no event timer */
+    volatile bool_t     update;
+    uint32_t            now_us;         /**< Scheduler clock in microseconds */
+    bool_t              operationalPrev;/**< NMT operational in previous call */
+    /** Set from CO_RPDOsched_stageMap() until mapping is swapped in */
+    volatile void      *stagedNew;
+    /** RPDO, which mapping is in staging, valid while stagedNew is set */
+    CO_RPDO_t          *staged;
+    /** Staging slot for mapping of one RPDO at a time */
+    CO_RPDOstaged_t     staging;
+}CO_RPDOsched_t;
+
+
 /**
  * TPDO object.
  */
@@ -226,19 +544,60 @@ typedef struct{
     /** If application set this flag, PDO will be later sent by
     function CO_TPDO_process(). Depends on transmission type. */
     uint8_t             sendRequest;
-    /** Pointers to 8 data objects, where PDO will be copied */
-    uint8_t            *mapPointer[8];
-    /** Inhibit timer used for inhibit PDO sending translated to microseconds */
-    uint32_t            inhibitTimer;
-    /** Event timer used for PDO sending translated to microseconds */
-    uint32_t            eventTimer;
-    /** Each flag bit is connected with one mapPointer. If flag bit
+    /** Copy plan, taken from planPool, when TPDO is mapped. Points to empty
+    plan before */
+    CO_TPDOplan_t      *plan;
+    CO_TPDOplanPool_t  *planPool;       /**< From CO_TPDO_init() */
+#if ((CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO) || defined CO_DOXYGEN
+    /** 0, #CO_PDO_MPDO_SAM or #CO_PDO_MPDO_DAM, from mapping parameters */
+    uint8_t             MPDO;
+    /** DAM: data of the first mapped object */
+    uint8_t            *MPDOdata;
+    uint16_t            MPDOindex;      /**< DAM: index of the first mapped object */
+    uint8_t             MPDOsubIndex;   /**< DAM: subindex of the first mapped object */
+    uint8_t             MPDOlength;     /**< DAM: length of the first mapped object, 1 to 4 */
+    bool_t              MPDOmultibyte;  /**< DAM: true for multibyte variable */
+    /** DAM: node-ID of consumer or 0 for all nodes, from CO_TPDO_initMPDO() */
+    uint8_t             MPDOdest;
+    /** SAM: object scanner list, from CO_TPDO_initMPDO() or NULL */
+    const uint32_t     *scanner;
+    uint8_t             scannerCount;   /**< Number of entries in scanner */
+    uint8_t             scanEntry;      /**< SAM: next entry in scanner */
+    uint8_t             scanSub;        /**< SAM: next subindex inside block of scanEntry */
+#endif
+    /** Time on scheduler clock in microseconds, when inhibit time expires,
+    valid while inhibitRunning */
+    uint32_t            inhibitDeadline;
+    /** Time on scheduler clock in microseconds, when event timer expires,
+    valid while TPDO is in scheduler heap */
+    uint32_t            eventDeadline;
+    /** True from transmission until inhibit time expires. TPDO stays in
+    scheduler heap meanwhile, so expiry is seen well before scheduler clock
+    wraps half way around */
+    bool_t              inhibitRunning;
+    /** Earliest relevant of the above deadlines, key in scheduler heap */
+    uint32_t            deadline;
+    /** Position in scheduler heap or #CO_TPDO_NOT_SCHEDULED */
+    uint16_t            heapPos;
+    /** Index in CO_TPDOsched_t::TPDO, from CO_TPDOsched_init() */
+    uint16_t            schedIndex;
+    struct CO_TPDOsched *sched;         /**< From CO_TPDOsched_init() */
+    /** @ref CO_TPDO_COMM bits from SDO server, taken by scheduler */
+    volatile uint32_t   commChanged;
+    /** Each bit is set for PDO byte, which is assembled from plan->bitField */
+    uint8_t             bitBytes;
+    /** Each flag bit is connected with one PDO byte. If flag bit
     is true, CO_TPDO_process() functiuon will send PDO if
-    Change of State is detected on value pointed by that mapPointer */
+    Change of State is detected on value in that byte */
     uint8_t             sendIfCOSFlags;
+    /** Bits of PDO data, which detect Change of State. Bit j of PDO byte i
+    is bit i * 8 + j. Zero, if no mapped variable detects COS */
+    uint64_t            COSmask;
 #if ((CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE) || defined CO_DOXYGEN
     /** SYNC counter used for PDO sending */
     uint8_t             syncCounter;
+    /** True, if TPDO is staged in CO_TPDOsched_t::syncDue for next SYNC */
+    bool_t              syncDue;
     CO_SYNC_t          *SYNC;           /**< From CO_TPDO_init() */
 #endif
     CO_CANmodule_t     *CANdevTx;       /**< From CO_TPDO_init() */
@@ -247,6 +606,89 @@ typedef struct{
 }CO_TPDO_t;
 
 
+/**
+ * TPDO mapping prepared off to the side, see CO_TPDOsched_stageMap(). One of
+ * them is in CO_TPDOsched_t, it is shared by all TPDOs.
+ */
+typedef struct CO_TPDOstaged{
+    CO_TPDO_t           shadow;         /**< Copy of TPDO with new mapping, its plan is plan */
+    CO_TPDOplan_t       plan;           /**< New copy plan */
+    CO_TPDOMapPar_t     mapPar;         /**< New mapping parameters */
+    /** Plan from pool for TPDO, which has none yet, or NULL */
+    CO_TPDOplan_t      *take;
+}CO_TPDOstaged_t;
+
+
+/**
+ * TPDO scheduler.
+ *
+ * Event driven TPDOs (transmission type 253 to 255) with running event timer
+ * or with send request waiting for end of inhibit time are kept in binary
+ * min-heap, ordered by CO_TPDO_t::deadline. Comparison of deadlines is wrap
+ * around safe.
+ */
+typedef struct CO_TPDOsched{
+    CO_TPDO_t         **TPDO;           /**< From CO_TPDOsched_init() */
+    uint16_t           *heap;           /**< From CO_TPDOsched_init(), indexes into TPDO */
+    /** From CO_TPDOsched_init(), indexes of valid TPDOs */
+    uint16_t           *active;
+    uint16_t            count;          /**< From CO_TPDOsched_init() */
+    uint16_t            heapCount;      /**< Number of TPDOs in heap */
+    uint16_t            activeCount;    /**< Number of TPDOs in active */
+    /** Set after SDO write to communication parameters, scheduler then
+    recalculates deadlines and active list */
+    volatile bool_t     update;
+    uint32_t            now_us;         /**< Scheduler clock in microseconds */
+    bool_t              operationalPrev;/**< NMT operational in previous call */
+    /** Set from CO_TPDOsched_stageMap() until mapping is swapped in */
+    volatile void      *stagedNew;
+    /** TPDO, which mapping is in staging, valid while stagedNew is set */
+    CO_TPDO_t          *staged;
+    /** Staging slot for mapping of one TPDO at a time */
+    CO_TPDOstaged_t     staging;
+#if ((CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE) || defined CO_DOXYGEN
+    /** From CO_TPDOsched_init(), indexes of valid synchronous TPDOs */
+    uint16_t           *sync;
+    /** From CO_TPDOsched_init(), indexes of synchronous TPDOs, which may be
+    sent on next SYNC */
+    uint16_t           *syncDue;
+    /** From CO_TPDOsched_init(), CAN transmit buffers of one burst */
+    CO_CANtx_t        **burst;
+    uint16_t            syncCount;      /**< Number of TPDOs in sync */
+    uint16_t            syncDueCount;   /**< Number of TPDOs in syncDue */
+    uint16_t            syncSent;       /**< Number of TPDOs sent on last SYNC */
+#endif
+}CO_TPDOsched_t;
+
+
+/**
+ * Initialize pool of RPDO copy plans.
+ *
+ * Function must be called in the communication reset section, before
+ * CO_RPDO_init(). RPDOs take plans from the pool again, when they are
+ * initialized.
+ *
+ * Only mapped RPDOs take plan, so count may be less than number of RPDOs. If
+ * pool is empty, mapping is refused with SDO abort _Out of memory_, or
+ * emergency #CO_EM_MEMORY_ALLOCATION_ERROR is sent from CO_RPDO_init().
+ *
+ * @param pool This object will be initialized.
+ * @param plans Array of count plans.
+ * @param count Number of plans.
+ */
+void CO_RPDOplanPool_init(CO_RPDOplanPool_t *pool, CO_RPDOplan_t *plans, uint16_t count);
+
+
+/**
+ * Initialize pool of TPDO copy plans, see CO_RPDOplanPool_init().
+ *
+ * @param pool This object will be initialized.
+ * @param plans Array of count plans.
+ * @param count Number of plans.
+ */
+void CO_TPDOplanPool_init(CO_TPDOplanPool_t *pool, CO_TPDOplan_t *plans, uint16_t count);
+
+
 /**
  * Initialize RPDO object.
  *
@@ -255,6 +697,7 @@ typedef struct{
  * @param RPDO This object will be initialized.
  * @param em Emergency object.
  * @param SDO SDO server object.
+ * @param planPool Pool, from which RPDO takes copy plan, when it is mapped.
  * @param SYNC void pointer to SYNC object or NULL.
  * @param operatingState Pointer to variable indicating CANopen device NMT internal state.
  * @param nodeId CANopen Node ID of this device. If default COB_ID is used, value will be added.
@@ -281,6 +724,7 @@ CO_ReturnError_t CO_RPDO_init(
         CO_RPDO_t              *RPDO,
         CO_EM_t                *em,
         CO_SDO_t               *SDO,
+        CO_RPDOplanPool_t      *planPool,
 #if ((CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE) || defined CO_DOXYGEN
         CO_SYNC_t              *SYNC,
 #endif
@@ -315,6 +759,53 @@ void CO_RPDO_initCallbackPre(
 #endif
 
 
+#if ((CO_CONFIG_PDO) & CO_CONFIG_RPDO_CALLBACK_RX) || defined CO_DOXYGEN
+/**
+ * Initialize RPDO receive callback function.
+ *
+ * Function initializes optional callback function, which is called directly
+ * from CAN receive function, when valid RPDO is received in NMT operational
+ * state. Callback gets data of the CAN message without copying and the list of
+ * mapped objects, so application can react without waiting for
+ * CO_RPDO_process(). Synchronous RPDOs are also delivered at reception, not
+ * after SYNC.
+ *
+ * Callback runs in the CAN receive thread and must be short. It must not
+ * access the Object Dictionary.
+ *
+ * @param RPDO This object.
+ * @param object Pointer to object, which will be passed to pFunctRx(). Can be NULL
+ * @param pFunctRx Pointer to the callback function. Not called if NULL. If it
+ * returns true, message is consumed and is not copied to the Object Dictionary.
+ */
+void CO_RPDO_initCallbackRx(
+        CO_RPDO_t              *RPDO,
+        void                   *object,
+        bool_t                (*pFunctRx)(void *object, const uint8_t *data,
+                                          const CO_PDOfield_t *field, uint8_t fieldCount));
+#endif
+
+
+#if ((CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO) || defined CO_DOXYGEN
+/**
+ * Initialize RPDO as MPDO consumer.
+ *
+ * RPDO receives MPDOs, if its _numberOfMappedObjects_ is #CO_PDO_MPDO_SAM or
+ * #CO_PDO_MPDO_DAM. CAN receive function queues received object,
+ * CO_RPDO_process() writes it into Object Dictionary and calls its extension,
+ * as for other RPDOs. Object must be mappable to RPDO.
+ *
+ * @param RPDO This object.
+ * @param dispatcher Object dispatcher list, used in source address mode.
+ * @param dispatcherCount Number of entries in dispatcher.
+ */
+void CO_RPDO_initMPDO(
+        CO_RPDO_t              *RPDO,
+        const uint64_t         *dispatcher,
+        uint8_t                 dispatcherCount);
+#endif
+
+
 /**
  * Initialize TPDO object.
  *
@@ -323,6 +814,7 @@ void CO_RPDO_initCallbackPre(
  * @param TPDO This object will be initialized.
  * @param em Emergency object.
  * @param SDO SDO object.
+ * @param planPool Pool, from which TPDO takes copy plan, when it is mapped.
  * @param SYNC void pointer to SYNC object or NULL.
  * @param operatingState Pointer to variable indicating CANopen device NMT internal state.
  * @param nodeId CANopen Node ID of this device. If default COB_ID is used, value will be added.
@@ -349,6 +841,7 @@ CO_ReturnError_t CO_TPDO_init(
         CO_TPDO_t              *TPDO,
         CO_EM_t                *em,
         CO_SDO_t               *SDO,
+        CO_TPDOplanPool_t      *planPool,
 #if ((CO_CONFIG_PDO) & CO_CONFIG_PDO_SYNC_ENABLE) || defined CO_DOXYGEN
         CO_SYNC_t              *SYNC,
 #endif
@@ -372,7 +865,8 @@ CO_ReturnError_t CO_TPDO_init(
  * #CO_SDO_OD_attributes_t.
  *
  * Function may be called by application just before CO_TPDO_process() function,
- * for example: `TPDOx->sendRequest = CO_TPDOisCOS(TPDOx); CO_TPDO_process(TPDOx, ....`
+ * for example: `TPDOx->sendRequest = CO_TPDOisCOS(TPDOx); CO_TPDO_process(TPDOx, ...`.
+ * CO_TPDOsched_process() calls it for all valid TPDOs.
  *
  * @param TPDO TPDO object.
  *
@@ -395,6 +889,47 @@ uint8_t CO_TPDOisCOS(CO_TPDO_t *TPDO);
 int16_t CO_TPDOsend(CO_TPDO_t *TPDO);
 
 
+#if ((CO_CONFIG_PDO) & CO_CONFIG_PDO_MPDO) || defined CO_DOXYGEN
+/**
+ * Initialize TPDO as MPDO producer.
+ *
+ * TPDO sends MPDOs, if its _numberOfMappedObjects_ is #CO_PDO_MPDO_SAM or
+ * #CO_PDO_MPDO_DAM. On each transmission by its transmission type, SAM MPDO
+ * sends the next object from scanner, DAM MPDO sends the first mapped object
+ * to destNodeId.
+ *
+ * @param TPDO This object.
+ * @param scanner Object scanner list, used in source address mode.
+ * @param scannerCount Number of entries in scanner.
+ * @param destNodeId Node-ID of consumer in destination address mode, 0 for
+ * all nodes.
+ */
+void CO_TPDO_initMPDO(
+        CO_TPDO_t              *TPDO,
+        const uint32_t         *scanner,
+        uint8_t                 scannerCount,
+        uint8_t                 destNodeId);
+
+
+/**
+ * Send one object with SAM MPDO now.
+ *
+ * Used for sparse updates of objects, which are in object scanner list. It
+ * must be called from the same thread as CO_TPDOsched_process(), because it
+ * uses CAN transmit buffer of the TPDO. Inhibit time is not checked.
+ *
+ * @param TPDO TPDO object, SAM MPDO producer.
+ * @param index Index of object.
+ * @param subIndex Subindex of object.
+ *
+ * @return CO_ERROR_NO, CO_ERROR_ILLEGAL_ARGUMENT, if TPDO is not SAM MPDO or
+ * object is not in scanner list, CO_ERROR_WRONG_NMT_STATE, if TPDO is not
+ * valid or not operational, or same as CO_CANsend().
+ */
+CO_ReturnError_t CO_TPDO_sendMPDO(CO_TPDO_t *TPDO, uint16_t index, uint8_t subIndex);
+#endif
+
+
 /**
  * Process received PDO messages.
  *
@@ -409,23 +944,171 @@ void CO_RPDO_process(CO_RPDO_t *RPDO, bool_t syncWas);
 
 
 /**
- * Process transmitting PDO messages.
+ * Initialize RPDO scheduler.
+ *
+ * Function must be called in the communication reset section, after all
+ * RPDO objects are initialized.
+ *
+ * @param sched This object will be initialized.
+ * @param RPDO Array of pointers to RPDO objects.
+ * @param pending Array of CO_RPDO_PENDING_WORDS(count) elements.
+ * @param received Array of CO_RPDO_PENDING_WORDS(count) elements.
+ * @param heap Array of count elements, used for heap.
+ * @param count Number of RPDO objects.
+ */
+void CO_RPDOsched_init(
+        CO_RPDOsched_t         *sched,
+        CO_RPDO_t             **RPDO,
+        uint32_t               *pending,
+        uint32_t               *received,
+        uint16_t               *heap,
+        uint16_t                count);
+
+
+/**
+ * Process RPDO objects with received message.
+ *
+ * Function must be called cyclically in any NMT state. It calls
+ * CO_RPDO_process() only for RPDOs marked in pending bitmap. Synchronous
+ * RPDO stays marked until it is processed after SYNC.
+ *
+ * In NMT operational it also monitors reception deadlines. If RPDO misses its
+ * deadline, CO_EM_RPDO_TIME_OUT is reported. Error is reset, when all timed out
+ * RPDOs are received again.
+ *
+ * @param sched This object.
+ * @param syncWas True, if CANopen SYNC message was just received or transmitted.
+ * @param timeDifference_us Time difference from previous function call in [microseconds].
+ * @param [out] timerNext_us info to OS - time until earliest reception
+ * deadline, see CO_process().
+ */
+void CO_RPDOsched_process(
+        CO_RPDOsched_t         *sched,
+        bool_t                  syncWas,
+        uint32_t                timeDifference_us,
+        uint32_t               *timerNext_us);
+
+
+/**
+ * Stage new RPDO mapping, which is applied without disabling the RPDO.
+ *
+ * Function verifies mapping and builds copy plan in staging slot of the
+ * scheduler, off to the side. CO_RPDOsched_process() then swaps it in:
+ * synchronous RPDO at next SYNC, after messages received with old mapping are
+ * processed, other RPDO at next call. Mapping parameters in Object Dictionary
+ * are updated at the same time. CAN receive function is not stopped: it
+ * switches to the shadow by one pointer, while the RPDO takes over the new
+ * mapping, and back.
+ *
+ * Function may be called from mainline. Slot is shared by all RPDOs of the
+ * scheduler, so only one mapping may be staged at a time. Mapping is rarely
+ * changed, while one staging object per RPDO would take its size again.
+ *
+ * @param sched RPDO scheduler.
+ * @param index Index of RPDO in sched.
+ * @param map Array of noOfMappedObjects mapping entries, same as
+ * _RPDO mapping parameter_ (index 0x1600+, subindex 1...8).
+ * @param noOfMappedObjects Number of mapped objects, 1 to 8, or
+ * #CO_PDO_MPDO_SAM or #CO_PDO_MPDO_DAM, which use at most map[0].
+ *
+ * @return 0 on success, otherwise SDO abort code. CO_SDO_AB_DATA_DEV_STATE,
+ * if other mapping is still staged.
+ */
+CO_SDO_abortCode_t CO_RPDOsched_stageMap(
+        CO_RPDOsched_t         *sched,
+        uint16_t                index,
+        const uint32_t         *map,
+        uint8_t                 noOfMappedObjects);
+
+
+/**
+ * Process transmitting PDO message.
  *
- * Function must be called cyclically in any NMT state. It prepares and sends
- * TPDO if necessary. If Change of State needs to be detected, function
+ * Function prepares and sends TPDO if necessary and updates its position in
+ * scheduler. It is called from CO_TPDOsched_process() for TPDOs, which need
+ * processing. If Change of State needs to be detected, function
  * CO_TPDOisCOS() must be called before.
  *
  * @param TPDO This object.
  * @param syncWas True, if CANopen SYNC message was just received or transmitted.
+ */
+void CO_TPDO_process(CO_TPDO_t *TPDO, bool_t syncWas);
+
+
+/**
+ * Initialize TPDO scheduler.
+ *
+ * Function must be called in the communication reset section, after all
+ * TPDO objects are initialized.
+ *
+ * @param sched This object will be initialized.
+ * @param TPDO Array of pointers to TPDO objects.
+ * @param heap Array of count elements, used for heap.
+ * @param active Array of count elements, used for list of valid TPDOs.
+ * @param sync Array of count elements, used for list of valid synchronous
+ * TPDOs. Not used, if SYNC is disabled.
+ * @param syncDue Array of count elements, used for list of synchronous TPDOs
+ * staged for next SYNC. Not used, if SYNC is disabled.
+ * @param burst Array of count elements, used for CAN transmit buffers sent on
+ * SYNC. Not used, if SYNC is disabled.
+ * @param count Number of TPDO objects.
+ */
+void CO_TPDOsched_init(
+        CO_TPDOsched_t         *sched,
+        CO_TPDO_t             **TPDO,
+        uint16_t               *heap,
+        uint16_t               *active,
+        uint16_t               *sync,
+        uint16_t               *syncDue,
+        CO_CANtx_t            **burst,
+        uint16_t                count);
+
+
+/**
+ * Process all TPDO objects.
+ *
+ * Function must be called cyclically in any NMT state. For valid TPDOs it
+ * detects Change of State and processes TPDOs with send request and
+ * synchronous TPDOs after SYNC. Synchronous TPDOs are sent first, in one
+ * burst. It also processes TPDOs from heap, which inhibit time or event timer
+ * expired. Invalid TPDOs and timers of other TPDOs are not touched.
+ *
+ * @param sched This object.
+ * @param syncWas True, if CANopen SYNC message was just received or transmitted.
  * @param timeDifference_us Time difference from previous function call in [microseconds].
- * @param [out] timerNext_us info to OS - see CO_process_SYNC_PDO().
+ * @param [out] timerNext_us info to OS - time until earliest deadline in heap,
+ * see CO_process().
  */
-void CO_TPDO_process(
-        CO_TPDO_t              *TPDO,
+void CO_TPDOsched_process(
+        CO_TPDOsched_t         *sched,
         bool_t                  syncWas,
         uint32_t                timeDifference_us,
         uint32_t               *timerNext_us);
 
+
+/**
+ * Stage new TPDO mapping, which is applied without disabling the TPDO.
+ *
+ * Same as CO_RPDOsched_stageMap(). CO_TPDOsched_process() swaps mapping in,
+ * synchronous TPDO at next SYNC, other TPDO at next call, before TPDOs are
+ * sent. It also updates data length of CAN message.
+ *
+ * @param sched TPDO scheduler.
+ * @param index Index of TPDO in sched.
+ * @param map Array of noOfMappedObjects mapping entries, same as
+ * _TPDO mapping parameter_ (index 0x1A00+, subindex 1...8).
+ * @param noOfMappedObjects Number of mapped objects, 1 to 8, or
+ * #CO_PDO_MPDO_SAM or #CO_PDO_MPDO_DAM, which use at most map[0].
+ *
+ * @return 0 on success, otherwise SDO abort code. CO_SDO_AB_DATA_DEV_STATE,
+ * if other mapping is still staged.
+ */
+CO_SDO_abortCode_t CO_TPDOsched_stageMap(
+        CO_TPDOsched_t         *sched,
+        uint16_t                index,
+        const uint32_t         *map,
+        uint8_t                 noOfMappedObjects);
+
 #ifdef __cplusplus
 }
 #endif /*__cplusplus*/
@@ -43,6 +43,11 @@
 #error CO_CONFIG_SDO_BLOCK is enabled, CO_CONFIG_SDO_SEGMENTED must be enabled also.
 #endif
 
+/* Object dictionary index, see CO_OD_initIndex() */
+#define CO_OD_INDEX_BUCKET_MAX 8U   /* maximum number of objects in one bucket */
+#define CO_OD_INDEX_SEEDS 32U       /* number of hash seeds tried */
+#define CO_OD_INDEX_PLACED 0x8000U  /* bucket is placed, used while building */
+
 static void CO_SDO_receive_done(CO_SDO_t *SDO)
 {
 #if CO_SDO_RX_DATA_SIZE > 1
@@ -211,6 +216,9 @@ CO_ReturnError_t CO_SDO_init(
         SDO->OD = OD;
         SDO->ODSize = ODSize;
         SDO->ODExtensions = ODExtensions;
+        SDO->ODindex = NULL;
+        SDO->ODdesc = NULL;
+        SDO->ODdescFirst = NULL;
 
         /* clear pointers in ODExtensions */
         for (i = 0U; i < ODSize; i++)
@@ -227,6 +235,9 @@ CO_ReturnError_t CO_SDO_init(
         SDO->OD = parentSDO->OD;
         SDO->ODSize = parentSDO->ODSize;
         SDO->ODExtensions = parentSDO->ODExtensions;
+        SDO->ODindex = parentSDO->ODindex;
+        SDO->ODdesc = parentSDO->ODdesc;
+        SDO->ODdescFirst = parentSDO->ODdescFirst;
     }
 
     /* Configure object variables */
@@ -337,11 +348,206 @@ void CO_OD_configure(
     }
 }
 
+/* Hash of Object dictionary index. Upper half selects bucket, lower half slot. */
+static inline uint32_t CO_OD_hash(uint16_t index, uint32_t seed)
+{
+    uint32_t h = ((uint32_t)index ^ seed) * 0x9E3779B1UL;
+
+    return h ^ (h >> 16);
+}
+
+/*
+ * Try to build Object dictionary index with ODindex->seed.
+ *
+ * Largest buckets are placed first. For each bucket the smallest displacement
+ * is searched, which moves all its objects to free slots.
+ *
+ * @return true on success. If false and *duplicate is true, Object dictionary
+ * contains the same index twice, otherwise other seed may be tried.
+ */
+static bool_t CO_OD_buildIndex(CO_SDO_t *SDO, CO_OD_index_t *ODindex, bool_t *duplicate)
+{
+    uint16_t *slot = ODindex->slot;
+    uint16_t *disp = ODindex->disp;
+    uint16_t i, b, size;
+    uint16_t maxSize = 0U;
+
+    for (i = 0U; i < ODindex->slotCount; i++)
+    {
+        slot[i] = 0xFFFFU;
+    }
+    for (b = 0U; b < ODindex->bucketCount; b++)
+    {
+        disp[b] = 0U;
+    }
+
+    /* count objects in each bucket */
+    for (i = 0U; i < SDO->ODSize; i++)
+    {
+        b = (CO_OD_hash(SDO->OD[i].index, ODindex->seed) >> 16) % ODindex->bucketCount;
+        if (++disp[b] > CO_OD_INDEX_BUCKET_MAX)
+        {
+            return false;
+        }
+        if (disp[b] > maxSize)
+        {
+            maxSize = disp[b];
+        }
+    }
+
+    for (size = maxSize; size > 0U; size--)
+    {
+        for (b = 0U; b < ODindex->bucketCount; b++)
+        {
+            uint16_t pos[CO_OD_INDEX_BUCKET_MAX];
+            uint16_t entryNo[CO_OD_INDEX_BUCKET_MAX];
+            uint16_t n = 0U;
+            uint16_t d, k, j;
+
+            /* placed buckets are marked, so they do not match */
+            if (disp[b] != size)
+            {
+                continue;
+            }
+
+            for (i = 0U; i < SDO->ODSize && n < size; i++)
+            {
+                uint32_t h = CO_OD_hash(SDO->OD[i].index, ODindex->seed);
+
+                if ((h >> 16) % ODindex->bucketCount != b)
+                {
+                    continue;
+                }
+                for (j = 0U; j < n; j++)
+                {
+                    if (SDO->OD[entryNo[j]].index == SDO->OD[i].index)
+                    {
+                        *duplicate = true;
+                        return false;
+                    }
+                }
+                pos[n] = (uint16_t)((h & 0xFFFFU) % ODindex->slotCount);
+                entryNo[n++] = i;
+            }
+
+            /* smallest displacement, which gives free and distinct slots */
+            for (d = 0U; d < ODindex->slotCount; d++)
+            {
+                for (k = 0U; k < n; k++)
+                {
+                    uint16_t s = (pos[k] + d) % ODindex->slotCount;
+
+                    if (slot[s] != 0xFFFFU)
+                    {
+                        break;
+                    }
+                    for (j = 0U; j < k; j++)
+                    {
+                        if (pos[j] == pos[k])
+                        {
+                            break;
+                        }
+                    }
+                    if (j < k)
+                    {
+                        break;
+                    }
+                }
+                if (k == n)
+                {
+                    break;
+                }
+            }
+            if (d == ODindex->slotCount)
+            {
+                return false;
+            }
+
+            for (k = 0U; k < n; k++)
+            {
+                slot[(pos[k] + d) % ODindex->slotCount] = entryNo[k];
+            }
+            disp[b] = CO_OD_INDEX_PLACED | d;
+        }
+    }
+
+    for (b = 0U; b < ODindex->bucketCount; b++)
+    {
+        disp[b] &= ~CO_OD_INDEX_PLACED;
+    }
+
+    return true;
+}
+
 /******************************************************************************/
-uint16_t CO_OD_find(CO_SDO_t *SDO, uint16_t index)
+CO_ReturnError_t CO_OD_initIndex(
+    CO_SDO_t *SDO,
+    CO_OD_index_t *ODindex,
+    uint16_t *slot,
+    uint16_t *disp)
+{
+    uint32_t seed;
+
+    /* verify arguments, displacement must fit below CO_OD_INDEX_PLACED */
+    if (SDO == NULL || ODindex == NULL || slot == NULL || disp == NULL ||
+        !SDO->ownOD || SDO->ODSize == 0U || SDO->ODSize >= (CO_OD_INDEX_PLACED / 2U))
+    {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    SDO->ODindex = NULL;
+    ODindex->slot = slot;
+    ODindex->disp = disp;
+    /* 0xFFFF is not valid index, so empty cache never matches */
+    ODindex->lastHit = 0xFFFFFFFFUL;
+
+    /* small Object dictionary: binary search, which needs sorted indexes */
+    if (SDO->ODSize < CO_CONFIG_OD_INDEX_MIN)
+    {
+        uint16_t i;
+
+        for (i = 1U; i < SDO->ODSize; i++)
+        {
+            if (SDO->OD[i].index <= SDO->OD[i - 1U].index)
+            {
+                return CO_ERROR_PARAMETERS;
+            }
+        }
+        ODindex->slotCount = 0U;
+        ODindex->bucketCount = 0U;
+        ODindex->seed = 0U;
+        SDO->ODindex = ODindex;
+        return CO_ERROR_NO;
+    }
+
+    ODindex->slotCount = CO_OD_INDEX_SLOTS(SDO->ODSize);
+    ODindex->bucketCount = CO_OD_INDEX_BUCKETS(SDO->ODSize);
+
+    for (seed = 0U; seed < CO_OD_INDEX_SEEDS; seed++)
+    {
+        bool_t duplicate = false;
+
+        ODindex->seed = seed * 0x85EBCA6BUL;
+        if (CO_OD_buildIndex(SDO, ODindex, &duplicate))
+        {
+            SDO->ODindex = ODindex;
+            return CO_ERROR_NO;
+        }
+        if (duplicate)
+        {
+            break;
+        }
+    }
+
+    return CO_ERROR_PARAMETERS;
+}
+
+/*
+ * Binary search in ordered Object Dictionary. If indexes are mixed, this won't work.
+ * If Object Dictionary has up to 2^N entries, then N is max number of loop passes.
+ */
+static uint16_t CO_OD_search(CO_SDO_t *SDO, uint16_t index)
 {
-    /* Fast search in ordered Object Dictionary. If indexes are mixed, this won't work. */
-    /* If Object Dictionary has up to 2^N entries, then N is max number of loop passes. */
     uint16_t cur, min, max;
     const CO_OD_entry_t *object;
 
@@ -379,6 +585,90 @@ uint16_t CO_OD_find(CO_SDO_t *SDO, uint16_t index)
     return 0xFFFFU; /* object does not exist in OD */
 }
 
+/******************************************************************************/
+uint16_t CO_OD_find(CO_SDO_t *SDO, uint16_t index)
+{
+    CO_OD_index_t *ODindex = SDO->ODindex;
+    uint32_t lastHit;
+    uint16_t entryNo;
+
+    if (ODindex == NULL)
+    {
+        return CO_OD_search(SDO, index);
+    }
+
+    lastHit = ODindex->lastHit;
+    if ((uint16_t)(lastHit >> 16) == index)
+    {
+        return (uint16_t)lastHit;
+    }
+
+    if (ODindex->slotCount != 0U)
+    {
+        uint32_t h = CO_OD_hash(index, ODindex->seed);
+
+        entryNo = ODindex->slot[((h & 0xFFFFU) + ODindex->disp[(h >> 16) % ODindex->bucketCount]) % ODindex->slotCount];
+        if (entryNo == 0xFFFFU || SDO->OD[entryNo].index != index)
+        {
+            return 0xFFFFU; /* object does not exist in OD */
+        }
+    }
+    else
+    {
+        entryNo = CO_OD_search(SDO, index);
+        if (entryNo == 0xFFFFU)
+        {
+            return 0xFFFFU;
+        }
+    }
+
+    ODindex->lastHit = ((uint32_t)index << 16) | entryNo;
+    return entryNo;
+}
+
+/******************************************************************************/
+CO_ReturnError_t CO_OD_initDesc(
+    CO_SDO_t *SDO,
+    const CO_OD_desc_t *desc,
+    const uint16_t *descFirst)
+{
+    uint16_t i;
+
+    /* verify arguments */
+    if (SDO == NULL || desc == NULL || descFirst == NULL || !SDO->ownOD)
+    {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    /* compare each descriptor with decoded OD entry */
+    SDO->ODdesc = NULL;
+    SDO->ODdescFirst = NULL;
+    for (i = 0U; i < SDO->ODSize; i++)
+    {
+        uint16_t sub;
+
+        if ((uint16_t)(descFirst[i + 1U] - descFirst[i]) != (uint16_t)SDO->OD[i].maxSubIndex + 1U)
+        {
+            return CO_ERROR_PARAMETERS;
+        }
+        for (sub = 0U; sub <= SDO->OD[i].maxSubIndex; sub++)
+        {
+            const CO_OD_desc_t *d = &desc[descFirst[i] + sub];
+
+            if (d->pData != CO_OD_getDataPointer(SDO, i, (uint8_t)sub) ||
+                d->attribute != CO_OD_getAttribute(SDO, i, (uint8_t)sub) ||
+                d->length != CO_OD_getLength(SDO, i, (uint8_t)sub))
+            {
+                return CO_ERROR_PARAMETERS;
+            }
+        }
+    }
+
+    SDO->ODdesc = desc;
+    SDO->ODdescFirst = descFirst;
+    return CO_ERROR_NO;
+}
+
 /******************************************************************************/
 uint16_t CO_OD_getLength(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex)
 {
@@ -389,6 +679,13 @@ uint16_t CO_OD_getLength(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex)
         return 0U;
     }
 
+    if (SDO->ODdesc != NULL)
+    {
+        uint16_t desc = SDO->ODdescFirst[entryNo] + subIndex;
+
+        return (desc < SDO->ODdescFirst[entryNo + 1U]) ? SDO->ODdesc[desc].length : 0U;
+    }
+
     if (object->maxSubIndex == 0U)
     { /* Object type is Var */
         if (object->pData == 0)
@@ -440,6 +737,13 @@ uint16_t CO_OD_getAttribute(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex)
         return 0U;
     }
 
+    if (SDO->ODdesc != NULL)
+    {
+        uint16_t desc = SDO->ODdescFirst[entryNo] + subIndex;
+
+        return (desc < SDO->ODdescFirst[entryNo + 1U]) ? SDO->ODdesc[desc].attribute : 0U;
+    }
+
     if (object->maxSubIndex == 0U)
     { /* Object type is Var */
         return object->attribute;
@@ -480,6 +784,13 @@ void *CO_OD_getDataPointer(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex)
         return 0;
     }
 
+    if (SDO->ODdesc != NULL)
+    {
+        uint16_t desc = SDO->ODdescFirst[entryNo] + subIndex;
+
+        return (desc < SDO->ODdescFirst[entryNo + 1U]) ? SDO->ODdesc[desc].pData : 0;
+    }
+
     if (object->maxSubIndex == 0U)
     { /* Object type is Var */
         return object->pData;
@@ -770,6 +1081,112 @@ static void CO_SDO_process_done(CO_SDO_t *SDO, uint32_t *timerNext_us)
 #endif
 }
 
+#if (CO_CONFIG_SDO) & CO_CONFIG_SDO_EXPEDITED_FAST
+/*
+ * Expedited upload or download of object, which is 1 to 4 bytes long and has
+ * no Object Dictionary function. Data are copied directly between Object
+ * Dictionary and CAN message, ODF_arg is not used.
+ *
+ * Returns true, if response is ready in CANtxBuff. Returns false, if object
+ * is not eligible or request is erroneous. In that case normal path must
+ * process the request and generate abort message, if necessary.
+ */
+static bool_t CO_SDO_expedited(CO_SDO_t *SDO, const uint8_t *CANrxData)
+{
+    uint8_t CCS = CANrxData[0] >> 5;
+    uint8_t subIndex = CANrxData[3];
+    uint16_t index, entryNo, length, attribute;
+    uint8_t *ODdata, *CANdata = &SDO->CANtxBuff->data[4];
+
+    /* only expedited download with indicated or known size and initiate upload */
+    if (!((CCS == CCS_UPLOAD_INITIATE) ||
+          ((CCS == CCS_DOWNLOAD_INITIATE) && ((CANrxData[0] & 0x02U) != 0U))))
+    {
+        return false;
+    }
+
+    index = CANrxData[2];
+    index = index << 8 | CANrxData[1];
+    entryNo = CO_OD_find(SDO, index);
+    if ((entryNo == 0xFFFFU) || (subIndex > SDO->OD[entryNo].maxSubIndex))
+    {
+        return false;
+    }
+    if ((SDO->ODExtensions != NULL) && (SDO->ODExtensions[entryNo].pODFunc != NULL))
+    {
+        return false;
+    }
+
+    /* domain and objects longer than 4 bytes are not eligible */
+    ODdata = (uint8_t *)CO_OD_getDataPointer(SDO, entryNo, subIndex);
+    length = CO_OD_getLength(SDO, entryNo, subIndex);
+    if ((ODdata == NULL) || (length == 0U) || (length > 4U))
+    {
+        return false;
+    }
+    attribute = CO_OD_getAttribute(SDO, entryNo, subIndex);
+
+    if (CCS == CCS_UPLOAD_INITIATE)
+    {
+        if ((attribute & CO_ODA_READABLE) == 0U)
+        {
+            return false;
+        }
+        SDO->CANtxBuff->data[0] = 0x43U | ((4U - length) << 2U);
+    }
+    else
+    {
+        /* verify length, if size is indicated */
+        if (((attribute & CO_ODA_WRITEABLE) == 0U) ||
+            (((CANrxData[0] & 0x01U) != 0U) && ((4U - ((CANrxData[0] >> 2U) & 0x03U)) != length)))
+        {
+            return false;
+        }
+        /* Special exception: 1003,00 is writable from network, but not in OD */
+        if ((index == 0x1003) && (subIndex == 0U))
+        {
+            return false;
+        }
+        SDO->CANtxBuff->data[0] = 0x60U;
+    }
+    SDO->CANtxBuff->data[1] = CANrxData[1];
+    SDO->CANtxBuff->data[2] = CANrxData[2];
+    SDO->CANtxBuff->data[3] = subIndex;
+
+    CO_LOCK_OD();
+#ifdef CO_BIG_ENDIAN
+    /* swap data if processor is not little endian (CANopen is) */
+    if ((attribute & CO_ODA_MB_VALUE) != 0)
+    {
+        uint16_t i;
+
+        for (i = 0U; i < length; i++)
+        {
+            if (CCS == CCS_UPLOAD_INITIATE)
+                CANdata[i] = ODdata[length - 1U - i];
+            else
+                ODdata[length - 1U - i] = CANrxData[4U + i];
+        }
+    }
+    else
+#endif
+    if (CCS == CCS_UPLOAD_INITIATE)
+    {
+        memcpy(CANdata, ODdata, length);
+    }
+    else
+    {
+        memcpy(ODdata, &CANrxData[4], length);
+    }
+    CO_UNLOCK_OD();
+
+    SDO->ODF_arg.index = index;
+    SDO->ODF_arg.subIndex = subIndex;
+    SDO->entryNo = entryNo;
+    return true;
+}
+#endif
+
 /******************************************************************************/
 static void CO_SDO_abort(CO_SDO_t *SDO, uint32_t code)
 {
@@ -856,6 +1273,20 @@ int8_t CO_SDO_process(
                 return -1;
             }
 
+#if (CO_CONFIG_SDO) & CO_CONFIG_SDO_EXPEDITED_FAST
+            /* small object without Object Dictionary function, respond directly */
+            if (CO_SDO_expedited(SDO, CANrxData))
+            {
+                CO_SDO_process_done(SDO, timerNext_us);
+                CO_CANsend(SDO->CANdevTx, SDO->CANtxBuff);
+#if (CO_CONFIG_SDO) & CO_CONFIG_FLAG_TIMERNEXT
+                if (timerNext_us != NULL)
+                    *timerNext_us = 0;
+#endif
+                return 0;
+            }
+#endif
+
             /* init ODF_arg */
             index = CANrxData[2];
             index = index << 8 | CANrxData[1];
@@ -441,7 +441,9 @@ typedef enum{
  * \endcode
  *
  * Be aware that accessing the OD directly using CO_OD.h files is more CPU
- * efficient as CO_OD_find() has to do a search everytime it is called.
+ * efficient as CO_OD_find() has to do a search everytime it is called. With
+ * index from CO_OD_initIndex() the search is one hash lookup and Object
+ * dictionary does not need to be sorted.
  *
  */
 
@@ -482,6 +484,10 @@ typedef enum{
  *     data, which are longer than #CO_CONFIG_SDO_BUFFER_SIZE. In that case
  *     Object dictionary function is called multiple times between SDO transfer.
  *
+ * ####Locking
+ *     Function is called with CO_LOCK_OD() held. SYNC/PDO processing may wait
+ *     for the lock, so function must be short and must not block.
+ *
  * ####Parameter to function:
  *     ODF_arg     - Pointer to CO_ODF_arg_t object filled before function call.
  *
@@ -660,6 +666,23 @@ typedef struct{
 }CO_OD_entryRecord_t;
 
 
+/**
+ * Descriptor of one subindex in flat Object dictionary descriptor table.
+ *
+ * Table has one descriptor for each index and subindex, in order of
+ * @ref CO_SDO_objectDictionary. It is generated from CO_OD.c by
+ * tools/od_desc.py into CO_OD_desc.c, see CO_OD_initDesc().
+ */
+typedef struct{
+    /** Pointer to data, same as from CO_OD_getDataPointer() */
+    void               *pData;
+    /** Attribute, same as from CO_OD_getAttribute() */
+    uint16_t            attribute;
+    /** Length, same as from CO_OD_getLength() */
+    uint16_t            length;
+}CO_OD_desc_t;
+
+
 /**
  * Object contains all information about the object being transferred by SDO server.
  *
@@ -729,6 +752,44 @@ typedef struct{
 }CO_OD_extension_t;
 
 
+/** Number of slots in #CO_OD_index_t for Object dictionary with ODSize
+entries, one unused slot below #CO_CONFIG_OD_INDEX_MIN */
+#define CO_OD_INDEX_SLOTS(ODSize) \
+    ((ODSize) >= CO_CONFIG_OD_INDEX_MIN ? 2U * (ODSize) : 1U)
+/** Number of buckets in #CO_OD_index_t for Object dictionary with ODSize
+entries, one unused bucket below #CO_CONFIG_OD_INDEX_MIN */
+#define CO_OD_INDEX_BUCKETS(ODSize) \
+    ((ODSize) >= CO_CONFIG_OD_INDEX_MIN ? (ODSize) / 2U + 1U : 1U)
+
+
+/**
+ * Index of Object dictionary, used by CO_OD_find().
+ *
+ * Perfect hash, built once by CO_OD_initIndex(). Index of object is hashed to
+ * a bucket and to a position. Displacement of the bucket moves positions of
+ * all its objects to free slots, so each object has own slot and lookup is
+ * one hash and one compare.
+ *
+ * Object dictionary smaller than #CO_CONFIG_OD_INDEX_MIN has no hash. It is
+ * verified to be sorted, searched binary and only lastHit is used.
+ */
+typedef struct{
+    /** Array of CO_OD_INDEX_SLOTS() sequence numbers of OD entries, 0xFFFF if slot is empty */
+    uint16_t           *slot;
+    /** Array of CO_OD_INDEX_BUCKETS() displacements */
+    uint16_t           *disp;
+    /** Number of elements in slot, 0 if there is no hash */
+    uint16_t            slotCount;
+    /** Number of elements in disp */
+    uint16_t            bucketCount;
+    /** Hash seed, for which there are no collisions */
+    uint32_t            seed;
+    /** Last found object, (index << 16) | entryNo. It is a single word, so it
+    is consistent, if CO_OD_find() is called from different threads. */
+    volatile uint32_t   lastHit;
+}CO_OD_index_t;
+
+
 /**
  * SDO server object.
  */
@@ -746,6 +807,14 @@ typedef struct{
     /** Pointer to array of CO_OD_extension_t objects. Size of the array is
     equal to ODSize. */
     CO_OD_extension_t  *ODExtensions;
+    /** From CO_OD_initIndex() or from parent SDO. If NULL, CO_OD_find() uses
+    binary search in sorted Object dictionary. */
+    CO_OD_index_t      *ODindex;
+    /** From CO_OD_initDesc() or from parent SDO. If NULL, CO_OD_getLength(),
+    CO_OD_getAttribute() and CO_OD_getDataPointer() decode the OD entry. */
+    const CO_OD_desc_t *ODdesc;
+    /** From CO_OD_initDesc(), first descriptor of each OD entry */
+    const uint16_t     *ODdescFirst;
     /** Offset in buffer of next data segment being read/written */
     uint16_t            bufferOffset;
     /** Sequence number of OD entry as returned from CO_OD_find() */
@@ -1041,6 +1110,60 @@ void CO_OD_configure(
 uint16_t CO_OD_find(CO_SDO_t *SDO, uint16_t index);
 
 
+/**
+ * Build index of Object dictionary for CO_OD_find().
+ *
+ * Function must be called after CO_SDO_init() of SDO with own Object
+ * dictionary and before other SDO objects are initialized with it as parent,
+ * so they share the index. Index is built in CO_OD_INDEX_SLOTS(ODSize) +
+ * CO_OD_INDEX_BUCKETS(ODSize) words. Build time grows with the square of ODSize
+ * and is spent only once, at initialization.
+ *
+ * If ODSize is below #CO_CONFIG_OD_INDEX_MIN, no hash is built. Object
+ * dictionary is then verified to be sorted, CO_OD_find() uses binary search
+ * and the last found object.
+ *
+ * @param SDO SDO object with own Object dictionary.
+ * @param ODindex Index object, will be initialized.
+ * @param slot Array of CO_OD_INDEX_SLOTS(ODSize) elements.
+ * @param disp Array of CO_OD_INDEX_BUCKETS(ODSize) elements.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO, CO_ERROR_ILLEGAL_ARGUMENT or
+ * CO_ERROR_PARAMETERS, if Object dictionary contains the same index twice or
+ * if it is not sorted and has no hash.
+ */
+CO_ReturnError_t CO_OD_initIndex(
+        CO_SDO_t               *SDO,
+        CO_OD_index_t          *ODindex,
+        uint16_t               *slot,
+        uint16_t               *disp);
+
+
+/**
+ * Use flat descriptor table for Object dictionary access.
+ *
+ * With descriptor table CO_OD_getLength(), CO_OD_getAttribute() and
+ * CO_OD_getDataPointer() are single table lookups. Table is verified against
+ * Object dictionary, each descriptor must give the same result as decoding
+ * the OD entry. Function must be called after CO_SDO_init() of SDO with own
+ * Object dictionary and before other SDO objects are initialized with it as
+ * parent.
+ *
+ * @param SDO SDO object with own Object dictionary.
+ * @param desc Descriptor table, CO_OD_desc from CO_OD_desc.c.
+ * @param descFirst Array of ODSize + 1 elements, index of the first
+ * descriptor of each OD entry and end of table, CO_OD_descFirst.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO, CO_ERROR_ILLEGAL_ARGUMENT or
+ * CO_ERROR_PARAMETERS, if table does not match Object dictionary. Then table
+ * is not used.
+ */
+CO_ReturnError_t CO_OD_initDesc(
+        CO_SDO_t               *SDO,
+        const CO_OD_desc_t     *desc,
+        const uint16_t         *descFirst);
+
+
 /**
  * Get length of the given object with specific subIndex.
  *
@@ -9,13 +9,35 @@ extern "C" {
 
 #define CAN_TX_IO (22)  /** CAN TX pin */
 #define CAN_RX_IO (21) /** CAN RX pin */
-#define CAN_TX_QUEUE_LENGTH (5) /** CAN TX buffer size */
-#define CAN_RX_QUEUE_LENGTH (5) /** CAN RX buffer size */
-
-#define CO_CAN_PSEUDO_INTERRUPT_INTERVAL (1000) /** CAN "Interrupt" Interval in μs*/
-#define CO_MAIN_TASK_INTERVAL (1000)   /* Interval of tmrTask thread in microseconds */
+#define CAN_TX_QUEUE_LENGTH (5) /** CAN TX buffer size, shorter queue keeps pending messages closer to CAN-ID priority order */
+#define CAN_RX_QUEUE_LENGTH (32) /** CAN RX buffer size */
+#define CAN_USE_RX_FILTERS (1) /** Program CAN acceptance filter from registered rx buffers, 0 accepts all messages */
+
+#define CO_CAN_RX_TASK_PRIORITY (23)    /** CAN receive task priority, above esp_timer task */
+#define CO_CAN_RX_TASK_STACK_SIZE (3072) /** CAN receive task stack size in bytes */
+#define CO_CAN_RX_TASK_TIMEOUT (100)     /** CAN receive task wait in ms before module state is checked again */
+#define CO_CAN_TX_TASK_PRIORITY (23)    /** CAN transmit task priority, same as receive task */
+#define CO_CAN_TX_TASK_STACK_SIZE (2048) /** CAN transmit task stack size in bytes */
+#ifndef CO_CAN_TRACE
+#define CO_CAN_TRACE (0)                    /** 1 records every CAN frame into binary trace, printed by low priority task. 0 compiles frame logging out */
+#endif
+#define CO_CAN_TRACE_SIZE (256)              /** Number of frames in trace ring buffer, must be power of 2 */
+#define CO_CAN_TRACE_TASK_PRIORITY (1)       /** Trace print task priority, below all CANopen tasks */
+#define CO_CAN_TRACE_TASK_STACK_SIZE (3072)  /** Trace print task stack size in bytes */
+#define CO_CAN_TRACE_INTERVAL (100)          /** Trace print task period in ms */
+#define CO_CAN_SEND_STATS (0)                /** 1 measures CO_CANsend() duration into histogram, logged by mainline */
+#define CO_CAN_SEND_STATS_INTERVAL (10000)   /** CO_CANsend() duration histogram log period in ms */
+#define CO_MAIN_TASK_INTERVAL (1000)   /* Longest interval of SYNC/PDO task in microseconds, it wakes earlier for SYNC/PDO deadlines */
+#define CO_RT_TIMER_MIN (50)                 /** Shortest SYNC/PDO task timer in us, limits retries while CAN TX is full */
+#define CO_RT_CORE (1)                       /** Core running CAN rx/tx tasks and SYNC/PDO task, WiFi/LwIP stay on core 0 */
+#define CO_RT_TASK_PRIORITY (22)             /** SYNC/PDO task priority, below CAN rx/tx tasks */
+#define CO_RT_TASK_STACK_SIZE (3072)         /** SYNC/PDO task stack size in bytes */
+#define CO_MAIN_CORE (0)                     /** Core running mainline CO_process() (SDO, EMCY, HB, gateway) and application */
+#define CO_MAIN_TASK_PRIORITY (5)            /** Mainline task priority */
+#define CO_MAIN_TASK_STACK_SIZE (4096)       /** Mainline task stack size in bytes */
+#define CO_JITTER_MEASURE (0)                /** 1 records SYNC reception to last TPDO transmitted latency, percentiles logged by mainline */
+#define CO_JITTER_SAMPLES (512)              /** Number of latency samples per logged percentile set */
 
-#define CAN_TICKS_TO_WAIT (10000) /*CAN TX/RX Timeout value*/
 
 //----------------------------------
 
@@ -106,6 +128,9 @@ extern "C" {
  * - CO_CONFIG_SDO_SEGMENTED - Enable SDO server segmented transfer.
  * - CO_CONFIG_SDO_BLOCK - Enable SDO server block transfer. If set, then
  *   CO_CONFIG_SDO_SEGMENTED must also be set.
+ * - CO_CONFIG_SDO_EXPEDITED_FAST - Serve expedited upload and download of
+ *   1 to 4 byte objects without Object Dictionary function directly between
+ *   Object Dictionary and CAN message, without CO_SDO_initTransfer().
  */
 #ifdef CO_DOXYGEN
 #define CO_CONFIG_SDO (CO_CONFIG_FLAG_CALLBACK_PRE | CO_CONFIG_FLAG_TIMERNEXT | CO_CONFIG_SDO_SEGMENTED | CO_CONFIG_SDO_BLOCK)
@@ -113,6 +138,7 @@ extern "C" {
 /* TODO with new OD */
 #define CO_CONFIG_SDO_SEGMENTED 0x01
 #define CO_CONFIG_SDO_BLOCK 0x02
+#define CO_CONFIG_SDO_EXPEDITED_FAST 0x04
 
 
 /**
@@ -130,6 +156,18 @@ extern "C" {
 #endif
 
 
+/**
+ * Smallest Object dictionary, for which CO_OD_initIndex() builds a hash.
+ *
+ * Smaller Object dictionary is searched binary and needs no RAM for the hash,
+ * both use the last found object. Lookups per second of both are measured by
+ * host_test/test_od_find.c.
+ */
+#ifdef CO_DOXYGEN
+#define CO_CONFIG_OD_INDEX_MIN 64
+#endif
+
+
 /**
  * Configuration of Emergency object
  *
@@ -183,19 +221,38 @@ extern "C" {
  *   received RPDO CAN message.
  *   Callback is configured by CO_RPDO_initCallbackPre().
  * - #CO_CONFIG_FLAG_TIMERNEXT - Enable calculation of timerNext_us variable
- *   inside CO_TPDO_process().
+ *   inside CO_TPDOsched_process().
  * - CO_CONFIG_PDO_SYNC_ENABLE - Enable SYNC object inside PDO objects.
  * - CO_CONFIG_RPDO_CALLS_EXTENSION - Enable calling configured extension
  *   callbacks when received RPDO CAN message modifies OD entries.
  * - CO_CONFIG_TPDO_CALLS_EXTENSION - Enable calling configured extension
  *   callbacks before TPDO CAN message is sent.
+ * - CO_CONFIG_RPDO_CALLBACK_RX - Enable application callback, which receives
+ *   RPDO data directly from CAN receive function.
+ *   Callback is configured by CO_RPDO_initCallbackRx().
+ * - CO_CONFIG_PDO_MPDO - Enable multiplexed PDOs in source and destination
+ *   address mode, with object scanner and object dispatcher lists.
  */
 #ifdef CO_DOXYGEN
-#define CO_CONFIG_PDO (CO_CONFIG_FLAG_CALLBACK_PRE | CO_CONFIG_FLAG_TIMERNEXT | CO_CONFIG_PDO_SYNC_ENABLE | CO_CONFIG_RPDO_CALLS_EXTENSION | CO_CONFIG_TPDO_CALLS_EXTENSION)
+#define CO_CONFIG_PDO (CO_CONFIG_FLAG_CALLBACK_PRE | CO_CONFIG_FLAG_TIMERNEXT | CO_CONFIG_PDO_SYNC_ENABLE | CO_CONFIG_RPDO_CALLS_EXTENSION | CO_CONFIG_TPDO_CALLS_EXTENSION | CO_CONFIG_RPDO_CALLBACK_RX | CO_CONFIG_PDO_MPDO)
 #endif
 #define CO_CONFIG_PDO_SYNC_ENABLE 0x01
 #define CO_CONFIG_RPDO_CALLS_EXTENSION 0x02
 #define CO_CONFIG_TPDO_CALLS_EXTENSION 0x04
+#define CO_CONFIG_RPDO_CALLBACK_RX 0x08
+#define CO_CONFIG_PDO_MPDO 0x10
+
+
+/**
+ * Number of entries in queue of received MPDO objects of each RPDO.
+ *
+ * CAN receive function queues received objects, CO_RPDO_process() writes them
+ * into Object Dictionary. One entry is always free, objects received while
+ * queue is full are lost, see CO_RPDO_t::MPDOlost.
+ */
+#ifdef CO_DOXYGEN
+#define CO_CONFIG_PDO_MPDO_QUEUE 8
+#endif
 
 
 /**
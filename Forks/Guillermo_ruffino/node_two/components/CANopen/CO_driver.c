@@ -29,18 +29,485 @@
 #include "CO_config.h"
 
 #include "esp_log.h"
+#include "esp_timer.h"
+#include <string.h>
 
 #define CO_DRIVER_TAG "co-driver"
 
-static const can_general_config_t g_config =
+static can_general_config_t g_config =
     CAN_GENERAL_CONFIG_DEFAULT(CAN_TX_IO, CAN_RX_IO, CAN_MODE_NORMAL);
 static const can_timing_config_t t_config = CAN_TIMING_CONFIG_125KBITS();
-static const can_filter_config_t f_config = CAN_FILTER_CONFIG_ACCEPT_ALL();
+static can_filter_config_t f_config = CAN_FILTER_CONFIG_ACCEPT_ALL();
+
+/* Critical section locks, see CO_LOCK_* in CO_driver_target.h */
+portMUX_TYPE CO_CANsendMux = portMUX_INITIALIZER_UNLOCKED;
+portMUX_TYPE CO_EMCYmux = portMUX_INITIALIZER_UNLOCKED;
+SemaphoreHandle_t CO_ODmutex = NULL;
+
+static CO_CANmodule_t *CANmodulePointer = NULL;
+/* CAN receive task handle, NULL if task is not running */
+static TaskHandle_t CO_CANrxTaskHandle = NULL;
+/* CAN transmit task handle, NULL if task is not running */
+static TaskHandle_t CO_CANtxTaskHandle = NULL;
+/* True, if esp can driver is installed */
+static bool_t CO_CANdriverInstalled = false;
+
+/* Group of rx buffers, accepted by one esp can acceptance filter */
+typedef struct
+{
+  uint16_t code;     /* common identifier bits */
+  uint16_t dontCare; /* identifier bits, which differ or are masked out */
+  uint16_t count;    /* number of rx buffers in group */
+} CO_CANfilterGroup_t;
+
+/* Merge rx buffer into hardware filter group, so group accepts also its identifiers */
+static void CO_CANfilterMerge(CO_CANfilterGroup_t *group, const CO_CANrx_t *buffer)
+{
+  uint16_t bufDontCare = (uint16_t)~buffer->mask & 0x07FFU;
+
+  if (group->count == 0U)
+  {
+    group->dontCare = bufDontCare;
+  }
+  else
+  {
+    group->dontCare |= bufDontCare | ((group->code ^ buffer->ident) & 0x07FFU);
+  }
+  group->code = buffer->ident & 0x07FFU & (uint16_t)~group->dontCare;
+  group->count++;
+}
+
+/* Number of 11-bit identifiers accepted by filter group */
+static uint32_t CO_CANfilterSize(const CO_CANfilterGroup_t *group)
+{
+  return (group->count == 0U) ? 0U : (1UL << __builtin_popcount(group->dontCare));
+}
+
+/* Number of 11-bit identifiers accepted by either of two filter groups. A
+ * buffer, which doesn't care about the split bit, may widen the first group
+ * over the second one, so overlap is not counted twice. */
+static uint32_t CO_CANfilterUnionSize(const CO_CANfilterGroup_t *group0, const CO_CANfilterGroup_t *group1)
+{
+  uint32_t size = CO_CANfilterSize(group0) + CO_CANfilterSize(group1);
+
+  if ((group0->count != 0U) && (group1->count != 0U) &&
+      (((group0->code ^ group1->code) & (uint16_t)~group0->dontCare & (uint16_t)~group1->dontCare) == 0U))
+  {
+    size -= 1UL << __builtin_popcount(group0->dontCare & group1->dontCare);
+  }
+  return size;
+}
+
+/* Compute the tightest esp can acceptance filter, which accepts all configured
+ * rx buffers. Single filter is compared with dual filters, where buffers are
+ * split on each of 11 identifier bits, and the one accepting the fewest
+ * identifiers is used. RTR bit and data bytes are not filtered. Returns number
+ * of accepted 11-bit identifiers. */
+static uint32_t CO_CANfilterSetup(CO_CANmodule_t *CANmodule, can_filter_config_t *filter)
+{
+  CO_CANfilterGroup_t single = {0};
+  CO_CANfilterGroup_t best[2] = {{0}};
+  uint32_t bestSize;
+  uint16_t i;
+  uint8_t bit;
+
+  for (i = 0U; i < CANmodule->rxSize; i++)
+  {
+    if (CANmodule->rxArray[i].CANrx_callback != NULL)
+    {
+      CO_CANfilterMerge(&single, &CANmodule->rxArray[i]);
+    }
+  }
+  if (!CANmodule->useCANrxFilters || (single.count == 0U))
+  {
+    filter->acceptance_code = 0U;
+    filter->acceptance_mask = 0xFFFFFFFFU;
+    filter->single_filter = true;
+    return CO_CAN_RX_LOOKUP_SIZE;
+  }
+  bestSize = CO_CANfilterSize(&single);
+
+  for (bit = 0U; bit < 11U; bit++)
+  {
+    CO_CANfilterGroup_t split[2] = {{0}};
+    uint32_t size;
+
+    for (i = 0U; i < CANmodule->rxSize; i++)
+    {
+      const CO_CANrx_t *buffer = &CANmodule->rxArray[i];
+      if (buffer->CANrx_callback != NULL)
+      {
+        /* buffers, which don't care about the bit, go to the first filter */
+        uint8_t side = ((buffer->mask & buffer->ident) >> bit) & 1U;
+        CO_CANfilterMerge(&split[side], buffer);
+      }
+    }
+    size = CO_CANfilterUnionSize(&split[0], &split[1]);
+    if ((split[0].count != 0U) && (split[1].count != 0U) && (size < bestSize))
+    {
+      best[0] = split[0];
+      best[1] = split[1];
+      bestSize = size;
+    }
+  }
+
+  if (best[0].count == 0U)
+  {
+    /* single filter: ID in bits 31..21, RTR and data bytes don't care */
+    filter->acceptance_code = (uint32_t)single.code << 21;
+    filter->acceptance_mask = ((uint32_t)single.dontCare << 21) | 0x001FFFFFU;
+    filter->single_filter = true;
+  }
+  else
+  {
+    /* dual filter: IDs in bits 31..21 and 15..5, everything else don't care */
+    filter->acceptance_code = ((uint32_t)best[0].code << 21) | ((uint32_t)best[1].code << 5);
+    filter->acceptance_mask = ((uint32_t)best[0].dontCare << 21) | ((uint32_t)best[1].dontCare << 5) | 0x001F001FU;
+    filter->single_filter = false;
+  }
+  return bestSize;
+}
+
+/* True, if esp can acceptance filter accepts all identifiers of ident/mask pair */
+static bool_t CO_CANfilterAccepts(const can_filter_config_t *filter, uint16_t ident, uint16_t mask)
+{
+  uint16_t dontCare = (uint16_t)~mask & 0x07FFU;
+  uint16_t code = (filter->acceptance_code >> 21) & 0x07FFU;
+  uint16_t filterDontCare = (filter->acceptance_mask >> 21) & 0x07FFU;
+
+  if (((dontCare & ~filterDontCare) == 0U) && (((ident ^ code) & ~filterDontCare & 0x07FFU) == 0U))
+  {
+    return true;
+  }
+  if (!filter->single_filter)
+  {
+    code = (filter->acceptance_code >> 5) & 0x07FFU;
+    filterDontCare = (filter->acceptance_mask >> 5) & 0x07FFU;
+    if (((dontCare & ~filterDontCare) == 0U) && (((ident ^ code) & ~filterDontCare & 0x07FFU) == 0U))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+#if CO_CAN_TRACE
+/* One CAN frame in binary trace */
+typedef struct
+{
+  volatile uint32_t seq; /* sequence number + 1, written after the frame, 0 while written */
+  uint32_t timestamp;    /* esp_timer time in microseconds */
+  uint16_t ident;        /* 11-bit identifier, bit 11 set for RTR frame */
+  uint8_t tx;            /* 1 for transmitted, 0 for received frame */
+  uint8_t DLC;
+  uint8_t data[8];
+} CO_CANtraceEntry_t;
+
+/* Trace ring buffer, written without locks by CAN receive task and CO_CANsend() callers */
+static CO_CANtraceEntry_t CO_CANtraceRing[CO_CAN_TRACE_SIZE];
+static uint32_t CO_CANtraceHead = 0U;
+static TaskHandle_t CO_CANtraceTaskHandle = NULL;
+
+/* Record frame into trace. Slot is reserved atomically, so writer never blocks.
+ * If trace task falls behind, the oldest frames are overwritten. */
+static void CO_CANtrace(const can_message_t *msg, uint8_t tx)
+{
+  uint32_t seq = __atomic_fetch_add(&CO_CANtraceHead, 1U, __ATOMIC_RELAXED);
+  CO_CANtraceEntry_t *entry = &CO_CANtraceRing[seq & (CO_CAN_TRACE_SIZE - 1U)];
+
+  __atomic_store_n(&entry->seq, 0U, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  entry->timestamp = (uint32_t)esp_timer_get_time();
+  entry->ident = (uint16_t)(msg->identifier & 0x07FFU);
+  if (msg->flags & CAN_MSG_FLAG_RTR)
+  {
+    entry->ident |= 0x0800U;
+  }
+  entry->tx = tx;
+  entry->DLC = msg->data_length_code;
+  memcpy(entry->data, msg->data, sizeof(entry->data));
+  __atomic_store_n(&entry->seq, seq + 1U, __ATOMIC_RELEASE);
+}
+
+/* Trace task. Prints recorded frames with low priority, so formatting and UART
+ * output don't delay CAN processing. */
+static void CO_CANtraceTask(void *arg)
+{
+  uint32_t tail = 0U;
+
+  (void)arg;
+  for (;;)
+  {
+    uint32_t head;
+
+    vTaskDelay(pdMS_TO_TICKS(CO_CAN_TRACE_INTERVAL));
+    head = __atomic_load_n(&CO_CANtraceHead, __ATOMIC_ACQUIRE);
+    if ((head - tail) > CO_CAN_TRACE_SIZE)
+    {
+      ESP_LOGW(CO_DRIVER_TAG, "trace overrun, %u frames lost", head - tail - CO_CAN_TRACE_SIZE);
+      tail = head - CO_CAN_TRACE_SIZE;
+    }
+    while (tail != head)
+    {
+      CO_CANtraceEntry_t *slot = &CO_CANtraceRing[tail & (CO_CAN_TRACE_SIZE - 1U)];
+      CO_CANtraceEntry_t entry;
+
+      if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != (tail + 1U))
+      {
+        break; /* frame is still written, print it next time */
+      }
+      entry = *slot;
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == (tail + 1U))
+      {
+        ESP_LOGI(CO_DRIVER_TAG, "%10u %s 0x%03X%s [%d] %02X %02X %02X %02X %02X %02X %02X %02X",
+                 entry.timestamp, entry.tx ? "tx" : "rx", entry.ident & 0x07FFU, (entry.ident & 0x0800U) ? " rtr" : "",
+                 entry.DLC, entry.data[0], entry.data[1], entry.data[2], entry.data[3],
+                 entry.data[4], entry.data[5], entry.data[6], entry.data[7]);
+      }
+      tail++;
+    }
+  }
+}
+
+#define CO_CAN_TRACE_FRAME(msg, tx) CO_CANtrace((msg), (tx))
+#else
+#define CO_CAN_TRACE_FRAME(msg, tx)
+#endif /* CO_CAN_TRACE */
+
+/* CAN receive task. Blocks on the esp can RX queue and processes every
+ * received message, until CAN module leaves normal mode. */
+static void CO_CANrxTask(void *arg)
+{
+  CO_CANmodule_t *CANmodule = (CO_CANmodule_t *)arg;
+
+  while (CANmodule->CANnormal)
+  {
+    CANreceive(CANmodule);
+  }
+  CO_CANrxTaskHandle = NULL;
+  vTaskDelete(NULL);
+}
+
+#if CO_CAN_SEND_STATS
+#define CO_CAN_SEND_STATS_BINS 16U
+/* CO_CANsend() duration histogram, bin n counts durations from 2^(n-1) to 2^n - 1 us */
+static uint32_t CO_CANsendHist[CO_CAN_SEND_STATS_BINS];
+/* Longest CO_CANsend() duration in us */
+static uint32_t CO_CANsendMax = 0U;
+
+/* Add CO_CANsend() duration to histogram, callable from any context */
+static void CO_CANsendStatsAdd(uint32_t duration)
+{
+  uint32_t bin = (duration == 0U) ? 0U : (32U - (uint32_t)__builtin_clz(duration));
+  uint32_t max = __atomic_load_n(&CO_CANsendMax, __ATOMIC_RELAXED);
+
+  if (bin >= CO_CAN_SEND_STATS_BINS)
+  {
+    bin = CO_CAN_SEND_STATS_BINS - 1U;
+  }
+  __atomic_fetch_add(&CO_CANsendHist[bin], 1U, __ATOMIC_RELAXED);
+  while ((duration > max) &&
+         !__atomic_compare_exchange_n(&CO_CANsendMax, &max, duration, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+  {
+  }
+}
+
+/* Log CO_CANsend() duration histogram every CO_CAN_SEND_STATS_INTERVAL */
+static void CO_CANsendStatsLog(void)
+{
+  static int64_t lastLog = 0;
+  int64_t now = esp_timer_get_time();
+  char line[16 * CO_CAN_SEND_STATS_BINS];
+  int len = 0;
+  uint32_t i;
+
+  if ((now - lastLog) < ((int64_t)CO_CAN_SEND_STATS_INTERVAL * 1000))
+  {
+    return;
+  }
+  lastLog = now;
+  for (i = 0U; i < CO_CAN_SEND_STATS_BINS; i++)
+  {
+    len += snprintf(&line[len], sizeof(line) - len, " <%u:%u", 1U << i, CO_CANsendHist[i]);
+  }
+  ESP_LOGI(CO_DRIVER_TAG, "CO_CANsend max %u us, histogram [us:count]%s", CO_CANsendMax, line);
+}
+#endif /* CO_CAN_SEND_STATS */
+
+/* Copy tx buffer into esp can message and add it to TX queue without waiting */
+static esp_err_t CO_CANtransmit(CO_CANtx_t *buffer)
+{
+  can_message_t msg;
+  esp_err_t ret;
+
+  msg.identifier = buffer->ident;
+  msg.data_length_code = buffer->DLC;
+  msg.flags = CAN_MSG_FLAG_NONE;
+  memcpy(msg.data, buffer->data, sizeof(msg.data));
+
+  ret = can_transmit(&msg, 0);
+  if (ret == ESP_OK)
+  {
+    CO_CAN_TRACE_FRAME(&msg, 1U);
+  }
+  return ret;
+}
+
+/* Insert tx buffer into pending list, sorted by CAN-ID as in bus arbitration.
+ * Buffers with the same CAN-ID keep their order. Must be called locked. */
+static void CO_CANtxPendingInsert(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer)
+{
+  CO_CANtx_t **link = &CANmodule->txPending;
+
+  while ((*link != NULL) && ((*link)->ident <= buffer->ident))
+  {
+    link = &(*link)->next;
+  }
+  buffer->next = *link;
+  *link = buffer;
+}
+
+/* Remove tx buffer from pending list. Returns false, if it is not there,
+ * because it is just being copied to TX queue. Must be called locked. */
+static bool_t CO_CANtxPendingRemove(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer)
+{
+  CO_CANtx_t **link = &CANmodule->txPending;
+
+  while (*link != NULL)
+  {
+    if (*link == buffer)
+    {
+      *link = buffer->next;
+      buffer->next = NULL;
+      return true;
+    }
+    link = &(*link)->next;
+  }
+  return false;
+}
+
+/* Move pending messages, lowest CAN-ID first, to esp can TX queue until it is full */
+static void CO_CANtxProcess(CO_CANmodule_t *CANmodule)
+{
+  for (;;)
+  {
+    CO_CANtx_t *buffer;
+
+    CO_LOCK_CAN_SEND();
+    buffer = CANmodule->txPending;
+    if (buffer != NULL)
+    {
+      CANmodule->txPending = buffer->next;
+    }
+    CO_UNLOCK_CAN_SEND();
+
+    if (buffer == NULL)
+    {
+      break;
+    }
+    if (CO_CANtransmit(buffer) != ESP_OK)
+    {
+      /* TX queue is full, retry on next TX alert */
+      CO_LOCK_CAN_SEND();
+      CO_CANtxPendingInsert(CANmodule, buffer);
+      CO_UNLOCK_CAN_SEND();
+      break;
+    }
+    CO_LOCK_CAN_SEND();
+    buffer->bufferFull = false;
+    CANmodule->CANtxCount--;
+    CANmodule->txInFlight++;
+    CANmodule->bufferInhibitFlag = buffer->syncFlag;
+    CO_UNLOCK_CAN_SEND();
+  }
+}
+
+/* CAN transmit task. Waits for esp can TX alerts, which replace CAN TX
+ * interrupt, and refills TX queue with pending messages. */
+static void CO_CANtxTask(void *arg)
+{
+  CO_CANmodule_t *CANmodule = (CO_CANmodule_t *)arg;
+  uint32_t alerts;
+
+  while (CANmodule->CANnormal)
+  {
+    if (can_read_alerts(&alerts, pdMS_TO_TICKS(CO_CAN_RX_TASK_TIMEOUT)) == ESP_OK)
+    {
+      bool_t burstSent = false;
+
+      if (alerts & CAN_ALERT_TX_SUCCESS)
+      {
+        /* First CAN message (bootup) was sent successfully */
+        CANmodule->firstCANtxMessage = false;
+      }
+      CO_LOCK_CAN_SEND();
+      if (alerts & CAN_ALERT_TX_IDLE)
+      {
+        /* clear flag from previous message, TX queue is empty. A message
+         * queued by CO_CANsend() since the alert is not counted now, see
+         * txInFlight in CO_driver_target.h */
+        CANmodule->bufferInhibitFlag = false;
+        CANmodule->txInFlight = 0U;
+        /* last message of burst is transmitted, if none is pending */
+        if (CANmodule->txBurst && (CANmodule->CANtxCount == 0U))
+        {
+          CANmodule->txBurst = false;
+          burstSent = true;
+        }
+      }
+      else if ((alerts & (CAN_ALERT_TX_SUCCESS | CAN_ALERT_TX_FAILED)) && (CANmodule->txInFlight > 0U))
+      {
+        /* alerts don't count messages, so at least one has left TX queue */
+        CANmodule->txInFlight--;
+      }
+      CO_UNLOCK_CAN_SEND();
+      if (burstSent && (CANmodule->pFunctBurstSent != NULL))
+      {
+        CANmodule->pFunctBurstSent(CANmodule->functBurstSentObject);
+      }
+    }
+    /* Are there any new messages waiting to be send */
+    if (CANmodule->CANtxCount > 0U)
+    {
+      CO_CANtxProcess(CANmodule);
+    }
+  }
+  CO_CANtxTaskHandle = NULL;
+  vTaskDelete(NULL);
+}
+
+/* Stop CAN receive and transmit tasks and uninstall esp can driver */
+static void CO_CANdriverStop(CO_CANmodule_t *CANmodule)
+{
+  if (CANmodule != NULL)
+  {
+    CANmodule->CANnormal = false;
+  }
+  /* CAN tasks exit after their current wait times out */
+  while ((CO_CANrxTaskHandle != NULL) || (CO_CANtxTaskHandle != NULL))
+  {
+    vTaskDelay(pdMS_TO_TICKS(1));
+  }
+  if (CO_CANdriverInstalled)
+  {
+    can_stop();
+    if (can_driver_uninstall() == ESP_OK)
+    {
+      CO_CANdriverInstalled = false;
+    }
+    else
+    {
+      ESP_LOGE(CO_DRIVER_TAG, "can_driver_uninstall failed, acceptance filter is not reprogrammed");
+    }
+  }
+}
 
 /******************************************************************************/
 void CO_CANsetConfigurationMode(void *CANptr)
 {
   /* Put CAN module in configuration mode */
+  CO_CANdriverStop(CANmodulePointer);
   ESP_LOGI(CO_DRIVER_TAG, "CO_CANsetConfigurationMode");
 }
 
@@ -48,10 +515,33 @@ void CO_CANsetConfigurationMode(void *CANptr)
 void CO_CANsetNormalMode(CO_CANmodule_t *CANmodule)
 {
   /* Put CAN module in normal mode */
+  if (!CO_CANdriverInstalled)
+  {
+    /* Acceptance filter is programmed from rx buffers, configured by CANopen init functions */
+    uint32_t accepted = CO_CANfilterSetup(CANmodule, &f_config);
+    ESP_LOGI(CO_DRIVER_TAG, "Acceptance filter code: 0x%08X mask: 0x%08X single: %d, accepts %d of 2048 identifiers",
+             f_config.acceptance_code, f_config.acceptance_mask, f_config.single_filter, accepted);
+
+    ESP_ERROR_CHECK(can_driver_install(&g_config, &t_config, &f_config));
+    CO_CANdriverInstalled = true;
+  }
 
   CANmodule->CANnormal = true;
 
   ESP_ERROR_CHECK(can_start());
+
+  /* Received messages are processed by CAN receive task */
+  if (CO_CANrxTaskHandle == NULL)
+  {
+    xTaskCreatePinnedToCore(&CO_CANrxTask, "CO_CANrx", CO_CAN_RX_TASK_STACK_SIZE, (void *)CANmodule,
+                            CO_CAN_RX_TASK_PRIORITY, &CO_CANrxTaskHandle, CO_RT_CORE);
+  }
+  /* Pending messages are sent by CAN transmit task */
+  if (CO_CANtxTaskHandle == NULL)
+  {
+    xTaskCreatePinnedToCore(&CO_CANtxTask, "CO_CANtx", CO_CAN_TX_TASK_STACK_SIZE, (void *)CANmodule,
+                            CO_CAN_TX_TASK_PRIORITY, &CO_CANtxTaskHandle, CO_RT_CORE);
+  }
   ESP_LOGI(CO_DRIVER_TAG, "CO_CANsetNormalMode");
 }
 
@@ -73,7 +563,17 @@ CO_ReturnError_t CO_CANmodule_init(
     return CO_ERROR_ILLEGAL_ARGUMENT;
   }
 
+  if (CO_ODmutex == NULL)
+  {
+    CO_ODmutex = xSemaphoreCreateMutex();
+    if (CO_ODmutex == NULL)
+    {
+      return CO_ERROR_OUT_OF_MEMORY;
+    }
+  }
+
   /* Configure object variables */
+  CANmodulePointer = CANmodule;
   CANmodule->CANptr = CANptr;
   CANmodule->rxArray = rxArray;
   CANmodule->rxSize = rxSize;
@@ -81,10 +581,15 @@ CO_ReturnError_t CO_CANmodule_init(
   CANmodule->txSize = txSize;
   CANmodule->CANerrorStatus = 0;
   CANmodule->CANnormal = false;
-  CANmodule->useCANrxFilters = false; // TODO: (rxSize <= 32U) ? true : false; /* microcontroller dependent */
+  CANmodule->useCANrxFilters = CAN_USE_RX_FILTERS;
   CANmodule->bufferInhibitFlag = false;
   CANmodule->firstCANtxMessage = true;
   CANmodule->CANtxCount = 0U;
+  CANmodule->txPending = NULL;
+  CANmodule->txInFlight = 0U;
+  CANmodule->txBurst = false;
+  CANmodule->pFunctBurstSent = NULL;
+  CANmodule->functBurstSentObject = NULL;
   CANmodule->errOld = 0U;
 
   for (i = 0U; i < rxSize; i++)
@@ -94,35 +599,34 @@ CO_ReturnError_t CO_CANmodule_init(
     rxArray[i].object = NULL;
     rxArray[i].CANrx_callback = NULL;
   }
+  memset(CANmodule->rxLookup, 0, sizeof(CANmodule->rxLookup));
+  CANmodule->rxMaskedCount = 0U;
   for (i = 0U; i < txSize; i++)
   {
     txArray[i].bufferFull = false;
+    txArray[i].next = NULL;
   }
 
   /* Configure CAN module registers */
+  g_config.tx_queue_len = CAN_TX_QUEUE_LENGTH;
+  g_config.rx_queue_len = CAN_RX_QUEUE_LENGTH;
+  /* TX alerts are used by CAN transmit task instead of TX interrupt */
+  g_config.alerts_enabled = CAN_ALERT_TX_IDLE | CAN_ALERT_TX_SUCCESS | CAN_ALERT_TX_FAILED;
 
   /* Configure CAN timing */
 
-  /* Configure CAN module hardware filters */
-  if (CANmodule->useCANrxFilters)
-  {
-    /* CAN module filters are used, they will be configured with */
-    /* CO_CANrxBufferInit() functions, called by separate CANopen */
-    /* init functions. */
-    /* Configure all masks so, that received message must match filter */
-  }
-  else
+  /* CAN module hardware filters are configured from rx buffers and esp can */
+  /* driver is installed in CO_CANsetNormalMode() */
+
+#if CO_CAN_TRACE
+  if (CO_CANtraceTaskHandle == NULL)
   {
-    /* CAN module filters are not used, all messages with standard 11-bit */
-    /* identifier will be received */
-    /* Configure mask 0 so, that all messages with standard identifier are accepted */
+    xTaskCreatePinnedToCore(&CO_CANtraceTask, "CO_CANtrace", CO_CAN_TRACE_TASK_STACK_SIZE, NULL,
+                            CO_CAN_TRACE_TASK_PRIORITY, &CO_CANtraceTaskHandle, CO_MAIN_CORE);
   }
+#endif
 
-  /* configure CAN interrupt registers */
-
-  ESP_ERROR_CHECK(can_driver_install(&g_config, &t_config, &f_config));
-
-  ESP_LOGI(CO_DRIVER_TAG, "CO_CANmodule_init (Driver installed)");
+  ESP_LOGI(CO_DRIVER_TAG, "CO_CANmodule_init");
   return CO_ERROR_NO;
 }
 
@@ -130,11 +634,104 @@ CO_ReturnError_t CO_CANmodule_init(
 void CO_CANmodule_disable(CO_CANmodule_t *CANmodule)
 {
   /* turn off the module */
-  ESP_ERROR_CHECK(can_driver_uninstall());
+  CO_CANdriverStop(CANmodule);
 
   ESP_LOGI(CO_DRIVER_TAG, "CO_CANmodule_disable (can_driver_uninstall)");
 }
 
+/* True, if rx buffer mask covers all 11 bits of standard identifier */
+#define CO_CANrxIsExact(buffer) (((buffer)->mask & 0x07FFU) == 0x07FFU)
+
+/* Remove rx buffer from CAN-ID lookup before it is reconfigured. If another
+ * buffer with full mask is registered for the same identifier, the one with
+ * the lowest index takes its place. */
+static void CO_CANrxLookupRemove(CO_CANmodule_t *CANmodule, uint16_t index)
+{
+  CO_CANrx_t *buffer = &CANmodule->rxArray[index];
+  uint16_t id = buffer->ident & 0x07FFU;
+  uint16_t i;
+
+  if (buffer->CANrx_callback == NULL)
+  {
+    return; /* buffer was not configured yet */
+  }
+  if (!CO_CANrxIsExact(buffer))
+  {
+    CANmodule->rxMaskedCount--;
+    return;
+  }
+  if (CANmodule->rxLookup[id] != (uint16_t)(index + 1U))
+  {
+    return;
+  }
+  CANmodule->rxLookup[id] = 0U;
+  for (i = 0U; i < CANmodule->rxSize; i++)
+  {
+    CO_CANrx_t *other = &CANmodule->rxArray[i];
+    if ((i != index) && (other->CANrx_callback != NULL) && CO_CANrxIsExact(other) && ((other->ident & 0x07FFU) == id))
+    {
+      CANmodule->rxLookup[id] = i + 1U;
+      break;
+    }
+  }
+}
+
+/* Add configured rx buffer to CAN-ID lookup. Lower index has priority, same as
+ * with linear search. */
+static void CO_CANrxLookupInsert(CO_CANmodule_t *CANmodule, uint16_t index)
+{
+  CO_CANrx_t *buffer = &CANmodule->rxArray[index];
+  uint16_t id = buffer->ident & 0x07FFU;
+
+  if (!CO_CANrxIsExact(buffer))
+  {
+    CANmodule->rxMaskedCount++;
+    return;
+  }
+  if ((CANmodule->rxLookup[id] == 0U) || (CANmodule->rxLookup[id] > (index + 1U)))
+  {
+    CANmodule->rxLookup[id] = index + 1U;
+  }
+}
+
+/* Find rx buffer for received identifier. Buffers with full mask are found
+ * directly in CAN-ID lookup and have precedence, only buffers with partial
+ * mask (emergency consumer) are searched linearly. */
+static CO_CANrx_t *CO_CANrxFind(CO_CANmodule_t *CANmodule, uint32_t rcvMsgIdent)
+{
+  uint16_t slot = CANmodule->rxLookup[rcvMsgIdent & 0x07FFU];
+  bool_t maskedOnly = true;
+  CO_CANrx_t *buffer;
+  uint16_t index;
+
+  if (slot != 0U)
+  {
+    buffer = &CANmodule->rxArray[slot - 1U];
+    /* verify also RTR */
+    if (((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U)
+    {
+      return buffer;
+    }
+    /* Same CAN-ID with different RTR, search all buffers */
+    maskedOnly = false;
+  }
+  else if (CANmodule->rxMaskedCount == 0U)
+  {
+    return NULL;
+  }
+
+  buffer = &CANmodule->rxArray[0];
+  for (index = CANmodule->rxSize; index > 0U; index--)
+  {
+    if ((buffer->CANrx_callback != NULL) && !(maskedOnly && CO_CANrxIsExact(buffer)) && (((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U))
+    {
+      return buffer;
+    }
+    buffer++;
+  }
+  return NULL;
+}
+
 /******************************************************************************/
 CO_ReturnError_t CO_CANrxBufferInit(
     CO_CANmodule_t *CANmodule,
@@ -152,6 +749,8 @@ CO_ReturnError_t CO_CANrxBufferInit(
     /* buffer, which will be configured */
     CO_CANrx_t *buffer = &CANmodule->rxArray[index];
 
+    CO_CANrxLookupRemove(CANmodule, index);
+
     /* Configure object variables */
     buffer->object = object;
     buffer->CANrx_callback = CANrx_callback;
@@ -164,9 +763,15 @@ CO_ReturnError_t CO_CANrxBufferInit(
     }
     buffer->mask = (mask & 0x07FFU) | 0x0800U;
 
-    /* Set CAN hardware module filter and mask. */
-    if (CANmodule->useCANrxFilters)
+    CO_CANrxLookupInsert(CANmodule, index);
+
+    /* Set CAN hardware module filter and mask. Filter can only be changed with
+     * the driver uninstalled, which is not safe while CAN tasks and CO_CANsend()
+     * callers run. Buffer configured in normal mode (SDO write of COB-ID) and
+     * not accepted by filter receives nothing until communication reset. */
+    if (CANmodule->CANnormal && !CO_CANfilterAccepts(&f_config, buffer->ident, buffer->mask))
     {
+      ESP_LOGW(CO_DRIVER_TAG, "rx[%d] ident: %d is outside acceptance filter until communication reset", index, ident);
     }
 
     ESP_LOGI(CO_DRIVER_TAG, "Setup buffer rx[%d] ident: %d mask %d", index, ident, mask);
@@ -195,14 +800,22 @@ CO_CANtx_t *CO_CANtxBufferInit(
     /* get specific buffer */
     buffer = &CANmodule->txArray[index];
 
+    CO_LOCK_CAN_SEND();
+    /* Buffer may be reinitialized at runtime, drop message still pending
+     * with old CAN-ID. If it is just being copied to TX queue, its sender
+     * clears bufferFull, or queues it again with new CAN-ID. */
+    if (buffer->bufferFull && CO_CANtxPendingRemove(CANmodule, buffer))
+    {
+      buffer->bufferFull = false;
+      CANmodule->CANtxCount--;
+    }
     /* CAN identifier, DLC and rtr, bit aligned with CAN module transmit buffer.
          * Microcontroller specific. */
     //buffer->ident = ((uint32_t)ident & 0x07FFU) | ((uint32_t)(((uint32_t)noOfBytes & 0xFU) << 12U)) | ((uint32_t)(rtr ? 0x8000U : 0U));
     buffer->ident = ident & 0x07FFU;
     buffer->DLC = noOfBytes & 0xFU;
-
-    buffer->bufferFull = false;
     buffer->syncFlag = syncFlag;
+    CO_UNLOCK_CAN_SEND();
   }
 
   ESP_LOGI(CO_DRIVER_TAG, "Setup buffer tx[%d] ident: %d bytes %d", index, ident, noOfBytes);
@@ -211,10 +824,12 @@ CO_CANtx_t *CO_CANtxBufferInit(
 }
 
 /******************************************************************************/
-CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer)
+/* Send or queue tx buffer without waiting, see CO_CANsend() */
+static CO_ReturnError_t CO_CANsendBuffer(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer)
 {
-  CO_ReturnError_t err = CO_ERROR_NO;
+  bool_t txNow;
 
+  CO_LOCK_CAN_SEND();
   /* Verify overflow */
   if (buffer->bufferFull)
   {
@@ -223,84 +838,161 @@ CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer)
       /* don't set error, if bootup message is still on buffers */
       CANmodule->CANerrorStatus |= CO_CAN_ERRTX_OVERFLOW;
     }
-    err = CO_ERROR_TX_OVERFLOW;
+    /* previous message is still pending, it will be sent with new data */
+    CO_UNLOCK_CAN_SEND();
+    return CO_ERROR_TX_OVERFLOW;
+  }
+  buffer->bufferFull = true;
+  CANmodule->CANtxCount++;
+  /* if CAN TX queue has space and no other message is pending, copy message to it */
+  txNow = (CANmodule->txInFlight < CAN_TX_QUEUE_LENGTH) && (CANmodule->CANtxCount == 1U);
+  if (!txNow)
+  {
+    /* message will be sent by CAN transmit task */
+    CO_CANtxPendingInsert(CANmodule, buffer);
   }
+  CO_UNLOCK_CAN_SEND();
 
-  CO_LOCK_CAN_SEND();
-  /* if CAN TX buffer is free, copy message to it */
+  if (txNow)
+  {
+    esp_err_t ret = CO_CANtransmit(buffer);
 
-  can_message_t msg;
-  msg.identifier = buffer->ident;
-  msg.data_length_code = buffer->DLC;
-  msg.flags = CAN_MSG_FLAG_NONE;
-  // TODO: Use memcpy
-  for (uint8_t i = 0; i < 8; i++)
-    msg.data[i] = buffer->data[i];
+    CO_LOCK_CAN_SEND();
+    if (ret == ESP_OK)
+    {
+      buffer->bufferFull = false;
+      CANmodule->CANtxCount--;
+      CANmodule->txInFlight++;
+      CANmodule->bufferInhibitFlag = buffer->syncFlag;
+    }
+    else
+    {
+      /* TX queue is full, txInFlight was too low. Message will be sent by
+       * CAN transmit task on next TX alert */
+      CO_CANtxPendingInsert(CANmodule, buffer);
+    }
+    CO_UNLOCK_CAN_SEND();
+  }
 
-  esp_err_t ret = can_transmit(&msg, pdMS_TO_TICKS(10));
+  return CO_ERROR_NO;
+}
 
-  if ((ret == ESP_OK) && CANmodule->CANtxCount == 0)
-  {
-    CANmodule->bufferInhibitFlag = buffer->syncFlag;
-    /* copy message and txRequest */
+/******************************************************************************/
+CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer)
+{
+#if CO_CAN_SEND_STATS
+  int64_t start = esp_timer_get_time();
+  CO_ReturnError_t err = CO_CANsendBuffer(CANmodule, buffer);
 
-    // ESP_LOGI(CO_DRIVER_TAG, "can_transmit ident: 0x%03X, DLC: %d 0x[%02X %02X %02X %02X %02X %02X %02X %02X] flags: 0x%08X",
-    //          msg.identifier, msg.data_length_code, msg.data[0], msg.data[1], msg.data[2], msg.data[3], msg.data[4],
-    //          msg.data[5], msg.data[6], msg.data[7], msg.flags);
-  }
+  CO_CANsendStatsAdd((uint32_t)(esp_timer_get_time() - start));
+  return err;
+#else
+  return CO_CANsendBuffer(CANmodule, buffer);
+#endif
+}
 
-  /* if no buffer is free, message will be sent by interrupt */
-  else
+/******************************************************************************/
+CO_ReturnError_t CO_CANsendBurst(CO_CANmodule_t *CANmodule, CO_CANtx_t *const *buffers, uint16_t count)
+{
+  CO_ReturnError_t err = CO_ERROR_NO;
+  bool_t txNow;
+  uint16_t i;
+
+  CO_LOCK_CAN_SEND();
+  for (i = 0U; i < count; i++)
   {
-    ESP_LOGI(CO_DRIVER_TAG, "Tx fail! %d", buffer->ident);
+    CO_CANtx_t *buffer = buffers[i];
+
+    /* Verify overflow, see CO_CANsendBuffer() */
+    if (buffer->bufferFull)
+    {
+      if (!CANmodule->firstCANtxMessage)
+      {
+        CANmodule->CANerrorStatus |= CO_CAN_ERRTX_OVERFLOW;
+      }
+      err = CO_ERROR_TX_OVERFLOW;
+      continue;
+    }
     buffer->bufferFull = true;
     CANmodule->CANtxCount++;
+    CO_CANtxPendingInsert(CANmodule, buffer);
+    CANmodule->txBurst = true;
   }
-
+  txNow = CANmodule->txInFlight < CAN_TX_QUEUE_LENGTH;
   CO_UNLOCK_CAN_SEND();
 
+  /* fill CAN TX queue now, rest is sent by CAN transmit task */
+  if (txNow)
+  {
+    CO_CANtxProcess(CANmodule);
+  }
+
   return err;
 }
 
+/******************************************************************************/
+void CO_CANmodule_initCallbackBurstSent(
+    CO_CANmodule_t *CANmodule,
+    void *object,
+    void (*pFunctBurstSent)(void *object))
+{
+  if (CANmodule != NULL)
+  {
+    CANmodule->functBurstSentObject = object;
+    CANmodule->pFunctBurstSent = pFunctBurstSent;
+  }
+}
+
 /******************************************************************************/
 void CO_CANclearPendingSyncPDOs(CO_CANmodule_t *CANmodule)
 {
   ESP_LOGI(CO_DRIVER_TAG, "CO_CANclearPendingSyncPDOs");
 
   uint32_t tpdoDeleted = 0U;
+  bool_t clearTxQueue = false;
 
   CO_LOCK_CAN_SEND();
   /* Abort message from CAN module, if there is synchronous TPDO.
      * Take special care with this functionality. */
   if (/*messageIsOnCanBuffer && */ CANmodule->bufferInhibitFlag)
   {
-    /* clear TXREQ */
-    can_clear_transmit_queue();
-
     CANmodule->bufferInhibitFlag = false;
+    clearTxQueue = true;
     tpdoDeleted = 1U;
   }
   /* delete also pending synchronous TPDOs in TX buffers */
-  if (CANmodule->CANtxCount != 0U)
+  CO_CANtx_t **link = &CANmodule->txPending;
+  while (*link != NULL)
   {
-    uint16_t i;
-    CO_CANtx_t *buffer = &CANmodule->txArray[0];
-    for (i = CANmodule->txSize; i > 0U; i--)
+    CO_CANtx_t *buffer = *link;
+    if (buffer->syncFlag)
     {
-      if (buffer->bufferFull)
-      {
-        if (buffer->syncFlag)
-        {
-          buffer->bufferFull = false;
-          CANmodule->CANtxCount--;
-          tpdoDeleted = 2U;
-        }
-      }
-      buffer++;
+      *link = buffer->next;
+      buffer->bufferFull = false;
+      CANmodule->CANtxCount--;
+      tpdoDeleted = 2U;
+    }
+    else
+    {
+      link = &buffer->next;
     }
   }
   CO_UNLOCK_CAN_SEND();
 
+  if (clearTxQueue)
+  {
+    /* clear TXREQ, esp can driver takes its own lock */
+    can_clear_transmit_queue();
+    /* TX queue is empty and no TX alert will report it */
+    CO_LOCK_CAN_SEND();
+    CANmodule->txInFlight = 0U;
+    CO_UNLOCK_CAN_SEND();
+    /* send other pending messages now, not on next TX alert */
+    if (CANmodule->CANtxCount > 0U)
+    {
+      CO_CANtxProcess(CANmodule);
+    }
+  }
   if (tpdoDeleted != 0U)
   {
     CANmodule->CANerrorStatus |= CO_CAN_ERRTX_PDO_LATE;
@@ -317,6 +1009,10 @@ void CO_CANmodule_process(CO_CANmodule_t *CANmodule)
   // this one is called from main continuously
   uint32_t err;
 
+#if CO_CAN_SEND_STATS
+  CO_CANsendStatsLog();
+#endif
+
   err = ((uint32_t)txErrors << 16) | ((uint32_t)rxErrors << 8) | overflow;
 
   if (CANmodule->errOld != err)
@@ -376,174 +1072,37 @@ void CO_CANmodule_process(CO_CANmodule_t *CANmodule)
 
 /******************************************************************************/
 
-void CANreceive(CO_CANmodule_t *CANmodule)
+/* Process one message received from esp can driver */
+static void CANreceiveMessage(CO_CANmodule_t *CANmodule, can_message_t *rcvMsg)
 {
-  can_message_t rcvMsg;      /* received message in CAN module */
-  uint16_t index;            /* index of received message */
   uint32_t rcvMsgIdent;      /* identifier of the received message */
   CO_CANrx_t *buffer = NULL; /* receive message buffer from CO_CANmodule_t object. */
-  bool_t msgMatched = false;
 
-  esp_err_t ret = can_receive(&rcvMsg, portMAX_DELAY);
+  rcvMsgIdent = rcvMsg->identifier;
+  /* Search rxArray form CANmodule for the same CAN-ID. */
+  buffer = CO_CANrxFind(CANmodule, rcvMsgIdent);
 
-  rcvMsgIdent = rcvMsg.identifier;
-  if (CANmodule->useCANrxFilters)
-  {
-    /* CAN module filters are used. Message with known 11-bit identifier has */
-    /* been received */
-
-    // TODO: Hardare filters
-    index = 0; /* get index of the received message here. Or something similar */
-    // if (index < CANmodule->rxSize)
-    // {
-    //   buffer = &CANmodule->rxArray[index];
-    //   /* verify also RTR */
-    //   if (((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U)
-    //   {
-    //     msgMatched = true;
-    //   }
-    // }
-  }
-  else
-  {
-    /* CAN module filters are not used, message with any standard 11-bit identifier */
-    /* has been received. Search rxArray form CANmodule for the same CAN-ID. */
-    buffer = &CANmodule->rxArray[0];
-    for (index = CANmodule->rxSize; index > 0U; index--)
-    {
-      if (((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U)
-      {
-        msgMatched = true;
-        break;
-      }
-      buffer++;
-    }
-  }
+  CO_CAN_TRACE_FRAME(rcvMsg, 0U);
 
   /* Call specific function, which will process the message */
-  if (msgMatched && (buffer != NULL) && (buffer->CANrx_callback != NULL))
+  if ((buffer != NULL) && (buffer->CANrx_callback != NULL))
   {
-    ESP_LOGI(CO_DRIVER_TAG, "can_receive * ident: 0x%03X, DLC: %d 0x[%02X %02X %02X %02X %02X %02X %02X %02X] flags: 0x%08X idx: %d, cb: %d",
-             rcvMsg.identifier, rcvMsg.data_length_code, rcvMsg.data[0], rcvMsg.data[1], rcvMsg.data[2], rcvMsg.data[3],
-             rcvMsg.data[4], rcvMsg.data[5], rcvMsg.data[6], rcvMsg.data[7], rcvMsg.flags, CANmodule->rxSize - index,
-             (int)(void *)buffer->CANrx_callback);
-
-    buffer->CANrx_callback(buffer->object, (void *)&rcvMsg);
-  }
-  else
-  {
-    if (ret == ESP_OK)
-    {
-      ESP_LOGI(CO_DRIVER_TAG, "can_receive ident: 0x%03X, DLC: %d 0x[%02X %02X %02X %02X %02X %02X %02X %02X] flags: 0x%08X",
-               rcvMsg.identifier, rcvMsg.data_length_code, rcvMsg.data[0], rcvMsg.data[1], rcvMsg.data[2], rcvMsg.data[3],
-               rcvMsg.data[4], rcvMsg.data[5], rcvMsg.data[6], rcvMsg.data[7], rcvMsg.flags);
-    }
+    buffer->CANrx_callback(buffer->object, (void *)rcvMsg);
   }
 }
 
-typedef struct
-{
-  uint16_t ident;
-} CO_CANrxMsg_t;
-
-void CO_CANinterrupt(CO_CANmodule_t *CANmodule)
+void CANreceive(CO_CANmodule_t *CANmodule)
 {
-  ESP_LOGI(CO_DRIVER_TAG, "CO_CANinterrupt");
-
-  /* receive interrupt */
-  if (1)
-  {
-    CO_CANrxMsg_t *rcvMsg;     /* pointer to received message in CAN module */
-    uint16_t index;            /* index of received message */
-    uint32_t rcvMsgIdent;      /* identifier of the received message */
-    CO_CANrx_t *buffer = NULL; /* receive message buffer from CO_CANmodule_t object. */
-    bool_t msgMatched = false;
-
-    rcvMsg = 0; /* get message from module here */
-
-    rcvMsgIdent = rcvMsg->ident;
-    if (CANmodule->useCANrxFilters)
-    {
-      /* CAN module filters are used. Message with known 11-bit identifier has */
-      /* been received */
-      index = 0; /* get index of the received message here. Or something similar */
-      if (index < CANmodule->rxSize)
-      {
-        buffer = &CANmodule->rxArray[index];
-        /* verify also RTR */
-        if (((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U)
-        {
-          msgMatched = true;
-        }
-      }
-    }
-    else
-    {
-      /* CAN module filters are not used, message with any standard 11-bit identifier */
-      /* has been received. Search rxArray form CANmodule for the same CAN-ID. */
-      buffer = &CANmodule->rxArray[0];
-      for (index = CANmodule->rxSize; index > 0U; index--)
-      {
-        if (((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U)
-        {
-          msgMatched = true;
-          break;
-        }
-        buffer++;
-      }
-    }
-
-    /* Call specific function, which will process the message */
-    if (msgMatched && (buffer != NULL) && (buffer->CANrx_callback != NULL))
-    {
-      buffer->CANrx_callback(buffer->object, (void *)rcvMsg);
-    }
-
-    /* Clear interrupt flag */
-  }
+  can_message_t rcvMsg; /* received message in CAN module */
 
-  /* transmit interrupt */
-  else if (0)
+  /* Wait for the first message, so module state is checked at least every CO_CAN_RX_TASK_TIMEOUT */
+  if (can_receive(&rcvMsg, pdMS_TO_TICKS(CO_CAN_RX_TASK_TIMEOUT)) != ESP_OK)
   {
-    /* Clear interrupt flag */
-
-    /* First CAN message (bootup) was sent successfully */
-    CANmodule->firstCANtxMessage = false;
-    /* clear flag from previous message */
-    CANmodule->bufferInhibitFlag = false;
-    /* Are there any new messages waiting to be send */
-    if (CANmodule->CANtxCount > 0U)
-    {
-      uint16_t i; /* index of transmitting message */
-
-      /* first buffer */
-      CO_CANtx_t *buffer = &CANmodule->txArray[0];
-      /* search through whole array of pointers to transmit message buffers. */
-      for (i = CANmodule->txSize; i > 0U; i--)
-      {
-        /* if message buffer is full, send it. */
-        if (buffer->bufferFull)
-        {
-          buffer->bufferFull = false;
-          CANmodule->CANtxCount--;
-
-          /* Copy message to CAN buffer */
-          CANmodule->bufferInhibitFlag = buffer->syncFlag;
-          /* canSend... */
-          break; /* exit for loop */
-        }
-        buffer++;
-      } /* end of for loop */
-
-      /* Clear counter if no more messages */
-      if (i == 0U)
-      {
-        CANmodule->CANtxCount = 0U;
-      }
-    }
+    return;
   }
-  else
+  /* Process it and all messages, which were queued in the meantime */
+  do
   {
-    /* some other interrupt reason */
-  }
+    CANreceiveMessage(CANmodule, &rcvMsg);
+  } while (can_receive(&rcvMsg, 0) == ESP_OK);
 }
@@ -51,6 +51,10 @@ extern "C"
 #define CO_CONFIG_SDO_BUFFER_SIZE 32
 #endif
 
+#ifndef CO_CONFIG_OD_INDEX_MIN
+#define CO_CONFIG_OD_INDEX_MIN 64
+#endif
+
 #ifndef CO_CONFIG_EM
 #define CO_CONFIG_EM (0)
 #endif
@@ -63,6 +67,10 @@ extern "C"
 #define CO_CONFIG_PDO (CO_CONFIG_PDO_SYNC_ENABLE)
 #endif
 
+#ifndef CO_CONFIG_PDO_MPDO_QUEUE
+#define CO_CONFIG_PDO_MPDO_QUEUE 8
+#endif
+
 #ifndef CO_CONFIG_SYNC
 #define CO_CONFIG_SYNC (0)
 #endif
@@ -321,7 +329,7 @@ extern "C"
  * sets _bufferFull_ flag to true. Message will be then sent by CAN TX interrupt
  * as soon as CAN module is freed. Until message is not copied to CAN module,
  * its contents must not change. If there are multiple CO_CANtx_t objects with
- * _bufferFull_ flag set to true, then CO_CANtx_t with lower index will be sent
+ * _bufferFull_ flag set to true, then CO_CANtx_t with lower CAN-ID will be sent
  * first.
  */
 
@@ -450,6 +458,44 @@ extern "C"
         __sync_synchronize(); \
         rxNew = NULL;         \
     }
+/** Set bits in 32-bit word of new message flags */
+#define CO_FLAG_SET_BITS(word, bits) __sync_fetch_and_or(&(word), (bits))
+/** Read and clear all bits in 32-bit word of new message flags */
+#define CO_FLAG_TAKE_BITS(word) __sync_fetch_and_and(&(word), 0U)
+/** Start writing data protected by sequence counter, counter becomes odd */
+#define CO_SEQ_WRITE_BEGIN(seq)   \
+    {                             \
+        seq++;                    \
+        __sync_synchronize();     \
+    }
+/** Finish writing data protected by sequence counter, counter becomes even */
+#define CO_SEQ_WRITE_END(seq)     \
+    {                             \
+        __sync_synchronize();     \
+        seq++;                    \
+    }
+/** Read sequence counter before reading protected data */
+#define CO_SEQ_READ_BEGIN(seq) (__sync_synchronize(), (seq))
+/** True, if protected data were modified since CO_SEQ_READ_BEGIN() */
+#define CO_SEQ_READ_RETRY(seq, start) (__sync_synchronize(), (seq) != (start))
+/** Read index of single writer queue, written by the other thread */
+#define CO_FIFO_LOAD(idx) (__sync_synchronize(), (idx))
+/** Write own index of single writer queue, after queue entry was accessed */
+#define CO_FIFO_STORE(idx, value) \
+    {                             \
+        __sync_synchronize();     \
+        idx = (value);            \
+    }
+/** Enter receive function, which reads data through CO_RCU_READ() pointer */
+#define CO_RCU_ENTER(seq) __sync_fetch_and_add(&(seq), 1U)
+/** Leave receive function */
+#define CO_RCU_EXIT(seq) __sync_fetch_and_add(&(seq), 1U)
+/** Read pointer to data in receive function */
+#define CO_RCU_READ(ptr) (__sync_synchronize(), (ptr))
+/** Replace pointer to data, returns start value for CO_RCU_QUIET() */
+#define CO_RCU_REPLACE(ptr, value, seq) ((ptr) = (value), __sync_synchronize(), (seq))
+/** True, if data of replaced pointer are not used by receive function any more */
+#define CO_RCU_QUIET(seq, start) ((((start) & 1U) == 0U) || (__sync_synchronize(), (seq) != (start)))
 
 /** @} */
 #endif /* CO_DOXYGEN */
@@ -662,6 +708,42 @@ extern "C"
  */
     CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer);
 
+    /**
+ * Send several CAN messages at once.
+ *
+ * Same as calling CO_CANsend() for each buffer, but all buffers are queued
+ * under one lock and then moved to CAN module, lowest CAN-ID first. Used for
+ * synchronous TPDOs, which are all due right after SYNC.
+ *
+ * @param CANmodule This object.
+ * @param buffers Array of pointers to transmit buffers, returned by
+ * CO_CANtxBufferInit(). Data bytes must be written in buffers before function
+ * call.
+ * @param count Number of buffers.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_TX_OVERFLOW, if
+ * previous message of any buffer was still pending.
+ */
+    CO_ReturnError_t CO_CANsendBurst(CO_CANmodule_t *CANmodule, CO_CANtx_t *const *buffers, uint16_t count);
+
+    /**
+ * Initialize callback function for end of burst.
+ *
+ * Callback is called from CAN transmit task, when CAN module has transmitted
+ * all messages, after CO_CANsendBurst() was called, and no other message is
+ * pending. It marks the end of transmission of the last synchronous TPDO, for
+ * measurement of SYNC to TPDO latency. Messages sent with CO_CANsend() in the
+ * meantime delay it. Must be initialized after CO_CANmodule_init().
+ *
+ * @param CANmodule This object.
+ * @param object Pointer to object, which will be passed to pFunctBurstSent(). Can be NULL
+ * @param pFunctBurstSent Pointer to the callback function. Not called if NULL.
+ */
+    void CO_CANmodule_initCallbackBurstSent(
+        CO_CANmodule_t *CANmodule,
+        void *object,
+        void (*pFunctBurstSent)(void *object));
+
     /**
  * Clear all synchronous TPDOs from CAN module transmit buffers.
  *
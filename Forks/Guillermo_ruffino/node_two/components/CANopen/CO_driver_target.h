@@ -63,7 +63,8 @@ extern "C"
 #define CO_CONFIG_SDO (CO_CONFIG_FLAG_CALLBACK_PRE | \
                        CO_CONFIG_FLAG_TIMERNEXT |    \
                        CO_CONFIG_SDO_SEGMENTED |     \
-                       CO_CONFIG_SDO_BLOCK)
+                       CO_CONFIG_SDO_BLOCK |         \
+                       CO_CONFIG_SDO_EXPEDITED_FAST)
 #endif
 
 #ifndef CO_CONFIG_SDO_BUFFER_SIZE
@@ -89,7 +90,9 @@ extern "C"
                        CO_CONFIG_FLAG_TIMERNEXT |       \
                        CO_CONFIG_PDO_SYNC_ENABLE |      \
                        CO_CONFIG_RPDO_CALLS_EXTENSION | \
-                       CO_CONFIG_TPDO_CALLS_EXTENSION)
+                       CO_CONFIG_TPDO_CALLS_EXTENSION | \
+                       CO_CONFIG_RPDO_CALLBACK_RX |     \
+                       CO_CONFIG_PDO_MPDO)
 #endif
 
 #ifndef CO_CONFIG_SYNC
@@ -169,15 +172,19 @@ extern "C"
     } CO_CANrx_t;
 
     /* Transmit message object */
-    typedef struct
+    typedef struct CO_CANtx
     {
         uint32_t ident;
         uint8_t DLC;
         uint8_t data[8];
         volatile bool_t bufferFull;
         volatile bool_t syncFlag;
+        struct CO_CANtx *next; /* next pending message with higher or same CAN-ID */
     } CO_CANtx_t;
 
+/* Number of entries in CAN-ID lookup table, one for each standard 11-bit identifier */
+#define CO_CAN_RX_LOOKUP_SIZE 0x800U
+
     /* CAN module object */
     typedef struct
     {
@@ -192,35 +199,101 @@ extern "C"
         volatile bool_t bufferInhibitFlag;
         volatile bool_t firstCANtxMessage;
         volatile uint16_t CANtxCount;
+        /* Messages waiting for space in esp can TX queue, sorted by CAN-ID, lowest first */
+        CO_CANtx_t *txPending;
+        /* Estimate of messages in esp can TX queue, counted by CO_CANsend() and
+         * TX alerts. Alerts are coalesced, and TX_IDLE may be handled after
+         * CO_CANsend() on the other core has queued a new message, so the
+         * estimate can be too high or too low. It only decides, whether
+         * can_transmit() is tried directly. can_transmit() never waits, and a
+         * message it rejects goes to txPending, so a wrong estimate may delay
+         * a message to the next TX alert, but never loses it. */
+        volatile uint16_t txInFlight;
+        /* Set by CO_CANsendBurst(), cleared by CAN transmit task, when last
+         * frame has left esp can TX queue, see CO_CANmodule_initCallbackBurstSent() */
+        volatile bool_t txBurst;
+        /* From CO_CANmodule_initCallbackBurstSent() or NULL */
+        void (*pFunctBurstSent)(void *object);
+        /* From CO_CANmodule_initCallbackBurstSent() or NULL */
+        void *functBurstSentObject;
         uint32_t errOld;
+        /* rxArray index + 1 of the first buffer with full 11-bit mask for
+         * each standard identifier, 0 if none. Maintained by CO_CANrxBufferInit() */
+        uint16_t rxLookup[CO_CAN_RX_LOOKUP_SIZE];
+        /* Number of rxArray buffers with partial mask, searched linearly on lookup miss */
+        uint16_t rxMaskedCount;
     } CO_CANmodule_t;
 
+/* Locks for CANopenNode objects shared between CAN tasks, esp_timer task and
+ * mainline, which may run on different cores. CAN send and EMCY sections only
+ * copy a few bytes and use spinlocks. OD sections call OD extension functions,
+ * which may log or reconfigure CAN buffers, so they use a mutex.
+ *
+ * CO_ODmutex is taken also by SYNC/PDO task (RPDO monitor, TPDO scheduler
+ * update, mapping swap), while SDO server in mainline holds it across the OD
+ * extension function of the accessed object. It is created with
+ * xSemaphoreCreateMutex(), which has priority inheritance: the holder runs at
+ * priority of SYNC/PDO task, until it gives the mutex. So SYNC/PDO task waits
+ * at most one SDO server section: copy of up to CO_CONFIG_SDO_BUFFER_SIZE bytes
+ * plus the OD extension function. OD extension functions must therefore be
+ * short and must not block, see @ref CO_SDO_OD_function. */
+extern portMUX_TYPE CO_CANsendMux;
+extern portMUX_TYPE CO_EMCYmux;
+extern SemaphoreHandle_t CO_ODmutex;
+
 /* (un)lock critical section in CO_CANsend() */
-#define CO_LOCK_CAN_SEND()
-#define CO_UNLOCK_CAN_SEND()
+#define CO_LOCK_CAN_SEND() portENTER_CRITICAL(&CO_CANsendMux)
+#define CO_UNLOCK_CAN_SEND() portEXIT_CRITICAL(&CO_CANsendMux)
 
 /* (un)lock critical section in CO_errorReport() or CO_errorReset() */
-#define CO_LOCK_EMCY()
-#define CO_UNLOCK_EMCY()
+#define CO_LOCK_EMCY() portENTER_CRITICAL(&CO_EMCYmux)
+#define CO_UNLOCK_EMCY() portEXIT_CRITICAL(&CO_EMCYmux)
 
 /* (un)lock critical section when accessing Object Dictionary */
-#define CO_LOCK_OD()
-#define CO_UNLOCK_OD()
-
-/* Synchronization between CAN receive and message processing threads. */
-#define CO_MemoryBarrier()
-#define CO_FLAG_READ(rxNew) ((rxNew) != NULL)
-#define CO_FLAG_SET(rxNew)  \
-    {                       \
-        CO_MemoryBarrier(); \
-        rxNew = (void *)1L; \
-    }
-#define CO_FLAG_CLEAR(rxNew) \
-    {                        \
-        CO_MemoryBarrier();  \
-        rxNew = NULL;        \
+#define CO_LOCK_OD() xSemaphoreTake(CO_ODmutex, portMAX_DELAY)
+#define CO_UNLOCK_OD() xSemaphoreGive(CO_ODmutex)
+
+/* Synchronization between CAN receive and message processing threads.
+ * Flag store releases and flag read acquires the received message data. */
+#define CO_MemoryBarrier() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define CO_FLAG_READ(rxNew) (__atomic_load_n(&(rxNew), __ATOMIC_ACQUIRE) != NULL)
+#define CO_FLAG_SET(rxNew) __atomic_store_n(&(rxNew), (void *)1L, __ATOMIC_RELEASE)
+#define CO_FLAG_CLEAR(rxNew) __atomic_store_n(&(rxNew), NULL, __ATOMIC_RELEASE)
+#define CO_FLAG_SET_BITS(word, bits) __atomic_fetch_or(&(word), (bits), __ATOMIC_RELEASE)
+#define CO_FLAG_TAKE_BITS(word) __atomic_exchange_n(&(word), 0U, __ATOMIC_ACQUIRE)
+
+/* Sequence counter (seqlock) for received data with single writer. Counter
+ * is odd while writer is copying data. Reader retries, if counter changed. */
+#define CO_SEQ_WRITE_BEGIN(seq)                                        \
+    {                                                                  \
+        __atomic_store_n(&(seq), (seq) + 1U, __ATOMIC_RELAXED);        \
+        __atomic_thread_fence(__ATOMIC_RELEASE);                       \
     }
+#define CO_SEQ_WRITE_END(seq) __atomic_store_n(&(seq), (seq) + 1U, __ATOMIC_RELEASE)
+#define CO_SEQ_READ_BEGIN(seq) __atomic_load_n(&(seq), __ATOMIC_ACQUIRE)
+#define CO_SEQ_READ_RETRY(seq, start) \
+    (__atomic_thread_fence(__ATOMIC_ACQUIRE), __atomic_load_n(&(seq), __ATOMIC_RELAXED) != (start))
+
+/* Queue with one writer and one reader thread, each owns one index. Index
+ * store releases the accessed entry, index load acquires it. */
+#define CO_FIFO_LOAD(idx) __atomic_load_n(&(idx), __ATOMIC_ACQUIRE)
+#define CO_FIFO_STORE(idx, value) __atomic_store_n(&(idx), (value), __ATOMIC_RELEASE)
+
+/* Data read by CAN receive function through a pointer, which processing
+ * thread replaces. Receive function counts its entries and exits. Old data
+ * may be reused, when receive function was outside at the replace or has
+ * left since. */
+#define CO_RCU_ENTER(seq) __atomic_fetch_add(&(seq), 1U, __ATOMIC_SEQ_CST)
+#define CO_RCU_EXIT(seq) __atomic_fetch_add(&(seq), 1U, __ATOMIC_RELEASE)
+#define CO_RCU_READ(ptr) __atomic_load_n(&(ptr), __ATOMIC_SEQ_CST)
+#define CO_RCU_REPLACE(ptr, value, seq) \
+    (__atomic_store_n(&(ptr), (value), __ATOMIC_SEQ_CST), __atomic_load_n(&(seq), __ATOMIC_SEQ_CST))
+#define CO_RCU_QUIET(seq, start) \
+    ((((start) & 1U) == 0U) || (__atomic_load_n(&(seq), __ATOMIC_ACQUIRE) != (start)))
 
+    /* Wait up to CO_CAN_RX_TASK_TIMEOUT for a message from esp can driver, then
+     * process it and all other queued messages. Called in a loop by CAN receive
+     * task, which is started by CO_CANsetNormalMode(). */
     void CANreceive(CO_CANmodule_t *CANmodule);
 
 #ifdef __cplusplus
@@ -0,0 +1,76 @@
+/*
+ * Monotonic microsecond timebase for CANopenNode process functions.
+ *
+ * @file        CO_timebase.c
+ * @ingroup     CO_driver
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CO_timebase.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#else
+#include <time.h>
+#endif
+
+
+/******************************************************************************/
+int64_t CO_timebase_now_us(void)
+{
+#ifdef ESP_PLATFORM
+    return esp_timer_get_time();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+
+/******************************************************************************/
+void CO_timebase_init(CO_timebase_t *tb)
+{
+    tb->previous_us = CO_timebase_now_us();
+}
+
+
+/******************************************************************************/
+uint32_t CO_timebase_diff_us(CO_timebase_t *tb)
+{
+    int64_t diff = CO_timebase_now_us() - tb->previous_us;
+
+    if (diff > UINT32_MAX) {
+        diff = UINT32_MAX;
+    }
+    tb->previous_us += diff;
+    return (uint32_t)diff;
+}
+
+
+/******************************************************************************/
+uint16_t CO_timebase_diff_ms(CO_timebase_t *tb)
+{
+    int64_t diff = (CO_timebase_now_us() - tb->previous_us) / 1000;
+
+    if (diff > UINT16_MAX) {
+        diff = UINT16_MAX;
+    }
+    tb->previous_us += diff * 1000;
+    return (uint16_t)diff;
+}
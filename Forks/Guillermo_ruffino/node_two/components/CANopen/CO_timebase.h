@@ -0,0 +1,86 @@
+/*
+ * Monotonic microsecond timebase for CANopenNode process functions.
+ *
+ * @file        CO_timebase.h
+ * @ingroup     CO_driver
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_TIMEBASE_H
+#define CO_TIMEBASE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Timebase object, one per caller of CO_process* functions.
+ *
+ * Time is read from esp_timer_get_time() on target and from
+ * CLOCK_MONOTONIC on host builds. Each diff function advances
+ * previous_us only by the time it returns, so truncation to the
+ * returned unit is carried into the next call and no time is lost.
+ */
+typedef struct {
+    int64_t previous_us; /**< Time consumed by previous diff call */
+} CO_timebase_t;
+
+
+/**
+ * Current monotonic time.
+ *
+ * @return Time since boot in microseconds.
+ */
+int64_t CO_timebase_now_us(void);
+
+
+/**
+ * Initialize timebase object, next diff is measured from now.
+ *
+ * @param tb This object.
+ */
+void CO_timebase_init(CO_timebase_t *tb);
+
+
+/**
+ * Time since previous call, for timeDifference_us arguments.
+ *
+ * @param tb This object.
+ *
+ * @return Elapsed time in microseconds, saturated to UINT32_MAX.
+ */
+uint32_t CO_timebase_diff_us(CO_timebase_t *tb);
+
+
+/**
+ * Time since previous call in whole milliseconds, for timeDifference_ms
+ * arguments. Remaining fraction of millisecond is kept for next call.
+ *
+ * @param tb This object.
+ *
+ * @return Elapsed time in milliseconds, saturated to UINT16_MAX.
+ */
+uint16_t CO_timebase_diff_ms(CO_timebase_t *tb);
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus*/
+
+#endif /* CO_TIMEBASE_H */
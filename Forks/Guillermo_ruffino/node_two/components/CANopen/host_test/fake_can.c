@@ -0,0 +1,339 @@
+/*
+ * Simulated esp can (TWAI) driver for host tests, see fake_can.h.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#include "fake_can.h"
+
+#define FAKE_CAN_QUEUE_MAX 256U
+
+typedef struct
+{
+    can_message_t msg[FAKE_CAN_QUEUE_MAX];
+    uint32_t len; /* configured queue length */
+    uint32_t head;
+    uint32_t count;
+} fake_can_queue_t;
+
+static pthread_mutex_t fake_can_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t fake_can_rxCond;
+static pthread_cond_t fake_can_alertCond;
+static bool fake_can_installed = false;
+static bool fake_can_running = false;
+static can_filter_config_t fake_can_f_config;
+static uint32_t fake_can_alertsEnabled;
+static uint32_t fake_can_alerts;
+static fake_can_queue_t fake_can_rxQueue;
+static fake_can_queue_t fake_can_txQueue;
+static fake_can_stats_t fake_can_statsData;
+
+static bool fake_can_push(fake_can_queue_t *queue, const can_message_t *msg)
+{
+    if (queue->count >= queue->len)
+    {
+        return false;
+    }
+    queue->msg[(queue->head + queue->count) % FAKE_CAN_QUEUE_MAX] = *msg;
+    queue->count++;
+    return true;
+}
+
+static bool fake_can_pop(fake_can_queue_t *queue, can_message_t *msg)
+{
+    if (queue->count == 0U)
+    {
+        return false;
+    }
+    *msg = queue->msg[queue->head];
+    queue->head = (queue->head + 1U) % FAKE_CAN_QUEUE_MAX;
+    queue->count--;
+    return true;
+}
+
+/* Wait on condition for up to ticks milliseconds, mutex is locked */
+static void fake_can_wait(pthread_cond_t *cond, TickType_t ticks)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += ticks / 1000U;
+    ts.tv_nsec += (long)(ticks % 1000U) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(cond, &fake_can_mutex, &ts);
+}
+
+/* Acceptance filter match as in TWAI single and dual filter mode, standard frames.
+ * Single filter: ID in bits 31..21, RTR in bit 20. Dual filter: ID in bits
+ * 31..21 and 15..5, RTR in bits 20 and 4. */
+static bool fake_can_match(const can_filter_config_t *f, uint32_t ident, bool rtr)
+{
+    uint32_t frame = (ident << 21) | (rtr ? (1UL << 20) : 0U);
+
+    if (f->single_filter)
+    {
+        return ((frame ^ f->acceptance_code) & ~f->acceptance_mask & 0xFFF00000U) == 0U;
+    }
+    if (((frame ^ f->acceptance_code) & ~f->acceptance_mask & 0xFFF00000U) == 0U)
+    {
+        return true;
+    }
+    frame >>= 16;
+    return ((frame ^ f->acceptance_code) & ~f->acceptance_mask & 0x0000FFF0U) == 0U;
+}
+
+esp_err_t can_driver_install(const can_general_config_t *g_config, const can_timing_config_t *t_config,
+                             const can_filter_config_t *f_config)
+{
+    pthread_condattr_t attr;
+
+    (void)t_config;
+    if (fake_can_installed || (g_config->rx_queue_len > FAKE_CAN_QUEUE_MAX) ||
+        (g_config->tx_queue_len > FAKE_CAN_QUEUE_MAX))
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&fake_can_rxCond, &attr);
+    pthread_cond_init(&fake_can_alertCond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    pthread_mutex_lock(&fake_can_mutex);
+    memset(&fake_can_rxQueue, 0, sizeof(fake_can_rxQueue));
+    memset(&fake_can_txQueue, 0, sizeof(fake_can_txQueue));
+    fake_can_rxQueue.len = g_config->rx_queue_len;
+    fake_can_txQueue.len = g_config->tx_queue_len;
+    fake_can_f_config = *f_config;
+    fake_can_alertsEnabled = g_config->alerts_enabled;
+    fake_can_alerts = 0U;
+    fake_can_installed = true;
+    fake_can_statsData.installs++;
+    pthread_mutex_unlock(&fake_can_mutex);
+    return ESP_OK;
+}
+
+esp_err_t can_driver_uninstall(void)
+{
+    pthread_mutex_lock(&fake_can_mutex);
+    if (!fake_can_installed || fake_can_running)
+    {
+        pthread_mutex_unlock(&fake_can_mutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+    fake_can_installed = false;
+    pthread_mutex_unlock(&fake_can_mutex);
+    return ESP_OK;
+}
+
+esp_err_t can_start(void)
+{
+    esp_err_t ret = ESP_ERR_INVALID_STATE;
+
+    pthread_mutex_lock(&fake_can_mutex);
+    if (fake_can_installed && !fake_can_running)
+    {
+        fake_can_running = true;
+        ret = ESP_OK;
+    }
+    pthread_mutex_unlock(&fake_can_mutex);
+    return ret;
+}
+
+esp_err_t can_stop(void)
+{
+    esp_err_t ret = ESP_ERR_INVALID_STATE;
+
+    pthread_mutex_lock(&fake_can_mutex);
+    if (fake_can_running)
+    {
+        fake_can_running = false;
+        fake_can_txQueue.count = 0U;
+        ret = ESP_OK;
+    }
+    pthread_mutex_unlock(&fake_can_mutex);
+    return ret;
+}
+
+esp_err_t can_transmit(const can_message_t *message, TickType_t ticks_to_wait)
+{
+    esp_err_t ret = ESP_OK;
+
+    pthread_mutex_lock(&fake_can_mutex);
+    if (!fake_can_running)
+    {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    else
+    {
+        if ((fake_can_txQueue.count >= fake_can_txQueue.len) && (ticks_to_wait != 0U))
+        {
+            fake_can_wait(&fake_can_alertCond, ticks_to_wait);
+        }
+        if (!fake_can_push(&fake_can_txQueue, message))
+        {
+            ret = ESP_ERR_TIMEOUT;
+        }
+        else if (fake_can_txQueue.count > fake_can_statsData.txQueueMax)
+        {
+            fake_can_statsData.txQueueMax = fake_can_txQueue.count;
+        }
+    }
+    pthread_mutex_unlock(&fake_can_mutex);
+    return ret;
+}
+
+esp_err_t can_receive(can_message_t *message, TickType_t ticks_to_wait)
+{
+    esp_err_t ret = ESP_OK;
+
+    pthread_mutex_lock(&fake_can_mutex);
+    if ((fake_can_rxQueue.count == 0U) && (ticks_to_wait != 0U))
+    {
+        fake_can_wait(&fake_can_rxCond, ticks_to_wait);
+    }
+    if (!fake_can_pop(&fake_can_rxQueue, message))
+    {
+        ret = ESP_ERR_TIMEOUT;
+    }
+    pthread_mutex_unlock(&fake_can_mutex);
+    return ret;
+}
+
+esp_err_t can_read_alerts(uint32_t *alerts, TickType_t ticks_to_wait)
+{
+    esp_err_t ret = ESP_OK;
+
+    pthread_mutex_lock(&fake_can_mutex);
+    if ((fake_can_alerts == 0U) && (ticks_to_wait != 0U))
+    {
+        fake_can_wait(&fake_can_alertCond, ticks_to_wait);
+    }
+    *alerts = fake_can_alerts;
+    fake_can_alerts = 0U;
+    if (*alerts == 0U)
+    {
+        ret = ESP_ERR_TIMEOUT;
+    }
+    pthread_mutex_unlock(&fake_can_mutex);
+    return ret;
+}
+
+esp_err_t can_clear_transmit_queue(void)
+{
+    pthread_mutex_lock(&fake_can_mutex);
+    fake_can_txQueue.count = 0U;
+    pthread_mutex_unlock(&fake_can_mutex);
+    return ESP_OK;
+}
+
+bool fake_can_inject(const can_message_t *msg)
+{
+    bool ret = false;
+
+    pthread_mutex_lock(&fake_can_mutex);
+    if (fake_can_running)
+    {
+        if (!fake_can_match(&fake_can_f_config, msg->identifier, (msg->flags & CAN_MSG_FLAG_RTR) != 0U))
+        {
+            fake_can_statsData.rxFiltered++;
+        }
+        else if (!fake_can_push(&fake_can_rxQueue, msg))
+        {
+            fake_can_statsData.rxMissed++;
+        }
+        else
+        {
+            fake_can_statsData.rxAccepted++;
+            if (fake_can_rxQueue.count > fake_can_statsData.rxQueueMax)
+            {
+                fake_can_statsData.rxQueueMax = fake_can_rxQueue.count;
+            }
+            pthread_cond_signal(&fake_can_rxCond);
+            ret = true;
+        }
+    }
+    pthread_mutex_unlock(&fake_can_mutex);
+    return ret;
+}
+
+bool fake_can_txStep(can_message_t *msg)
+{
+    can_message_t sent;
+    bool ret;
+
+    pthread_mutex_lock(&fake_can_mutex);
+    ret = fake_can_pop(&fake_can_txQueue, &sent);
+    if (ret)
+    {
+        fake_can_statsData.txSent++;
+        fake_can_alerts |= CAN_ALERT_TX_SUCCESS & fake_can_alertsEnabled;
+        if (fake_can_txQueue.count == 0U)
+        {
+            fake_can_alerts |= CAN_ALERT_TX_IDLE & fake_can_alertsEnabled;
+        }
+        pthread_cond_broadcast(&fake_can_alertCond);
+        if (msg != NULL)
+        {
+            *msg = sent;
+        }
+    }
+    pthread_mutex_unlock(&fake_can_mutex);
+    return ret;
+}
+
+bool fake_can_filterMatch(const can_filter_config_t *filter, uint32_t ident, bool rtr)
+{
+    return fake_can_match(filter, ident, rtr);
+}
+
+can_filter_config_t fake_can_filter(void)
+{
+    can_filter_config_t f;
+
+    pthread_mutex_lock(&fake_can_mutex);
+    f = fake_can_f_config;
+    pthread_mutex_unlock(&fake_can_mutex);
+    return f;
+}
+
+uint32_t fake_can_rxQueueFill(void)
+{
+    uint32_t fill;
+
+    pthread_mutex_lock(&fake_can_mutex);
+    fill = fake_can_rxQueue.count;
+    pthread_mutex_unlock(&fake_can_mutex);
+    return fill;
+}
+
+uint32_t fake_can_txQueueFill(void)
+{
+    uint32_t fill;
+
+    pthread_mutex_lock(&fake_can_mutex);
+    fill = fake_can_txQueue.count;
+    pthread_mutex_unlock(&fake_can_mutex);
+    return fill;
+}
+
+void fake_can_stats(fake_can_stats_t *stats)
+{
+    pthread_mutex_lock(&fake_can_mutex);
+    *stats = fake_can_statsData;
+    pthread_mutex_unlock(&fake_can_mutex);
+}
+
+void fake_can_statsClear(void)
+{
+    pthread_mutex_lock(&fake_can_mutex);
+    memset(&fake_can_statsData, 0, sizeof(fake_can_statsData));
+    pthread_mutex_unlock(&fake_can_mutex);
+}
@@ -0,0 +1,52 @@
+/*
+ * Simulated esp can (TWAI) driver for host tests.
+ *
+ * The bus side of the controller is driven by the test: frames are injected
+ * into the RX queue through the acceptance filter, and frames waiting in the
+ * TX queue are put on the bus one at a time, which raises the same TX alerts
+ * as the esp can driver.
+ */
+
+#ifndef FAKE_CAN_H
+#define FAKE_CAN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driver/can.h"
+
+typedef struct
+{
+    uint32_t rxAccepted; /* frames passed by acceptance filter into RX queue */
+    uint32_t rxFiltered; /* frames rejected by acceptance filter */
+    uint32_t rxMissed;   /* accepted frames lost, because RX queue was full */
+    uint32_t rxQueueMax; /* highest RX queue fill seen */
+    uint32_t txSent;     /* frames put on the bus from TX queue */
+    uint32_t txQueueMax; /* highest TX queue fill seen */
+    uint32_t installs;   /* can_driver_install() calls */
+} fake_can_stats_t;
+
+/* Put frame on the bus for the controller to receive, as the TWAI ISR would
+ * see it. Returns false, if the frame was filtered or lost. */
+bool fake_can_inject(const can_message_t *msg);
+
+/* Send the oldest frame from TX queue, raise TX_SUCCESS and, if queue became
+ * empty, TX_IDLE. Returns false, if TX queue was empty. */
+bool fake_can_txStep(can_message_t *msg);
+
+/* True, if acceptance filter accepts standard frame, as TWAI matches it */
+bool fake_can_filterMatch(const can_filter_config_t *filter, uint32_t ident, bool rtr);
+
+/* Acceptance filter of installed driver */
+can_filter_config_t fake_can_filter(void);
+
+/* Number of frames in RX and TX queue */
+uint32_t fake_can_rxQueueFill(void);
+uint32_t fake_can_txQueueFill(void);
+
+void fake_can_stats(fake_can_stats_t *stats);
+
+/* Reset statistics */
+void fake_can_statsClear(void);
+
+#endif /* FAKE_CAN_H */
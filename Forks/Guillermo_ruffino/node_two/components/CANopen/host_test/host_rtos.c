@@ -0,0 +1,190 @@
+/*
+ * Host stand-in for FreeRTOS tasks, mutexes and esp_timer, used by host tests.
+ *
+ * Tasks run as pthreads without priorities or core affinity, which makes
+ * every race the two ESP32 cores can have possible on the host too.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+typedef struct
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t count;
+} host_notify_t;
+
+typedef struct
+{
+    TaskFunction_t function;
+    void *arg;
+    host_notify_t *notify; /* task handle */
+} host_task_t;
+
+static __thread host_notify_t *host_taskNotify = NULL;
+
+/* Absolute CLOCK_MONOTONIC time after ticks milliseconds */
+static struct timespec host_deadline(TickType_t ticks)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += ticks / 1000U;
+    ts.tv_nsec += (long)(ticks % 1000U) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+static host_notify_t *host_notifyNew(void)
+{
+    host_notify_t *notify = calloc(1, sizeof(host_notify_t));
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&notify->mutex, NULL);
+    pthread_cond_init(&notify->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    return notify;
+}
+
+static void *host_taskEntry(void *arg)
+{
+    host_task_t task = *(host_task_t *)arg;
+
+    free(arg);
+    host_taskNotify = task.notify;
+    task.function(task.arg);
+    return NULL;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackSize, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+    host_task_t *task = malloc(sizeof(host_task_t));
+    pthread_t thread;
+
+    (void)name;
+    (void)stackSize;
+    (void)priority;
+    (void)core;
+    task->function = function;
+    task->arg = arg;
+    task->notify = host_notifyNew();
+    /* handle is set before the task runs, as xTaskCreate() does */
+    if (handle != NULL)
+    {
+        *handle = (TaskHandle_t)task->notify;
+    }
+    if (pthread_create(&thread, NULL, host_taskEntry, task) != 0)
+    {
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL)
+    {
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = {ticks / 1000U, (long)(ticks % 1000U) * 1000000L};
+
+    nanosleep(&ts, NULL);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(esp_timer_get_time() / 1000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    if (host_taskNotify == NULL)
+    {
+        host_taskNotify = host_notifyNew();
+    }
+    return (TaskHandle_t)host_taskNotify;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks)
+{
+    host_notify_t *notify = (host_notify_t *)xTaskGetCurrentTaskHandle();
+    struct timespec deadline = host_deadline(ticks);
+    uint32_t count;
+
+    pthread_mutex_lock(&notify->mutex);
+    while ((notify->count == 0U) && (ticks != 0U))
+    {
+        if (pthread_cond_timedwait(&notify->cond, &notify->mutex, &deadline) == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+    count = notify->count;
+    if (count != 0U)
+    {
+        notify->count = clearOnExit ? 0U : count - 1U;
+    }
+    pthread_mutex_unlock(&notify->mutex);
+    return count;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    host_notify_t *notify = (host_notify_t *)task;
+
+    pthread_mutex_lock(&notify->mutex);
+    notify->count++;
+    pthread_cond_signal(&notify->cond);
+    pthread_mutex_unlock(&notify->mutex);
+    return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    pthread_mutex_t *mutex = malloc(sizeof(pthread_mutex_t));
+
+    pthread_mutex_init(mutex, NULL);
+    return (SemaphoreHandle_t)mutex;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    if (ticks == 0U)
+    {
+        return (pthread_mutex_trylock((pthread_mutex_t *)sem) == 0) ? pdTRUE : pdFALSE;
+    }
+    return (pthread_mutex_lock((pthread_mutex_t *)sem) == 0) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    return (pthread_mutex_unlock((pthread_mutex_t *)sem) == 0) ? pdTRUE : pdFALSE;
+}
@@ -0,0 +1,47 @@
+/*
+ * Common helpers for CANopen host tests.
+ *
+ * Each test is a standalone program, which includes the source file under
+ * test, so static functions can be tested too. It exits with non-zero status
+ * on the first failed CHECK and prints measured figures with REPORT.
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define CHECK(cond)                                                                  \
+    do                                                                               \
+    {                                                                                \
+        if (!(cond))                                                                 \
+        {                                                                            \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1);                                                                 \
+        }                                                                            \
+    } while (0)
+
+#define REPORT(fmt, ...) printf("  " fmt "\n", ##__VA_ARGS__)
+
+/* Monotonic time in seconds */
+static inline double host_test_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Sleep until absolute host_test_seconds() time */
+static inline void host_test_sleepUntil(double t)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)t;
+    ts.tv_nsec = (long)((t - (double)ts.tv_sec) * 1e9);
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+#endif /* HOST_TEST_H */
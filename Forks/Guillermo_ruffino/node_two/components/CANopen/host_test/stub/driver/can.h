@@ -0,0 +1,81 @@
+/*
+ * Host stand-in for esp can driver API, implemented by fake_can.c.
+ */
+
+#ifndef HOST_CAN_H
+#define HOST_CAN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef enum
+{
+    CAN_MODE_NORMAL,
+    CAN_MODE_NO_ACK,
+    CAN_MODE_LISTEN_ONLY
+} can_mode_t;
+
+#define CAN_IO_UNUSED (-1)
+
+#define CAN_MSG_FLAG_NONE 0x00
+#define CAN_MSG_FLAG_EXTD 0x01
+#define CAN_MSG_FLAG_RTR 0x02
+
+#define CAN_ALERT_TX_IDLE 0x0001
+#define CAN_ALERT_TX_SUCCESS 0x0002
+#define CAN_ALERT_TX_FAILED 0x0200
+#define CAN_ALERT_NONE 0x0000
+
+typedef struct
+{
+    uint32_t flags;
+    uint32_t identifier;
+    uint8_t data_length_code;
+    uint8_t data[8];
+} can_message_t;
+
+typedef struct
+{
+    can_mode_t mode;
+    int tx_io;
+    int rx_io;
+    int clkout_io;
+    int bus_off_io;
+    uint32_t tx_queue_len;
+    uint32_t rx_queue_len;
+    uint32_t alerts_enabled;
+    uint32_t clkout_divider;
+} can_general_config_t;
+
+typedef struct
+{
+    uint32_t brp;
+} can_timing_config_t;
+
+typedef struct
+{
+    uint32_t acceptance_code;
+    uint32_t acceptance_mask;
+    bool single_filter;
+} can_filter_config_t;
+
+#define CAN_GENERAL_CONFIG_DEFAULT(tx, rx, op_mode) \
+    {.mode = op_mode, .tx_io = tx, .rx_io = rx, .clkout_io = CAN_IO_UNUSED, .bus_off_io = CAN_IO_UNUSED, \
+     .tx_queue_len = 5, .rx_queue_len = 5, .alerts_enabled = CAN_ALERT_NONE, .clkout_divider = 0}
+#define CAN_TIMING_CONFIG_125KBITS() {.brp = 32}
+#define CAN_FILTER_CONFIG_ACCEPT_ALL() {.acceptance_code = 0, .acceptance_mask = 0xFFFFFFFF, .single_filter = true}
+
+esp_err_t can_driver_install(const can_general_config_t *g_config, const can_timing_config_t *t_config,
+                             const can_filter_config_t *f_config);
+esp_err_t can_driver_uninstall(void);
+esp_err_t can_start(void);
+esp_err_t can_stop(void);
+esp_err_t can_transmit(const can_message_t *message, TickType_t ticks_to_wait);
+esp_err_t can_receive(can_message_t *message, TickType_t ticks_to_wait);
+esp_err_t can_read_alerts(uint32_t *alerts, TickType_t ticks_to_wait);
+esp_err_t can_clear_transmit_queue(void);
+
+#endif /* HOST_CAN_H */
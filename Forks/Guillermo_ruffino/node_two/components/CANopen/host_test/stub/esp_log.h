@@ -0,0 +1,24 @@
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+#include <stdio.h>
+
+/* Errors and warnings are printed, info is not printed to keep test output
+ * short. Its arguments are still used and format checked, as with ESP-IDF log
+ * level below info. */
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) fprintf(stderr, "W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...)                                   \
+    do                                                            \
+    {                                                             \
+        if (0)                                                    \
+            fprintf(stderr, "I %s: " fmt "\n", tag, ##__VA_ARGS__); \
+    } while (0)
+#define ESP_LOGD(tag, fmt, ...)                                   \
+    do                                                            \
+    {                                                             \
+        if (0)                                                    \
+            fprintf(stderr, "D %s: " fmt "\n", tag, ##__VA_ARGS__); \
+    } while (0)
+
+#endif /* HOST_ESP_LOG_H */
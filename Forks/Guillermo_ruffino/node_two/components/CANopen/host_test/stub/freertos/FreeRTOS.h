@@ -0,0 +1,48 @@
+/*
+ * Host stand-in for FreeRTOS, used by host tests only. Tasks are pthreads,
+ * ticks are milliseconds and portMUX spinlocks really spin, so tests can
+ * race CANopenNode code on several threads. Spinning yields, so the thread
+ * holding the lock can run also on a single CPU host.
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <sched.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xFFFFFFFFU
+#define portTICK_PERIOD_MS 1
+#define configTICK_RATE_HZ 1000
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+typedef struct
+{
+    volatile int locked;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux)                                          \
+    do                                                                   \
+    {                                                                    \
+        while (__atomic_test_and_set(&(mux)->locked, __ATOMIC_ACQUIRE)) \
+        {                                                                \
+            sched_yield();                                               \
+        }                                                                \
+    } while (0)
+#define portEXIT_CRITICAL(mux) __atomic_clear(&(mux)->locked, __ATOMIC_RELEASE)
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
+
+#define IRAM_ATTR
+
+#endif /* HOST_FREERTOS_H */
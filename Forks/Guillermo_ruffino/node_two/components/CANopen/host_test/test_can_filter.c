@@ -0,0 +1,252 @@
+/*
+ * Acceptance filter synthesis from rx buffers: coverage of every configured
+ * identifier and false-accept rate for typical node layouts.
+ */
+
+#include "../CO_driver.c"
+
+#include "fake_can.h"
+#include "host_test.h"
+
+#define RX_SIZE 80U
+
+typedef struct
+{
+    uint16_t ident;
+    uint16_t mask;
+} layoutBuffer_t;
+
+static CO_CANmodule_t CANmodule;
+static CO_CANrx_t rxArray[RX_SIZE];
+static CO_CANtx_t txArray[4];
+static uint32_t rxDummy;
+
+static void rxCallback(void *object, void *msg)
+{
+    (void)msg;
+    (*(uint32_t *)object)++;
+}
+
+static void moduleInit(void)
+{
+    CHECK(CO_CANmodule_init(&CANmodule, NULL, rxArray, RX_SIZE, txArray, 4, 125) == CO_ERROR_NO);
+}
+
+static void rxBuffer(uint16_t index, uint16_t ident, uint16_t mask)
+{
+    CHECK(CO_CANrxBufferInit(&CANmodule, index, ident, mask, false, &rxDummy, rxCallback) == CO_ERROR_NO);
+}
+
+/* True, if any configured rx buffer wants the identifier */
+static bool wanted(uint16_t ident)
+{
+    uint16_t i;
+
+    for (i = 0U; i < RX_SIZE; i++)
+    {
+        const CO_CANrx_t *b = &rxArray[i];
+        if ((b->CANrx_callback != NULL) && (((ident ^ b->ident) & b->mask & 0x07FFU) == 0U))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Program filter and verify it against TWAI matching. Every wanted
+ * identifier must pass, and the count returned by CO_CANfilterSetup() must
+ * be the real number of identifiers passed. Returns number of false accepts. */
+static uint32_t verifyFilter(can_filter_config_t *filter, uint32_t *wantedCount)
+{
+    uint32_t size = CO_CANfilterSetup(&CANmodule, filter);
+    uint32_t accepted = 0U, falseAccepts = 0U;
+    uint16_t ident;
+
+    *wantedCount = 0U;
+    for (ident = 0U; ident < 0x800U; ident++)
+    {
+        bool pass = fake_can_filterMatch(filter, ident, false);
+
+        /* RTR is not filtered */
+        CHECK(pass == fake_can_filterMatch(filter, ident, true));
+        if (wanted(ident))
+        {
+            CHECK(pass);
+            (*wantedCount)++;
+        }
+        else if (pass)
+        {
+            falseAccepts++;
+        }
+        accepted += pass ? 1U : 0U;
+    }
+    CHECK(accepted == size);
+    return falseAccepts;
+}
+
+static void reportLayout(const char *name, const layoutBuffer_t *layout, uint16_t count)
+{
+    can_filter_config_t filter;
+    uint32_t wantedCount, falseAccepts;
+    uint16_t i;
+
+    moduleInit();
+    for (i = 0U; i < count; i++)
+    {
+        rxBuffer(i, layout[i].ident, layout[i].mask);
+    }
+    falseAccepts = verifyFilter(&filter, &wantedCount);
+    REPORT("%-34s %-6s accepts %4u of 2048, wanted %4u, false accepts %4u (%5.1f%% of unwanted)",
+           name, filter.single_filter ? "single" : "dual", wantedCount + falseAccepts, wantedCount,
+           falseAccepts, 100.0 * falseAccepts / (2048U - wantedCount));
+}
+
+#define NODE 0x0AU
+#define LAYOUT(name, ...)                                    \
+    do                                                       \
+    {                                                        \
+        static const layoutBuffer_t l[] = {__VA_ARGS__};     \
+        reportLayout(name, l, sizeof(l) / sizeof(l[0]));     \
+    } while (0)
+
+/* NMT, SYNC, 4 RPDOs and SDO server of one node */
+#define SLAVE_BUFFERS                                                                           \
+    {0x000, 0x7FF}, {0x080, 0x7FF}, {0x200 + NODE, 0x7FF}, {0x300 + NODE, 0x7FF},               \
+        {0x400 + NODE, 0x7FF}, {0x500 + NODE, 0x7FF}, {0x600 + NODE, 0x7FF}
+
+static void testLayouts(void)
+{
+    LAYOUT("slave (NMT SYNC 4xRPDO SDO)", SLAVE_BUFFERS);
+    LAYOUT("slave + 1 HB consumer", SLAVE_BUFFERS, {0x701, 0x7FF});
+    LAYOUT("slave + EMCY consumer + 1 HB cons.", SLAVE_BUFFERS, {0x080, 0x780}, {0x701, 0x7FF});
+    LAYOUT("node_two (+ SDO client, 4 HB cons.)", SLAVE_BUFFERS, {0x080, 0x780}, {0x580 + 0x20, 0x7FF},
+           {0x701, 0x7FF}, {0x702, 0x7FF}, {0x703, 0x7FF}, {0x704, 0x7FF});
+    LAYOUT("master (+ 8 HB cons., LSS master)", SLAVE_BUFFERS, {0x080, 0x780}, {0x580 + 0x20, 0x7FF},
+           {0x701, 0x7FF}, {0x702, 0x7FF}, {0x703, 0x7FF}, {0x704, 0x7FF}, {0x705, 0x7FF}, {0x706, 0x7FF},
+           {0x707, 0x7FF}, {0x708, 0x7FF}, {0x7E4, 0x7FF});
+}
+
+/* Gateway consuming TPDO1..4 of nodes 1..nodes */
+static void testGateway(uint16_t nodes)
+{
+    static const layoutBuffer_t base[] = {{0x000, 0x7FF}, {0x080, 0x7FF}, {0x600 + NODE, 0x7FF}};
+    layoutBuffer_t layout[RX_SIZE];
+    uint16_t count = 0U, n, pdo;
+    char name[40];
+
+    for (n = 0U; n < 3U; n++)
+    {
+        layout[count++] = base[n];
+    }
+    for (n = 1U; n <= nodes; n++)
+    {
+        for (pdo = 0U; pdo < 4U; pdo++)
+        {
+            layout[count++] = (layoutBuffer_t){0x180 + 0x100 * pdo + n, 0x7FF};
+        }
+    }
+    snprintf(name, sizeof(name), "gateway, TPDO1-4 of %u nodes", nodes);
+    reportLayout(name, layout, count);
+}
+
+/* Random layouts: coverage, exact count, and never wider than one filter */
+static void testRandom(void)
+{
+    uint32_t seed = 12345U;
+    int run;
+
+    for (run = 0; run < 2000; run++)
+    {
+        can_filter_config_t filter;
+        CO_CANfilterGroup_t single = {0};
+        uint32_t wantedCount, size;
+        uint16_t count, i;
+
+        moduleInit();
+        seed = seed * 1103515245U + 12345U;
+        count = 1U + (seed >> 16) % 24U;
+        for (i = 0U; i < count; i++)
+        {
+            uint16_t mask = 0x7FFU;
+
+            seed = seed * 1103515245U + 12345U;
+            if (((seed >> 8) & 7U) == 0U)
+            {
+                mask = 0x780U; /* partial mask like EMCY consumer */
+            }
+            rxBuffer(i * (RX_SIZE / 24U), (seed >> 16) & 0x7FFU, mask);
+        }
+        verifyFilter(&filter, &wantedCount);
+        size = CO_CANfilterSetup(&CANmodule, &filter);
+        for (i = 0U; i < RX_SIZE; i++)
+        {
+            if (rxArray[i].CANrx_callback != NULL)
+            {
+                CO_CANfilterMerge(&single, &rxArray[i]);
+            }
+        }
+        CHECK(size <= CO_CANfilterSize(&single));
+        CHECK(size >= wantedCount);
+    }
+}
+
+/* Disabled filters and empty module accept everything */
+static void testAcceptAll(void)
+{
+    can_filter_config_t filter;
+
+    moduleInit();
+    CHECK(CO_CANfilterSetup(&CANmodule, &filter) == 2048U);
+    CHECK(filter.single_filter && (filter.acceptance_mask == 0xFFFFFFFFU));
+
+    rxBuffer(0, 0x123, 0x7FF);
+    CANmodule.useCANrxFilters = false;
+    CHECK(CO_CANfilterSetup(&CANmodule, &filter) == 2048U);
+    CHECK(filter.acceptance_mask == 0xFFFFFFFFU);
+}
+
+/* Buffer configured in normal mode outside the filter does not reinstall
+ * the driver. Filter is reprogrammed on communication reset. */
+static void testRuntimeChange(void)
+{
+    fake_can_stats_t stats;
+    can_filter_config_t filter;
+    uint16_t i;
+
+    moduleInit();
+    for (i = 0U; i < 7U; i++)
+    {
+        static const layoutBuffer_t l[] = {SLAVE_BUFFERS};
+        rxBuffer(i, l[i].ident, l[i].mask);
+    }
+    fake_can_statsClear();
+    CO_CANsetNormalMode(&CANmodule);
+    CHECK(!fake_can_filterMatch(&f_config, 0x333, false));
+
+    /* RPDO COB-ID written by SDO */
+    rxBuffer(2, 0x333, 0x7FF);
+    CO_CANmodule_process(&CANmodule);
+    fake_can_stats(&stats);
+    CHECK((stats.installs == 1U) && CANmodule.CANnormal && (CO_CANrxTaskHandle != NULL));
+    filter = fake_can_filter();
+    CHECK(!fake_can_filterMatch(&filter, 0x333, false));
+
+    /* communication reset */
+    CO_CANsetConfigurationMode(NULL);
+    CO_CANsetNormalMode(&CANmodule);
+    fake_can_stats(&stats);
+    filter = fake_can_filter();
+    CHECK((stats.installs == 2U) && fake_can_filterMatch(&filter, 0x333, false));
+    CO_CANmodule_disable(&CANmodule);
+}
+
+int main(void)
+{
+    testLayouts();
+    testGateway(4);
+    testGateway(16);
+    testAcceptAll();
+    testRandom();
+    testRuntimeChange();
+    return 0;
+}
@@ -0,0 +1,396 @@
+/*
+ * CAN receive path: CAN-ID lookup, dispatch by CAN receive task and RX
+ * throughput at full bus load on simulated bus. Benchmark of dispatch with
+ * CAN-ID lookup and with linear mask search, which it replaced, at 8, 16, 64
+ * and 256 rx buffers.
+ */
+
+#include "../CO_driver.c"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "fake_can.h"
+#include "host_test.h"
+
+#define NODE_ID 0x0AU
+#define RX_SIZE 16U
+#define BENCH_RX_MAX 256U
+#define BENCH_FRAMES 4000000UL
+#define BENCH_SEQUENCE 4096U
+
+/* 1 Mbit/s, 8 data bytes, standard frame with worst case bit stuffing */
+#define BUS_FRAME_US 135.0
+#define BUS_SECONDS 2.0
+
+typedef struct
+{
+    uint16_t index;
+    volatile uint32_t count;
+    uint16_t lastIdent;
+    uint8_t lastData[8];
+} rxObject_t;
+
+static CO_CANmodule_t CANmodule;
+static CO_CANrx_t rxArray[RX_SIZE];
+static CO_CANtx_t txArray[4];
+static rxObject_t rxObject[RX_SIZE];
+static volatile uint32_t rxTotal;
+
+/* Same work as a typical CANopenNode receive function: check, copy, flag */
+static void rxCallback(void *object, void *msg)
+{
+    rxObject_t *o = (rxObject_t *)object;
+
+    o->lastIdent = CO_CANrxMsg_readIdent(msg);
+    memcpy(o->lastData, CO_CANrxMsg_readData(msg), sizeof(o->lastData));
+    __atomic_fetch_add(&o->count, 1U, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&rxTotal, 1U, __ATOMIC_RELEASE);
+}
+
+static void rxBuffer(uint16_t index, uint16_t ident, uint16_t mask, bool_t rtr)
+{
+    rxObject[index].index = index;
+    CHECK(CO_CANrxBufferInit(&CANmodule, index, ident, mask, rtr, &rxObject[index], rxCallback) == CO_ERROR_NO);
+}
+
+/* Reference for CO_CANrxFind(): buffers with full mask have precedence,
+ * lowest index first, then the first matching buffer with partial mask */
+static int referenceFind(uint16_t ident)
+{
+    uint16_t i;
+
+    for (i = 0U; i < RX_SIZE; i++)
+    {
+        const CO_CANrx_t *b = &rxArray[i];
+        if ((b->CANrx_callback != NULL) && CO_CANrxIsExact(b) && (((ident ^ b->ident) & b->mask) == 0U))
+        {
+            return i;
+        }
+    }
+    for (i = 0U; i < RX_SIZE; i++)
+    {
+        const CO_CANrx_t *b = &rxArray[i];
+        if ((b->CANrx_callback != NULL) && (((ident ^ b->ident) & b->mask) == 0U))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void waitRxTotal(uint32_t total)
+{
+    double timeout = host_test_seconds() + 2.0;
+
+    while (__atomic_load_n(&rxTotal, __ATOMIC_ACQUIRE) < total)
+    {
+        CHECK(host_test_seconds() < timeout);
+        vTaskDelay(1);
+    }
+}
+
+/* Typical node layout, same as CO_CANopenInit() registers, plus a second
+ * buffer for the same SDO identifier and one with the same identifier as RTR */
+static void nodeLayout(void)
+{
+    uint16_t i;
+
+    rxBuffer(0, 0x000, 0x7FF, false);              /* NMT */
+    rxBuffer(1, 0x080, 0x7FF, false);              /* SYNC */
+    rxBuffer(2, 0x080, 0x780, false);              /* EMCY consumer, partial mask */
+    rxBuffer(3, 0x100, 0x7FF, false);              /* TIME */
+    for (i = 0U; i < 4U; i++)
+    {
+        rxBuffer(4 + i, 0x200 + 0x100 * i + NODE_ID, 0x7FF, false); /* RPDO */
+    }
+    rxBuffer(8, 0x600 + NODE_ID, 0x7FF, false);    /* SDO server */
+    rxBuffer(9, 0x580 + 0x20, 0x7FF, false);       /* SDO client */
+    rxBuffer(10, 0x700 + 0x01, 0x7FF, false);      /* HB consumer */
+    rxBuffer(11, 0x700 + 0x02, 0x7FF, false);      /* HB consumer */
+    rxBuffer(12, 0x7E5, 0x7FF, false);             /* LSS slave */
+    rxBuffer(13, 0x600 + NODE_ID, 0x7FF, false);   /* duplicate, index 8 has precedence */
+    rxBuffer(14, 0x300 + NODE_ID, 0x7FF, true);    /* RTR, shares CAN-ID with RPDO 2 */
+}
+
+static void testLookup(void)
+{
+    uint32_t ident;
+
+    for (ident = 0U; ident < 0x1000U; ident++)
+    {
+        CO_CANrx_t *found = CO_CANrxFind(&CANmodule, ident);
+        int ref = referenceFind((uint16_t)ident);
+
+        CHECK((ref < 0) ? (found == NULL) : (found == &rxArray[ref]));
+    }
+
+    /* reconfigure duplicate away and back, precedence must follow */
+    rxBuffer(8, 0x123, 0x7FF, false);
+    CHECK(CO_CANrxFind(&CANmodule, 0x600 + NODE_ID) == &rxArray[13]);
+    rxBuffer(8, 0x600 + NODE_ID, 0x7FF, false);
+    CHECK(CO_CANrxFind(&CANmodule, 0x600 + NODE_ID) == &rxArray[8]);
+    CHECK(CO_CANrxFind(&CANmodule, 0x123) == NULL);
+}
+
+/* Every standard identifier through fake bus, acceptance filter and CAN receive task */
+static void testDispatch(void)
+{
+    uint32_t expected[RX_SIZE] = {0};
+    uint32_t total = 0U;
+    uint32_t ident;
+    uint16_t i;
+
+    for (ident = 0U; ident < 0x800U; ident++)
+    {
+        can_message_t msg = {.identifier = ident, .data_length_code = 8, .data = {ident & 0xFF, ident >> 8}};
+        int ref = referenceFind((uint16_t)ident);
+
+        if (fake_can_inject(&msg))
+        {
+            if (ref >= 0)
+            {
+                expected[ref]++;
+                total++;
+            }
+        }
+        else
+        {
+            CHECK(ref < 0); /* filter must not reject a configured identifier */
+        }
+        /* one frame at a time, so RX queue never overflows */
+        waitRxTotal(total);
+        while (fake_can_rxQueueFill() != 0U)
+        {
+            vTaskDelay(0);
+        }
+    }
+    for (i = 0U; i < RX_SIZE; i++)
+    {
+        CHECK(rxObject[i].count == expected[i]);
+    }
+    CHECK(rxObject[2].count == 0x80U - 1U); /* EMCY 0x081..0x0FF */
+    CHECK(rxObject[8].lastIdent == 0x600 + NODE_ID && rxObject[8].lastData[0] == NODE_ID);
+    CHECK(rxObject[13].count == 0U);
+}
+
+/* Inject frames at bus rate for BUS_SECONDS. Returns number of missed frames. */
+static uint32_t fullBusLoadRun(void)
+{
+    static const uint16_t idents[] = {0x080, 0x200 + NODE_ID, 0x300 + NODE_ID, 0x400 + NODE_ID, 0x500 + NODE_ID,
+                                      0x600 + NODE_ID, 0x701, 0x702, 0x181, 0x281};
+    uint32_t frames = (uint32_t)(BUS_SECONDS * 1e6 / BUS_FRAME_US);
+    uint32_t startTotal = rxTotal;
+    uint32_t expected = 0U;
+    fake_can_stats_t stats;
+    double start, t;
+    uint32_t n;
+
+    fake_can_statsClear();
+    start = host_test_seconds();
+    for (n = 0U; n < frames; n++)
+    {
+        can_message_t msg = {.identifier = idents[n % (sizeof(idents) / sizeof(idents[0]))], .data_length_code = 8};
+
+        memcpy(msg.data, &n, sizeof(n));
+        host_test_sleepUntil(start + n * BUS_FRAME_US * 1e-6);
+        if (fake_can_inject(&msg) && (referenceFind(msg.identifier) >= 0))
+        {
+            expected++;
+        }
+    }
+    t = host_test_seconds() - start;
+    waitRxTotal(startTotal + expected);
+    fake_can_stats(&stats);
+    CHECK(rxTotal - startTotal == expected);
+
+    REPORT("full bus load: %u frames in %.2f s (%.0f frames/s), %u accepted, %u filtered, %u missed, "
+           "RX queue max %u of %u",
+           frames, t, frames / t, stats.rxAccepted, stats.rxFiltered, stats.rxMissed, stats.rxQueueMax,
+           CAN_RX_QUEUE_LENGTH);
+    return stats.rxMissed;
+}
+
+/* No frame may be lost at full bus load. The host scheduler, unlike the
+ * ESP32 one with CAN receive task at priority CO_CAN_RX_TASK_PRIORITY, may
+ * stall the receive thread for longer than the RX queue covers, so a run
+ * with missed frames is repeated. */
+static void testFullBusLoad(void)
+{
+    int run;
+
+    for (run = 0; run < 3; run++)
+    {
+        if (fullBusLoadRun() == 0U)
+        {
+            return;
+        }
+    }
+    CHECK(false);
+}
+
+/* Inject as fast as possible, waiting only when RX queue is full */
+static void testDrainRate(void)
+{
+    const uint32_t frames = 1000000U;
+    uint32_t startTotal = rxTotal;
+    double start, t;
+    uint32_t n;
+
+    start = host_test_seconds();
+    for (n = 0U; n < frames; n++)
+    {
+        can_message_t msg = {.identifier = 0x200 + NODE_ID, .data_length_code = 8};
+
+        /* frame lost on full queue is injected again */
+        while (!fake_can_inject(&msg))
+        {
+            sched_yield();
+        }
+    }
+    waitRxTotal(startTotal + frames);
+    t = host_test_seconds() - start;
+    REPORT("CAN receive task drain rate: %.0f frames/s, %.0fx of full bus load", frames / t,
+           frames / t * BUS_FRAME_US * 1e-6);
+}
+
+/* Module for dispatch benchmark, not connected to the bus */
+static CO_CANmodule_t benchModule;
+static CO_CANrx_t benchRx[BENCH_RX_MAX];
+static uint16_t benchSequence[BENCH_SEQUENCE];
+static uint32_t benchCount;
+
+static void benchCallback(void *object, void *msg)
+{
+    (void)object;
+    benchCount += CO_CANrxMsg_readIdent(msg);
+}
+
+/* Dispatch as before CAN-ID lookup: first buffer, which matches with mask */
+static void linearDispatch(CO_CANmodule_t *CANmodule, can_message_t *msg)
+{
+    CO_CANrx_t *buffer = &CANmodule->rxArray[0];
+    uint16_t index;
+
+    for (index = CANmodule->rxSize; index > 0U; index--)
+    {
+        if (((msg->identifier ^ buffer->ident) & buffer->mask) == 0U)
+        {
+            buffer->CANrx_callback(buffer->object, (void *)msg);
+            return;
+        }
+        buffer++;
+    }
+}
+
+/* rxSize buffers, as CO_CANmodule_init() clears them. Last two have partial
+ * mask (EMCY consumer, SDO client range), others are RPDOs with full mask.
+ * Received frames are for random buffers, every 8th for a masked one. */
+static void benchSetup(uint16_t rxSize)
+{
+    uint32_t seed = 1U;
+    uint16_t i;
+
+    memset(&benchModule, 0, sizeof(benchModule));
+    benchModule.rxArray = benchRx;
+    benchModule.rxSize = rxSize;
+    for (i = 0U; i < rxSize; i++)
+    {
+        benchRx[i] = (CO_CANrx_t){.mask = 0xFFFFU};
+    }
+    for (i = 0U; i < rxSize - 2U; i++)
+    {
+        CHECK(CO_CANrxBufferInit(&benchModule, i, 0x180U + i, 0x7FF, false, &benchModule, benchCallback) ==
+              CO_ERROR_NO);
+    }
+    CHECK(CO_CANrxBufferInit(&benchModule, rxSize - 2U, 0x080, 0x780, false, &benchModule, benchCallback) ==
+          CO_ERROR_NO);
+    CHECK(CO_CANrxBufferInit(&benchModule, rxSize - 1U, 0x580, 0x780, false, &benchModule, benchCallback) ==
+          CO_ERROR_NO);
+
+    for (i = 0U; i < BENCH_SEQUENCE; i++)
+    {
+        seed = seed * 1103515245U + 12345U;
+        if (i % 8U == 7U)
+        {
+            benchSequence[i] = (uint16_t)((((seed >> 16) & 1U) != 0U ? 0x080U : 0x580U) + 1U + (seed >> 17) % 0x7FU);
+        }
+        else
+        {
+            benchSequence[i] = (uint16_t)(0x180U + (seed >> 16) % (rxSize - 2U));
+        }
+    }
+}
+
+/* Nanoseconds per dispatched frame */
+static double benchDispatch(bool_t linear)
+{
+    can_message_t msg = {.data_length_code = 8};
+    double start = host_test_seconds();
+    uint32_t n;
+
+    for (n = 0U; n < BENCH_FRAMES; n++)
+    {
+        msg.identifier = benchSequence[n % BENCH_SEQUENCE];
+        if (linear)
+        {
+            linearDispatch(&benchModule, &msg);
+        }
+        else
+        {
+            CO_CANrx_t *buffer = CO_CANrxFind(&benchModule, msg.identifier);
+
+            buffer->CANrx_callback(buffer->object, (void *)&msg);
+        }
+    }
+    return (host_test_seconds() - start) * 1e9 / BENCH_FRAMES;
+}
+
+static void benchmarkDispatch(void)
+{
+    static const uint16_t sizes[] = {8U, 16U, 64U, BENCH_RX_MAX};
+    uint16_t i;
+
+    for (i = 0U; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        uint32_t count;
+        double lookup, linear;
+        uint16_t k;
+
+        benchSetup(sizes[i]);
+        /* masked buffers are last, so both find the same buffer */
+        for (k = 0U; k < BENCH_SEQUENCE; k++)
+        {
+            can_message_t msg = {.identifier = benchSequence[k]};
+            CO_CANrx_t *found = CO_CANrxFind(&benchModule, msg.identifier);
+
+            CHECK(found != NULL && ((msg.identifier ^ found->ident) & found->mask) == 0U);
+            count = benchCount;
+            linearDispatch(&benchModule, &msg);
+            CHECK(benchCount == count + msg.identifier);
+        }
+        benchCount = 0U;
+        lookup = benchDispatch(false);
+        count = benchCount;
+        benchCount = 0U;
+        linear = benchDispatch(true);
+        CHECK(benchCount == count);
+        REPORT("rxSize %3u: ns per frame, CAN-ID lookup %5.1f, linear mask search %6.1f", sizes[i], lookup, linear);
+    }
+}
+
+int main(void)
+{
+    CHECK(CO_CANmodule_init(&CANmodule, NULL, rxArray, RX_SIZE, txArray, 4, 125) == CO_ERROR_NO);
+    nodeLayout();
+    testLookup();
+
+    CO_CANsetNormalMode(&CANmodule);
+    testDispatch();
+    testFullBusLoad();
+    testDrainRate();
+    CO_CANmodule_disable(&CANmodule);
+    CHECK(!CANmodule.CANnormal && (CO_CANrxTaskHandle == NULL));
+    benchmarkDispatch();
+    return 0;
+}
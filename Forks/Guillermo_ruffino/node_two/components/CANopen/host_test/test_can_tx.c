@@ -0,0 +1,569 @@
+/*
+ * CAN transmit path: txInFlight estimate, pending list fallback, buffer
+ * reinitialization, abort of synchronous TPDOs, latency per CAN-ID class and
+ * CO_CANsend() duration histogram on simulated bus. Benchmark of CO_CANsend()
+ * cost, which the Makefile trace target runs with CO_CAN_TRACE 0 and 1.
+ */
+
+#include "CO_config.h"
+#undef CO_CAN_SEND_STATS
+#define CO_CAN_SEND_STATS 1
+/* trace is only recorded, trace task doesn't print it during the test */
+#undef CO_CAN_TRACE_INTERVAL
+#define CO_CAN_TRACE_INTERVAL 60000
+
+#include "../CO_driver.c"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "fake_can.h"
+#include "host_test.h"
+
+#define TX_SIZE 16U
+#define SENDERS 2U
+
+/* 1 Mbit/s, 8 data bytes, standard frame with worst case bit stuffing */
+#define BUS_FRAME_US 135.0
+#define BUS_SECONDS 2.0
+
+static CO_CANmodule_t CANmodule;
+static CO_CANrx_t rxArray[1];
+static CO_CANtx_t *txBuffer[TX_SIZE];
+static CO_CANtx_t txArray[TX_SIZE];
+static volatile uint32_t txSent[TX_SIZE];
+static volatile bool busRunning;
+
+/* Put one frame from TX queue on the bus, count it by identifier */
+static bool busStep(void)
+{
+    can_message_t msg;
+
+    if (!fake_can_txStep(&msg))
+    {
+        return false;
+    }
+    CHECK(msg.identifier >= 0x180U && msg.identifier < 0x180U + TX_SIZE);
+    __atomic_fetch_add(&txSent[msg.identifier - 0x180U], 1U, __ATOMIC_RELEASE);
+    return true;
+}
+
+static uint32_t txSentTotal(void)
+{
+    uint32_t total = 0U;
+    uint16_t i;
+
+    for (i = 0U; i < TX_SIZE; i++)
+    {
+        total += __atomic_load_n(&txSent[i], __ATOMIC_ACQUIRE);
+    }
+    return total;
+}
+
+/* Wait, until CAN transmit task has sent all pending messages and has
+ * seen TX_IDLE */
+static void waitTxIdle(void)
+{
+    double timeout = host_test_seconds() + 2.0;
+
+    for (;;)
+    {
+        uint16_t count, inFlight;
+        CO_CANtx_t *pending;
+
+        CO_LOCK_CAN_SEND();
+        count = CANmodule.CANtxCount;
+        inFlight = CANmodule.txInFlight;
+        pending = CANmodule.txPending;
+        CO_UNLOCK_CAN_SEND();
+        if ((count == 0U) && (inFlight == 0U) && (pending == NULL) && (fake_can_txQueueFill() == 0U))
+        {
+            return;
+        }
+        CHECK(host_test_seconds() < timeout);
+        vTaskDelay(1);
+    }
+}
+
+/* TX_IDLE handled after CO_CANsend() has queued a new message leaves
+ * txInFlight too low. CO_CANsend() then finds TX queue full, and the
+ * message must go to pending list and be sent on a later TX alert. */
+static void testInFlightTooLow(void)
+{
+    uint32_t start = txSentTotal();
+    uint16_t i;
+
+    for (i = 0U; i <= CAN_TX_QUEUE_LENGTH; i++)
+    {
+        if (i == 1U)
+        {
+            /* first message is still in TX queue, as if late TX_IDLE has cleared it */
+            CO_LOCK_CAN_SEND();
+            CANmodule.txInFlight = 0U;
+            CO_UNLOCK_CAN_SEND();
+        }
+        CHECK(CO_CANsend(&CANmodule, txBuffer[i]) == CO_ERROR_NO);
+    }
+    CHECK(fake_can_txQueueFill() == CAN_TX_QUEUE_LENGTH);
+    CHECK(CANmodule.CANtxCount == 1U);
+    CHECK(CANmodule.txPending == txBuffer[CAN_TX_QUEUE_LENGTH]);
+
+    while (txSentTotal() - start < CAN_TX_QUEUE_LENGTH + 1U)
+    {
+        if (!busStep())
+        {
+            vTaskDelay(1); /* CAN transmit task refills TX queue */
+        }
+    }
+    waitTxIdle();
+    for (i = 0U; i <= CAN_TX_QUEUE_LENGTH; i++)
+    {
+        CHECK(txSent[i] == 1U);
+    }
+}
+
+/* Walk pending list locked, check it is sorted by CAN-ID and not longer
+ * than CANtxCount. Returns number of times buffer is in it. */
+static uint16_t pendingCheck(const CO_CANtx_t *buffer)
+{
+    const CO_CANtx_t *p;
+    uint16_t len = 0U, found = 0U;
+
+    CO_LOCK_CAN_SEND();
+    for (p = CANmodule.txPending; p != NULL; p = p->next)
+    {
+        CHECK(++len <= CANmodule.CANtxCount);
+        CHECK((p->next == NULL) || (p->ident <= p->next->ident));
+        if (p == buffer)
+        {
+            found++;
+        }
+    }
+    CO_UNLOCK_CAN_SEND();
+    return found;
+}
+
+/* Buffer reinitialized with new CAN-ID, while it is pending, as on COB-ID
+ * write by SDO. It must leave pending list, and when sent again, go to
+ * its new place in CAN-ID order, instead of being linked in twice. */
+static void testReinitPending(void)
+{
+    const uint16_t first = CAN_TX_QUEUE_LENGTH;
+    CO_CANtx_t *buffer = txBuffer[first + 1U];
+    uint32_t sent0 = txSent[0], sent = txSent[first + 1U];
+    uint32_t start = txSentTotal();
+    uint16_t i;
+
+    /* fill TX queue, next 4 messages wait in pending list. CAN transmit
+     * task may try to move list head only, which is not reinitialized. */
+    for (i = 0U; i < first + 4U; i++)
+    {
+        CHECK(CO_CANsend(&CANmodule, txBuffer[i]) == CO_ERROR_NO);
+    }
+    CHECK(CANmodule.CANtxCount == 4U);
+    CHECK(pendingCheck(buffer) == 1U);
+
+    /* lowest CAN-ID, same as txBuffer[0] */
+    CHECK(CO_CANtxBufferInit(&CANmodule, first + 1U, 0x180U, false, 8, false) == buffer);
+    CHECK(!buffer->bufferFull && (CANmodule.CANtxCount == 3U));
+    CHECK(pendingCheck(buffer) == 0U);
+
+    CHECK(CO_CANsend(&CANmodule, buffer) == CO_ERROR_NO);
+    CHECK(CANmodule.CANtxCount == 4U);
+    CHECK(pendingCheck(buffer) == 1U);
+    CHECK(CANmodule.txPending == buffer);
+
+    while (txSentTotal() - start < first + 4U)
+    {
+        if (!busStep())
+        {
+            vTaskDelay(1);
+        }
+    }
+    waitTxIdle();
+    CHECK(txSent[0] == sent0 + 2U);
+    CHECK(txSent[first + 1U] == sent);
+    CHECK(CO_CANtxBufferInit(&CANmodule, first + 1U, 0x180U + first + 1U, false, 8, false) == buffer);
+}
+
+/* Synchronous TPDO in TX queue is aborted outside SYNC window. Cleared TX
+ * queue raises no TX alert, so txInFlight must be reset with it, and
+ * pending messages must go to TX queue at once, not on a later alert. */
+static void testClearSyncPDOs(void)
+{
+    const uint16_t sync = CAN_TX_QUEUE_LENGTH - 1U;
+    uint32_t start = txSentTotal();
+    uint16_t i;
+
+    CHECK(CO_CANtxBufferInit(&CANmodule, sync, 0x180U + sync, false, 8, true) == txBuffer[sync]);
+    /* synchronous TPDO is the last one in full TX queue, next two are pending */
+    for (i = 0U; i < CAN_TX_QUEUE_LENGTH + 2U; i++)
+    {
+        CHECK(CO_CANsend(&CANmodule, txBuffer[i]) == CO_ERROR_NO);
+    }
+    CHECK(CANmodule.bufferInhibitFlag && (CANmodule.txInFlight == CAN_TX_QUEUE_LENGTH));
+    CHECK(CANmodule.CANtxCount == 2U);
+
+    CO_CANclearPendingSyncPDOs(&CANmodule);
+    CHECK((CANmodule.CANerrorStatus & CO_CAN_ERRTX_PDO_LATE) != 0U);
+    CANmodule.CANerrorStatus &= ~CO_CAN_ERRTX_PDO_LATE;
+    CHECK((CANmodule.CANtxCount == 0U) && (CANmodule.txInFlight == 2U));
+    CHECK(fake_can_txQueueFill() == 2U);
+    /* TX queue is not seen full */
+    CHECK(CO_CANsend(&CANmodule, txBuffer[CAN_TX_QUEUE_LENGTH + 2U]) == CO_ERROR_NO);
+    CHECK((CANmodule.CANtxCount == 0U) && (fake_can_txQueueFill() == 3U));
+
+    while (busStep())
+    {
+    }
+    waitTxIdle();
+    CHECK(txSentTotal() - start == 3U);
+    CHECK(CO_CANtxBufferInit(&CANmodule, sync, 0x180U + sync, false, 8, false) == txBuffer[sync]);
+}
+
+static void *busThread(void *arg)
+{
+    double start = host_test_seconds();
+    uint32_t n = 0U;
+
+    (void)arg;
+    while (busRunning)
+    {
+        host_test_sleepUntil(start + n * BUS_FRAME_US * 1e-6);
+        if (busStep())
+        {
+            n++;
+        }
+        else
+        {
+            start = host_test_seconds();
+            n = 1U;
+        }
+    }
+    return NULL;
+}
+
+typedef struct
+{
+    uint16_t first;
+    uint32_t sent;     /* CO_CANsend() returned CO_ERROR_NO */
+    uint32_t overflow; /* CO_CANsend() returned CO_ERROR_TX_OVERFLOW */
+} sender_t;
+
+/* Send own buffers in turn for BUS_SECONDS, twice as fast as bus can take them */
+static void *senderThread(void *arg)
+{
+    sender_t *s = (sender_t *)arg;
+    double start = host_test_seconds();
+    uint32_t n = 0U;
+
+    while (host_test_seconds() - start < BUS_SECONDS)
+    {
+        CO_CANtx_t *buffer = txBuffer[s->first + n % (TX_SIZE / SENDERS)];
+        CO_ReturnError_t err = CO_CANsend(&CANmodule, buffer);
+
+        CHECK(err == CO_ERROR_NO || err == CO_ERROR_TX_OVERFLOW);
+        if (err == CO_ERROR_NO)
+        {
+            s->sent++;
+        }
+        else
+        {
+            s->overflow++;
+        }
+        n++;
+        host_test_sleepUntil(start + n * BUS_FRAME_US * SENDERS / 2.0 * 1e-6);
+    }
+    return NULL;
+}
+
+/* Senders on two threads, CAN transmit task and bus race on txInFlight.
+ * Every accepted message must reach the bus exactly once. */
+static void testStress(void)
+{
+    pthread_t bus, sender[SENDERS];
+    sender_t s[SENDERS];
+    uint32_t start = txSentTotal();
+    uint32_t sent = 0U, overflow = 0U;
+    fake_can_stats_t stats;
+    uint16_t i;
+
+    fake_can_statsClear();
+    busRunning = true;
+    CHECK(pthread_create(&bus, NULL, busThread, NULL) == 0);
+    for (i = 0U; i < SENDERS; i++)
+    {
+        s[i] = (sender_t){.first = i * (TX_SIZE / SENDERS)};
+        CHECK(pthread_create(&sender[i], NULL, senderThread, &s[i]) == 0);
+    }
+    for (i = 0U; i < SENDERS; i++)
+    {
+        pthread_join(sender[i], NULL);
+        sent += s[i].sent;
+        overflow += s[i].overflow;
+    }
+    waitTxIdle();
+    busRunning = false;
+    pthread_join(bus, NULL);
+    fake_can_stats(&stats);
+
+    CHECK(txSentTotal() - start == sent);
+    CHECK(CANmodule.txInFlight <= CAN_TX_QUEUE_LENGTH);
+    REPORT("stress: %u messages sent, %u overflowed, TX queue max %u of %u", sent, overflow, stats.txQueueMax,
+           CAN_TX_QUEUE_LENGTH);
+}
+
+/* CAN-ID classes for latency test, in priority order */
+#define LAT_CLASSES 3U
+#define LAT_RING 64U /* send times per buffer, more than TX queue + pending */
+#define LAT_SAMPLES 65536U
+
+static const char *const latClassName[LAT_CLASSES] = {"NMT/SYNC/EMCY", "PDO", "SDO"};
+
+/* Buffer CAN-ID, class and send period in us, 0 sends whenever buffer is free */
+static const struct
+{
+    uint16_t ident;
+    uint8_t latClass;
+    uint32_t period;
+} latTraffic[TX_SIZE] = {
+    {0x000U, 0U, 100000U}, {0x080U, 0U, 1000U}, {0x081U, 0U, 10000U}, {0x082U, 0U, 10000U},
+    {0x181U, 1U, 2000U},   {0x182U, 1U, 2000U}, {0x281U, 1U, 2000U},  {0x282U, 1U, 2000U},
+    {0x381U, 1U, 2000U},   {0x382U, 1U, 2000U}, {0x481U, 1U, 2000U},  {0x482U, 1U, 2000U},
+    {0x581U, 2U, 0U},      {0x582U, 2U, 0U},    {0x601U, 2U, 0U},     {0x602U, 2U, 0U},
+};
+
+/* Send times of frames not yet on the bus, per buffer. Written by sender,
+ * read by bus thread. */
+static double latSendTime[TX_SIZE][LAT_RING];
+static volatile uint32_t latHead[TX_SIZE], latTail[TX_SIZE];
+static float latSamples[LAT_CLASSES][LAT_SAMPLES];
+static uint32_t latCount[LAT_CLASSES];
+static uint32_t latInversions;
+
+static uint16_t latIndex(uint32_t ident)
+{
+    uint16_t i;
+
+    for (i = 0U; i < TX_SIZE; i++)
+    {
+        if (latTraffic[i].ident == ident)
+        {
+            return i;
+        }
+    }
+    CHECK(false);
+    return 0U;
+}
+
+/* Put frames on the bus at bus rate. For each frame record time since its
+ * CO_CANsend() and check, that no frame with lower CAN-ID, sent earlier,
+ * is still waiting. */
+static void *latBusThread(void *arg)
+{
+    double start = host_test_seconds();
+    uint32_t n = 0U;
+
+    (void)arg;
+    while (busRunning)
+    {
+        can_message_t msg;
+        uint16_t i, j;
+        uint32_t tail;
+        double sendTime;
+
+        host_test_sleepUntil(start + n * BUS_FRAME_US * 1e-6);
+        if (!fake_can_txStep(&msg))
+        {
+            start = host_test_seconds();
+            n = 1U;
+            continue;
+        }
+        n++;
+        i = latIndex(msg.identifier);
+        tail = latTail[i];
+        /* sender records send time just after CO_CANsend() returns */
+        while (__atomic_load_n(&latHead[i], __ATOMIC_ACQUIRE) == tail)
+        {
+            sched_yield();
+        }
+        sendTime = latSendTime[i][tail % LAT_RING];
+        __atomic_store_n(&latTail[i], tail + 1U, __ATOMIC_RELEASE);
+        if (latCount[latTraffic[i].latClass] < LAT_SAMPLES)
+        {
+            latSamples[latTraffic[i].latClass][latCount[latTraffic[i].latClass]++] =
+                (float)((host_test_seconds() - sendTime) * 1e6);
+        }
+        for (j = 0U; j < TX_SIZE; j++)
+        {
+            uint32_t t = latTail[j];
+
+            if ((latTraffic[j].ident < msg.identifier) && (__atomic_load_n(&latHead[j], __ATOMIC_ACQUIRE) != t) &&
+                (latSendTime[j][t % LAT_RING] < sendTime))
+            {
+                latInversions++;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Offer latTraffic for BUS_SECONDS, SDO buffers fill bus to full load */
+static void *latSenderThread(void *arg)
+{
+    double start = host_test_seconds();
+    double next[TX_SIZE] = {0};
+    uint32_t n = 0U;
+
+    (void)arg;
+    for (;;)
+    {
+        double now = host_test_seconds() - start;
+        uint16_t i;
+
+        if (now >= BUS_SECONDS)
+        {
+            break;
+        }
+        for (i = 0U; i < TX_SIZE; i++)
+        {
+            double t;
+
+            if (now < next[i])
+            {
+                continue;
+            }
+            next[i] += latTraffic[i].period * 1e-6;
+            CHECK(latHead[i] - latTail[i] < LAT_RING);
+            t = host_test_seconds();
+            if (CO_CANsend(&CANmodule, txBuffer[i]) == CO_ERROR_NO)
+            {
+                latSendTime[i][latHead[i] % LAT_RING] = t;
+                __atomic_store_n(&latHead[i], latHead[i] + 1U, __ATOMIC_RELEASE);
+            }
+        }
+        n++;
+        host_test_sleepUntil(start + n * BUS_FRAME_US / 2.0 * 1e-6);
+    }
+    return NULL;
+}
+
+static int latCompare(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Queue-to-bus latency per CAN-ID class with fully loaded bus */
+static void testLatency(void)
+{
+    pthread_t bus, sender;
+    uint16_t i;
+
+    for (i = 0U; i < TX_SIZE; i++)
+    {
+        CHECK(CO_CANtxBufferInit(&CANmodule, i, latTraffic[i].ident, false, 8, false) == txBuffer[i]);
+    }
+    busRunning = true;
+    CHECK(pthread_create(&bus, NULL, latBusThread, NULL) == 0);
+    CHECK(pthread_create(&sender, NULL, latSenderThread, NULL) == 0);
+    pthread_join(sender, NULL);
+    waitTxIdle();
+    busRunning = false;
+    pthread_join(bus, NULL);
+
+    for (i = 0U; i < TX_SIZE; i++)
+    {
+        CHECK(latHead[i] == latTail[i]);
+    }
+    for (i = 0U; i < LAT_CLASSES; i++)
+    {
+        uint32_t count = latCount[i];
+
+        CHECK(count > 0U);
+        qsort(latSamples[i], count, sizeof(float), latCompare);
+        REPORT("latency %-13s %6u frames, us p50 %7.0f p90 %7.0f p99 %7.0f max %7.0f", latClassName[i], count,
+               latSamples[i][count / 2U], latSamples[i][count * 9U / 10U], latSamples[i][count * 99U / 100U],
+               latSamples[i][count - 1U]);
+    }
+    CHECK(latInversions == 0U);
+}
+
+/* Nanoseconds per CO_CANsend() into empty TX queue, without duration
+ * statistics. Bus is drained between batches, untimed. */
+static double benchmarkSend(void)
+{
+    const uint32_t batches = 200000U;
+    double total = 0.0;
+#if CO_CAN_TRACE
+    uint32_t traceStart = CO_CANtraceHead;
+#endif
+    uint32_t n;
+
+    waitTxIdle();
+    for (n = 0U; n < batches; n++)
+    {
+        double start = host_test_seconds();
+        uint16_t i;
+
+        for (i = 0U; i < CAN_TX_QUEUE_LENGTH; i++)
+        {
+            CHECK(CO_CANsendBuffer(&CANmodule, txBuffer[i]) == CO_ERROR_NO);
+        }
+        total += host_test_seconds() - start;
+        while (busStep())
+        {
+        }
+        /* as TX_IDLE would, before CAN transmit task sees it */
+        CO_LOCK_CAN_SEND();
+        CHECK(CANmodule.CANtxCount == 0U);
+        CANmodule.txInFlight = 0U;
+        CO_UNLOCK_CAN_SEND();
+    }
+#if CO_CAN_TRACE
+    CHECK(CO_CANtraceHead - traceStart == batches * CAN_TX_QUEUE_LENGTH);
+#endif
+    return total * 1e9 / (batches * CAN_TX_QUEUE_LENGTH);
+}
+
+static void reportSendStats(void)
+{
+    char line[16 * CO_CAN_SEND_STATS_BINS];
+    uint32_t total = 0U;
+    int len = 0;
+    uint32_t i;
+
+    for (i = 0U; i < CO_CAN_SEND_STATS_BINS; i++)
+    {
+        total += CO_CANsendHist[i];
+        if (CO_CANsendHist[i] != 0U)
+        {
+            len += snprintf(&line[len], sizeof(line) - len, " <%u:%u", 1U << i, CO_CANsendHist[i]);
+        }
+    }
+    REPORT("CO_CANsend: %u calls, max %u us, histogram [us:count]%s", total, CO_CANsendMax, line);
+}
+
+int main(void)
+{
+    uint16_t i;
+
+    CHECK(CO_CANmodule_init(&CANmodule, NULL, rxArray, 1, txArray, TX_SIZE, 125) == CO_ERROR_NO);
+    for (i = 0U; i < TX_SIZE; i++)
+    {
+        txBuffer[i] = CO_CANtxBufferInit(&CANmodule, i, 0x180U + i, false, 8, false);
+        CHECK(txBuffer[i] != NULL);
+    }
+    CO_CANsetNormalMode(&CANmodule);
+    testInFlightTooLow();
+    testReinitPending();
+    testClearSyncPDOs();
+    testStress();
+    REPORT("CO_CAN_TRACE %d: %.1f ns per CO_CANsend()", CO_CAN_TRACE, benchmarkSend());
+    testLatency();
+    reportSendStats();
+    CO_CANmodule_disable(&CANmodule);
+    CHECK(!CANmodule.CANnormal && (CO_CANtxTaskHandle == NULL));
+    return 0;
+}
@@ -0,0 +1,382 @@
+/*
+ * CO_LOCK_* sections, CO_FLAG_* flags and emergency buffer hammered from
+ * several threads, as CAN tasks, esp_timer task and mainline do on ESP32.
+ *
+ * Critical sections and CO_errorReport() yield at the points, where another
+ * thread would break a missing or too narrow lock, so races show up also on
+ * a single CPU host.
+ */
+
+#include <sched.h>
+
+#include "CO_driver.h"
+
+/* yield just before entering EMCY section, after any check done outside it */
+#undef CO_LOCK_EMCY
+#define CO_LOCK_EMCY()                      \
+    do                                      \
+    {                                       \
+        sched_yield();                      \
+        portENTER_CRITICAL(&CO_EMCYmux);    \
+    } while (0)
+
+#include "../CO_Emergency.c"
+
+#include <pthread.h>
+
+#include "host_test.h"
+
+#define THREADS 4U
+#define LOCK_ROUNDS 20000U
+#define FLAG_ROUNDS 100000U
+#define BIT_ROUNDS 20000U
+#define EM_PRODUCERS 2U
+#define EM_ROUNDS 20000U
+
+static volatile bool start;
+
+static void waitStart(void)
+{
+    while (!start)
+    {
+        sched_yield();
+    }
+}
+
+static void runThreads(void *(*fn)(void *), uint32_t count)
+{
+    pthread_t thread[THREADS + 1U];
+    uint32_t i;
+
+    start = false;
+    for (i = 0U; i < count; i++)
+    {
+        CHECK(pthread_create(&thread[i], NULL, fn, (void *)(uintptr_t)i) == 0);
+    }
+    start = true;
+    for (i = 0U; i < count; i++)
+    {
+        pthread_join(thread[i], NULL);
+    }
+}
+
+/* Each lock guards two plain counters, which must be equal inside section */
+static uint32_t lockA, lockB;
+static uint32_t lockViolations;
+static int lockKind;
+
+static void lockEnter(void)
+{
+    switch (lockKind)
+    {
+    case 0:
+        CO_LOCK_CAN_SEND();
+        break;
+    case 1:
+        CO_LOCK_EMCY();
+        break;
+    default:
+        CO_LOCK_OD();
+        break;
+    }
+}
+
+static void lockExit(void)
+{
+    switch (lockKind)
+    {
+    case 0:
+        CO_UNLOCK_CAN_SEND();
+        break;
+    case 1:
+        CO_UNLOCK_EMCY();
+        break;
+    default:
+        CO_UNLOCK_OD();
+        break;
+    }
+}
+
+static void *lockThread(void *arg)
+{
+    uint32_t n;
+
+    (void)arg;
+    waitStart();
+    for (n = 0U; n < LOCK_ROUNDS; n++)
+    {
+        lockEnter();
+        if (lockA != lockB)
+        {
+            lockViolations++;
+        }
+        lockA++;
+        if ((n & 0xFU) == 0U)
+        {
+            /* give other threads the chance to enter, if lock is broken */
+            sched_yield();
+        }
+        lockB++;
+        lockExit();
+    }
+    return NULL;
+}
+
+static void testLocks(void)
+{
+    static const char *const name[] = {"CO_LOCK_CAN_SEND", "CO_LOCK_EMCY", "CO_LOCK_OD"};
+
+    for (lockKind = 0; lockKind < 3; lockKind++)
+    {
+        double t = host_test_seconds();
+
+        lockA = lockB = lockViolations = 0U;
+        runThreads(lockThread, THREADS);
+        t = host_test_seconds() - t;
+        CHECK(lockViolations == 0U);
+        CHECK(lockA == THREADS * LOCK_ROUNDS && lockB == lockA);
+        REPORT("%-16s %u threads x %u sections, 0 violations, %.2f us per section", name[lockKind], THREADS,
+               LOCK_ROUNDS, t * 1e6 / (THREADS * LOCK_ROUNDS));
+    }
+}
+
+/* CO_FLAG_SET publishes data written before it to CO_FLAG_READ, as from
+ * CAN receive function to processing function */
+static volatile void *flag;
+static uint32_t flagData[2];
+
+static void *flagProducer(void *arg)
+{
+    uint32_t n;
+
+    (void)arg;
+    waitStart();
+    for (n = 1U; n <= FLAG_ROUNDS; n++)
+    {
+        while (CO_FLAG_READ(flag))
+        {
+            sched_yield();
+        }
+        flagData[0] = n;
+        flagData[1] = ~n;
+        CO_FLAG_SET(flag);
+    }
+    return NULL;
+}
+
+static void *flagConsumer(void *arg)
+{
+    uint32_t n;
+
+    (void)arg;
+    waitStart();
+    for (n = 1U; n <= FLAG_ROUNDS; n++)
+    {
+        while (!CO_FLAG_READ(flag))
+        {
+            sched_yield();
+        }
+        CHECK(flagData[0] == n && flagData[1] == ~n);
+        CO_FLAG_CLEAR(flag);
+    }
+    return NULL;
+}
+
+static void *flagThread(void *arg)
+{
+    return ((uintptr_t)arg == 0U) ? flagProducer(arg) : flagConsumer(arg);
+}
+
+static void testFlags(void)
+{
+    runThreads(flagThread, 2U);
+    CHECK(!CO_FLAG_READ(flag));
+    REPORT("CO_FLAG_SET/READ/CLEAR %u messages handed over in order", FLAG_ROUNDS);
+}
+
+/* CO_FLAG_SET_BITS from several threads into one word, CO_FLAG_TAKE_BITS
+ * from another, as RPDO receive functions and CO_RPDOsched_process() do.
+ * Producer sets its bit again only after the consumer has taken it, so any
+ * lost bit stops the producer. */
+static uint32_t bitWord;
+static uint32_t bitTaken[THREADS];
+
+static void *bitProducer(void *arg)
+{
+    uint32_t i = (uint32_t)(uintptr_t)arg;
+    double timeout;
+    uint32_t n;
+
+    waitStart();
+    timeout = host_test_seconds() + 20.0;
+    for (n = 1U; n <= BIT_ROUNDS; n++)
+    {
+        CO_FLAG_SET_BITS(bitWord, 1UL << (i * 8U));
+        while (__atomic_load_n(&bitTaken[i], __ATOMIC_ACQUIRE) != n)
+        {
+            CHECK(host_test_seconds() < timeout);
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *bitThread(void *arg)
+{
+    uint32_t total = 0U;
+
+    if ((uintptr_t)arg < THREADS)
+    {
+        return bitProducer(arg);
+    }
+    waitStart();
+    while (total < THREADS * BIT_ROUNDS)
+    {
+        uint32_t bits = CO_FLAG_TAKE_BITS(bitWord);
+        uint32_t i;
+
+        for (i = 0U; i < THREADS; i++)
+        {
+            if (bits & (1UL << (i * 8U)))
+            {
+                __atomic_fetch_add(&bitTaken[i], 1U, __ATOMIC_RELEASE);
+                total++;
+            }
+        }
+        CHECK((bits & ~0x01010101UL) == 0U);
+        sched_yield();
+    }
+    return NULL;
+}
+
+static void testBits(void)
+{
+    runThreads(bitThread, THREADS + 1U);
+    CHECK(bitWord == 0U);
+    REPORT("CO_FLAG_SET_BITS/TAKE_BITS %u threads x %u bits into one word, none lost", THREADS, BIT_ROUNDS);
+}
+
+/* Emergency buffer: producers report and reset their own error bits, which
+ * share one byte of errorStatusBits, consumer takes messages as
+ * CO_EM_process() does. Every message accepted into the buffer, counted by
+ * pFunctSignalPre, must come out once and in order. */
+static CO_EM_t em;
+static uint8_t errorStatusBits[10];
+static uint32_t emAccepted[EM_PRODUCERS];
+static uint32_t emReceived[EM_PRODUCERS];
+static uint32_t emOverflows;
+static volatile uint32_t emProducersDone;
+static __thread uint32_t emSignals;
+
+static void emSignal(void *object)
+{
+    (void)object;
+    emSignals++;
+}
+
+static void *emProducer(void *arg)
+{
+    uint32_t p = (uint32_t)(uintptr_t)arg;
+    uint8_t errorBit = CO_EM_MANUFACTURER_START + p;
+    uint32_t n;
+
+    waitStart();
+    for (n = 1U; n <= EM_ROUNDS; n++)
+    {
+        CO_errorReport(&em, errorBit, CO_EMC_GENERIC, n);
+        CHECK(CO_isError(&em, errorBit));
+        CO_errorReset(&em, errorBit, n);
+        CHECK(!CO_isError(&em, errorBit));
+    }
+    emAccepted[p] = emSignals;
+    __atomic_fetch_add(&emProducersDone, 1U, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void *emConsumer(void *arg)
+{
+    uint32_t last[EM_PRODUCERS] = {0};
+
+    (void)arg;
+    waitStart();
+    for (;;)
+    {
+        bool_t done = __atomic_load_n(&emProducersDone, __ATOMIC_ACQUIRE) == EM_PRODUCERS;
+        uint8_t msg[8];
+        bool_t overflow;
+        uint16_t errorCode;
+        uint32_t infoCode, seq, p;
+
+        if ((em.bufReadPtr == em.bufWritePtr) && !em.bufFull)
+        {
+            if (done)
+            {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+        CO_EM_bufTake(&em, msg, 0x81U, &overflow);
+        if (overflow)
+        {
+            emOverflows++;
+        }
+        CO_memcpySwap2(&errorCode, &msg[0]);
+        CO_memcpySwap4(&infoCode, &msg[4]);
+        CHECK(msg[2] == 0x81U);
+        CHECK(msg[3] >= CO_EM_MANUFACTURER_START && msg[3] < CO_EM_MANUFACTURER_START + EM_PRODUCERS);
+        p = msg[3] - CO_EM_MANUFACTURER_START;
+        /* report n, reset n, report n + 1, ... */
+        CHECK(errorCode == CO_EMC_GENERIC || errorCode == 0U);
+        seq = infoCode * 2U + (errorCode == 0U ? 1U : 0U);
+        CHECK(seq > last[p]);
+        last[p] = seq;
+        emReceived[p]++;
+        /* slower than producers, so buffer is mostly full */
+        sched_yield();
+        sched_yield();
+    }
+    return NULL;
+}
+
+static void *emThread(void *arg)
+{
+    return ((uintptr_t)arg < EM_PRODUCERS) ? emProducer(arg) : emConsumer(arg);
+}
+
+static void testEmergency(void)
+{
+    uint32_t p, accepted = 0U, received = 0U;
+
+    memset(&em, 0, sizeof(em));
+    em.errorStatusBits = errorStatusBits;
+    em.errorStatusBitsSize = sizeof(errorStatusBits);
+    em.bufEnd = em.buf + sizeof(em.buf);
+    em.bufWritePtr = em.buf;
+    em.bufReadPtr = em.buf;
+    em.pFunctSignalPre = emSignal;
+
+    runThreads(emThread, EM_PRODUCERS + 1U);
+    for (p = 0U; p < EM_PRODUCERS; p++)
+    {
+        CHECK(emReceived[p] == emAccepted[p]);
+        accepted += emAccepted[p];
+        received += emReceived[p];
+    }
+    CHECK(errorStatusBits[CO_EM_MANUFACTURER_START >> 3] == 0U);
+    CHECK((em.bufReadPtr == em.bufWritePtr) && (em.bufFull == 0U));
+    REPORT("emergency buffer: %u producers x %u report/reset, %u accepted, %u received, %u taken after overflow", EM_PRODUCERS,
+           EM_ROUNDS, accepted, received, emOverflows);
+}
+
+int main(void)
+{
+    CO_ODmutex = xSemaphoreCreateMutex();
+    CHECK(CO_ODmutex != NULL);
+
+    testLocks();
+    testFlags();
+    testBits();
+    testEmergency();
+    return 0;
+}
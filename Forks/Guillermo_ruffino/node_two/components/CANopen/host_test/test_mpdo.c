@@ -0,0 +1,380 @@
+/*
+ * Received MPDO queue: CAN receive function queues objects on one thread,
+ * CO_RPDO_process() writes them into Object Dictionary and calls their
+ * extension on another, as SYNC/PDO task does on ESP32.
+ *
+ * 4-byte copies yield to the other thread in the middle, zero to two times
+ * in turn, so queue entries are written and read concurrently also on a
+ * single CPU host.
+ *
+ * Address byte of frames built by hand in CiA 301 encoding is checked for
+ * both modes, on consumer and on producer: bit 7 is 0 for source address
+ * mode and 1 for destination address mode.
+ *
+ * Benchmark of values per second written into remote Object Dictionary by
+ * SAM MPDO and by expedited SDO download. Processing time of producer and
+ * consumer, or of SDO server, is measured on host. Bus time is added for
+ * 8-byte frames with worst case bit stuffing. SDO client waits for response,
+ * so each value takes two frames and server processing, while MPDOs are sent
+ * back to back. Processing of SDO client is not counted.
+ */
+
+#include <string.h>
+
+#include "CO_driver.h"
+
+static void *test_memcpy(void *dest, const void *src, size_t n);
+static CO_ReturnError_t test_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer);
+#define memcpy(dest, src, n) test_memcpy(dest, src, n)
+#define CO_CANsend(CANmodule, buffer) test_CANsend(CANmodule, buffer)
+
+#include "../CO_PDO.c"
+#include "../CO_SDOserver.c"
+
+#undef memcpy
+#undef CO_CANsend
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "CO_OD.h"
+#include "host_test.h"
+
+extern const CO_OD_entry_t CO_OD[CO_OD_NoOfElements];
+
+#define OBJECTS 200000U
+#define NODE_ID 9U
+#define PRODUCER_ID 7U
+#define VALUES 2000000U
+/* 8-byte standard frame with worst case bit stuffing and interframe space */
+#define FRAME_BITS 135U
+
+static volatile bool copyYield;
+static __thread uint32_t copies;
+static __thread bool isReceiveThread;
+
+static CO_SDO_t SDO;
+static CO_OD_extension_t ODExtensions[CO_OD_NoOfElements];
+static CO_CANmodule_t CANmodule;
+static CO_CANrx_t rxArray[2];
+static CO_CANtx_t txArray[2];
+static CO_RPDO_t RPDO;
+static CO_RPDOplan_t RPDOplan[1];
+static CO_RPDOplanPool_t RPDOplanPool;
+static CO_RPDOMapPar_t RPDOMapPar;
+static CO_TPDO_t TPDO;
+static CO_TPDOplan_t TPDOplan[1];
+static CO_TPDOplanPool_t TPDOplanPool;
+static CO_TPDOMapPar_t TPDOMapPar = {.numberOfMappedObjects = 1, .mappedObject1 = 0x21100320UL};
+static CO_CANtx_t TPDOtx;
+static uint8_t txFrame[8];
+static uint32_t txFrames;
+/* 0x2110 subindexes 1 to 16 */
+static const uint32_t scanner[1] = {0x10211001UL};
+static const uint64_t dispatcher[1] = {0x1021100121100100ULL | PRODUCER_ID};
+static CO_NMT_internalState_t operatingState = CO_NMT_OPERATIONAL;
+static uint32_t pendingWord;
+static volatile bool receiverDone;
+static uint32_t lostObjects; /* of OBJECTS, counted by receive thread */
+
+/* written by extension */
+static uint32_t extCalls, extFromReceive, extTorn;
+static uint32_t extLast[17];
+
+static void *test_memcpy(void *dest, const void *src, size_t n)
+{
+    if ((n == 4U) && copyYield)
+    {
+        uint32_t k;
+
+        memcpy(dest, src, 2);
+        for (k = copies++ % 3U; k > 0U; k--)
+        {
+            sched_yield();
+        }
+        memcpy((uint8_t *)dest + 2, (const uint8_t *)src + 2, 2);
+        return dest;
+    }
+    return memcpy(dest, src, n);
+}
+
+/* Captures frame sent by TPDO or SDO server */
+static CO_ReturnError_t test_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer)
+{
+    memcpy(txFrame, buffer->data, sizeof(txFrame));
+    txFrames++;
+    return CO_ERROR_NO;
+}
+
+/* Object n is 0x2110 subindex 1 + n % 16 with value n */
+static CO_SDO_abortCode_t testODF(CO_ODF_arg_t *ODF_arg)
+{
+    uint32_t value = CO_getUint32(ODF_arg->data);
+
+    CHECK(!ODF_arg->reading && ODF_arg->index == 0x2110U);
+    extCalls++;
+    if (isReceiveThread)
+    {
+        extFromReceive++;
+    }
+    if (ODF_arg->subIndex != 1U + value % 16U)
+    {
+        extTorn++;
+    }
+    else
+    {
+        /* objects of each subindex are written in order */
+        CHECK(value > extLast[ODF_arg->subIndex]);
+        extLast[ODF_arg->subIndex] = value;
+    }
+    return CO_SDO_AB_NONE;
+}
+
+static void receiveFrame(const uint8_t data[8])
+{
+    can_message_t msg = {.identifier = 0x200U + NODE_ID, .data_length_code = 8};
+
+    memcpy(msg.data, data, 8);
+    CO_PDO_receive(&RPDO, &msg);
+}
+
+static void receive(uint8_t address, uint16_t index, uint8_t subIndex, uint32_t value)
+{
+    uint8_t data[8];
+
+    data[0] = address;
+    data[1] = (uint8_t)index;
+    data[2] = (uint8_t)(index >> 8);
+    data[3] = subIndex;
+    CO_setUint32(&data[4], value);
+    receiveFrame(data);
+}
+
+static void *receiveThread(void *arg)
+{
+    uint32_t n;
+
+    (void)arg;
+    isReceiveThread = true;
+    for (n = 1U; n <= OBJECTS; n++)
+    {
+        uint16_t lost = RPDO.MPDOlost;
+
+        receive(0x80U | NODE_ID, 0x2110U, (uint8_t)(1U + n % 16U), n);
+        lostObjects += (uint16_t)(RPDO.MPDOlost - lost);
+        /* frame for other node and frame for unknown object are not written */
+        if ((n & 0xFFU) == 0U)
+        {
+            receive(0x80U | (NODE_ID + 1U), 0x2110U, 1U, 0xFFFFFFFFU);
+            receive(0x80U | NODE_ID, 0x2110U, 17U, 0xFFFFFFFFU);
+        }
+        sched_yield();
+    }
+    receiverDone = true;
+    return NULL;
+}
+
+static void processAll(void)
+{
+    if (CO_FLAG_TAKE_BITS(pendingWord) != 0U)
+    {
+        CO_RPDO_process(&RPDO, false);
+    }
+}
+
+/* Frames built by hand in CiA 301 encoding, RPDO is DAM consumer */
+static void standardFrames(void)
+{
+    static const uint8_t toThisNode[8] = {0x89, 0x10, 0x21, 0x05, 0x78, 0x56, 0x34, 0x12};
+    static const uint8_t toAllNodes[8] = {0x80, 0x10, 0x21, 0x06, 0x01, 0x00, 0x00, 0x80};
+    static const uint8_t toOtherNode[8] = {0x8A, 0x10, 0x21, 0x05, 0xFF, 0xFF, 0xFF, 0xFF};
+    static const uint8_t fromProducer[8] = {0x07, 0x10, 0x21, 0x02, 0x44, 0x33, 0x22, 0x11};
+    static const uint8_t fromOtherProducer[8] = {0x08, 0x10, 0x21, 0x02, 0xFF, 0xFF, 0xFF, 0xFF};
+    uint32_t calls = extCalls;
+
+    receiveFrame(toThisNode);
+    receiveFrame(toAllNodes);
+    receiveFrame(toOtherNode);
+    /* SAM frame is not for DAM consumer */
+    receiveFrame(fromProducer);
+    processAll();
+    CHECK(extCalls == calls + 2U);
+    CHECK(CO_OD_RAM.variableInt32[4] == 0x12345678 && CO_OD_RAM.variableInt32[5] == (int32_t)0x80000001UL);
+
+    /* SAM consumer finds object of producer 7, subindex 2, in dispatcher */
+    CO_RPDO_initMPDO(&RPDO, dispatcher, 1U);
+    CHECK(CO_RPDOconfigMap(&RPDO, CO_PDO_MPDO_SAM) == 0U && RPDO.MPDO == CO_PDO_MPDO_SAM);
+    receiveFrame(fromProducer);
+    receiveFrame(fromOtherProducer);
+    /* DAM frame is not for SAM consumer */
+    receiveFrame(toThisNode);
+    processAll();
+    CHECK(extCalls == calls + 3U);
+    CHECK(CO_OD_RAM.variableInt32[1] == 0x11223344);
+
+    /* SAM producer sends node-ID, DAM producer 0x80 | node-ID of consumer,
+     * or 0x80 for all nodes */
+    CHECK(CO_TPDO_sendMPDO(&TPDO, 0x2110U, 2U) == CO_ERROR_NO);
+    CHECK(memcmp(txFrame, fromProducer, 8) == 0);
+    CO_TPDO_initMPDO(&TPDO, scanner, 1U, NODE_ID);
+    CHECK(CO_TPDOconfigMap(&TPDO, CO_PDO_MPDO_DAM) == 0U);
+    CO_OD_RAM.variableInt32[2] = 0x12345678;
+    CHECK(CO_TPDOgather(&TPDO));
+    CHECK(TPDO.CANtxBuff->data[0] == 0x89U && TPDO.CANtxBuff->data[3] == 0x03U);
+    CO_TPDO_initMPDO(&TPDO, scanner, 1U, 0U);
+    CHECK(CO_TPDOgather(&TPDO) && TPDO.CANtxBuff->data[0] == 0x80U);
+    CO_TPDO_initMPDO(&TPDO, scanner, 1U, 0U);
+    CHECK(CO_TPDOconfigMap(&TPDO, CO_PDO_MPDO_SAM) == 0U);
+}
+
+/* Seconds of processing per value written by SAM MPDO */
+static double benchmarkMPDO(void)
+{
+    can_message_t msg = {.identifier = 0x200U + NODE_ID, .data_length_code = 8};
+    double start;
+    uint32_t n;
+
+    start = host_test_seconds();
+    for (n = 0U; n < VALUES; n++)
+    {
+        CO_OD_RAM.variableInt32[n % 16U] = (int32_t)n;
+        CO_TPDO_sendMPDO(&TPDO, 0x2110U, (uint8_t)(1U + n % 16U));
+        memcpy(msg.data, txFrame, 8);
+        CO_PDO_receive(&RPDO, &msg);
+        CO_RPDO_process(&RPDO, false);
+    }
+    return (host_test_seconds() - start) / VALUES;
+}
+
+/* Seconds of SDO server processing per value written by expedited download */
+static double benchmarkSDO(void)
+{
+    can_message_t msg = {.identifier = 0x600U + NODE_ID, .data_length_code = 8, .data = {0x23, 0x10, 0x21}};
+    uint32_t timerNext_us;
+    double start;
+    uint32_t n;
+
+    start = host_test_seconds();
+    for (n = 0U; n < VALUES; n++)
+    {
+        msg.data[3] = (uint8_t)(1U + n % 16U);
+        CO_setUint32(&msg.data[4], n);
+        CO_SDO_receive(&SDO, &msg);
+        timerNext_us = 1000U;
+        CO_SDO_process(&SDO, true, 0U, &timerNext_us);
+    }
+    return (host_test_seconds() - start) / VALUES;
+}
+
+int main(void)
+{
+    pthread_t receiver;
+    uint32_t queued;
+    uint16_t lost;
+    double perValue[2];
+    uint8_t i;
+
+    CO_ODmutex = xSemaphoreCreateMutex();
+    CHECK(CO_CANmodule_init(&CANmodule, NULL, rxArray, 2, txArray, 2, 125) == CO_ERROR_NO);
+    CHECK(CO_SDO_init(&SDO, 0x600U + NODE_ID, 0x580U + NODE_ID, OD_H1200_SDO_SERVER_PARAM, NULL, CO_OD,
+                      CO_OD_NoOfElements, ODExtensions, NODE_ID, 1000U, &CANmodule, 0, &CANmodule, 0) == CO_ERROR_NO);
+    CO_OD_configure(&SDO, 0x2110U, testODF, NULL, 0, 0);
+
+    CO_RPDOplanPool_init(&RPDOplanPool, RPDOplan, 1);
+    RPDO.SDO = &SDO;
+    RPDO.planPool = &RPDOplanPool;
+    RPDO.RPDOMapPar = &RPDOMapPar;
+    RPDO.operatingState = &operatingState;
+    RPDO.nodeId = NODE_ID;
+    RPDO.valid = true;
+    RPDO.rxMap = &RPDO;
+    RPDO.pendingWord = &pendingWord;
+    RPDO.pendingBit = 1U;
+    CHECK(CO_RPDOconfigMap(&RPDO, CO_PDO_MPDO_DAM) == 0U && RPDO.MPDO == CO_PDO_MPDO_DAM);
+
+    CO_TPDOplanPool_init(&TPDOplanPool, TPDOplan, 1);
+    TPDO.SDO = &SDO;
+    TPDO.planPool = &TPDOplanPool;
+    TPDO.TPDOMapPar = &TPDOMapPar;
+    TPDO.operatingState = &operatingState;
+    TPDO.nodeId = PRODUCER_ID;
+    TPDO.valid = true;
+    TPDO.CANdevTx = &CANmodule;
+    TPDO.CANtxBuff = &TPDOtx;
+    CO_TPDO_initMPDO(&TPDO, scanner, 1U, 0U);
+    CHECK(CO_TPDOconfigMap(&TPDO, CO_PDO_MPDO_SAM) == 0U && TPDO.MPDO == CO_PDO_MPDO_SAM);
+
+    copyYield = true;
+    CHECK(pthread_create(&receiver, NULL, receiveThread, NULL) == 0);
+    while (!receiverDone)
+    {
+        processAll();
+        sched_yield();
+    }
+    pthread_join(receiver, NULL);
+    processAll();
+    copyYield = false;
+
+    queued = OBJECTS - lostObjects;
+    REPORT("%u objects received, %u written with extension, %u lost on full queue of %u, %u torn", OBJECTS, extCalls,
+           lostObjects, CO_CONFIG_PDO_MPDO_QUEUE, extTorn);
+    CHECK(extTorn == 0U);
+    CHECK(extFromReceive == 0U);
+    CHECK(extCalls == queued);
+    CHECK(RPDO.MPDOhead == RPDO.MPDOtail);
+    for (i = 1U; i <= 16U; i++)
+    {
+        CHECK(CO_OD_RAM.variableInt32[i - 1U] == (int32_t)extLast[i]);
+    }
+
+    /* object received while queue is full is lost, others are kept */
+    lost = RPDO.MPDOlost;
+    for (i = 0U; i < CO_CONFIG_PDO_MPDO_QUEUE; i++)
+    {
+        receive(0x80U | NODE_ID, 0x2110U, 1U, 16U * (OBJECTS + 1U + i));
+    }
+    CHECK((uint16_t)(RPDO.MPDOlost - lost) == 1U);
+    processAll();
+    queued += CO_CONFIG_PDO_MPDO_QUEUE - 1U;
+    CHECK(extCalls == queued);
+    CHECK(extLast[1] == 16U * (OBJECTS + CO_CONFIG_PDO_MPDO_QUEUE - 1U));
+
+    /* queued objects are discarded, if PDO is not operational */
+    receive(0x80U | NODE_ID, 0x2110U, 1U, 32U * OBJECTS);
+    CHECK(RPDO.MPDOhead != RPDO.MPDOtail);
+    operatingState = CO_NMT_PRE_OPERATIONAL;
+    CO_RPDO_process(&RPDO, false);
+    CHECK(RPDO.MPDOhead == RPDO.MPDOtail);
+    CHECK(extCalls == queued);
+    operatingState = CO_NMT_OPERATIONAL;
+
+    standardFrames();
+    REPORT("frames in CiA 301 encoding: SAM address is node-ID, DAM address is 0x80 | node-ID or 0x80");
+
+    /* values per second, without extension, so SDO server takes fast path */
+    CO_OD_configure(&SDO, 0x2110U, NULL, NULL, 0, 0);
+    perValue[0] = benchmarkMPDO();
+    CHECK(RPDO.MPDOhead == RPDO.MPDOtail);
+    for (i = 1U; i <= 16U; i++)
+    {
+        CHECK(CO_OD_RAM.variableInt32[i - 1U] == (int32_t)(VALUES - 17U + i));
+    }
+    txFrames = 0U;
+    perValue[1] = benchmarkSDO();
+    CHECK(txFrames == VALUES && txFrame[0] == 0x60U);
+    for (i = 1U; i <= 16U; i++)
+    {
+        CHECK(CO_OD_RAM.variableInt32[i - 1U] == (int32_t)(VALUES - 17U + i));
+    }
+    REPORT("ns of processing per value: MPDO producer and consumer %.0f, SDO server %.0f", perValue[0] * 1e9,
+           perValue[1] * 1e9);
+    for (i = 0U; i < 4U; i++)
+    {
+        static const uint32_t bitrate[4] = {125000U, 250000U, 500000U, 1000000U};
+        double frame = (double)FRAME_BITS / bitrate[i];
+
+        REPORT("values/s at %4u kbit/s: MPDO %6.0f, expedited SDO %6.0f", bitrate[i] / 1000U,
+               1.0 / (frame > perValue[0] ? frame : perValue[0]), 1.0 / (2.0 * frame + perValue[1]));
+    }
+    return 0;
+}
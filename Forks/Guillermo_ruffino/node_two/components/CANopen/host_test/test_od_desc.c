@@ -0,0 +1,96 @@
+/*
+ * Flat Object Dictionary descriptor table: generated CO_OD_desc matches
+ * decoded CO_OD for each index and subindex, stale table is rejected.
+ * Benchmark of SDO initiate lookups (find, attribute, length and data
+ * pointer) over all subentries, with descriptors and with decoding.
+ */
+
+#include "../CO_SDOserver.c"
+
+#include "CO_OD_desc.h"
+#include "host_test.h"
+
+extern const CO_OD_entry_t CO_OD[CO_OD_NoOfElements];
+
+#define LOOKUPS 20000000UL
+
+static CO_SDO_t SDO;
+static CO_OD_extension_t ODExtensions[CO_OD_NoOfElements];
+static CO_OD_index_t ODindex;
+static uint16_t slot[CO_OD_INDEX_SLOTS(CO_OD_NoOfElements)];
+static uint16_t disp[CO_OD_INDEX_BUCKETS(CO_OD_NoOfElements)];
+static uint16_t subIndex[CO_OD_NoOfDescriptors];
+static uint16_t entryIndex[CO_OD_NoOfDescriptors];
+static CO_OD_desc_t stale[CO_OD_NoOfDescriptors];
+
+/* Lookups per second of subentries in pseudo random order */
+static double benchmark(void)
+{
+    volatile uintptr_t sink = 0U;
+    double start = host_test_seconds();
+    uint32_t n;
+
+    for (n = 0U; n < LOOKUPS; n++)
+    {
+        uint16_t k = (uint16_t)((n * 7919UL) % CO_OD_NoOfDescriptors);
+        uint16_t entryNo = CO_OD_find(&SDO, entryIndex[k]);
+        uint8_t sub = (uint8_t)subIndex[k];
+
+        sink += CO_OD_getAttribute(&SDO, entryNo, sub) + CO_OD_getLength(&SDO, entryNo, sub) +
+                (uintptr_t)CO_OD_getDataPointer(&SDO, entryNo, sub);
+    }
+    (void)sink;
+    return (double)LOOKUPS / (host_test_seconds() - start);
+}
+
+int main(void)
+{
+    double desc, decode;
+    uint16_t i, k = 0U;
+
+    SDO.ownOD = true;
+    SDO.OD = CO_OD;
+    SDO.ODSize = CO_OD_NoOfElements;
+    SDO.ODExtensions = ODExtensions;
+    CHECK(CO_OD_initIndex(&SDO, &ODindex, slot, disp) == CO_ERROR_NO);
+
+    for (i = 0U; i < CO_OD_NoOfElements; i++)
+    {
+        uint16_t sub;
+
+        CHECK(CO_OD_descFirst[i] == k);
+        for (sub = 0U; sub <= CO_OD[i].maxSubIndex; sub++)
+        {
+            entryIndex[k] = CO_OD[i].index;
+            subIndex[k++] = sub;
+        }
+    }
+    CHECK(k == CO_OD_NoOfDescriptors && CO_OD_descFirst[CO_OD_NoOfElements] == k);
+
+    /* descriptors are verified against decoding, subindex past the end has none */
+    CHECK(CO_OD_initDesc(&SDO, CO_OD_desc, CO_OD_descFirst) == CO_ERROR_NO);
+    CHECK(SDO.ODdesc == CO_OD_desc);
+    for (i = 0U; i < CO_OD_NoOfElements; i++)
+    {
+        uint8_t sub = (uint8_t)(CO_OD[i].maxSubIndex + 1U);
+
+        CHECK(CO_OD_getLength(&SDO, i, sub) == 0U);
+        CHECK(CO_OD_getAttribute(&SDO, i, sub) == 0U);
+        CHECK(CO_OD_getDataPointer(&SDO, i, sub) == NULL);
+    }
+    desc = benchmark();
+    SDO.ODdesc = NULL;
+    decode = benchmark();
+    REPORT("%u subentries, M SDO initiate lookups/s: descriptors %.1f, decoding %.1f", CO_OD_NoOfDescriptors,
+           desc / 1e6, decode / 1e6);
+
+    /* stale table is rejected, decoding stays in use */
+    memcpy(stale, CO_OD_desc, sizeof(stale));
+    stale[5].attribute ^= CO_ODA_WRITEABLE;
+    CHECK(CO_OD_initDesc(&SDO, stale, CO_OD_descFirst) == CO_ERROR_PARAMETERS);
+    CHECK(SDO.ODdesc == NULL);
+    memcpy(stale, CO_OD_desc, sizeof(stale));
+    stale[CO_OD_NoOfDescriptors - 1U].length++;
+    CHECK(CO_OD_initDesc(&SDO, stale, CO_OD_descFirst) == CO_ERROR_PARAMETERS);
+    return 0;
+}
@@ -0,0 +1,150 @@
+/*
+ * CO_OD_find() with CO_OD_initIndex(): every object is found and missing
+ * objects are not, with hash and with binary search. Benchmark of lookups
+ * per second of both at 58, 500 and 5000 OD entries, for choosing
+ * CO_CONFIG_OD_INDEX_MIN.
+ *
+ * CO_CONFIG_OD_INDEX_MIN is a variable here, so both are built at each size.
+ */
+
+#include <stdint.h>
+
+static uint16_t odIndexMin;
+#define CO_CONFIG_OD_INDEX_MIN odIndexMin
+
+#include "../CO_SDOserver.c"
+
+#include "CO_OD.h"
+#include "host_test.h"
+
+extern const CO_OD_entry_t CO_OD[CO_OD_NoOfElements];
+
+#define OD_MAX 5000U
+#define LOOKUPS 20000000UL
+#define SEQUENCE 4096U
+
+static CO_SDO_t SDO;
+static CO_OD_entry_t OD[OD_MAX];
+static CO_OD_extension_t ODExtensions[OD_MAX];
+static CO_OD_index_t ODindex;
+static uint16_t slot[2U * OD_MAX];
+static uint16_t disp[OD_MAX / 2U + 1U];
+static uint16_t sequence[SEQUENCE];
+
+/* Object k has index 0x1000 + 3 * k + k % 2, so there are gaps in between */
+static uint16_t odIndex(uint16_t k)
+{
+    return (uint16_t)(0x1000U + 3U * k + k % 2U);
+}
+
+static void initOD(const CO_OD_entry_t *od, uint16_t size)
+{
+    SDO.ownOD = true;
+    SDO.OD = od;
+    SDO.ODSize = size;
+    SDO.ODExtensions = ODExtensions;
+    SDO.ODindex = NULL;
+}
+
+static void checkFind(uint16_t size)
+{
+    uint16_t k;
+
+    for (k = 0U; k < size; k++)
+    {
+        CHECK(CO_OD_find(&SDO, odIndex(k)) == k);
+        CHECK(CO_OD_find(&SDO, odIndex(k)) == k); /* from last hit */
+        CHECK(CO_OD_find(&SDO, (uint16_t)(odIndex(k) + 1U)) == 0xFFFFU);
+    }
+    CHECK(CO_OD_find(&SDO, 0x0FFFU) == 0xFFFFU);
+    CHECK(CO_OD_find(&SDO, 0xFFFFU) == 0xFFFFU);
+}
+
+/* Lookups per second of objects in pseudo random order or of all objects in
+ * OD order, as CO_OD_configure() and PDO mapping do. */
+static double benchmark(bool_t random)
+{
+    volatile uint16_t sink = 0U;
+    double start = host_test_seconds();
+    uint32_t n;
+
+    for (n = 0U; n < LOOKUPS; n++)
+    {
+        sink = CO_OD_find(&SDO, random ? sequence[n % SEQUENCE] : SDO.OD[n % SDO.ODSize].index);
+    }
+    (void)sink;
+    return (double)LOOKUPS / (host_test_seconds() - start);
+}
+
+int main(void)
+{
+    static const uint16_t sizes[] = {58U, 500U, OD_MAX};
+    uint16_t k, i;
+    uint32_t rnd = 1U;
+
+    for (k = 0U; k < OD_MAX; k++)
+    {
+        OD[k].index = odIndex(k);
+    }
+
+    /* Object dictionary of node is sorted and has binary search */
+    odIndexMin = 64U;
+    initOD(CO_OD, CO_OD_NoOfElements);
+    CHECK(CO_OD_initIndex(&SDO, &ODindex, slot, disp) == CO_ERROR_NO);
+    CHECK(SDO.ODindex == &ODindex && ODindex.slotCount == 0U);
+    for (k = 0U; k < CO_OD_NoOfElements; k++)
+    {
+        CHECK(CO_OD_find(&SDO, CO_OD[k].index) == k);
+    }
+
+    for (i = 0U; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        uint16_t size = sizes[i];
+        double hash[2], binary[2], build;
+
+        for (k = 0U; k < SEQUENCE; k++)
+        {
+            rnd = rnd * 1103515245UL + 12345UL;
+            sequence[k] = odIndex((uint16_t)((rnd >> 16) % size));
+        }
+        initOD(OD, size);
+
+        odIndexMin = 0U;
+        build = host_test_seconds();
+        CHECK(CO_OD_initIndex(&SDO, &ODindex, slot, disp) == CO_ERROR_NO);
+        build = host_test_seconds() - build;
+        CHECK(ODindex.slotCount == 2U * size);
+        checkFind(size);
+        hash[0] = benchmark(true);
+        hash[1] = benchmark(false);
+
+        odIndexMin = 0xFFFFU;
+        CHECK(CO_OD_initIndex(&SDO, &ODindex, slot, disp) == CO_ERROR_NO);
+        CHECK(ODindex.slotCount == 0U);
+        checkFind(size);
+        binary[0] = benchmark(true);
+        binary[1] = benchmark(false);
+
+        REPORT("%4u OD entries, M lookups/s random / in order: hash %5.1f / %5.1f, binary search %5.1f / %5.1f, "
+               "hash build %.2f ms",
+               size, hash[0] / 1e6, hash[1] / 1e6, binary[0] / 1e6, binary[1] / 1e6, build * 1e3);
+    }
+
+    /* unsorted Object dictionary is rejected without hash, works with it */
+    OD[3].index = odIndex(1U);
+    OD[1].index = odIndex(3U);
+    initOD(OD, 58U);
+    odIndexMin = 0xFFFFU;
+    CHECK(CO_OD_initIndex(&SDO, &ODindex, slot, disp) == CO_ERROR_PARAMETERS);
+    CHECK(SDO.ODindex == NULL);
+    odIndexMin = 0U;
+    CHECK(CO_OD_initIndex(&SDO, &ODindex, slot, disp) == CO_ERROR_NO);
+    CHECK(CO_OD_find(&SDO, odIndex(3U)) == 1U);
+
+    /* duplicate index is rejected by both */
+    OD[3].index = odIndex(3U);
+    CHECK(CO_OD_initIndex(&SDO, &ODindex, slot, disp) == CO_ERROR_PARAMETERS);
+    odIndexMin = 0xFFFFU;
+    CHECK(CO_OD_initIndex(&SDO, &ODindex, slot, disp) == CO_ERROR_PARAMETERS);
+    return 0;
+}
@@ -0,0 +1,615 @@
+/*
+ * Bit granular PDO mapping with objects of node Object Dictionary: TPDO
+ * encodes bit fields of 3, 12, 8 and 1 bits and byte aligned 16 bits of a
+ * 32-bit variable, which is copied by copy plan. The RPDO with same layout
+ * decodes the frame back through CO_PDO_receive() and CO_RPDO_process().
+ * Change of state is detected only on mapped bits of COS objects. One bit
+ * BOOLEAN dummy entry 0x0001 leaves a gap between bit fields.
+ *
+ * Benchmark of per-PDO copy cost, as PDO copies (copy plan or, for short runs,
+ * per byte) and with per-byte mapPointer copy, for 1 to 8 mapped objects: one
+ * byte objects from separate places in Object Dictionary (one run each), from
+ * one OD array, as in default TPDO mapping of the node (one run), 16-bit and
+ * 32-bit objects.
+ *
+ * Benchmark of CO_TPDOisCOS() for many COS TPDOs with unchanged data, masked
+ * 64-bit compare against per-byte compare through mapPointer with
+ * sendIfCOSFlags, which it replaced.
+ *
+ * Frames per cycle and bus load of signal sets, which Slave maps byte
+ * granular (hatox buttons, gyro status, dunker status and command), compared
+ * with bit granular layout of the same signals. Objects of node OD with the
+ * same width stand in for them.
+ */
+
+#include "../CO_PDO.c"
+
+#include "CO_OD.h"
+#include "host_test.h"
+
+extern const CO_OD_entry_t CO_OD[CO_OD_NoOfElements];
+
+static CO_SDO_t SDO;
+static CO_OD_extension_t ODExtensions[CO_OD_NoOfElements];
+static CO_NMT_internalState_t operatingState = CO_NMT_OPERATIONAL;
+static uint8_t rxBitOffset[8], rxBitLength[8], rxFieldCount;
+
+#define COPY_ITERATIONS 5000000UL
+#define COS_CHECKS 4000000UL
+#define COS_TPDOS 64U
+
+/* Each PDO of a signal set once per cycle, 1 Mbit/s as Slave configures TWAI */
+#define LOAD_CYCLE_US 10000U
+#define LOAD_BITRATE 1000000U
+
+/* One PDO of a signal set */
+typedef struct
+{
+    const char *name;
+    bool_t bits;    /* bit granular layout */
+    uint8_t count;  /* number of mapped objects */
+    uint32_t map[8];
+} loadPdo_t;
+
+/* 8-bit signals are 6000, 16-bit 6401 and 32-bit 2110 */
+static const loadPdo_t loadPdos[] = {
+    /* hatox status, Slave RPDO 1600 analog_data_0..4 and 1601 digital_data_0/1,
+     * buttons RUN to 6 are bits 0 to 9 */
+    {"hatox status", false, 5, {0x60000108UL, 0x60000208UL, 0x60000308UL, 0x60000408UL, 0x60000508UL}},
+    {"hatox status", false, 2, {0x60000608UL, 0x60000708UL}},
+    {"hatox status", true, 7,
+     {0x60000108UL, 0x60000208UL, 0x60000308UL, 0x60000408UL, 0x60000508UL, 0x60000608UL, 0x60000702UL}},
+    /* gyro, RPDO 1602 angle, temperature, status and lifecounter, status
+     * flags are bits 0, 1, 4 and 7, so all 8 bits stay mapped */
+    {"gyro", false, 4, {0x21100120UL, 0x64010110UL, 0x60000108UL, 0x60000208UL}},
+    {"gyro", true, 4, {0x21100120UL, 0x64010110UL, 0x60000108UL, 0x60000208UL}},
+    /* dunker status, RPDO 1603 and 1604 status and error register per
+     * motor, status bits are 0 to 27 */
+    {"dunker status", false, 2, {0x21100120UL, 0x64010110UL}},
+    {"dunker status", false, 2, {0x21100220UL, 0x64010210UL}},
+    {"dunker status", true, 2, {0x2110011CUL, 0x64010110UL}},
+    {"dunker status", true, 2, {0x2110021CUL, 0x64010210UL}},
+    /* dunker command, TPDO 1a02 and 1a03 device command 0 to 5, mode of
+     * operation, power enable and velocity per motor */
+    {"dunker command", false, 4, {0x60000108UL, 0x60000208UL, 0x60000308UL, 0x21100120UL}},
+    {"dunker command", false, 4, {0x60000408UL, 0x60000508UL, 0x60000608UL, 0x21100220UL}},
+    {"dunker command", true, 4, {0x60000103UL, 0x60000208UL, 0x60000301UL, 0x21100120UL}},
+    {"dunker command", true, 4, {0x60000403UL, 0x60000508UL, 0x60000601UL, 0x21100220UL}},
+};
+
+/* Reports field view and lets message be buffered */
+static bool_t rxCallback(void *object, const uint8_t *data, const CO_PDOfield_t *field, uint8_t fieldCount)
+{
+    uint8_t i;
+
+    (void)object;
+    (void)data;
+    rxFieldCount = fieldCount;
+    for (i = 0U; i < fieldCount; i++)
+    {
+        rxBitOffset[i] = field[i].bitOffset;
+        rxBitLength[i] = field[i].bitLength;
+    }
+    return false;
+}
+
+/* Copy, as CO_TPDOgather() and CO_RPDO_process() use it */
+static void __attribute__((noinline)) planGather(const CO_TPDOplan_t *plan, uint8_t *data)
+{
+    CO_PDOgather(data, plan->copyRun, plan->copyRunCount, plan->mapPointer, plan->mapPointerCount);
+}
+
+static void __attribute__((noinline)) planScatter(const CO_RPDOplan_t *plan, const uint8_t *data)
+{
+    CO_PDOscatter(data, plan->copyRun, plan->copyRunCount, plan->mapPointer, plan->mapPointerCount);
+}
+
+/* Per-byte copy through mapPointer, as before copy plan */
+static void __attribute__((noinline)) byteGather(uint8_t *const *mapPointer, uint8_t length, uint8_t *data)
+{
+    for (; length > 0U; length--)
+    {
+        *(data++) = **(mapPointer++);
+    }
+}
+
+static void __attribute__((noinline)) byteScatter(uint8_t *const *mapPointer, uint8_t length, const uint8_t *data)
+{
+    for (; length > 0U; length--)
+    {
+        **(mapPointer++) = *(data++);
+    }
+}
+
+/* mapPointer, from which plan was built */
+static void planPointers(const CO_PDOcopyRun_t *run, uint8_t count, uint8_t **mapPointer)
+{
+    for (; count > 0U; count--, run++)
+    {
+        uint8_t j;
+
+        for (j = 0U; j < run->length; j++)
+        {
+            mapPointer[run->PDOoffset + j] = run->ODdata + j;
+        }
+    }
+}
+
+/* Nanoseconds per TPDO gather and RPDO scatter of first count objects of
+ * map, as PDO copies it (time[0], time[1]) and per-byte (time[2], time[3]).
+ * Returns number of runs, *how is "plan" or "per byte", as PDO copies. */
+static uint8_t benchmarkCopy(const uint32_t *txMap, const uint32_t *rxMap, uint8_t count, double time[4],
+                             const char **how)
+{
+    static CO_TPDOplan_t TPDOplan[1];
+    static CO_RPDOplan_t RPDOplan[1];
+    CO_TPDOplanPool_t TPDOplanPool;
+    CO_RPDOplanPool_t RPDOplanPool;
+    CO_TPDOMapPar_t TPDOMapPar = {0};
+    CO_RPDOMapPar_t RPDOMapPar = {0};
+    CO_TPDO_t TPDO = {0};
+    CO_RPDO_t RPDO = {0};
+    CO_CANtx_t CANtx = {0};
+    uint8_t *txPointer[8], *rxPointer[8];
+    uint8_t data[8] = {0}, byteData[8] = {0};
+    double start;
+    uint32_t n;
+    int k;
+
+    CO_TPDOplanPool_init(&TPDOplanPool, TPDOplan, 1);
+    TPDO.SDO = &SDO;
+    TPDO.planPool = &TPDOplanPool;
+    TPDO.TPDOMapPar = &TPDOMapPar;
+    TPDO.CANtxBuff = &CANtx;
+    memcpy(&TPDOMapPar.mappedObject1, txMap, count * sizeof(uint32_t));
+    CHECK(CO_TPDOconfigMap(&TPDO, count) == 0U);
+    CO_RPDOplanPool_init(&RPDOplanPool, RPDOplan, 1);
+    RPDO.SDO = &SDO;
+    RPDO.planPool = &RPDOplanPool;
+    RPDO.RPDOMapPar = &RPDOMapPar;
+    memcpy(&RPDOMapPar.mappedObject1, rxMap, count * sizeof(uint32_t));
+    CHECK(CO_RPDOconfigMap(&RPDO, count) == 0U && RPDO.dataLength == TPDO.dataLength);
+    CHECK(RPDO.plan->mapPointerCount == TPDO.plan->mapPointerCount);
+    *how = (TPDO.plan->mapPointerCount > 0U) ? "per byte" : "plan";
+    planPointers(TPDO.plan->copyRun, TPDO.plan->copyRunCount, txPointer);
+    planPointers(RPDO.plan->copyRun, RPDO.plan->copyRunCount, rxPointer);
+
+    /* both copy the same bytes */
+    planGather(TPDO.plan, data);
+    byteGather(txPointer, TPDO.dataLength, byteData);
+    CHECK(memcmp(data, byteData, sizeof(data)) == 0);
+
+    /* faster of two passes */
+    for (k = 0; k < 8; k++)
+    {
+        double t;
+
+        start = host_test_seconds();
+        for (n = 0U; n < COPY_ITERATIONS; n++)
+        {
+            /* whole PDO data is written, as received message is copied */
+            uint64_t value = n;
+
+            memcpy(data, &value, sizeof(data));
+            switch (k & 3)
+            {
+            case 0: planGather(TPDO.plan, data); break;
+            case 1: planScatter(RPDO.plan, data); break;
+            case 2: byteGather(txPointer, TPDO.dataLength, data); break;
+            default: byteScatter(rxPointer, RPDO.dataLength, data); break;
+            }
+            __asm__ volatile("" ::: "memory");
+        }
+        t = (host_test_seconds() - start) * 1e9 / COPY_ITERATIONS;
+        if (k < 4 || t < time[k & 3])
+        {
+            time[k & 3] = t;
+        }
+    }
+    return TPDO.plan->copyRunCount;
+}
+
+static void reportCopy(void)
+{
+    /* 6000 and 6200 subindexes 1, 3, 5, 7, 2, 4, 6, 8 and 1 to 8 */
+    static const uint32_t txSeparate[8] = {0x60000108UL, 0x60000308UL, 0x60000508UL, 0x60000708UL,
+                                           0x60000208UL, 0x60000408UL, 0x60000608UL, 0x60000808UL};
+    static const uint32_t rxSeparate[8] = {0x62000108UL, 0x62000308UL, 0x62000508UL, 0x62000708UL,
+                                           0x62000208UL, 0x62000408UL, 0x62000608UL, 0x62000808UL};
+    static const uint32_t txArray[8] = {0x60000108UL, 0x60000208UL, 0x60000308UL, 0x60000408UL,
+                                        0x60000508UL, 0x60000608UL, 0x60000708UL, 0x60000808UL};
+    static const uint32_t rxArray[8] = {0x62000108UL, 0x62000208UL, 0x62000308UL, 0x62000408UL,
+                                        0x62000508UL, 0x62000608UL, 0x62000708UL, 0x62000808UL};
+    /* 6401 and 6411 subindexes 1, 3, 5, 7 */
+    static const uint32_t txWord[4] = {0x64010110UL, 0x64010310UL, 0x64010510UL, 0x64010710UL};
+    static const uint32_t rxWord[4] = {0x64110110UL, 0x64110310UL, 0x64110510UL, 0x64110710UL};
+    /* 2110 subindexes 1, 3 and 2, 4 */
+    static const uint32_t txLong[2] = {0x21100120UL, 0x21100320UL};
+    static const uint32_t rxLong[2] = {0x21100220UL, 0x21100420UL};
+    uint8_t count;
+
+    REPORT("ns per PDO copy, TPDO gather / RPDO scatter, as PDO copies vs per-byte mapPointer:");
+    for (count = 1U; count <= 8U; count++)
+    {
+        double separate[4], array[4];
+        const char *howSeparate, *howArray;
+        uint8_t runsSeparate = benchmarkCopy(txSeparate, rxSeparate, count, separate, &howSeparate);
+        uint8_t runsArray = benchmarkCopy(txArray, rxArray, count, array, &howArray);
+
+        CHECK(runsSeparate == count && runsArray == 1U);
+        /* one byte runs are copied per byte, runs of 4 and more bytes by plan */
+        CHECK(strcmp(howSeparate, "per byte") == 0 && strcmp(howArray, (count < 4U) ? "per byte" : "plan") == 0);
+        REPORT("%u objects: separate (%u runs, %s) %4.1f / %4.1f vs %4.1f / %4.1f, OD array (1 run, %s) %4.1f / %4.1f "
+               "vs %4.1f / %4.1f",
+               count, runsSeparate, howSeparate, separate[0], separate[1], separate[2], separate[3], howArray,
+               array[0], array[1], array[2], array[3]);
+    }
+    for (count = 1U; count <= 4U; count++)
+    {
+        double word[4];
+        const char *how;
+
+        CHECK(benchmarkCopy(txWord, rxWord, count, word, &how) == count);
+        REPORT("%u 16-bit objects: separate (%u runs, %s) %4.1f / %4.1f vs %4.1f / %4.1f", count, count, how, word[0],
+               word[1], word[2], word[3]);
+    }
+    for (count = 1U; count <= 2U; count++)
+    {
+        double word[4];
+        const char *how;
+
+        CHECK(benchmarkCopy(txLong, rxLong, count, word, &how) == count && strcmp(how, "plan") == 0);
+        REPORT("%u 32-bit objects: separate (%u runs, %s) %4.1f / %4.1f vs %4.1f / %4.1f", count, count, how, word[0],
+               word[1], word[2], word[3]);
+    }
+}
+
+/* Masked 64-bit COS compare of CO_TPDOisCOS() */
+static uint8_t __attribute__((noinline)) maskIsCOS(CO_TPDO_t *TPDO)
+{
+    return CO_TPDOisCOS(TPDO);
+}
+
+/* COS compare, which masked compare replaced */
+static uint8_t __attribute__((noinline)) byteIsCOS(const CO_TPDO_t *TPDO, uint8_t *const *mapPointer)
+{
+    const uint8_t *pPDOdataByte = &TPDO->CANtxBuff->data[TPDO->dataLength];
+    uint8_t *const *ppODdataByte = &mapPointer[TPDO->dataLength];
+
+    switch (TPDO->dataLength)
+    {
+    case 8: if (*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags & 0x80)) return 1; // fallthrough
+    case 7: if (*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags & 0x40)) return 1; // fallthrough
+    case 6: if (*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags & 0x20)) return 1; // fallthrough
+    case 5: if (*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags & 0x10)) return 1; // fallthrough
+    case 4: if (*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags & 0x08)) return 1; // fallthrough
+    case 3: if (*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags & 0x04)) return 1; // fallthrough
+    case 2: if (*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags & 0x02)) return 1; // fallthrough
+    case 1: if (*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags & 0x01)) return 1; // fallthrough
+    }
+    return 0;
+}
+
+/* Nanoseconds per CO_TPDOisCOS() (time[0]) and per-byte compare (time[1]) of
+ * tpdos TPDOs with the same mapping, none of them changed. changed is the OD
+ * byte, which is changed for the check, that both detect COS. Per-byte compare
+ * has no pointers to bit fields, time[1] is 0 for them. */
+static void benchmarkCOS(const uint32_t *map, uint8_t count, uint16_t tpdos, uint8_t *changed, double time[2])
+{
+    static CO_TPDO_t TPDO[COS_TPDOS];
+    static CO_TPDOplan_t TPDOplan[COS_TPDOS];
+    static CO_TPDOMapPar_t TPDOMapPar;
+    static CO_CANtx_t CANtx[COS_TPDOS];
+    static uint8_t *mapPointer[COS_TPDOS][8];
+    CO_TPDOplanPool_t TPDOplanPool;
+    uint32_t n, cos = 0U;
+    uint16_t t;
+    uint8_t bytes;
+    double start;
+
+    CO_TPDOplanPool_init(&TPDOplanPool, TPDOplan, tpdos);
+    memset(&TPDOMapPar, 0, sizeof(TPDOMapPar));
+    memcpy(&TPDOMapPar.mappedObject1, map, count * sizeof(uint32_t));
+    for (t = 0U; t < tpdos; t++)
+    {
+        memset(&TPDO[t], 0, sizeof(TPDO[t]));
+        TPDO[t].SDO = &SDO;
+        TPDO[t].planPool = &TPDOplanPool;
+        TPDO[t].TPDOMapPar = &TPDOMapPar;
+        TPDO[t].CANtxBuff = &CANtx[t];
+        CHECK(CO_TPDOconfigMap(&TPDO[t], count) == 0U && TPDO[t].sendIfCOSFlags != 0U);
+        planPointers(TPDO[t].plan->copyRun, TPDO[t].plan->copyRunCount, mapPointer[t]);
+        CHECK(CO_TPDOgather(&TPDO[t]));
+        CHECK(!maskIsCOS(&TPDO[t]) && (TPDO[t].bitBytes != 0U || !byteIsCOS(&TPDO[t], mapPointer[t])));
+    }
+    bytes = TPDO[0].bitBytes == 0U;
+    (*changed)++;
+    CHECK(maskIsCOS(&TPDO[tpdos - 1U]) && (!bytes || byteIsCOS(&TPDO[tpdos - 1U], mapPointer[tpdos - 1U])));
+    (*changed)--;
+
+    start = host_test_seconds();
+    for (n = 0U; n < COS_CHECKS / tpdos; n++)
+    {
+        for (t = 0U; t < tpdos; t++)
+        {
+            cos += maskIsCOS(&TPDO[t]);
+        }
+    }
+    time[0] = (host_test_seconds() - start) * 1e9 / (n * tpdos);
+    time[1] = 0.0;
+    if (!bytes)
+    {
+        CHECK(cos == 0U);
+        return;
+    }
+    start = host_test_seconds();
+    for (n = 0U; n < COS_CHECKS / tpdos; n++)
+    {
+        for (t = 0U; t < tpdos; t++)
+        {
+            cos += byteIsCOS(&TPDO[t], mapPointer[t]);
+        }
+    }
+    time[1] = (host_test_seconds() - start) * 1e9 / (n * tpdos);
+    CHECK(cos == 0U);
+}
+
+static void reportCOS(void)
+{
+    /* default 1A00 mapping: 6000 subindexes 1 to 8, one run */
+    static const uint32_t array[8] = {0x60000108UL, 0x60000208UL, 0x60000308UL, 0x60000408UL,
+                                      0x60000508UL, 0x60000608UL, 0x60000708UL, 0x60000808UL};
+    /* 6000 subindexes 1, 3, 5, 7, 2, 4, 6, 8, copied per byte */
+    static const uint32_t separate[8] = {0x60000108UL, 0x60000308UL, 0x60000508UL, 0x60000708UL,
+                                         0x60000208UL, 0x60000408UL, 0x60000608UL, 0x60000808UL};
+    /* 2110 subindexes 1 and 3, two runs */
+    static const uint32_t longs[2] = {0x21100120UL, 0x21100320UL};
+    /* 6000,01 and 2110,01 with 1 and 12 bits */
+    static const uint32_t bits[2] = {0x60000101UL, 0x2110010CUL};
+    uint16_t tpdos;
+
+    REPORT("ns per CO_TPDOisCOS() without change, masked 64-bit vs per-byte sendIfCOSFlags compare:");
+    for (tpdos = 8U; tpdos <= COS_TPDOS; tpdos *= 8U)
+    {
+        double a[2], s[2], l[2];
+
+        benchmarkCOS(array, 8, tpdos, &CO_OD_RAM.readInput8Bit[7], a);
+        benchmarkCOS(separate, 8, tpdos, &CO_OD_RAM.readInput8Bit[7], s);
+        benchmarkCOS(longs, 2, tpdos, (uint8_t *)&CO_OD_RAM.variableInt32[2], l);
+        REPORT("%2u TPDOs: OD array %4.1f vs %4.1f, separate bytes %4.1f vs %4.1f, 32-bit objects %4.1f vs %4.1f",
+               tpdos, a[0], a[1], s[0], s[1], l[0], l[1]);
+    }
+    {
+        double b[2];
+
+        /* per-byte compare can not see bit fields, only masked compare */
+        benchmarkCOS(bits, 2, COS_TPDOS, &CO_OD_RAM.readInput8Bit[0], b);
+        REPORT("%2u TPDOs: bit fields %4.1f", COS_TPDOS, b[0]);
+    }
+}
+
+/* Bits of standard CAN frame with worst case bit stuffing */
+static uint32_t frameBits(uint8_t dataLength)
+{
+    return 47U + 8U * dataLength + (34U + 8U * dataLength - 1U) / 4U;
+}
+
+/* Data bytes of PDO, as mapped by CO_TPDOconfigMap() */
+static uint8_t loadPdoLength(const loadPdo_t *pdo)
+{
+    static CO_TPDOplan_t TPDOplan[1];
+    CO_TPDOplanPool_t TPDOplanPool;
+    CO_TPDOMapPar_t TPDOMapPar = {0};
+    CO_TPDO_t TPDO = {0};
+    CO_CANtx_t CANtx = {0};
+
+    CO_TPDOplanPool_init(&TPDOplanPool, TPDOplan, 1);
+    TPDO.SDO = &SDO;
+    TPDO.planPool = &TPDOplanPool;
+    TPDO.TPDOMapPar = &TPDOMapPar;
+    TPDO.CANtxBuff = &CANtx;
+    memcpy(&TPDOMapPar.mappedObject1, pdo->map, pdo->count * sizeof(uint32_t));
+    CHECK(CO_TPDOconfigMap(&TPDO, pdo->count) == 0U);
+    CHECK(pdo->bits || TPDO.plan->bitFieldCount == 0U);
+    return TPDO.dataLength;
+}
+
+static void reportLoad(void)
+{
+    uint32_t frames[2] = {0U, 0U}, bits[2] = {0U, 0U};
+    size_t i = 0U;
+
+    REPORT("frames and bits per cycle, byte granular vs bit granular mapping:");
+    while (i < sizeof(loadPdos) / sizeof(loadPdos[0]))
+    {
+        const char *name = loadPdos[i].name;
+        uint32_t setFrames[2] = {0U, 0U}, setBytes[2] = {0U, 0U}, setBits[2] = {0U, 0U};
+
+        for (; i < sizeof(loadPdos) / sizeof(loadPdos[0]) && strcmp(loadPdos[i].name, name) == 0; i++)
+        {
+            uint8_t length = loadPdoLength(&loadPdos[i]);
+            int k = loadPdos[i].bits ? 1 : 0;
+
+            setFrames[k]++;
+            setBytes[k] += length;
+            setBits[k] += frameBits(length);
+        }
+        CHECK(setFrames[1] <= setFrames[0] && setBits[1] <= setBits[0]);
+        REPORT("%-14s %u frames, %2u bytes, %4u bits vs %u frames, %2u bytes, %4u bits", name, setFrames[0],
+               setBytes[0], setBits[0], setFrames[1], setBytes[1], setBits[1]);
+        frames[0] += setFrames[0];
+        frames[1] += setFrames[1];
+        bits[0] += setBits[0];
+        bits[1] += setBits[1];
+    }
+    REPORT("all sets: %u vs %u frames, %u vs %u bits, bus load %.2f%% vs %.2f%% with %u us cycle at %u kbit/s",
+           frames[0], frames[1], bits[0], bits[1], 100.0 * bits[0] / LOAD_CYCLE_US / (LOAD_BITRATE / 1e6),
+           100.0 * bits[1] / LOAD_CYCLE_US / (LOAD_BITRATE / 1e6), LOAD_CYCLE_US, LOAD_BITRATE / 1000U);
+    /* hatox buttons fit into the frame with analog data */
+    CHECK(frames[1] == frames[0] - 1U);
+}
+
+/* 1-bit gap with dummy entry of BOOLEAN between bit fields of 6000 / 6200
+ * subindexes 1 and 2 */
+static void dummyBoolean(void)
+{
+    static const uint32_t tpdoMap[3] = {0x60000103UL, 0x00010001UL, 0x60000204UL};
+    static const uint32_t rpdoMap[3] = {0x62000103UL, 0x00010001UL, 0x62000204UL};
+    static CO_TPDOplan_t TPDOplan[1];
+    static CO_RPDOplan_t RPDOplan[1];
+    CO_TPDOplanPool_t TPDOplanPool;
+    CO_RPDOplanPool_t RPDOplanPool;
+    CO_TPDOMapPar_t TPDOMapPar = {0};
+    CO_RPDOMapPar_t RPDOMapPar = {0};
+    CO_TPDO_t TPDO = {0};
+    CO_RPDO_t RPDO = {0};
+    CO_CANtx_t CANtx = {0};
+    can_message_t msg = {.identifier = 0x202, .data_length_code = 1};
+
+    CO_TPDOplanPool_init(&TPDOplanPool, TPDOplan, 1);
+    TPDO.SDO = &SDO;
+    TPDO.planPool = &TPDOplanPool;
+    TPDO.TPDOMapPar = &TPDOMapPar;
+    TPDO.CANtxBuff = &CANtx;
+    memcpy(&TPDOMapPar.mappedObject1, tpdoMap, sizeof(tpdoMap));
+    CHECK(CO_TPDOconfigMap(&TPDO, 3) == 0U && TPDO.dataLength == 1U);
+    CO_OD_RAM.readInput8Bit[0] = 0xFFU;
+    CO_OD_RAM.readInput8Bit[1] = 0x0AU;
+    CHECK(CO_TPDOgather(&TPDO));
+    CHECK(CANtx.data[0] == 0xA7U);
+
+    CO_RPDOplanPool_init(&RPDOplanPool, RPDOplan, 1);
+    RPDO.SDO = &SDO;
+    RPDO.planPool = &RPDOplanPool;
+    RPDO.RPDOMapPar = &RPDOMapPar;
+    RPDO.operatingState = &operatingState;
+    RPDO.valid = true;
+    RPDO.rxMap = &RPDO;
+    memcpy(&RPDOMapPar.mappedObject1, rpdoMap, sizeof(rpdoMap));
+    CHECK(CO_RPDOconfigMap(&RPDO, 3) == 0U && RPDO.dataLength == 1U);
+    /* bit in the gap is ignored */
+    msg.data[0] = 0x5BU;
+    CO_PDO_receive(&RPDO, &msg);
+    CO_RPDO_process(&RPDO, false);
+    CHECK(CO_OD_RAM.writeOutput8Bit[0] == 3U && CO_OD_RAM.writeOutput8Bit[1] == 5U);
+
+    /* dummy entry 0x0000 has no size */
+    TPDOMapPar.mappedObject2 = 0x00000001UL;
+    CHECK(CO_TPDOconfigMap(&TPDO, 3) == CO_SDO_AB_NO_MAP);
+    REPORT("1-bit BOOLEAN dummy 0x00010001 between bit fields: TPDO %02x, RPDO ignores gap bit", CANtx.data[0]);
+}
+
+int main(void)
+{
+    /* TPDO: 6000,01 3 bits, 6411,01 12 bits (no COS), 2110,01 8 bits at
+     * offset 15, 6000,02 1 bit, 2110,02 16 bits at offset 24 by copy plan */
+    static const uint32_t tpdoMap[5] = {0x60000103UL, 0x6411010CUL, 0x21100108UL, 0x60000201UL, 0x21100210UL};
+    /* RPDO: the same layout into writeable objects */
+    static const uint32_t rpdoMap[5] = {0x62000103UL, 0x6411020CUL, 0x21100308UL, 0x62000201UL, 0x21100410UL};
+    static const uint8_t offsets[5] = {0U, 3U, 15U, 23U, 24U};
+    static const uint8_t lengths[5] = {3U, 12U, 8U, 1U, 16U};
+    CO_TPDOMapPar_t TPDOMapPar = {0};
+    CO_RPDOMapPar_t RPDOMapPar = {0};
+    CO_TPDO_t TPDO;
+    CO_TPDOplan_t TPDOplan[1];
+    CO_TPDOplanPool_t TPDOplanPool;
+    CO_RPDO_t RPDO;
+    CO_RPDOplan_t RPDOplan[1];
+    CO_RPDOplanPool_t RPDOplanPool;
+    CO_CANtx_t CANtx;
+    can_message_t msg = {.identifier = 0x201, .data_length_code = 5};
+    uint64_t expected, got = 0U;
+    uint8_t i;
+
+    CO_ODmutex = xSemaphoreCreateMutex();
+    SDO.OD = CO_OD;
+    SDO.ODSize = CO_OD_NoOfElements;
+    SDO.ODExtensions = ODExtensions;
+
+    memset(&TPDO, 0, sizeof(TPDO));
+    memset(&CANtx, 0, sizeof(CANtx));
+    CO_TPDOplanPool_init(&TPDOplanPool, TPDOplan, 1);
+    TPDO.SDO = &SDO;
+    TPDO.planPool = &TPDOplanPool;
+    TPDO.TPDOMapPar = &TPDOMapPar;
+    TPDO.CANtxBuff = &CANtx;
+    memcpy(&TPDOMapPar.mappedObject1, tpdoMap, sizeof(tpdoMap));
+    CHECK(CO_TPDOconfigMap(&TPDO, 5) == 0U);
+    CHECK(TPDO.dataLength == 5U && TPDO.plan->bitFieldCount == 4U && TPDO.plan->copyRunCount == 1U);
+
+    CO_OD_RAM.readInput8Bit[0] = 0xFDU;             /* 5 in mapped bits */
+    CO_OD_RAM.writeAnalogueOutput16Bit[0] = 0x7ABCU;  /* 0xABC */
+    CO_OD_RAM.variableInt32[0] = 0x1234A5;          /* 0xA5 */
+    CO_OD_RAM.readInput8Bit[1] = 1U;
+    CO_OD_RAM.variableInt32[1] = 0x5634A5;          /* 0x34A5 */
+    expected = 5U | (0xABCULL << 3) | (0xA5ULL << 15) | (1ULL << 23) | (0x34A5ULL << 24);
+
+    CHECK(CO_TPDOgather(&TPDO));
+    for (i = 0U; i < 8U; i++)
+    {
+        got |= (uint64_t)CANtx.data[i] << (8U * i);
+    }
+    REPORT("TPDO with 3, 12, 8 and 1 bit fields and 16 bits copied: %010llx, expected %010llx", (unsigned long long)got,
+           (unsigned long long)expected);
+    CHECK(got == expected);
+
+    /* COS on mapped bits of 6000 and 2110 only */
+    CHECK(!CO_TPDOisCOS(&TPDO));
+    CO_OD_RAM.readInput8Bit[1] = 0U;
+    CHECK(CO_TPDOisCOS(&TPDO));
+    CO_OD_RAM.readInput8Bit[1] = 1U;
+    CO_OD_RAM.readInput8Bit[0] = 0x05U;
+    CO_OD_RAM.variableInt32[1] = 0x7734A5;
+    CHECK(!CO_TPDOisCOS(&TPDO));
+    CO_OD_RAM.writeAnalogueOutput16Bit[0] = 0x0ABDU;
+    CHECK(!CO_TPDOisCOS(&TPDO));
+    CO_OD_RAM.variableInt32[0] = 0x1234A4;
+    CHECK(CO_TPDOisCOS(&TPDO));
+
+    /* 65 bits do not fit */
+    TPDOMapPar.mappedObject6 = 0x21100320UL;
+    CHECK(CO_TPDOconfigMap(&TPDO, 6) == CO_SDO_AB_MAP_LEN);
+
+    memset(&RPDO, 0, sizeof(RPDO));
+    CO_RPDOplanPool_init(&RPDOplanPool, RPDOplan, 1);
+    RPDO.SDO = &SDO;
+    RPDO.planPool = &RPDOplanPool;
+    RPDO.RPDOMapPar = &RPDOMapPar;
+    RPDO.operatingState = &operatingState;
+    RPDO.valid = true;
+    RPDO.rxMap = &RPDO;
+    RPDO.pFunctRx = rxCallback;
+    memcpy(&RPDOMapPar.mappedObject1, rpdoMap, sizeof(rpdoMap));
+    CHECK(CO_RPDOconfigMap(&RPDO, 5) == 0U);
+    CHECK(RPDO.dataLength == 5U && RPDO.plan->bitFieldCount == 4U && RPDO.plan->copyRunCount == 1U);
+
+    CO_OD_RAM.writeOutput8Bit[0] = 0xF8U;
+    CO_OD_RAM.writeOutput8Bit[1] = 0xFEU;
+    CO_OD_RAM.writeAnalogueOutput16Bit[1] = 0xF000U;
+    CO_OD_RAM.variableInt32[2] = -1;
+    CO_OD_RAM.variableInt32[3] = -1;
+    memcpy(msg.data, CANtx.data, 5);
+    CO_PDO_receive(&RPDO, &msg);
+    CO_RPDO_process(&RPDO, false);
+
+    CHECK(rxFieldCount == 5U);
+    for (i = 0U; i < 5U; i++)
+    {
+        CHECK(rxBitOffset[i] == offsets[i] && rxBitLength[i] == lengths[i]);
+    }
+    /* whole variable of bit field is written, zero extended, copy plan
+     * writes mapped bytes only */
+    REPORT("RPDO decoded: %x %x %x %x %x", CO_OD_RAM.writeOutput8Bit[0], CO_OD_RAM.writeAnalogueOutput16Bit[1],
+           (unsigned)CO_OD_RAM.variableInt32[2], CO_OD_RAM.writeOutput8Bit[1], (unsigned)CO_OD_RAM.variableInt32[3]);
+    CHECK(CO_OD_RAM.writeOutput8Bit[0] == 5U);
+    CHECK(CO_OD_RAM.writeAnalogueOutput16Bit[1] == 0xABCU);
+    CHECK(CO_OD_RAM.variableInt32[2] == 0xA5);
+    CHECK(CO_OD_RAM.writeOutput8Bit[1] == 1U);
+    CHECK(CO_OD_RAM.variableInt32[3] == (int32_t)0xFFFF34A5UL);
+
+    dummyBoolean();
+    reportLoad();
+    reportCopy();
+    reportCOS();
+    return 0;
+}
@@ -0,0 +1,236 @@
+/*
+ * Synchronous TPDO burst on simulated bus: CO_TPDOsched_process() with SYNC
+ * passes all synchronous TPDOs to CO_CANsendBurst() of the CAN driver, which
+ * fills TX queue, and CAN transmit task sends the rest from pending list on
+ * TX alerts. Frames reach the bus in CAN-ID order, burst sent callback is
+ * called once per burst, after the last frame is transmitted.
+ *
+ * Reports time from SYNC until CO_TPDOsched_process() returns, until the
+ * last frame of the burst is transmitted and until burst sent callback, for
+ * 4 and 32 synchronous TPDOs. Most of 32 TPDOs are still pending, when
+ * CO_TPDOsched_process() returns.
+ */
+
+#include "../CO_PDO.c"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "CO_OD.h"
+#include "fake_can.h"
+#include "host_test.h"
+
+extern const CO_OD_entry_t CO_OD[CO_OD_NoOfElements];
+
+#define PDO_MAX 32U
+#define BURSTS 200U
+
+/* 1 Mbit/s, 8 data bytes, standard frame with worst case bit stuffing */
+#define BUS_FRAME_US 135.0
+
+static CO_SDO_t SDO;
+static CO_OD_extension_t ODExtensions[CO_OD_NoOfElements];
+static CO_NMT_internalState_t operatingState = CO_NMT_OPERATIONAL;
+static CO_SYNC_t SYNC;
+
+static CO_CANmodule_t CANmodule;
+static CO_CANrx_t rxArray[1];
+static CO_CANtx_t txArray[PDO_MAX];
+
+static CO_TPDO_t TPDO[PDO_MAX];
+static CO_TPDO_t *TPDOs[PDO_MAX];
+static CO_TPDOplan_t TPDOplan[PDO_MAX];
+static CO_TPDOplanPool_t TPDOplanPool;
+static CO_TPDOCommPar_t TPDOCommPar = {.maxSubIndex = 6, .transmissionType = 1};
+/* 0x2110 sub 1 and 2, 8 data bytes */
+static CO_TPDOMapPar_t TPDOMapPar = {.numberOfMappedObjects = 2, .mappedObject1 = 0x21100120UL,
+                                     .mappedObject2 = 0x21100220UL};
+static CO_TPDOsched_t sched;
+static uint16_t heap[PDO_MAX], active[PDO_MAX], sync[PDO_MAX], syncDue[PDO_MAX];
+static CO_CANtx_t *burst[PDO_MAX];
+
+static volatile bool busRunning;
+/* written by bus thread */
+static volatile uint32_t busFrames;
+static volatile double busLastTime;
+static uint32_t busLastIdent, busInversions;
+/* written by burst sent callback */
+static volatile uint32_t burstSentCount;
+static volatile double burstSentTime;
+
+/* Put frames from TX queue on the bus at bus rate. Each frame is
+ * transmitted one frame time after previous one or after it was queued. */
+static void *busThread(void *arg)
+{
+    double start = host_test_seconds();
+    uint32_t n = 1U;
+
+    (void)arg;
+    while (busRunning)
+    {
+        can_message_t msg;
+        double now;
+
+        host_test_sleepUntil(start + n * BUS_FRAME_US * 1e-6);
+        /* end of frame, TX alerts follow */
+        now = host_test_seconds();
+        if (!fake_can_txStep(&msg))
+        {
+            start = host_test_seconds();
+            n = 1U;
+            continue;
+        }
+        n++;
+        if (msg.identifier < busLastIdent)
+        {
+            busInversions++;
+        }
+        busLastIdent = msg.identifier;
+        busLastTime = now;
+        __atomic_store_n(&busFrames, busFrames + 1U, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+static void burstSent(void *object)
+{
+    CHECK(object == &sched);
+    burstSentTime = host_test_seconds();
+    __atomic_store_n(&burstSentCount, burstSentCount + 1U, __ATOMIC_RELEASE);
+}
+
+static void initTPDO(uint16_t count)
+{
+    uint16_t i;
+
+    CO_TPDOplanPool_init(&TPDOplanPool, TPDOplan, count);
+    for (i = 0U; i < count; i++)
+    {
+        CO_TPDO_t *T = &TPDO[i];
+
+        memset(T, 0, sizeof(*T));
+        T->SDO = &SDO;
+        T->planPool = &TPDOplanPool;
+        T->TPDOCommPar = &TPDOCommPar;
+        T->TPDOMapPar = &TPDOMapPar;
+        T->operatingState = &operatingState;
+        T->valid = true;
+        T->SYNC = &SYNC;
+        T->syncCounter = 255;
+        T->CANdevTx = &CANmodule;
+        T->CANtxBuff = CO_CANtxBufferInit(&CANmodule, i, 0x180U + i, false, 8, true);
+        CHECK(T->CANtxBuff != NULL);
+        CHECK(CO_TPDOconfigMap(T, 2) == 0U && T->dataLength == 8U);
+        TPDOs[i] = T;
+    }
+    CO_TPDOsched_init(&sched, TPDOs, heap, active, sync, syncDue, burst, count);
+    /* NMT state is seen first, lists of synchronous TPDOs are built */
+    CO_TPDOsched_process(&sched, false, 1000U, NULL);
+    CHECK(sched.syncCount == count);
+}
+
+static int compare(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Sort samples, return p50 and max */
+static void percentiles(float *samples, float *p50, float *max)
+{
+    qsort(samples, BURSTS, sizeof(float), compare);
+    *p50 = samples[BURSTS / 2U];
+    *max = samples[BURSTS - 1U];
+}
+
+/* BURSTS SYNCs with count synchronous TPDOs, next SYNC after burst is sent */
+static void burstRun(uint16_t count)
+{
+    static float processed[BURSTS], transmitted[BURSTS], callback[BURSTS];
+    float p50[3], max[3];
+    uint32_t pendingMax = 0U;
+    uint32_t n;
+
+    initTPDO(count);
+    busInversions = 0U;
+    for (n = 0U; n < BURSTS; n++)
+    {
+        uint32_t frames = busFrames, sentCount = burstSentCount;
+        double timeout, syncTime;
+
+        /* bus is idle, burst starts with lowest CAN-ID */
+        busLastIdent = 0U;
+        /* SYNC received */
+        syncTime = host_test_seconds();
+        CO_TPDOsched_process(&sched, true, 1000U, NULL);
+        processed[n] = (float)((host_test_seconds() - syncTime) * 1e6);
+        CHECK(sched.syncSent == count);
+        CO_LOCK_CAN_SEND();
+        if (CANmodule.CANtxCount > pendingMax)
+        {
+            pendingMax = CANmodule.CANtxCount;
+        }
+        CO_UNLOCK_CAN_SEND();
+
+        timeout = host_test_seconds() + 1.0;
+        while (__atomic_load_n(&burstSentCount, __ATOMIC_ACQUIRE) == sentCount)
+        {
+            CHECK(host_test_seconds() < timeout);
+            sched_yield();
+        }
+        /* bus thread counts the last frame after its TX alerts */
+        while (__atomic_load_n(&busFrames, __ATOMIC_ACQUIRE) - frames != count)
+        {
+            CHECK(host_test_seconds() < timeout);
+            sched_yield();
+        }
+        /* one callback per burst, after its last frame */
+        CHECK(burstSentCount == sentCount + 1U);
+        CHECK(burstSentTime >= busLastTime);
+        transmitted[n] = (float)((busLastTime - syncTime) * 1e6);
+        callback[n] = (float)((burstSentTime - syncTime) * 1e6);
+    }
+    CHECK(busInversions == 0U);
+    percentiles(processed, &p50[0], &max[0]);
+    percentiles(transmitted, &p50[1], &max[1]);
+    percentiles(callback, &p50[2], &max[2]);
+    REPORT("%2u sync TPDOs, us from SYNC p50 / max: CO_TPDOsched_process() returns %5.0f / %5.0f, "
+           "last frame transmitted %5.0f / %5.0f, burst sent callback %5.0f / %5.0f, pending max %u",
+           count, p50[0], max[0], p50[1], max[1], p50[2], max[2], pendingMax);
+    /* bus is polled, when idle, first frame takes up to one frame time */
+    CHECK(p50[1] >= (count - 1U) * BUS_FRAME_US && p50[0] < p50[1]);
+}
+
+int main(void)
+{
+    pthread_t bus;
+
+    CO_ODmutex = xSemaphoreCreateMutex();
+    SDO.OD = CO_OD;
+    SDO.ODSize = CO_OD_NoOfElements;
+    SDO.ODExtensions = ODExtensions;
+
+    CHECK(CO_CANmodule_init(&CANmodule, NULL, rxArray, 1, txArray, PDO_MAX, 1000) == CO_ERROR_NO);
+    CO_CANmodule_initCallbackBurstSent(&CANmodule, &sched, burstSent);
+    CO_CANsetNormalMode(&CANmodule);
+    busRunning = true;
+    CHECK(pthread_create(&bus, NULL, busThread, NULL) == 0);
+
+    burstRun(4U);
+    burstRun(PDO_MAX);
+
+    /* frames sent without burst don't call it */
+    CHECK(CO_CANsend(&CANmodule, &txArray[0]) == CO_ERROR_NO);
+    while (__atomic_load_n(&busFrames, __ATOMIC_ACQUIRE) != BURSTS * (4U + PDO_MAX) + 1U)
+    {
+        sched_yield();
+    }
+    vTaskDelay(10);
+    CHECK(burstSentCount == 2U * BURSTS);
+
+    busRunning = false;
+    pthread_join(bus, NULL);
+    CO_CANmodule_disable(&CANmodule);
+    return 0;
+}
@@ -0,0 +1,223 @@
+/*
+ * OD extensions of mapped PDO objects, resolved at mapping time: extension
+ * functions get the same arguments as from searching Object Dictionary on
+ * each PDO. Benchmark of CO_TPDOsend() and of CO_PDO_receive() with
+ * CO_RPDO_process() for PDO with 4 objects, which have extensions, with
+ * resolved extensions and with CO_OD_find() and getters on each PDO, as
+ * before. Node Object Dictionary is used with and without hash index and
+ * descriptor table.
+ *
+ * CAN send function of PDO is replaced by function, which counts messages.
+ */
+
+#include "CO_driver.h"
+
+static CO_ReturnError_t test_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer);
+#define CO_CANsend(CANmodule, buffer) test_CANsend(CANmodule, buffer)
+
+#include "../CO_PDO.c"
+
+#undef CO_CANsend
+
+#include "CO_OD.h"
+#include "CO_OD_desc.h"
+#include "host_test.h"
+
+extern const CO_OD_entry_t CO_OD[CO_OD_NoOfElements];
+
+#define PDOS 5000000UL
+
+static CO_SDO_t SDO;
+static CO_OD_extension_t ODExtensions[CO_OD_NoOfElements];
+static CO_OD_index_t ODindex;
+static uint16_t slot[CO_OD_INDEX_SLOTS(CO_OD_NoOfElements)];
+static uint16_t disp[CO_OD_INDEX_BUCKETS(CO_OD_NoOfElements)];
+static uint8_t flags2110[0x11], flags6000[0x09], flags6200[0x09], flags6401[0x0D], flags6411[0x09];
+static CO_NMT_internalState_t operatingState = CO_NMT_OPERATIONAL;
+static uint32_t sent;
+static uint32_t extCalls;
+static CO_ODF_arg_t lastArg;
+
+static CO_ReturnError_t test_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer)
+{
+    (void)CANmodule;
+    (void)buffer;
+    sent++;
+    return CO_ERROR_NO;
+}
+
+/* Extension function, which only looks at its arguments */
+static CO_SDO_abortCode_t extension(CO_ODF_arg_t *ODF_arg)
+{
+    extCalls++;
+    lastArg = *ODF_arg;
+    return CO_SDO_AB_NONE;
+}
+
+/* Call extensions of mapped objects as before they were resolved at mapping */
+static void searchExt(CO_SDO_t *pSDO, const uint32_t *pMap, uint8_t noOfMappedObjects, bool_t reading)
+{
+    int16_t i;
+
+    for (i = noOfMappedObjects; i > 0; i--)
+    {
+        uint32_t map = *(pMap++);
+        uint16_t index = (uint16_t)(map >> 16);
+        uint8_t subIndex = (uint8_t)(map >> 8);
+        uint16_t entryNo = CO_OD_find(pSDO, index);
+        CO_OD_extension_t *ext;
+        CO_ODF_arg_t ODF_arg;
+
+        if (entryNo == 0xFFFF)
+        {
+            continue;
+        }
+        ext = &pSDO->ODExtensions[entryNo];
+        if (ext->pODFunc == NULL)
+        {
+            continue;
+        }
+        memset((void *)&ODF_arg, 0, sizeof(CO_ODF_arg_t));
+        ODF_arg.reading = reading;
+        ODF_arg.index = index;
+        ODF_arg.subIndex = subIndex;
+        ODF_arg.object = ext->object;
+        ODF_arg.attribute = CO_OD_getAttribute(pSDO, entryNo, subIndex);
+        ODF_arg.pFlags = CO_OD_getFlagsPointer(pSDO, entryNo, subIndex);
+        ODF_arg.data = CO_OD_getDataPointer(pSDO, entryNo, subIndex);
+        ODF_arg.dataLength = CO_OD_getLength(pSDO, entryNo, subIndex);
+        ext->pODFunc(&ODF_arg);
+    }
+}
+
+/* Both ways pass the same arguments to extension function */
+static void checkArgs(CO_TPDO_t *TPDO, CO_RPDO_t *RPDO, can_message_t *msg)
+{
+    uint8_t extCount = TPDO->plan->extCount;
+    CO_ODF_arg_t resolved;
+
+    CHECK(extCount == 4U && RPDO->plan->extCount == 4U);
+    extCalls = 0U;
+    CHECK(CO_TPDOsend(TPDO) == CO_ERROR_NO && extCalls == 4U);
+    resolved = lastArg;
+    TPDO->plan->extCount = 0U;
+    searchExt(&SDO, &TPDO->TPDOMapPar->mappedObject1, TPDO->TPDOMapPar->numberOfMappedObjects, true);
+    TPDO->plan->extCount = extCount;
+    CHECK(extCalls == 8U && resolved.reading && lastArg.reading);
+    CHECK(resolved.index == lastArg.index && resolved.subIndex == lastArg.subIndex);
+    CHECK(resolved.data == lastArg.data && resolved.dataLength == lastArg.dataLength);
+    CHECK(resolved.attribute == lastArg.attribute && resolved.pFlags == lastArg.pFlags && resolved.pFlags != NULL);
+    CHECK(resolved.object == lastArg.object);
+
+    CO_PDO_receive(RPDO, msg);
+    CO_RPDO_process(RPDO, false);
+    CHECK(extCalls == 12U && !lastArg.reading && lastArg.index == 0x6200U && lastArg.subIndex == 2U);
+}
+
+/* Nanoseconds per TPDO sent and per RPDO received and processed */
+static void benchmark(CO_TPDO_t *TPDO, CO_RPDO_t *RPDO, can_message_t *msg, bool_t search, double time[2])
+{
+    uint8_t txExtCount = TPDO->plan->extCount;
+    uint8_t rxExtCount = RPDO->plan->extCount;
+    double start;
+    uint32_t n;
+
+    if (search)
+    {
+        TPDO->plan->extCount = 0U;
+        RPDO->plan->extCount = 0U;
+    }
+    extCalls = 0U;
+    start = host_test_seconds();
+    for (n = 0U; n < PDOS; n++)
+    {
+        if (search)
+        {
+            searchExt(&SDO, &TPDO->TPDOMapPar->mappedObject1, TPDO->TPDOMapPar->numberOfMappedObjects, true);
+        }
+        CO_TPDOsend(TPDO);
+    }
+    time[0] = (host_test_seconds() - start) * 1e9 / PDOS;
+    start = host_test_seconds();
+    for (n = 0U; n < PDOS; n++)
+    {
+        msg->data[0] = (uint8_t)n;
+        CO_PDO_receive(RPDO, msg);
+        CO_RPDO_process(RPDO, false);
+        if (search)
+        {
+            searchExt(&SDO, &RPDO->RPDOMapPar->mappedObject1, RPDO->RPDOMapPar->numberOfMappedObjects, false);
+        }
+    }
+    time[1] = (host_test_seconds() - start) * 1e9 / PDOS;
+    CHECK(extCalls == 8U * PDOS);
+    TPDO->plan->extCount = txExtCount;
+    RPDO->plan->extCount = rxExtCount;
+}
+
+int main(void)
+{
+    /* 32, 16, 8 and 8 bits, each object has extension */
+    static CO_TPDOMapPar_t TPDOMapPar = {.numberOfMappedObjects = 4, .mappedObject1 = 0x21100120UL,
+                                         .mappedObject2 = 0x64010110UL, .mappedObject3 = 0x60000108UL,
+                                         .mappedObject4 = 0x60000208UL};
+    static CO_RPDOMapPar_t RPDOMapPar = {.numberOfMappedObjects = 4, .mappedObject1 = 0x21100320UL,
+                                         .mappedObject2 = 0x64110110UL, .mappedObject3 = 0x62000108UL,
+                                         .mappedObject4 = 0x62000208UL};
+    static CO_TPDOplan_t TPDOplan[1];
+    static CO_RPDOplan_t RPDOplan[1];
+    CO_TPDOplanPool_t TPDOplanPool;
+    CO_RPDOplanPool_t RPDOplanPool;
+    CO_TPDO_t TPDO = {0};
+    CO_RPDO_t RPDO = {0};
+    CO_CANtx_t CANtx = {0};
+    can_message_t msg = {.identifier = 0x201, .data_length_code = 8};
+    double resolved[2], search[2], decoded[2], searchDecoded[2];
+
+    CO_ODmutex = xSemaphoreCreateMutex();
+    SDO.ownOD = true;
+    SDO.OD = CO_OD;
+    SDO.ODSize = CO_OD_NoOfElements;
+    SDO.ODExtensions = ODExtensions;
+    CHECK(CO_OD_initIndex(&SDO, &ODindex, slot, disp) == CO_ERROR_NO);
+    CHECK(CO_OD_initDesc(&SDO, CO_OD_desc, CO_OD_descFirst) == CO_ERROR_NO);
+    /* flagsSize is maxSubIndex, flags has one byte more */
+    CO_OD_configure(&SDO, 0x2110, extension, &SDO, flags2110, sizeof(flags2110) - 1U);
+    CO_OD_configure(&SDO, 0x6000, extension, &SDO, flags6000, sizeof(flags6000) - 1U);
+    CO_OD_configure(&SDO, 0x6200, extension, &SDO, flags6200, sizeof(flags6200) - 1U);
+    CO_OD_configure(&SDO, 0x6401, extension, &SDO, flags6401, sizeof(flags6401) - 1U);
+    CO_OD_configure(&SDO, 0x6411, extension, &SDO, flags6411, sizeof(flags6411) - 1U);
+
+    CO_TPDOplanPool_init(&TPDOplanPool, TPDOplan, 1);
+    TPDO.SDO = &SDO;
+    TPDO.planPool = &TPDOplanPool;
+    TPDO.TPDOMapPar = &TPDOMapPar;
+    TPDO.CANtxBuff = &CANtx;
+    CHECK(CO_TPDOconfigMap(&TPDO, 4) == 0U && TPDO.dataLength == 8U);
+
+    CO_RPDOplanPool_init(&RPDOplanPool, RPDOplan, 1);
+    RPDO.SDO = &SDO;
+    RPDO.planPool = &RPDOplanPool;
+    RPDO.RPDOMapPar = &RPDOMapPar;
+    RPDO.operatingState = &operatingState;
+    RPDO.valid = true;
+    RPDO.rxMap = &RPDO;
+    CHECK(CO_RPDOconfigMap(&RPDO, 4) == 0U && RPDO.dataLength == 8U);
+
+    checkArgs(&TPDO, &RPDO, &msg);
+    benchmark(&TPDO, &RPDO, &msg, false, resolved);
+    benchmark(&TPDO, &RPDO, &msg, true, search);
+    /* without hash index and descriptor table, as when extensions were searched */
+    SDO.ODindex = NULL;
+    SDO.ODdesc = NULL;
+    checkArgs(&TPDO, &RPDO, &msg);
+    benchmark(&TPDO, &RPDO, &msg, false, decoded);
+    benchmark(&TPDO, &RPDO, &msg, true, searchDecoded);
+
+    REPORT("ns per TPDO sent / RPDO processed, 4 objects with extensions:");
+    REPORT("  OD index and descriptors: resolved %5.1f / %5.1f, searched %5.1f / %5.1f", resolved[0], resolved[1],
+           search[0], search[1]);
+    REPORT("  binary search, decoding:  resolved %5.1f / %5.1f, searched %5.1f / %5.1f", decoded[0], decoded[1],
+           searchDecoded[0], searchDecoded[1]);
+    return 0;
+}
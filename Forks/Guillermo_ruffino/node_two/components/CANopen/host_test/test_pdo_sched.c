@@ -0,0 +1,438 @@
+/*
+ * RPDO and TPDO schedulers: staging slot is shared by all PDOs of scheduler,
+ * one mapping is staged at a time. Reports size of PDO objects and RAM of
+ * schedulers and benchmark of one CO_RPDOsched_process() and
+ * CO_TPDOsched_process() tick at 4, 64 and 512 PDOs.
+ *
+ * RPDO tick: four RPDOs receive a message and are processed, reception
+ * deadlines of all received RPDOs are monitored. TPDO tick: Change of State
+ * is checked for all TPDOs, event timers of 50 to 99 ms expire. Tick is 1 ms.
+ *
+ * Inhibit time and event timer keep working after 40 minutes without
+ * transmission, longer than half of the 32-bit microsecond scheduler clock.
+ *
+ * RPDO, which stops receiving, times out at its deadline, CO_EM_RPDO_TIME_OUT
+ * is reported and reset, when it is received again.
+ *
+ * CAN send functions of PDO are replaced by functions, which count messages,
+ * emergency functions by functions, which record CO_EM_RPDO_TIME_OUT.
+ */
+
+#include "CO_driver.h"
+#include "CO_PDO.h"
+
+static CO_ReturnError_t test_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer);
+static CO_ReturnError_t test_CANsendBurst(CO_CANmodule_t *CANmodule, CO_CANtx_t *const *buffers, uint16_t count);
+static void test_errorReport(CO_EM_t *em, const uint8_t errorBit, const uint16_t errorCode, const uint32_t infoCode);
+static void test_errorReset(CO_EM_t *em, const uint8_t errorBit, const uint32_t infoCode);
+#define CO_CANsend(CANmodule, buffer) test_CANsend(CANmodule, buffer)
+#define CO_CANsendBurst(CANmodule, buffers, count) test_CANsendBurst(CANmodule, buffers, count)
+#define CO_errorReport(em, errorBit, errorCode, infoCode) test_errorReport(em, errorBit, errorCode, infoCode)
+#define CO_errorReset(em, errorBit, infoCode) test_errorReset(em, errorBit, infoCode)
+
+#include "../CO_PDO.c"
+
+#undef CO_CANsend
+#undef CO_CANsendBurst
+#undef CO_errorReport
+#undef CO_errorReset
+
+#include "CO_OD.h"
+#include "host_test.h"
+
+extern const CO_OD_entry_t CO_OD[CO_OD_NoOfElements];
+
+#define PDO_MAX 512U
+#define TICKS 20000U
+#define RX_PER_TICK 4U
+
+static CO_SDO_t SDO;
+static CO_OD_extension_t ODExtensions[CO_OD_NoOfElements];
+static CO_NMT_internalState_t operatingState = CO_NMT_OPERATIONAL;
+static CO_CANmodule_t CANmodule;
+static uint32_t sent;
+static bool_t sendError;
+static bool_t timeoutError;  /* CO_EM_RPDO_TIME_OUT is set */
+static uint32_t timeoutInfo; /* info code of last report or reset */
+static uint32_t timeoutReports;
+
+static CO_RPDO_t RPDO[PDO_MAX];
+static CO_RPDO_t *RPDOs[PDO_MAX];
+static CO_RPDOplan_t RPDOplan[PDO_MAX];
+static CO_RPDOplanPool_t RPDOplanPool;
+static CO_RPDOCommPar_t RPDOCommPar = {.maxSubIndex = 5, .transmissionType = 255, .eventTimer = 60000};
+static CO_RPDOMapPar_t RPDOMapPar = {.numberOfMappedObjects = 1, .mappedObject1 = 0x21100120UL};
+static CO_RPDOsched_t RPDOsched;
+static uint32_t pending[CO_RPDO_PENDING_WORDS(PDO_MAX)], received[CO_RPDO_PENDING_WORDS(PDO_MAX)];
+static uint16_t RPDOheap[PDO_MAX];
+
+static CO_TPDO_t TPDO[PDO_MAX];
+static CO_TPDO_t *TPDOs[PDO_MAX];
+static CO_TPDOplan_t TPDOplan[PDO_MAX];
+static CO_TPDOplanPool_t TPDOplanPool;
+static CO_TPDOCommPar_t TPDOCommPar[PDO_MAX];
+static CO_TPDOMapPar_t TPDOMapPar = {.numberOfMappedObjects = 1, .mappedObject1 = 0x21100220UL};
+static CO_CANtx_t CANtx[PDO_MAX];
+static CO_TPDOsched_t TPDOsched;
+static uint16_t TPDOheap[PDO_MAX], active[PDO_MAX], sync[PDO_MAX], syncDue[PDO_MAX];
+static CO_CANtx_t *burst[PDO_MAX];
+
+/******************************************************************************/
+static CO_ReturnError_t test_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer)
+{
+    if (sendError)
+    {
+        return CO_ERROR_TX_OVERFLOW;
+    }
+    sent++;
+    return CO_ERROR_NO;
+}
+
+static CO_ReturnError_t test_CANsendBurst(CO_CANmodule_t *CANmodule, CO_CANtx_t *const *buffers, uint16_t count)
+{
+    sent += count;
+    return CO_ERROR_NO;
+}
+
+static void test_errorReport(CO_EM_t *em, const uint8_t errorBit, const uint16_t errorCode, const uint32_t infoCode)
+{
+    if (errorBit != CO_EM_RPDO_TIME_OUT)
+    {
+        return;
+    }
+    CHECK(errorCode == CO_EMC_RPDO_TIMEOUT);
+    timeoutError = true;
+    timeoutInfo = infoCode;
+    timeoutReports++;
+}
+
+static void test_errorReset(CO_EM_t *em, const uint8_t errorBit, const uint32_t infoCode)
+{
+    if (errorBit != CO_EM_RPDO_TIME_OUT)
+    {
+        return;
+    }
+    CHECK(timeoutError);
+    timeoutError = false;
+    timeoutInfo = infoCode;
+}
+
+/******************************************************************************/
+static void initRPDO(uint16_t count)
+{
+    uint16_t i;
+
+    CO_RPDOplanPool_init(&RPDOplanPool, RPDOplan, count);
+    for (i = 0U; i < count; i++)
+    {
+        CO_RPDO_t *R = &RPDO[i];
+
+        memset(R, 0, sizeof(*R));
+        R->SDO = &SDO;
+        R->planPool = &RPDOplanPool;
+        R->RPDOCommPar = &RPDOCommPar;
+        R->RPDOMapPar = &RPDOMapPar;
+        R->operatingState = &operatingState;
+        R->valid = true;
+        R->rxMap = R;
+        CHECK(CO_RPDOconfigMap(R, 1) == 0U);
+        RPDOs[i] = R;
+    }
+    CO_RPDOsched_init(&RPDOsched, RPDOs, pending, received, RPDOheap, count);
+}
+
+static void initTPDO(uint16_t count)
+{
+    uint16_t i;
+
+    CO_TPDOplanPool_init(&TPDOplanPool, TPDOplan, count);
+    for (i = 0U; i < count; i++)
+    {
+        CO_TPDO_t *T = &TPDO[i];
+
+        memset(T, 0, sizeof(*T));
+        TPDOCommPar[i] = (CO_TPDOCommPar_t){.maxSubIndex = 6, .transmissionType = 254,
+                                            .eventTimer = (uint16_t)(50U + i % 50U)};
+        T->SDO = &SDO;
+        T->planPool = &TPDOplanPool;
+        T->TPDOCommPar = &TPDOCommPar[i];
+        T->TPDOMapPar = &TPDOMapPar;
+        T->operatingState = &operatingState;
+        T->valid = true;
+        T->CANdevTx = &CANmodule;
+        T->CANtxBuff = &CANtx[i];
+        CHECK(CO_TPDOconfigMap(T, 1) == 0U);
+        TPDOs[i] = T;
+    }
+    CO_TPDOsched_init(&TPDOsched, TPDOs, TPDOheap, active, sync, syncDue, burst, count);
+}
+
+/* Nanoseconds per RPDO scheduler tick */
+static double benchmarkRPDO(uint16_t count)
+{
+    can_message_t msg = {.data_length_code = 4};
+    uint32_t timerNext_us;
+    uint16_t next = 0U;
+    double start;
+    uint32_t n, k;
+
+    initRPDO(count);
+    start = host_test_seconds();
+    for (n = 0U; n < TICKS; n++)
+    {
+        for (k = 0U; k < RX_PER_TICK; k++)
+        {
+            CO_setUint32(msg.data, n);
+            CO_PDO_receive(&RPDO[next], &msg);
+            next = (uint16_t)((next + 1U) % count);
+        }
+        timerNext_us = 1000000U;
+        CO_RPDOsched_process(&RPDOsched, false, 1000U, &timerNext_us);
+    }
+    start = host_test_seconds() - start;
+    CHECK(RPDOsched.heapCount == count && RPDOsched.timeoutCount == 0U);
+    CHECK(CO_OD_RAM.variableInt32[0] == (int32_t)(TICKS - 1U));
+    return start * 1e9 / TICKS;
+}
+
+/* Nanoseconds per TPDO scheduler tick */
+static double benchmarkTPDO(uint16_t count)
+{
+    uint32_t timerNext_us;
+    double start;
+    uint32_t n;
+
+    initTPDO(count);
+    sent = 0U;
+    start = host_test_seconds();
+    for (n = 0U; n < TICKS; n++)
+    {
+        timerNext_us = 1000000U;
+        CO_TPDOsched_process(&TPDOsched, false, 1000U, &timerNext_us);
+    }
+    start = host_test_seconds() - start;
+    /* each TPDO is sent on first tick and then by its event timer */
+    CHECK(sent >= count * (TICKS / 100U));
+    return start * 1e9 / TICKS;
+}
+
+static void tick(uint32_t ticks)
+{
+    while (ticks-- > 0U)
+    {
+        CO_TPDOsched_process(&TPDOsched, false, 1000U, NULL);
+    }
+}
+
+/* One TPDO idle for longer than half of scheduler clock range */
+static void longIdle(void)
+{
+    const uint32_t idle = 40U * 60U * 1000U; /* 40 min of 1 ms ticks */
+
+    /* send request after inhibit time, which expired 40 min ago */
+    initTPDO(1U);
+    TPDOCommPar[0].eventTimer = 0U;
+    TPDOCommPar[0].inhibitTime = 10U;
+    sent = 0U;
+    tick(1U);
+    TPDO[0].sendRequest = 1U;
+    tick(1U);
+    CHECK(sent == 1U && TPDO[0].inhibitRunning && TPDOsched.heapCount == 1U);
+    tick(1U);
+    CHECK(!TPDO[0].inhibitRunning && TPDOsched.heapCount == 0U);
+    tick(idle);
+    TPDO[0].sendRequest = 1U;
+    tick(1U);
+    CHECK(sent == 2U);
+
+    /* event timer, while CAN transmit buffer was full for 40 min */
+    initTPDO(1U);
+    TPDOCommPar[0].eventTimer = 100U;
+    sent = 0U;
+    sendError = true;
+    tick(idle);
+    sendError = false;
+    tick(1U);
+    CHECK(sent == 1U);
+    tick(100U);
+    CHECK(sent == 2U);
+
+    /* event timer of TPDO, which was not operational for 40 min */
+    initTPDO(1U);
+    TPDOCommPar[0].transmissionType = 253U;
+    TPDOCommPar[0].eventTimer = 100U;
+    sent = 0U;
+    tick(1U);
+    operatingState = CO_NMT_PRE_OPERATIONAL;
+    tick(idle);
+    operatingState = CO_NMT_OPERATIONAL;
+    tick(100U);
+    CHECK(sent == 0U);
+    tick(1U);
+    CHECK(sent == 1U);
+    REPORT("after %u min idle: send request and event timer are served in time", (unsigned)(idle / 60000U));
+}
+
+/* RPDO 2 stops receiving and misses its deadline, others keep receiving.
+ * RPDOs 0 and 1 are received every tick, RPDO 3 every 10 ticks. */
+static void rpdoTimeout(void)
+{
+    const uint32_t eventTimer = 100U; /* ms, ticks */
+    can_message_t msg = {.data_length_code = 4};
+    uint32_t timerNext_us = 0U;
+    uint32_t lastRx2 = 0U, lastRx3 = 0U;
+    uint32_t n;
+
+    initRPDO(4U);
+    RPDOCommPar.eventTimer = (uint16_t)eventTimer;
+    timeoutError = false;
+    timeoutReports = 0U;
+
+    for (n = 0U; n < 1000U; n++)
+    {
+        uint16_t k;
+
+        for (k = 0U; k < 4U; k++)
+        {
+            if ((k == 2U && n >= 50U && n < 500U) || (k == 3U && n % 10U != 0U))
+            {
+                continue;
+            }
+            CO_PDO_receive(&RPDO[k], &msg);
+            if (k == 2U)
+            {
+                lastRx2 = n;
+            }
+            if (k == 3U)
+            {
+                lastRx3 = n;
+            }
+        }
+        timerNext_us = 1000000U;
+        CO_RPDOsched_process(&RPDOsched, false, 1000U, &timerNext_us);
+
+        if (n < lastRx2 + eventTimer)
+        {
+            /* all received in time, RPDO 2 or 3 has earliest deadline */
+            uint32_t lastRx = (lastRx2 < lastRx3) ? lastRx2 : lastRx3;
+
+            CHECK(RPDOsched.timeoutCount == 0U && !timeoutError);
+            CHECK(timerNext_us == (lastRx + eventTimer - n) * 1000U);
+        }
+        else
+        {
+            /* RPDO 2 timed out, RPDO 3 has earliest remaining deadline */
+            CHECK(RPDOsched.timeoutCount == 1U && timeoutError && timeoutInfo == 2U);
+            CHECK(RPDOsched.heapCount == 3U && RPDO[2].heapPos == CO_RPDO_NOT_SCHEDULED);
+            CHECK(timerNext_us == (lastRx3 + eventTimer - n) * 1000U);
+        }
+    }
+    /* received again from tick 500 */
+    CHECK(lastRx2 == n - 1U && RPDOsched.timeoutCount == 0U && !timeoutError && timeoutInfo == 2U);
+    CHECK(timeoutReports == 1U && RPDOsched.heapCount == 4U);
+    RPDOCommPar.eventTimer = 60000U;
+    REPORT("RPDO timeout: reported %u ms after last message, reset when received again", (unsigned)eventTimer);
+}
+
+/* Only mapped PDOs take a plan, PDO mapped by staging takes it at swap */
+static void planPool(void)
+{
+    static const uint32_t map[1] = {0x21100120UL};
+
+    initRPDO(4U);
+    CO_RPDOplanPool_init(&RPDOplanPool, RPDOplan, 1);
+    RPDO[0].plan = RPDO[1].plan = NULL;
+    CHECK(CO_RPDOconfigMap(&RPDO[0], 0) == 0U && RPDO[0].dataLength == 0U && RPDOplanPool.used == 0U);
+    CHECK(CO_RPDOconfigMap(&RPDO[1], 0) == 0U && RPDOplanPool.used == 0U);
+    CHECK(CO_RPDOsched_stageMap(&RPDOsched, 0U, map, 1) == CO_SDO_AB_NONE && RPDOplanPool.used == 1U);
+    CHECK(RPDO[0].plan->copyRunCount == 0U);
+    CO_RPDOsched_process(&RPDOsched, false, 1000U, NULL);
+    CHECK(RPDO[0].plan == &RPDOplan[0] && RPDO[0].plan->copyRunCount == 1U && RPDO[0].dataLength == 4U);
+    CHECK(CO_RPDOsched_stageMap(&RPDOsched, 1U, map, 1) == CO_SDO_AB_OUT_OF_MEM);
+    CHECK(CO_RPDOconfigMap(&RPDO[1], 1) == CO_SDO_AB_OUT_OF_MEM && RPDO[1].dataLength == 0U);
+    CHECK(CO_RPDOconfigMap(&RPDO[0], 1) == 0U && RPDOplanPool.used == 1U);
+
+    initTPDO(4U);
+    CO_TPDOplanPool_init(&TPDOplanPool, TPDOplan, 1);
+    TPDO[0].plan = TPDO[1].plan = NULL;
+    CHECK(CO_TPDOconfigMap(&TPDO[0], 0) == 0U && CO_TPDOconfigMap(&TPDO[1], 0) == 0U);
+    CHECK(CO_TPDOsched_stageMap(&TPDOsched, 0U, map, 1) == CO_SDO_AB_NONE && TPDOplanPool.used == 1U);
+    CO_TPDOsched_process(&TPDOsched, false, 1000U, NULL);
+    CHECK(TPDO[0].plan == &TPDOplan[0] && TPDO[0].plan->copyRunCount == 1U && TPDO[0].dataLength == 4U);
+    CHECK(CO_TPDOconfigMap(&TPDO[1], 1) == CO_SDO_AB_OUT_OF_MEM && TPDO[1].dataLength == 0U);
+    REPORT("PDO without mapped objects takes no plan, empty pool aborts mapping with out of memory");
+}
+
+int main(void)
+{
+    static const uint16_t counts[] = {4U, 64U, PDO_MAX};
+    static const uint32_t mapA[1] = {0x21100120UL};
+    static const uint32_t mapB[2] = {0x21100220UL, 0x21100120UL};
+    static const uint32_t mapT[1] = {0x21100220UL};
+    uint16_t i;
+
+    CO_ODmutex = xSemaphoreCreateMutex();
+    SDO.OD = CO_OD;
+    SDO.ODSize = CO_OD_NoOfElements;
+    SDO.ODExtensions = ODExtensions;
+
+    REPORT("sizeof CO_RPDO_t %u, CO_TPDO_t %u, copy plan %u / %u, CO_RPDOsched_t %u, CO_TPDOsched_t %u, "
+           "staging slot in them %u / %u bytes",
+           (unsigned)sizeof(CO_RPDO_t), (unsigned)sizeof(CO_TPDO_t), (unsigned)sizeof(CO_RPDOplan_t),
+           (unsigned)sizeof(CO_TPDOplan_t), (unsigned)sizeof(CO_RPDOsched_t), (unsigned)sizeof(CO_TPDOsched_t),
+           (unsigned)sizeof(CO_RPDOstaged_t), (unsigned)sizeof(CO_TPDOstaged_t));
+    for (i = 0U; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        uint32_t n = counts[i];
+        /* objects, pointer arrays and scheduler arrays as allocated in CANopen.c */
+        uint32_t rx = n * (sizeof(CO_RPDO_t) + sizeof(CO_RPDO_t *) + sizeof(uint16_t)) +
+                      2U * CO_RPDO_PENDING_WORDS(n) * sizeof(uint32_t) + sizeof(CO_RPDOsched_t);
+        uint32_t tx = n * (sizeof(CO_TPDO_t) + sizeof(CO_TPDO_t *) + 4U * sizeof(uint16_t) + sizeof(CO_CANtx_t *)) +
+                      sizeof(CO_TPDOsched_t);
+
+        REPORT("%3u PDOs: RPDO %6u bytes, TPDO %6u bytes, plans for all of them add %6u / %6u bytes", (unsigned)n,
+               (unsigned)rx, (unsigned)tx, (unsigned)(n * sizeof(CO_RPDOplan_t)),
+               (unsigned)(n * sizeof(CO_TPDOplan_t)));
+    }
+
+    planPool();
+    rpdoTimeout();
+
+    /* one mapping at a time in staging slot of scheduler */
+    initRPDO(4U);
+    CHECK(CO_RPDOsched_stageMap(&RPDOsched, 4U, mapA, 1) == CO_SDO_AB_INVALID_VALUE);
+    CHECK(CO_RPDOsched_stageMap(&RPDOsched, 1U, mapB, 2) == CO_SDO_AB_NONE);
+    CHECK(RPDOsched.staged == &RPDO[1] && RPDOsched.staging.shadow.dataLength == 8U);
+    CHECK(CO_RPDOsched_stageMap(&RPDOsched, 2U, mapB, 2) == CO_SDO_AB_DATA_DEV_STATE);
+    CO_RPDOsched_process(&RPDOsched, false, 1000U, NULL);
+    CHECK(!CO_FLAG_READ(RPDOsched.stagedNew) && RPDO[1].dataLength == 8U && RPDO[2].dataLength == 4U);
+    CHECK(RPDOMapPar.numberOfMappedObjects == 2U && RPDOMapPar.mappedObject1 == mapB[0]);
+    CHECK(CO_RPDOsched_stageMap(&RPDOsched, 2U, mapA, 1) == CO_SDO_AB_NONE);
+    CO_RPDOsched_process(&RPDOsched, false, 1000U, NULL);
+    CHECK(!CO_FLAG_READ(RPDOsched.stagedNew) && RPDO[2].dataLength == 4U);
+    CHECK(RPDOMapPar.numberOfMappedObjects == 1U && RPDOMapPar.mappedObject1 == mapA[0]);
+    RPDOMapPar.mappedObject2 = 0U;
+
+    initTPDO(4U);
+    CHECK(CO_TPDOsched_stageMap(&TPDOsched, 3U, mapB, 2) == CO_SDO_AB_NONE);
+    CHECK(CO_TPDOsched_stageMap(&TPDOsched, 0U, mapA, 1) == CO_SDO_AB_DATA_DEV_STATE);
+    CO_TPDOsched_process(&TPDOsched, false, 1000U, NULL);
+    CHECK(!CO_FLAG_READ(TPDOsched.stagedNew) && TPDO[3].dataLength == 8U && TPDO[0].dataLength == 4U);
+    CHECK(TPDOMapPar.numberOfMappedObjects == 2U);
+    CHECK(CO_TPDOsched_stageMap(&TPDOsched, 0U, mapT, 1) == CO_SDO_AB_NONE);
+    CO_TPDOsched_process(&TPDOsched, false, 1000U, NULL);
+    CHECK(!CO_FLAG_READ(TPDOsched.stagedNew) && TPDOMapPar.numberOfMappedObjects == 1U);
+    CHECK(TPDOMapPar.mappedObject1 == mapT[0] && TPDOMapPar.mappedObject2 == 0U);
+
+    longIdle();
+
+    for (i = 0U; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        double rx = benchmarkRPDO(counts[i]);
+        double tx = benchmarkTPDO(counts[i]);
+
+        REPORT("%3u PDOs: ns per tick, RPDO scheduler %7.1f, TPDO scheduler %7.1f, %u TPDOs sent", counts[i], rx, tx,
+               sent);
+    }
+    return 0;
+}
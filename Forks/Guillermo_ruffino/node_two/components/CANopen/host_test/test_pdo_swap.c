@@ -0,0 +1,422 @@
+/*
+ * Staged RPDO mapping swapped in, while CAN receive function keeps running
+ * on another thread. Receive callback checks, that it always gets a complete
+ * field view of the old or of the new mapping, and counts rejected messages.
+ * Reports switch-over gap: calls of CO_RPDOsched_process() from staging until
+ * swap is finished and longest interval between processed messages.
+ *
+ * Receive function runs either in the middle of each copy of the field
+ * array, as CAN receive task preempts SYNC/PDO task on the same core, or on
+ * another thread. Then copies and receive callback yield to the other thread,
+ * zero to two times in turn. Control run verifies, that a field view written
+ * in place is seen half written.
+ *
+ * Reports receive-to-application latency of asynchronous RPDO: with receive
+ * callback, which gets the message in receive thread, and with SYNC/PDO
+ * thread, which polls CO_RPDOsched_process() every CO_MAIN_TASK_INTERVAL, as
+ * node_two does without SYNC. Latency of CAN receive task is not included.
+ */
+
+#include <string.h>
+
+static void *test_memcpy(void *dest, const void *src, size_t n);
+#define memcpy(dest, src, n) test_memcpy(dest, src, n)
+
+#include "../CO_PDO.c"
+
+#undef memcpy
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "CO_OD.h"
+#include "host_test.h"
+
+extern const CO_OD_entry_t CO_OD[CO_OD_NoOfElements];
+
+#define SWAPS 20000U
+#define LAT_MESSAGES 2000U
+
+static volatile bool copyYield;
+static bool copyReceive;
+static __thread uint32_t copies;
+
+static CO_SDO_t SDO;
+static CO_OD_extension_t ODExtensions[CO_OD_NoOfElements];
+static CO_EM_t em;
+static CO_RPDO_t RPDO;
+static CO_RPDOplan_t RPDOplan[1];
+static CO_RPDOplanPool_t RPDOplanPool;
+static CO_RPDO_t *RPDOs[1] = {&RPDO};
+static CO_RPDOCommPar_t RPDOCommPar = {.maxSubIndex = 5, .COB_IDUsedByRPDO = 0x201, .transmissionType = 255};
+static CO_RPDOMapPar_t RPDOMapPar;
+static CO_RPDOsched_t sched;
+static uint32_t pending[1], received[1];
+static uint16_t heap[1];
+static CO_NMT_internalState_t operatingState = CO_NMT_OPERATIONAL;
+static volatile bool running;
+
+/* written by receive thread */
+static uint32_t rxSent, rxDelivered, rxBadView;
+
+/* latency runs: send time of message k is latSendTime[k], message carries k */
+static double latSendTime[LAT_MESSAGES + 1U];
+static float latSamples[LAT_MESSAGES];
+static uint32_t latCount;
+
+/* Mapping A: 0x2110 sub 1 and 2, mapping B: sub 2 and 1, both INTEGER32 */
+static const uint32_t mapA[2] = {0x21100120UL, 0x21100220UL};
+static const uint32_t mapB[2] = {0x21100220UL, 0x21100120UL};
+
+static void receiveOne(void);
+
+static void *test_memcpy(void *dest, const void *src, size_t n)
+{
+    if ((n == sizeof(RPDO.plan->field)) && copyYield)
+    {
+        uint32_t k;
+
+        /* first mapped object, then the others */
+        memcpy(dest, src, sizeof(CO_PDOfield_t));
+        if (copyReceive)
+        {
+            receiveOne();
+        }
+        for (k = copies++ % 3U; k > 0U; k--)
+        {
+            sched_yield();
+        }
+        memcpy((uint8_t *)dest + sizeof(CO_PDOfield_t), (const uint8_t *)src + sizeof(CO_PDOfield_t),
+               n - sizeof(CO_PDOfield_t));
+        return dest;
+    }
+    return memcpy(dest, src, n);
+}
+
+static bool_t fieldIs(const CO_PDOfield_t *f, uint8_t subIndex, uint8_t bitOffset)
+{
+    return f->index == 0x2110U && f->subIndex == subIndex && f->bitOffset == bitOffset && f->bitLength == 32U;
+}
+
+/* Runs in receive thread, message is then buffered for CO_RPDO_process() */
+static bool_t rxCallback(void *object, const uint8_t *data, const CO_PDOfield_t *field, uint8_t fieldCount)
+{
+    uint32_t k;
+
+    (void)object;
+    (void)data;
+    rxDelivered++;
+    /* let processing thread run, while receive function is inside */
+    for (k = copies++ % 3U; k > 0U; k--)
+    {
+        sched_yield();
+    }
+    if (!(fieldCount == 2U && ((fieldIs(&field[0], 1U, 0U) && fieldIs(&field[1], 2U, 32U)) ||
+                               (fieldIs(&field[0], 2U, 0U) && fieldIs(&field[1], 1U, 32U)))))
+    {
+        rxBadView++;
+    }
+    return false;
+}
+
+/* Message n carries n in both halves, so each mapping writes n to sub 1 */
+static void receiveOne(void)
+{
+    can_message_t msg = {.identifier = 0x201, .data_length_code = 8};
+
+    rxSent++;
+    CO_setUint32(&msg.data[0], rxSent);
+    CO_setUint32(&msg.data[4], rxSent);
+    CO_PDO_receive(&RPDO, &msg);
+}
+
+static void *receiveThread(void *arg)
+{
+    (void)arg;
+    while (running)
+    {
+        receiveOne();
+        sched_yield();
+    }
+    return NULL;
+}
+
+/* Application in receive thread, message is consumed */
+static bool_t latCallback(void *object, const uint8_t *data, const CO_PDOfield_t *field, uint8_t fieldCount)
+{
+    uint32_t k = CO_getUint32(&data[field[0].bitOffset / 8U]);
+
+    (void)object;
+    (void)fieldCount;
+    latSamples[latCount++] = (float)((host_test_seconds() - latSendTime[k]) * 1e6);
+    return true;
+}
+
+/* SYNC/PDO thread, application reads mapped object after processing */
+static void *latPollThread(void *arg)
+{
+    double next = host_test_seconds();
+    int32_t last = 0;
+
+    (void)arg;
+    while (running)
+    {
+        int32_t value;
+
+        next += CO_MAIN_TASK_INTERVAL * 1e-6;
+        host_test_sleepUntil(next);
+        CO_RPDOsched_process(&sched, false, CO_MAIN_TASK_INTERVAL, NULL);
+        value = CO_OD_RAM.variableInt32[0];
+        if (value != last)
+        {
+            CHECK(value > last && value <= (int32_t)LAT_MESSAGES);
+            latSamples[latCount++] = (float)((host_test_seconds() - latSendTime[value]) * 1e6);
+            last = value;
+        }
+    }
+    return NULL;
+}
+
+static int latCompare(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Receive-to-application latency, messages are received 200 to 2200 us apart */
+static void latencyRun(bool callback)
+{
+    can_message_t msg = {.identifier = 0x201, .data_length_code = 8};
+    pthread_t poll;
+    uint32_t k, seed = 1U;
+    double t;
+
+    /* nothing left from previous runs */
+    CO_RPDOsched_process(&sched, false, 100, NULL);
+    CO_OD_RAM.variableInt32[0] = 0;
+    CO_RPDO_initCallbackRx(&RPDO, NULL, callback ? latCallback : NULL);
+    latCount = 0U;
+    running = true;
+    CHECK(pthread_create(&poll, NULL, latPollThread, NULL) == 0);
+    t = host_test_seconds();
+    for (k = 1U; k <= LAT_MESSAGES; k++)
+    {
+        seed = seed * 1103515245U + 12345U;
+        t += (200U + (seed >> 16) % 2000U) * 1e-6;
+        host_test_sleepUntil(t);
+        CO_setUint32(&msg.data[0], k);
+        CO_setUint32(&msg.data[4], k);
+        latSendTime[k] = host_test_seconds();
+        CO_PDO_receive(&RPDO, &msg);
+    }
+    host_test_sleepUntil(t + 3.0 * CO_MAIN_TASK_INTERVAL * 1e-6);
+    running = false;
+    pthread_join(poll, NULL);
+    CO_RPDO_initCallbackRx(&RPDO, NULL, rxCallback);
+
+    /* callback consumes all messages, polling may miss overwritten ones */
+    CHECK(callback ? (latCount == LAT_MESSAGES && CO_OD_RAM.variableInt32[0] == 0)
+                   : (latCount > 0U && CO_OD_RAM.variableInt32[0] == (int32_t)LAT_MESSAGES));
+    qsort(latSamples, latCount, sizeof(float), latCompare);
+    REPORT("latency %-8s %4u of %u messages, us p50 %6.1f p90 %6.1f p99 %6.1f max %6.1f",
+           callback ? "callback" : "polling", latCount, LAT_MESSAGES, latSamples[latCount / 2U],
+           latSamples[latCount * 9U / 10U], latSamples[latCount * 99U / 100U], latSamples[latCount - 1U]);
+}
+
+static void initRPDO(void)
+{
+    uint8_t i;
+
+    CO_ODmutex = xSemaphoreCreateMutex();
+    SDO.OD = CO_OD;
+    SDO.ODSize = CO_OD_NoOfElements;
+    SDO.ODExtensions = ODExtensions;
+
+    CO_RPDOplanPool_init(&RPDOplanPool, RPDOplan, 1);
+    RPDO.em = &em;
+    RPDO.SDO = &SDO;
+    RPDO.planPool = &RPDOplanPool;
+    RPDO.RPDOCommPar = &RPDOCommPar;
+    RPDO.RPDOMapPar = &RPDOMapPar;
+    RPDO.operatingState = &operatingState;
+    RPDO.valid = true;
+    RPDO.rxMap = &RPDO;
+    CO_RPDO_initCallbackRx(&RPDO, NULL, rxCallback);
+    RPDOMapPar.numberOfMappedObjects = 2;
+    RPDOMapPar.mappedObject1 = mapA[0];
+    RPDOMapPar.mappedObject2 = mapA[1];
+    CHECK(CO_RPDOconfigMap(&RPDO, 2) == 0U && RPDO.dataLength == 8U);
+    CO_RPDOsched_init(&sched, RPDOs, pending, received, heap, 1);
+    for (i = 0U; i < 2U; i++)
+    {
+        CHECK(fieldIs(&RPDO.plan->field[i], (uint8_t)(i + 1U), (uint8_t)(i * 32U)));
+    }
+}
+
+/* Control: field view written in place, while receive function reads it,
+ * must be seen torn. Returns number of torn views. */
+static uint32_t inPlaceRun(void)
+{
+    CO_PDOfield_t view[2][8];
+    uint32_t n;
+
+    memset(view, 0, sizeof(view));
+    view[0][0] = (CO_PDOfield_t){0x2110, 1, 0, 32};
+    view[0][1] = (CO_PDOfield_t){0x2110, 2, 32, 32};
+    view[1][0] = (CO_PDOfield_t){0x2110, 2, 0, 32};
+    view[1][1] = (CO_PDOfield_t){0x2110, 1, 32, 32};
+    rxSent = rxDelivered = rxBadView = 0U;
+    copyReceive = true;
+    for (n = 0U; n < SWAPS; n++)
+    {
+        test_memcpy(RPDO.plan->field, view[n & 1U], sizeof(RPDO.plan->field));
+    }
+    copyReceive = false;
+    memcpy(RPDO.plan->field, view[0], sizeof(RPDO.plan->field));
+    /* leave nothing for processing */
+    CO_FLAG_CLEAR(RPDO.CANrxNew[0]);
+    CO_FLAG_CLEAR(RPDO.CANrxNew[1]);
+    return rxBadView;
+}
+
+/* Swaps mapping SWAPS times, with receive function inside of the copies or
+ * on another thread. */
+static void swapRun(bool threaded)
+{
+    pthread_t receiver;
+    uint32_t n, swaps = 0U, calls = 0U, callsMax = 0U, callsOne = 0U;
+    uint32_t lastValue = (uint32_t)CO_OD_RAM.variableInt32[0], processed = 0U, sent;
+    double lastTime, gapSwap = 0.0, gapOther = 0.0;
+
+    /* message numbers keep growing */
+    sent = rxSent;
+    rxDelivered = rxBadView = 0U;
+    if (threaded)
+    {
+        running = true;
+        CHECK(pthread_create(&receiver, NULL, receiveThread, NULL) == 0);
+    }
+    else
+    {
+        copyReceive = true;
+    }
+    lastTime = host_test_seconds();
+
+    for (n = 0U; swaps < SWAPS; n++)
+    {
+        bool_t swapping = CO_FLAG_READ(sched.stagedNew);
+        uint32_t value;
+        double now;
+
+        /* stage new mapping in every fourth call, if previous is swapped in */
+        if (!swapping && (n & 3U) == 0U)
+        {
+            const uint32_t *map = (RPDOMapPar.mappedObject1 == mapA[0]) ? mapB : mapA;
+
+            CHECK(CO_RPDOsched_stageMap(&sched, 0, map, 2) == CO_SDO_AB_NONE);
+            CHECK(CO_RPDOsched_stageMap(&sched, 0, map, 2) == CO_SDO_AB_DATA_DEV_STATE);
+            swapping = true;
+            calls = 0U;
+        }
+        if (!threaded)
+        {
+            receiveOne();
+        }
+
+        CO_RPDOsched_process(&sched, false, 100, NULL);
+        calls++;
+
+        /* processing uses one mapping, sub 1 gets the whole message */
+        value = (uint32_t)CO_OD_RAM.variableInt32[0];
+        now = host_test_seconds();
+        if (value != lastValue)
+        {
+            double gap = now - lastTime;
+
+            CHECK(value > lastValue);
+            if (swapping && gap > gapSwap)
+            {
+                gapSwap = gap;
+            }
+            else if (!swapping && gap > gapOther)
+            {
+                gapOther = gap;
+            }
+            lastValue = value;
+            lastTime = now;
+            processed++;
+        }
+
+        if (swapping && !CO_FLAG_READ(sched.stagedNew))
+        {
+            swaps++;
+            if (calls == 1U)
+            {
+                callsOne++;
+            }
+            if (calls > callsMax)
+            {
+                callsMax = calls;
+            }
+            CHECK(RPDO.rxMap == &RPDO && RPDO.swapStep == 0U);
+            CHECK(RPDOMapPar.mappedObject1 == sched.staging.mapPar.mappedObject1);
+        }
+        if (threaded)
+        {
+            sched_yield();
+        }
+    }
+    if (threaded)
+    {
+        running = false;
+        pthread_join(receiver, NULL);
+    }
+    copyReceive = false;
+
+    sent = rxSent - sent;
+    REPORT("%s: %u swaps, %u messages, %u delivered, %u with torn field view, %u processed",
+           threaded ? "receive thread" : "receive inside copy", SWAPS, sent, rxDelivered, rxBadView, processed);
+    REPORT("  swap finished in the same call %u times, at most %u calls, longest interval between processed "
+           "messages %.0f us with swap, %.0f us without",
+           callsOne, callsMax, gapSwap * 1e6, gapOther * 1e6);
+    CHECK(rxBadView == 0U);
+    CHECK(rxDelivered == sent);
+    /* receive task is never preempted by processing on the same core, but a
+     * receive thread may be descheduled while inside, calls are not bound */
+    CHECK(threaded || callsOne == SWAPS);
+}
+
+int main(void)
+{
+    uint32_t torn;
+
+    initRPDO();
+    copyYield = true;
+    torn = inPlaceRun();
+    REPORT("in place control: %u views written, %u messages, %u with torn field view", SWAPS, rxSent, torn);
+    CHECK(torn > 0U);
+
+    swapRun(false);
+    swapRun(true);
+    copyYield = false;
+
+    /* synchronous RPDO swaps mapping only at SYNC */
+    {
+        CO_SYNC_t SYNC = {0};
+
+        RPDO.SYNC = &SYNC;
+        RPDO.synchronous = true;
+        CHECK(CO_RPDOsched_stageMap(&sched, 0, mapA, 2) == CO_SDO_AB_NONE);
+        CO_RPDOsched_process(&sched, false, 100, NULL);
+        CHECK(CO_FLAG_READ(sched.stagedNew) && RPDO.rxMap == &RPDO);
+        CO_RPDOsched_process(&sched, true, 100, NULL);
+        CHECK(!CO_FLAG_READ(sched.stagedNew) && fieldIs(&RPDO.plan->field[0], 1U, 0U));
+        RPDO.SYNC = NULL;
+        RPDO.synchronous = false;
+    }
+
+    latencyRun(true);
+    latencyRun(false);
+    return 0;
+}
@@ -0,0 +1,217 @@
+/*
+ * Expedited SDO fast path (CO_CONFIG_SDO_EXPEDITED_FAST): upload and download
+ * of each 1 to 4 byte subentry of node Object Dictionary give byte identical
+ * response and Object Dictionary data as the normal path, which serves the
+ * same request, when the entry has a pass-through Object Dictionary function.
+ * Erroneous and other requests are left to the normal path. Benchmark of round trips
+ * per second of both.
+ *
+ * CAN driver is replaced by CO_CANsend(), which captures the response.
+ */
+
+#include "../CO_SDOserver.c"
+
+#include "CO_OD.h"
+#include "CO_OD_desc.h"
+#include "host_test.h"
+
+extern const CO_OD_entry_t CO_OD[CO_OD_NoOfElements];
+
+#define NODE_ID 5U
+#define REQUESTS 400U
+#define ROUND_TRIPS 2000000UL
+
+SemaphoreHandle_t CO_ODmutex;
+
+static CO_SDO_t SDO;
+static CO_OD_extension_t ODExtensions[CO_OD_NoOfElements];
+static CO_OD_index_t ODindex;
+static uint16_t slot[CO_OD_INDEX_SLOTS(CO_OD_NoOfElements)];
+static uint16_t disp[CO_OD_INDEX_BUCKETS(CO_OD_NoOfElements)];
+static CO_CANmodule_t CANmodule;
+static CO_CANtx_t CANtx;
+static uint8_t response[8];
+static uint32_t odfCalls;
+
+static uint8_t upload[REQUESTS][8], download[REQUESTS][8];
+static uint16_t uploads, downloads;
+
+/******************************************************************************/
+CO_ReturnError_t CO_CANrxBufferInit(CO_CANmodule_t *CANmodule, uint16_t index, uint16_t ident, uint16_t mask,
+                                    bool_t rtr, void *object, void (*CANrx_callback)(void *object, void *message))
+{
+    return CO_ERROR_NO;
+}
+
+CO_CANtx_t *CO_CANtxBufferInit(CO_CANmodule_t *CANmodule, uint16_t index, uint16_t ident, bool_t rtr,
+                               uint8_t noOfBytes, bool_t syncFlag)
+{
+    return &CANtx;
+}
+
+CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer)
+{
+    memcpy(response, buffer->data, sizeof(response));
+    return CO_ERROR_NO;
+}
+
+/******************************************************************************/
+/* Lets normal path read and write Object Dictionary data as without it */
+static CO_SDO_abortCode_t passODF(CO_ODF_arg_t *ODF_arg)
+{
+    odfCalls++;
+    return CO_SDO_AB_NONE;
+}
+
+/* Serve one request, response is captured by CO_CANsend() */
+static void roundTrip(const uint8_t request[8])
+{
+    uint32_t timerNext_us = 1000U;
+
+    memset(CANtx.data, 0xAA, sizeof(CANtx.data));
+    memcpy(SDO.CANrxData[SDO.CANrxProc], request, 8);
+    CO_FLAG_SET(SDO.CANrxNew[SDO.CANrxProc]);
+    CO_SDO_process(&SDO, true, 0U, &timerNext_us);
+    CHECK(SDO.state == CO_SDO_ST_IDLE);
+}
+
+/* Response and OD data of request with fast path and with normal path */
+static void compare(const uint8_t request[8])
+{
+    uint16_t index = (uint16_t)(request[1] | (request[2] << 8));
+    uint16_t entryNo = CO_OD_find(&SDO, index);
+    uint8_t *ODdata = (uint8_t *)CO_OD_getDataPointer(&SDO, entryNo, request[3]);
+    uint16_t length = CO_OD_getLength(&SDO, entryNo, request[3]);
+    uint8_t original[4], fastData[4], fastResponse[8];
+    uint32_t calls = odfCalls;
+
+    memcpy(original, ODdata, length);
+    SDO.ODF_arg.ODdataStorage = NULL;
+    roundTrip(request);
+    /* fast path does not initialize transfer */
+    CHECK(SDO.ODF_arg.ODdataStorage == NULL);
+    memcpy(fastResponse, response, 8);
+    memcpy(fastData, ODdata, length);
+    CHECK((request[0] >> 5) == CCS_UPLOAD_INITIATE || memcmp(fastData, original, length) != 0);
+    /* subindex 0 of array may be constant */
+    if (memcmp(ODdata, original, length) != 0)
+    {
+        memcpy(ODdata, original, length);
+    }
+
+    ODExtensions[entryNo].pODFunc = passODF;
+    roundTrip(request);
+    ODExtensions[entryNo].pODFunc = NULL;
+    CHECK(odfCalls == calls + 1U && SDO.ODF_arg.ODdataStorage == ODdata);
+    CHECK(memcmp(fastResponse, response, 8) == 0);
+    CHECK(memcmp(fastData, ODdata, length) == 0);
+    if (memcmp(ODdata, original, length) != 0)
+    {
+        memcpy(ODdata, original, length);
+    }
+}
+
+static double benchmark(uint8_t (*requests)[8], uint16_t count, bool_t fast)
+{
+    double start;
+    uint32_t n;
+    uint16_t k;
+
+    for (k = 0U; !fast && k < count; k++)
+    {
+        ODExtensions[CO_OD_find(&SDO, (uint16_t)(requests[k][1] | (requests[k][2] << 8)))].pODFunc = passODF;
+    }
+    start = host_test_seconds();
+    for (n = 0U; n < ROUND_TRIPS; n++)
+    {
+        roundTrip(requests[n % count]);
+    }
+    start = host_test_seconds() - start;
+    for (k = 0U; !fast && k < count; k++)
+    {
+        ODExtensions[CO_OD_find(&SDO, (uint16_t)(requests[k][1] | (requests[k][2] << 8)))].pODFunc = NULL;
+    }
+    return (double)ROUND_TRIPS / start;
+}
+
+int main(void)
+{
+    /* requests left to normal path: download to read only, unknown object,
+     * wrong size, unknown subindex and clear 1003 */
+    static const uint8_t normal[][8] = {
+        {0x2F, 0x00, 0x10, 0x00, 0x01}, {0x40, 0x34, 0x12, 0x00}, {0x2F, 0x17, 0x10, 0x00, 0x01},
+        {0x40, 0x18, 0x10, 0x09},       {0x2F, 0x03, 0x10, 0x00},
+    };
+    static const uint8_t normalResponse[] = {0x80U, 0x80U, 0x80U, 0x80U, 0x60U};
+    static const uint8_t segmented[8] = {0x21, 0x17, 0x10, 0x00, 0x02};
+    double rate[4];
+    uint16_t i, k;
+
+    CO_ODmutex = xSemaphoreCreateMutex();
+    CHECK(CO_SDO_init(&SDO, 0x600U + NODE_ID, 0x580U + NODE_ID, OD_H1200_SDO_SERVER_PARAM, NULL, CO_OD,
+                      CO_OD_NoOfElements, ODExtensions, NODE_ID, 1000U, &CANmodule, 0, &CANmodule, 0) == CO_ERROR_NO);
+    CHECK(CO_OD_initIndex(&SDO, &ODindex, slot, disp) == CO_ERROR_NO);
+    CHECK(CO_OD_initDesc(&SDO, CO_OD_desc, CO_OD_descFirst) == CO_ERROR_NO);
+
+    /* expedited requests for all eligible subentries, download changes value */
+    for (i = 0U; i < CO_OD_NoOfElements; i++)
+    {
+        uint16_t sub;
+
+        if (ODExtensions[i].pODFunc != NULL)
+        {
+            continue;
+        }
+        for (sub = 0U; sub <= CO_OD[i].maxSubIndex; sub++)
+        {
+            uint16_t length = CO_OD_getLength(&SDO, i, (uint8_t)sub);
+            uint16_t attribute = CO_OD_getAttribute(&SDO, i, (uint8_t)sub);
+            const uint8_t *ODdata = (const uint8_t *)CO_OD_getDataPointer(&SDO, i, (uint8_t)sub);
+            uint8_t request[8] = {0x40, (uint8_t)CO_OD[i].index, (uint8_t)(CO_OD[i].index >> 8), (uint8_t)sub};
+
+            if (ODdata == NULL || length == 0U || length > 4U)
+            {
+                continue;
+            }
+            if ((attribute & CO_ODA_READABLE) != 0U)
+            {
+                memcpy(upload[uploads++], request, 8);
+            }
+            if ((attribute & CO_ODA_WRITEABLE) != 0U && !(CO_OD[i].index == 0x1003U && sub == 0U))
+            {
+                request[0] = (uint8_t)(0x23U | ((4U - length) << 2));
+                for (k = 0U; k < length; k++)
+                {
+                    request[4U + k] = (uint8_t)(ODdata[k] ^ (0x5AU + k));
+                }
+                memcpy(download[downloads++], request, 8);
+            }
+        }
+    }
+
+    for (k = 0U; k < uploads; k++)
+    {
+        compare(upload[k]);
+    }
+    for (k = 0U; k < downloads; k++)
+    {
+        compare(download[k]);
+    }
+    for (k = 0U; k < sizeof(normal) / sizeof(normal[0]); k++)
+    {
+        CHECK(!CO_SDO_expedited(&SDO, normal[k]));
+        roundTrip(normal[k]);
+        CHECK(response[0] == normalResponse[k]);
+    }
+    CHECK(!CO_SDO_expedited(&SDO, segmented));
+    REPORT("%u uploads and %u downloads byte identical with normal path, %u other requests left to it", uploads,
+           downloads, (unsigned)(sizeof(normal) / sizeof(normal[0]) + 1U));
+
+    rate[0] = benchmark(upload, uploads, true);
+    rate[1] = benchmark(upload, uploads, false);
+    rate[2] = benchmark(download, downloads, true);
+    rate[3] = benchmark(download, downloads, false);
+    REPORT("M round trips/s, fast / normal with pass-through ODF: upload %.1f / %.1f, download %.1f / %.1f",
+           rate[0] / 1e6, rate[1] / 1e6, rate[2] / 1e6, rate[3] / 1e6);
+    return 0;
+}
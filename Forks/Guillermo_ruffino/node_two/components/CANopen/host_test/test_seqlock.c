@@ -0,0 +1,160 @@
+/*
+ * RPDO receive buffer sequence counter (CO_SEQ_*): CAN receive function
+ * writes CANrxData on one thread, CO_RPDOsnapshot() reads it on another.
+ *
+ * The 8-byte copies yield to the other thread in the middle, zero to two
+ * times in turn, so reader and writer interleave inside the protected
+ * section in varying order also on a single CPU host.
+ */
+
+#include <string.h>
+
+static void *test_memcpy(void *dest, const void *src, size_t n);
+#define memcpy(dest, src, n) test_memcpy(dest, src, n)
+
+#include "../CO_PDO.c"
+
+#undef memcpy
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "host_test.h"
+
+#define WRITES 200000U
+
+static volatile bool copyYield;
+static CO_RPDO_t RPDO;
+static CO_NMT_internalState_t operatingState = CO_NMT_OPERATIONAL;
+static volatile bool writerDone;
+
+/* 8-byte copies of calling thread */
+static __thread uint32_t copies;
+
+static void *test_memcpy(void *dest, const void *src, size_t n)
+{
+    if ((n == 8U) && copyYield)
+    {
+        uint32_t k;
+
+        memcpy(dest, src, 4);
+        for (k = copies++ % 3U; k > 0U; k--)
+        {
+            sched_yield();
+        }
+        memcpy((uint8_t *)dest + 4, (const uint8_t *)src + 4, 4);
+        return dest;
+    }
+    return memcpy(dest, src, n);
+}
+
+/* Message n carries n and ~n, so a torn copy is detected */
+static void *writerThread(void *arg)
+{
+    uint32_t n;
+
+    (void)arg;
+    for (n = 1U; n <= WRITES; n++)
+    {
+        can_message_t msg = {.identifier = 0x20A, .data_length_code = 8};
+        uint32_t inv = ~n;
+
+        memcpy(&msg.data[0], &n, 4);
+        memcpy(&msg.data[4], &inv, 4);
+        CO_PDO_receive(&RPDO, &msg);
+        sched_yield();
+    }
+    writerDone = true;
+    return NULL;
+}
+
+static void resetRPDO(void)
+{
+    uint32_t inv = ~0U;
+
+    memset(&RPDO, 0, sizeof(RPDO));
+    RPDO.valid = true;
+    RPDO.rxMap = &RPDO;
+    RPDO.operatingState = &operatingState;
+    RPDO.dataLength = 8U;
+    memcpy(&RPDO.CANrxData[0][4], &inv, 4);
+    writerDone = false;
+}
+
+/* Reads while writer runs. Returns number of torn copies. */
+static uint32_t readerRun(bool_t useSeq, uint32_t *readsOut, uint32_t *busyOut, uint32_t *retryOut)
+{
+    pthread_t writer;
+    uint32_t last = 0U, reads = 0U, busy = 0U, torn = 0U;
+    uint32_t startCopies = copies;
+
+    resetRPDO();
+    copyYield = true;
+    CHECK(pthread_create(&writer, NULL, writerThread, NULL) == 0);
+    while (!writerDone)
+    {
+        uint8_t data[8];
+        uint32_t n, inv;
+
+        if (useSeq)
+        {
+            if (!CO_RPDOsnapshot(&RPDO, 0, data))
+            {
+                busy++;
+                sched_yield();
+                continue;
+            }
+        }
+        else
+        {
+            test_memcpy(data, RPDO.CANrxData[0], 8);
+        }
+        memcpy(&n, &data[0], 4);
+        memcpy(&inv, &data[4], 4);
+        reads++;
+        if (inv != ~n)
+        {
+            torn++;
+        }
+        else
+        {
+            CHECK(n >= last); /* no stale copy after a newer one */
+            last = n;
+        }
+    }
+    pthread_join(writer, NULL);
+    copyYield = false;
+    *readsOut = reads;
+    *busyOut = busy;
+    *retryOut = copies - startCopies - reads; /* copies repeated by CO_SEQ_READ_RETRY() */
+    return torn;
+}
+
+int main(void)
+{
+    uint32_t reads, busy, retry, torn;
+
+    /* control: without sequence counter, the yielding copies must tear */
+    torn = readerRun(false, &reads, &busy, &retry);
+    REPORT("unprotected: %u writes, %u reads, %u torn", WRITES, reads, torn);
+    CHECK(torn > 0U);
+
+    torn = readerRun(true, &reads, &busy, &retry);
+    REPORT("CO_RPDOsnapshot: %u writes, %u reads, %u while writer busy, %u retried, %u torn", WRITES, reads, busy,
+           retry, torn);
+    CHECK(torn == 0U);
+    CHECK(busy > 0U && retry > 0U);
+
+    /* writer finished, snapshot must return the last message */
+    {
+        uint8_t data[8];
+        uint32_t n;
+
+        CHECK(CO_RPDOsnapshot(&RPDO, 0, data));
+        memcpy(&n, data, 4);
+        CHECK(n == WRITES);
+        CHECK((RPDO.CANrxSeq[0] & 1U) == 0U);
+        CHECK(CO_FLAG_READ(RPDO.CANrxNew[0]));
+    }
+    return 0;
+}
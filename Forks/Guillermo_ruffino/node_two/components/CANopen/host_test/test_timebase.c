@@ -0,0 +1,57 @@
+/*
+ * CO_timebase: differences summed over many back-to-back calls equal the
+ * elapsed time, milliseconds lag by less than one millisecond, long gaps
+ * saturate without losing the reference.
+ */
+
+#include "../CO_timebase.c"
+
+#include "host_test.h"
+
+#define CALLS 1000000U
+
+int main(void)
+{
+    CO_timebase_t tbUs, tbMs;
+    int64_t start, elapsed;
+    uint64_t sumUs = 0U, sumMs = 0U;
+    uint32_t n, zeroMs = 0U;
+
+    CO_timebase_init(&tbUs);
+    tbMs = tbUs;
+    start = tbUs.previous_us;
+    for (n = 0U; n < CALLS; n++)
+    {
+        uint16_t ms = CO_timebase_diff_ms(&tbMs);
+
+        sumUs += CO_timebase_diff_us(&tbUs);
+        sumMs += ms;
+        if (ms == 0U)
+        {
+            zeroMs++;
+        }
+    }
+    elapsed = CO_timebase_now_us() - start;
+
+    REPORT("%u calls in %.1f ms: sum of us differences %.3f ms, sum of ms differences %u ms, %u calls with 0 ms",
+           CALLS, (double)elapsed / 1e3, (double)sumUs / 1e3, (unsigned)sumMs, zeroMs);
+    /* reference is advanced only by returned time */
+    CHECK((int64_t)sumUs == tbUs.previous_us - start);
+    CHECK((int64_t)sumMs * 1000 == tbMs.previous_us - start);
+    CHECK((int64_t)sumUs <= elapsed);
+    CHECK(tbMs.previous_us <= tbUs.previous_us && tbUs.previous_us - tbMs.previous_us < 1000);
+
+    /* fraction of millisecond is carried */
+    tbMs.previous_us = CO_timebase_now_us() - 2500;
+    CHECK(CO_timebase_diff_ms(&tbMs) >= 2U);
+    CHECK(CO_timebase_now_us() - tbMs.previous_us >= 500);
+
+    /* saturation keeps the rest for next calls */
+    tbUs.previous_us = CO_timebase_now_us() - (int64_t)UINT32_MAX - 1000000;
+    CHECK(CO_timebase_diff_us(&tbUs) == UINT32_MAX);
+    CHECK(CO_timebase_diff_us(&tbUs) >= 1000000U);
+    tbMs.previous_us = CO_timebase_now_us() - (int64_t)UINT16_MAX * 1000 - 5000;
+    CHECK(CO_timebase_diff_ms(&tbMs) == UINT16_MAX);
+    CHECK(CO_timebase_diff_ms(&tbMs) >= 5U);
+    return 0;
+}
@@ -3,7 +3,7 @@
 
 //####  MAIN CONFIG  ####
 #define BOOT_WAIT 2000
-#define MAIN_WAIT 100 /** Time in ms between every main loop cycle */
+#define MAIN_WAIT 100 /** Maximum time in ms between main loop cycles, mainline wakes earlier on CANopen timers and received messages */
 
 //----------------------------------
 
@@ -3,6 +3,7 @@
 #include <unistd.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_err.h"
 #include "esp_event.h"
 #include "esp_log.h"
@@ -16,6 +17,7 @@
 #include "CANopen.h"
 #include "CO_OD.h"
 #include "CO_config.h"
+#include "CO_timebase.h"
 #include "modul_config.h"
 
 #include <sys/param.h>
@@ -24,16 +26,41 @@
 
 uint8_t counter = 0;
 uint8_t LED_red, LED_green;
-volatile uint16_t CO_timer1ms = 0U; /* variable increments each millisecond */
 volatile static bool_t CANopenConfiguredOK = false;
-volatile uint32_t coInterruptCounter = 0U; /* variable increments each millisecond */
+volatile uint32_t coInterruptCounter = 0U; /* variable increments on each SYNC/PDO task pass */
 
 //Timer Interrupt Configuration
-static void coMainTask(void *arg);
+static void coTimerCallback(void *arg);
+static void coSyncSignal(void *object);
+static void coRtTask(void *pvParameter);
+static void coRtPark(void);
+static void coRtRelease(void);
+static void coRtTimerArm(uint32_t time_us);
+static void coMainSignal(void *object);
+static void coMainSignalInit(void);
+static TickType_t coSleepTicks(uint32_t time_us);
 
 esp_timer_create_args_t coMainTaskArgs;
-//Timer Handle
-esp_timer_handle_t periodicTimer;
+//One-shot timer, wakes SYNC/PDO task at its next deadline
+esp_timer_handle_t coRtTimer;
+//SYNC/PDO task handle, task is pinned to CO_RT_CORE
+static TaskHandle_t coRtTaskHandle = NULL;
+//Mainline task handle, notified by CANopen objects after message reception
+static TaskHandle_t mainTaskHandle = NULL;
+//Park handshake, coRtTask stays away from CANopen objects while mainline resets them.
+//Task starts parked, mainline releases it after the first communication reset.
+static volatile bool_t coRtParkRequest = true;
+static SemaphoreHandle_t coRtParked = NULL;   /* given by coRtTask, when it is parked */
+static SemaphoreHandle_t coRtReleased = NULL; /* given by mainline, when reset is done */
+
+#if CO_JITTER_MEASURE
+static volatile int64_t coSyncRxTime_us = 0;       /* time of last SYNC reception */
+static volatile int64_t coBurstSyncTime_us = -1;    /* SYNC reception of TPDO burst in transmission, -1 if none */
+static uint32_t coJitterSamples[CO_JITTER_SAMPLES]; /* SYNC reception to last TPDO transmitted in us */
+static uint16_t coJitterCount = 0U;                 /* filled by CAN transmit task, reset by mainline */
+static void coBurstSent(void *object);
+static void coJitterLog(void);
+#endif
 
 void mainTask(void *pvParameter)
 {
@@ -63,6 +90,8 @@ void mainTask(void *pvParameter)
 
 		gpio_config(&io_conf);
 
+		mainTaskHandle = xTaskGetCurrentTaskHandle();
+
 		/* Allocate memory */
 		err = CO_new(&heapMemoryUsed);
 		if (err != CO_ERROR_NO) {
@@ -71,11 +100,20 @@ void mainTask(void *pvParameter)
 				printf("Allocated %d bytes for CANopen objects\n", heapMemoryUsed);
 		}
 
-		coMainTaskArgs.callback = &coMainTask;
+		coMainTaskArgs.callback = &coTimerCallback;
 		coMainTaskArgs.name = "coMainTask";
 		reset = CO_RESET_NOT;
 		vTaskDelay(BOOT_WAIT / portTICK_PERIOD_MS);
 
+		/* SYNC/PDO processing runs on its own core, away from WiFi/LwIP and mainline */
+		coRtParked = xSemaphoreCreateBinary();
+		coRtReleased = xSemaphoreCreateBinary();
+		xTaskCreatePinnedToCore(&coRtTask, "coRtTask", CO_RT_TASK_STACK_SIZE, NULL,
+		                        CO_RT_TASK_PRIORITY, &coRtTaskHandle, CO_RT_CORE);
+
+		/* Configure timer for SYNC/PDO task, which arms it for its next deadline */
+		ESP_ERROR_CHECK(esp_timer_create(&coMainTaskArgs, &coRtTimer));
+
 		OD_powerOnCounter++;
 
 		printf("CANopenNode - Reset application, count = %d\n",
@@ -85,10 +123,13 @@ void mainTask(void *pvParameter)
 		{
 				/* CANopen communication reset - initialize CANopen objects
 				 * *******************/
-				uint16_t timer1msPrevious = 0;
+				CO_timebase_t mainTimebase;
 
 				printf("CANopenNode - Reset communication...\n");
 
+				/* SYNC/PDO task must not run, while its objects are initialized */
+				coRtPark();
+
 				/* disable CAN and CAN interrupts */
 				CANopenConfiguredOK = false;
 
@@ -105,9 +146,16 @@ void mainTask(void *pvParameter)
 				err = CO_CANopenInit(activeNodeId);
 				if (err == CO_ERROR_NO) {
 						CANopenConfiguredOK = true;
+						/* wake SYNC/PDO task directly on SYNC reception */
+						CO_SYNC_initCallbackPre(CO->SYNC, NULL, coSyncSignal);
+#if CO_JITTER_MEASURE
+						/* latency sample is taken, when the last TPDO is on the bus */
+						CO_CANmodule_initCallbackBurstSent(CO->CANmodule[0], NULL, coBurstSent);
+#endif
 				} else if (err != CO_ERROR_NODE_ID_UNCONFIGURED_LSS) {
 						printf("Error: CANopen initialization failed: %d\n", err);
 				}
+				coMainSignalInit();
 
 				/* CANopen communication reset - initialize CANopen objects *******************/
 				CO_ReturnError_t err;
@@ -121,28 +169,23 @@ void mainTask(void *pvParameter)
 				// 		CO_errorReport(CO->em, CO_EM_MEMORY_ALLOCATION_ERROR, CO_EMC_SOFTWARE_INTERNAL, err);
 				// 		esp_restart();
 				// }
-				/* Configure Timer interrupt function for execution every CO_MAIN_TASK_INTERVAL */
-				ESP_ERROR_CHECK(esp_timer_create(&coMainTaskArgs, &periodicTimer));
-				ESP_ERROR_CHECK(esp_timer_start_periodic(periodicTimer, CO_MAIN_TASK_INTERVAL));
 
 				/* start CAN */
 				CO_CANsetNormalMode(CO->CANmodule[0]);
+				coRtRelease();
 
 				reset = CO_RESET_NOT;
 				coInterruptCounterPrevious = coInterruptCounter;
+				CO_timebase_init(&mainTimebase);
 
 				while (reset == CO_RESET_NOT)
 				{
 						/* loop for normal program execution
 						 * ******************************************/
-						uint16_t timer1msCopy, timer1msDiff;
-
-						timer1msCopy = CO_timer1ms;
-						timer1msDiff = timer1msCopy - timer1msPrevious;
-						timer1msPrevious = timer1msCopy;
+						uint32_t timerNext_us = MAIN_WAIT * 1000;
 
 						/* CANopen process */
-						reset = CO_process(CO, (uint32_t)timer1msDiff * 1000, NULL);
+						reset = CO_process(CO, CO_timebase_diff_us(&mainTimebase), &timerNext_us);
 						LED_red = CO_LED_RED(CO->LEDs, CO_LED_CANopen);
 						LED_green = CO_LED_GREEN(CO->LEDs, CO_LED_CANopen);
 
@@ -167,10 +210,15 @@ void mainTask(void *pvParameter)
 						// 		ESP_LOGI("ADC", "val: %d", val);
 						// }
 
+#if CO_JITTER_MEASURE
+						if (__atomic_load_n(&coJitterCount, __ATOMIC_ACQUIRE) >= CO_JITTER_SAMPLES)
+								coJitterLog();
+#endif
+
 						/* Process EEPROM */
 
-						/* optional sleep for short time */
-						vTaskDelay(pdMS_TO_TICKS(1000));
+						/* sleep until next CANopen timer expires or received message wakes us */
+						ulTaskNotifyTake(pdTRUE, coSleepTicks(timerNext_us));
 				}
 		}
 		/* program exit
@@ -179,27 +227,182 @@ void mainTask(void *pvParameter)
 		esp_restart();
 }
 
-/* CanOpen-Task executes in constant intervals ********************************/
-static void coMainTask(void *arg)
+/* Called from CAN receive task after SDO, EMCY, NMT, HB or LSS reception *****/
+static void coMainSignal(void *object)
+{
+		if (mainTaskHandle != NULL)
+				xTaskNotifyGive(mainTaskHandle);
+}
+
+/* Register coMainSignal with all objects processed by CO_process() ************/
+static void coMainSignalInit(void)
+{
+		int i;
+
+		CO_EM_initCallbackPre(CO->em, NULL, coMainSignal);
+		CO_NMT_initCallbackPre(CO->NMT, NULL, coMainSignal);
+		for (i = 0; i < CO_NO_SDO_SERVER; i++)
+				CO_SDO_initCallbackPre(CO->SDO[i], NULL, coMainSignal);
+#if CO_NO_SDO_CLIENT != 0
+		for (i = 0; i < CO_NO_SDO_CLIENT; i++)
+				CO_SDOclient_initCallbackPre(CO->SDOclient[i], NULL, coMainSignal);
+#endif
+#if CO_NO_HB_CONS > 0
+		CO_HBconsumer_initCallbackPre(CO->HBcons, NULL, coMainSignal);
+#endif
+#if CO_NO_TIME == 1
+		CO_TIME_initCallbackPre(CO->TIME, NULL, coMainSignal);
+#endif
+#if CO_NO_LSS_SLAVE == 1
+		CO_LSSslave_initCallbackPre(CO->LSSslave, NULL, coMainSignal);
+#endif
+}
+
+/* Mainline sleep time in ticks, rounded up. At least one tick, so lower
+ * priority tasks on this core still run while CANopen asks for immediate call */
+static TickType_t coSleepTicks(uint32_t time_us)
+{
+		TickType_t ticks = (time_us + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000);
+		return ticks > 0 ? ticks : 1;
+}
+
+/* One-shot timer wakes SYNC/PDO task at its next deadline ********************/
+static void coTimerCallback(void *arg)
 {
-		coInterruptCounter++;
+		if (coRtTaskHandle != NULL)
+				xTaskNotifyGive(coRtTaskHandle);
+}
 
-		if (CO->CANmodule[0]->CANnormal)
+/* Called from CAN receive task after SYNC reception ***************************/
+static void coSyncSignal(void *object)
+{
+#if CO_JITTER_MEASURE
+		coSyncRxTime_us = esp_timer_get_time();
+#endif
+		if (coRtTaskHandle != NULL)
+				xTaskNotifyGive(coRtTaskHandle);
+}
+
+/* Stop coRtTask before communication reset, called from mainline. Returns,
+ * when coRtTask has finished its current pass and waits for coRtRelease(). */
+static void coRtPark(void)
+{
+		coRtParkRequest = true;
+		xTaskNotifyGive(coRtTaskHandle);
+		xSemaphoreTake(coRtParked, portMAX_DELAY);
+}
+
+/* Let coRtTask run again with reinitialized CANopen objects */
+static void coRtRelease(void)
+{
+		coRtParkRequest = false;
+		xSemaphoreGive(coRtReleased);
+}
+
+/* Wake coRtTask after time_us, at least after CO_RT_TIMER_MIN. Replaces
+ * running timer, if coRtTask was woken earlier by SYNC. */
+static void coRtTimerArm(uint32_t time_us)
+{
+		if (time_us < CO_RT_TIMER_MIN)
+				time_us = CO_RT_TIMER_MIN;
+		esp_timer_stop(coRtTimer); /* fails harmlessly, if timer has fired */
+		ESP_ERROR_CHECK(esp_timer_start_once(coRtTimer, time_us));
+}
+
+/* SYNC/PDO task, pinned to CO_RT_CORE ******************************************/
+static void coRtTask(void *pvParameter)
+{
+		CO_timebase_t rtTimebase;
+
+		CO_timebase_init(&rtTimebase);
+		for (;;)
 		{
-				bool_t syncWas;
+				ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
-				/* Process Sync */
-				syncWas = CO_process_SYNC(CO, CO_MAIN_TASK_INTERVAL, NULL);
+				if (coRtParkRequest)
+				{
+						/* mainline resets CANopen objects, wait until it is done */
+						xSemaphoreGive(coRtParked);
+						xSemaphoreTake(coRtReleased, portMAX_DELAY);
+						CO_timebase_init(&rtTimebase);
+						coRtTimerArm(0);
+						continue;
+				}
 
-				/* Read inputs */
-				CO_process_RPDO(CO, syncWas);
+				/* woken by timer or by SYNC, so measure the real interval */
+				uint32_t timeDifference_us = CO_timebase_diff_us(&rtTimebase);
+				/* SYNC/PDO objects lower it to their next deadline. Change of
+				 * State of TPDOs and received RPDOs are polled at this interval. */
+				uint32_t timerNext_us = CO_MAIN_TASK_INTERVAL;
+				coInterruptCounter++;
 
-				/* Write outputs */
-				CO_process_TPDO(CO, syncWas, CO_MAIN_TASK_INTERVAL, NULL);
+				if (CO->CANmodule[0]->CANnormal)
+				{
+						bool_t syncWas;
+
+						/* Process Sync */
+						syncWas = CO_process_SYNC(CO, timeDifference_us, &timerNext_us);
+
+						/* Read inputs */
+						CO_process_RPDO(CO, syncWas, timeDifference_us, &timerNext_us);
+
+#if CO_JITTER_MEASURE
+						/* synchronous TPDOs are still in CAN TX queue and in pending
+						 * list after CO_process_TPDO(), coBurstSent() takes the sample */
+						if (syncWas)
+								coBurstSyncTime_us = coSyncRxTime_us;
+#endif
+
+						/* Write outputs */
+						CO_process_TPDO(CO, syncWas, timeDifference_us, &timerNext_us);
+
+#if CO_JITTER_MEASURE
+						if (syncWas && CO->TPDOsched->syncSent == 0U)
+								coBurstSyncTime_us = -1;
+#endif
+				}
+				coRtTimerArm(timerNext_us);
 		}
 }
 
+#if CO_JITTER_MEASURE
+/* Called from CAN transmit task, when the last TPDO of SYNC burst is transmitted */
+static void coBurstSent(void *object)
+{
+		int64_t syncTime_us = coBurstSyncTime_us;
+		uint16_t count = __atomic_load_n(&coJitterCount, __ATOMIC_ACQUIRE);
+
+		coBurstSyncTime_us = -1;
+		if (syncTime_us >= 0 && count < CO_JITTER_SAMPLES)
+		{
+				coJitterSamples[count] = (uint32_t)(esp_timer_get_time() - syncTime_us);
+				__atomic_store_n(&coJitterCount, count + 1, __ATOMIC_RELEASE);
+		}
+}
+
+static int coJitterCompare(const void *a, const void *b)
+{
+		uint32_t x = *(const uint32_t *)a;
+		uint32_t y = *(const uint32_t *)b;
+		return (x > y) - (x < y);
+}
+
+/* Log SYNC to last TPDO transmitted latency percentiles, called from mainline when samples are full */
+static void coJitterLog(void)
+{
+		qsort(coJitterSamples, CO_JITTER_SAMPLES, sizeof(coJitterSamples[0]), coJitterCompare);
+		ESP_LOGI("coJitter", "SYNC to last TPDO transmitted latency us (%u sync TPDOs): p50 %u, p90 %u, p99 %u, max %u",
+		         CO->TPDOsched->syncSent,
+		         coJitterSamples[CO_JITTER_SAMPLES * 50 / 100],
+		         coJitterSamples[CO_JITTER_SAMPLES * 90 / 100],
+		         coJitterSamples[CO_JITTER_SAMPLES * 99 / 100],
+		         coJitterSamples[CO_JITTER_SAMPLES - 1]);
+		__atomic_store_n(&coJitterCount, 0, __ATOMIC_RELEASE);
+}
+#endif
+
 void app_main()
 {
-		xTaskCreate(&mainTask, "mainTask", 4096, NULL, 5, NULL);
+		xTaskCreatePinnedToCore(&mainTask, "mainTask", CO_MAIN_TASK_STACK_SIZE, NULL,
+		                        CO_MAIN_TASK_PRIORITY, NULL, CO_MAIN_CORE);
 }
\ No newline at end of file
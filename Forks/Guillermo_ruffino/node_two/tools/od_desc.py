@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+"""
+Generate flat Object Dictionary descriptor table from CO_OD.c.
+
+CO_OD.c is generated from EDS by libedssharp Object Dictionary Editor. This
+script reads its CO_OD[] and OD_record arrays and writes CO_OD_desc.c and
+CO_OD_desc.h with one (pData, attribute, length) descriptor for each index
+and subindex, so CO_OD_getLength(), CO_OD_getAttribute() and
+CO_OD_getDataPointer() do not need to branch on object type. See
+CO_OD_initDesc() in CO_SDOserver.h.
+
+Run it each time CO_OD.c is regenerated:
+
+    python3 tools/od_desc.py components/CANopen/CO_OD.c
+
+Output is written next to CO_OD.c, or to directory given with -o.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+CO_ODA_READABLE = 0x04
+CO_ODA_WRITEABLE = 0x08
+CO_ODA_RPDO_MAPABLE = 0x10
+
+DOMAIN_LENGTH = "CO_CONFIG_SDO_BUFFER_SIZE"
+
+RE_RECORD = re.compile(
+    r"const\s+CO_OD_entryRecord_t\s+(\w+)\s*\[\s*\d+\s*\]\s*=\s*\{(.*?)\};", re.S)
+RE_RECORD_MEMBER = re.compile(
+    r"\{\s*(\(void\s*\*\)\s*[^,]+?)\s*,\s*(0x[0-9A-Fa-f]+|\d+)\s*,\s*(0x[0-9A-Fa-f]+|\d+)\s*\}")
+RE_OD = re.compile(
+    r"const\s+CO_OD_entry_t\s+CO_OD\s*\[[^\]]*\]\s*=\s*\{(.*?)\n\};", re.S)
+RE_ENTRY = re.compile(
+    r"\{\s*(0x[0-9A-Fa-f]+)\s*,\s*(0x[0-9A-Fa-f]+)\s*,\s*(0x[0-9A-Fa-f]+)\s*,"
+    r"\s*(\d+)\s*,\s*(\(void\s*\*\)\s*[^}]+?)\s*\}")
+
+
+def is_null(ptr):
+    """True for (void*)0, used for domain data type."""
+    return re.sub(r"\s", "", ptr) in ("(void*)0", "(void*)NULL")
+
+
+def array_member(ptr, sub):
+    """Pointer to array member sub, from pointer to the first member."""
+    if not ptr.endswith("[0]"):
+        sys.exit("array data pointer must end with [0]: " + ptr)
+    return "%s[%d]" % (ptr[:-3], sub - 1)
+
+
+def parse(text):
+    records = {}
+    for name, body in RE_RECORD.findall(text):
+        records[name] = [(p, int(a, 0), int(l, 0)) for p, a, l in RE_RECORD_MEMBER.findall(body)]
+
+    od = RE_OD.search(text)
+    if od is None:
+        sys.exit("CO_OD[] not found")
+    entries = [(int(i, 16), int(m, 16), int(a, 16), int(l), p)
+               for i, m, a, l, p in RE_ENTRY.findall(od.group(1))]
+    if not entries:
+        sys.exit("CO_OD[] is empty")
+    return records, entries
+
+
+def descriptors(records, entries):
+    """List of (index, subIndex, pData, attribute, length) and first descriptor of each entry."""
+    desc = []
+    first = []
+
+    for k, (index, maxSub, attr, length, ptr) in enumerate(entries):
+        first.append(len(desc))
+
+        if maxSub == 0:
+            # Var
+            if is_null(ptr):
+                desc.append((index, 0, "(void*)0", attr, DOMAIN_LENGTH))
+            else:
+                desc.append((index, 0, ptr, attr, str(length)))
+
+        elif attr != 0:
+            # Array, subindex 0 is read only, except for 0x1003
+            attr0 = attr
+            if index == 0x1003:
+                attr0 |= CO_ODA_WRITEABLE
+            else:
+                attr0 = (attr0 & ~(CO_ODA_WRITEABLE | CO_ODA_RPDO_MAPABLE)) | CO_ODA_READABLE
+            desc.append((index, 0, "(void*)&CO_OD[%d].maxSubIndex" % k, attr0, "1"))
+            for sub in range(1, maxSub + 1):
+                if is_null(ptr):
+                    desc.append((index, sub, "(void*)0", attr, DOMAIN_LENGTH))
+                else:
+                    desc.append((index, sub, array_member(ptr, sub), attr, str(length)))
+
+        else:
+            # Record
+            name = re.sub(r"^\(void\s*\*\)\s*&?", "", ptr).strip()
+            members = records.get(name)
+            if members is None or len(members) < maxSub + 1:
+                sys.exit("record %s of index 0x%04X not found" % (name, index))
+            for sub in range(maxSub + 1):
+                p, a, l = members[sub]
+                if is_null(p):
+                    desc.append((index, sub, "(void*)0", a, DOMAIN_LENGTH))
+                else:
+                    desc.append((index, sub, p, a, str(l)))
+
+    first.append(len(desc))
+    return desc, first
+
+
+def write(outDir, source, entries, desc, first):
+    name = os.path.basename(source)
+    header = """// clang-format off
+/*******************************************************************************
+
+   File - CO_OD_desc.c/CO_OD_desc.h
+   Flat CANopen Object Dictionary descriptor table.
+
+   This file was automatically generated from %s with tools/od_desc.py
+   DON'T EDIT THIS FILE MANUALLY !!!!
+*******************************************************************************/
+""" % name
+
+    with open(os.path.join(outDir, "CO_OD_desc.h"), "w") as f:
+        f.write(header)
+        f.write("""
+#ifndef CO_OD_DESC_H_
+#define CO_OD_DESC_H_
+
+#include "CO_OD.h"
+#include "CO_SDOserver.h"
+
+/* Number of OD entries, which table was generated for, must match CO_OD.h */
+   #define CO_OD_DESC_NoOfElements        %d
+/* Number of descriptors, one for each index and subindex */
+   #define CO_OD_NoOfDescriptors          %d
+
+#if CO_OD_DESC_NoOfElements != CO_OD_NoOfElements
+#error CO_OD_desc.c is out of date, run tools/od_desc.py
+#endif
+
+extern const CO_OD_desc_t CO_OD_desc[CO_OD_NoOfDescriptors];
+extern const uint16_t CO_OD_descFirst[CO_OD_NoOfElements + 1];
+
+#endif /* CO_OD_DESC_H_ */
+""" % (len(entries), len(desc)))
+
+    with open(os.path.join(outDir, "CO_OD_desc.c"), "w") as f:
+        f.write(header)
+        f.write("""
+
+#include "CO_driver.h"
+#include "CO_OD_desc.h"
+
+
+/* Object Dictionary, data of array subindex 0 is its maxSubIndex */
+extern const CO_OD_entry_t CO_OD[CO_OD_NoOfElements];
+
+/*******************************************************************************
+   DESCRIPTORS, one for each index and subindex
+*******************************************************************************/
+const CO_OD_desc_t CO_OD_desc[CO_OD_NoOfDescriptors] = {
+""")
+        for index, sub, p, a, l in desc:
+            f.write("/*%04X %02X*/ {%s, 0x%02X, %s},\n" % (index, sub, p, a, l))
+        f.write("""};
+
+
+/*******************************************************************************
+   FIRST DESCRIPTOR of each CO_OD[] entry, last element is the end of table
+*******************************************************************************/
+const uint16_t CO_OD_descFirst[CO_OD_NoOfElements + 1] = {
+""")
+        for k, pos in enumerate(first):
+            comment = "%04X" % entries[k][0] if k < len(entries) else "end "
+            f.write("/*%s*/ %d,\n" % (comment, pos))
+        f.write("};\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate CO_OD_desc.c/.h from CO_OD.c")
+    parser.add_argument("source", help="CO_OD.c, generated by libedssharp")
+    parser.add_argument("-o", "--outdir", help="output directory, default is directory of source")
+    args = parser.parse_args()
+
+    with open(args.source) as f:
+        records, entries = parse(f.read())
+    desc, first = descriptors(records, entries)
+    write(args.outdir or os.path.dirname(os.path.abspath(args.source)), args.source, entries, desc, first)
+
+
+if __name__ == "__main__":
+    main()